@@ -3,6 +3,8 @@ import 'dart:async';
 
 import 'package:flutter/services.dart';
 import 'package:openautoflutter/openautoflutter.dart';
+import 'package:openautoflutter/openautoflutter_ffi.dart';
+import 'package:openautoflutter/openautoflutter_video_view.dart';
 
 void main() {
   runApp(const MyApp());
@@ -18,14 +20,27 @@ class MyApp extends StatefulWidget {
 class _MyAppState extends State<MyApp> {
   String _platformVersion = 'Unknown';
   final _openautoflutterPlugin = Openautoflutter();
+  late final TouchBatcher _touchBatcher = TouchBatcher(_openautoflutterPlugin);
+  final OpenautoflutterFfi? _ffi = OpenautoflutterFfi.instance;
   int? _videoTextureId;
   final Set<int> _activePointers = <int>{};
   Size? _textureSize;
+  TransportStatus _transport = const TransportStatus(state: TransportState.idle);
+  StreamSubscription<TransportStatus>? _transportSub;
 
   @override
   void initState() {
     super.initState();
     initPlatformState();
+    _transportSub = _openautoflutterPlugin.connectionStatus.listen((status) {
+      if (mounted) setState(() => _transport = status);
+    });
+  }
+
+  @override
+  void dispose() {
+    _transportSub?.cancel();
+    super.dispose();
   }
 
   // Platform messages are asynchronous, so we initialize in an async method.
@@ -61,12 +76,16 @@ class _MyAppState extends State<MyApp> {
     final double xNorm = (event.localPosition.dx / size.width).clamp(0.0, 1.0);
     final double yNorm = (event.localPosition.dy / size.height).clamp(0.0, 1.0);
 
-    _openautoflutterPlugin.sendTouchEvent(
+    final touch = TouchEvent(
       pointerId: event.pointer,
       x: xNorm,
       y: yNorm,
       action: action,
     );
+    // Prefer the synchronous FFI path; fall back to the binary channel.
+    if (_ffi?.sendTouch(touch) != true) {
+      _touchBatcher.add(touch);
+    }
   }
 
   void _handlePointerDown(PointerDownEvent event) {
@@ -107,6 +126,9 @@ class _MyAppState extends State<MyApp> {
               crossAxisAlignment: CrossAxisAlignment.center,
               children: [
                 Text('Running on: $_platformVersion'),
+                Text(_transport.state == TransportState.backoff
+                    ? 'Transport: retrying in ${_transport.retryIn.inMilliseconds} ms (attempt ${_transport.attempt})'
+                    : 'Transport: ${_transport.state.name}'),
                 const SizedBox(height: 12),
                 if (_videoTextureId == null)
                   const Text('Texture not available')
@@ -138,7 +160,10 @@ class _MyAppState extends State<MyApp> {
                               onPointerMove: _handlePointerMove,
                               onPointerUp: _handlePointerUp,
                               onPointerCancel: _handlePointerCancel,
-                              child: Texture(textureId: _videoTextureId!),
+                              child: VideoTextureView(
+                                textureId: _videoTextureId!,
+                                plugin: _openautoflutterPlugin,
+                              ),
                             ),
                           ),
                         );
@@ -1,3 +1,5 @@
+import 'dart:async';
+import 'dart:typed_data';
 
 import 'openautoflutter_platform_interface.dart';
 
@@ -27,6 +29,431 @@ extension TouchActionCode on TouchAction {
   }
 }
 
+/// One touch sample in normalized texture coordinates.
+class TouchEvent {
+  const TouchEvent({
+    required this.pointerId,
+    required this.x,
+    required this.y,
+    required this.action,
+  });
+
+  final int pointerId;
+  final double x;
+  final double y;
+  final TouchAction action;
+
+  /// Size of one packed record on the touch channel.
+  static const int packedSize = 16;
+
+  /// Packs [events] into the native TouchMessage layout.
+  static ByteData pack(List<TouchEvent> events) {
+    final data = ByteData(events.length * packedSize);
+    var offset = 0;
+    for (final e in events) {
+      data.setFloat32(offset, e.x, Endian.little);
+      data.setFloat32(offset + 4, e.y, Endian.little);
+      data.setUint32(offset + 8, e.pointerId, Endian.little);
+      data.setUint32(offset + 12, e.action.code, Endian.little);
+      offset += packedSize;
+    }
+    return data;
+  }
+}
+
+/// Collects touches produced in the same event-loop turn (one pointer packet
+/// usually dispatches several events synchronously) and sends them as a
+/// single binary message from a microtask.
+class TouchBatcher {
+  TouchBatcher(this._plugin);
+
+  final Openautoflutter _plugin;
+  final List<TouchEvent> _pending = <TouchEvent>[];
+  bool _scheduled = false;
+
+  void add(TouchEvent event) {
+    _pending.add(event);
+    if (_scheduled) return;
+    _scheduled = true;
+    scheduleMicrotask(flush);
+  }
+
+  void flush() {
+    _scheduled = false;
+    if (_pending.isEmpty) return;
+    final batch = List<TouchEvent>.of(_pending);
+    _pending.clear();
+    _plugin.sendTouchEvents(batch);
+  }
+}
+
+/// Compressed video formats the native decoder accepts.
+enum VideoCodec {
+  h264,
+
+  /// H.265/HEVC, for head units that negotiate it; roughly half the bitrate
+  /// of H.264 at similar quality.
+  h265,
+}
+
+/// A native video pipeline (decoder plus Flutter texture).
+class VideoStream {
+  const VideoStream({required this.streamId, required this.textureId});
+
+  /// Stream 0 is the primary stream fed by the transport's VIDEO messages.
+  final int streamId;
+
+  /// Pass to a `Texture` widget.
+  final int textureId;
+}
+
+/// Transport connection states reported by the plugin's reconnect supervisor.
+enum TransportState {
+  idle,
+  connecting,
+  connected,
+  backoff,
+  stopped,
+}
+
+/// Snapshot of the transport connection.
+class TransportStatus {
+  const TransportStatus({
+    required this.state,
+    this.attempt = 0,
+    this.retryIn = Duration.zero,
+    this.connects = 0,
+  });
+
+  factory TransportStatus.fromMap(Map<String, Object?> map) {
+    final name = map['state'] as String?;
+    return TransportStatus(
+      state: TransportState.values.firstWhere((s) => s.name == name, orElse: () => TransportState.idle),
+      attempt: map['attempt'] as int? ?? 0,
+      retryIn: Duration(milliseconds: map['retryInMs'] as int? ?? 0),
+      connects: map['connects'] as int? ?? 0,
+    );
+  }
+
+  final TransportState state;
+
+  /// Consecutive failed attempts since the last successful connect.
+  final int attempt;
+
+  /// Delay before the next attempt; only set in [TransportState.backoff].
+  final Duration retryIn;
+
+  /// Successful connects since the plugin started.
+  final int connects;
+}
+
+/// Time-to-first-video milestones, measured from plugin registration. A
+/// milestone not reached yet is null.
+class StartupTimeline {
+  const StartupTimeline({
+    this.glProgramReady,
+    this.transportConnected,
+    this.firstVideoPacket,
+    this.parameterSets,
+    this.firstFrameDecoded,
+    this.firstFramePresented,
+    this.firstFramePopulated,
+    this.lastConnectToFrame,
+  });
+
+  factory StartupTimeline.fromMap(Map<String, Object?> map) {
+    Duration? at(String key) {
+      final us = map[key] as int?;
+      return us == null ? null : Duration(microseconds: us);
+    }
+
+    return StartupTimeline(
+      glProgramReady: at('glProgramReady'),
+      transportConnected: at('transportConnected'),
+      firstVideoPacket: at('firstVideoPacket'),
+      parameterSets: at('parameterSets'),
+      firstFrameDecoded: at('firstFrameDecoded'),
+      firstFramePresented: at('firstFramePresented'),
+      firstFramePopulated: at('firstFramePopulated'),
+      lastConnectToFrame: at('lastConnectToFrame'),
+    );
+  }
+
+  /// YUV shader linked, or loaded from the program binary cache.
+  final Duration? glProgramReady;
+  final Duration? transportConnected;
+  final Duration? firstVideoPacket;
+
+  /// First SPS parsed; decoder and texture buffers are sized from here on.
+  final Duration? parameterSets;
+  final Duration? firstFrameDecoded;
+
+  /// First frame handed to the texture.
+  final Duration? firstFramePresented;
+
+  /// First frame uploaded by Flutter's raster thread, i.e. on screen.
+  final Duration? firstFramePopulated;
+
+  /// Most recent (re)connect to the first frame on screen after it. Not
+  /// relative to registration.
+  final Duration? lastConnectToFrame;
+}
+
+/// Statistics of a stream's compressed video, gathered as it arrives.
+class BitstreamStats {
+  const BitstreamStats({
+    required this.codec,
+    required this.accessUnits,
+    required this.bytes,
+    required this.frames,
+    required this.keyframes,
+    required this.bitrateShortBps,
+    required this.bitrateLongBps,
+    required this.fps,
+    required this.nalCounts,
+    required this.gopLength,
+    required this.currentGop,
+    this.keyframeInterval,
+    required this.largestFrame,
+    required this.largestKeyframe,
+    required this.largestRecentFrame,
+    this.profile,
+    this.level,
+    this.width,
+    this.height,
+  });
+
+  factory BitstreamStats.fromMap(Map<String, Object?> map) {
+    final intervalUs = map['keyframeIntervalUs'] as int?;
+    final nalCounts = (map['nalCounts'] as Map?) ?? const {};
+    return BitstreamStats(
+      codec: map['codec'] as String? ?? 'h264',
+      accessUnits: map['accessUnits'] as int? ?? 0,
+      bytes: map['bytes'] as int? ?? 0,
+      frames: map['frames'] as int? ?? 0,
+      keyframes: map['keyframes'] as int? ?? 0,
+      bitrateShortBps: map['bitrateShortBps'] as int? ?? 0,
+      bitrateLongBps: map['bitrateLongBps'] as int? ?? 0,
+      fps: (map['fps'] as num?)?.toDouble() ?? 0.0,
+      nalCounts: nalCounts.map((k, v) => MapEntry(k as int, v as int)),
+      gopLength: map['gopLength'] as int? ?? 0,
+      currentGop: map['currentGop'] as int? ?? 0,
+      keyframeInterval: intervalUs == null ? null : Duration(microseconds: intervalUs),
+      largestFrame: map['largestFrame'] as int? ?? 0,
+      largestKeyframe: map['largestKeyframe'] as int? ?? 0,
+      largestRecentFrame: map['largestRecentFrame'] as int? ?? 0,
+      profile: map['profile'] as String?,
+      level: (map['level'] as num?)?.toDouble(),
+      width: map['width'] as int?,
+      height: map['height'] as int?,
+    );
+  }
+
+  final String codec;
+  final int accessUnits;
+  final int bytes;
+
+  /// Access units carrying a picture.
+  final int frames;
+
+  /// GOP starts: IDR pictures for H.264, any IRAP picture for H.265.
+  final int keyframes;
+
+  /// Over the last second and the last ten seconds.
+  final int bitrateShortBps;
+  final int bitrateLongBps;
+  final double fps;
+
+  /// NAL units seen per nal_unit_type, without the types never seen.
+  final Map<int, int> nalCounts;
+
+  /// Frames in the last complete GOP; 0 until the second keyframe.
+  final int gopLength;
+  final int currentGop;
+  final Duration? keyframeInterval;
+
+  /// In bytes. [largestRecentFrame] covers the last ten seconds.
+  final int largestFrame;
+  final int largestKeyframe;
+  final int largestRecentFrame;
+
+  /// From the SPS; null until one was seen.
+  final String? profile;
+  final double? level;
+  final int? width;
+  final int? height;
+}
+
+/// swscale algorithms for the decoder's I420 copy.
+enum ScalerMode {
+  fastBilinear('fast_bilinear'),
+  bilinear('bilinear'),
+  bicubic('bicubic'),
+  point('point'),
+  area('area');
+
+  const ScalerMode(this.wireName);
+
+  final String wireName;
+}
+
+/// Native pipeline tuning. Null fields are left unchanged by
+/// [Openautoflutter.configurePipeline]; the returned config has every field
+/// set to the value in effect after clamping.
+class PipelineConfig {
+  const PipelineConfig({
+    this.pumpInterval,
+    this.transportWait,
+    this.transportPoll,
+    this.reconnectInitialBackoff,
+    this.reconnectMaxBackoff,
+    this.shmPoll,
+    this.shmVideoSize,
+    this.scaler,
+    this.decodeThreads,
+    this.lowDelay,
+    this.fastDecode,
+    this.keyframeRequestType,
+    this.decodeWorker,
+    this.decodeCgroup,
+    this.decodeCpuPercent,
+    this.prefaultMemory,
+    this.hugePages,
+    this.memoryLockBudget,
+    this.threadPolicy,
+  });
+
+  factory PipelineConfig.fromMap(Map<String, Object?> map) {
+    Duration? ms(String key) => map[key] is int ? Duration(milliseconds: map[key] as int) : null;
+    final scalerName = map['scaler'] as String?;
+    ScalerMode? scaler;
+    for (final mode in ScalerMode.values) {
+      if (mode.wireName == scalerName) scaler = mode;
+    }
+    return PipelineConfig(
+      pumpInterval: ms('pumpIntervalMs'),
+      transportWait: ms('transportWaitMs'),
+      transportPoll: map['transportPollUs'] is int ? Duration(microseconds: map['transportPollUs'] as int) : null,
+      reconnectInitialBackoff: ms('reconnectInitialBackoffMs'),
+      reconnectMaxBackoff: ms('reconnectMaxBackoffMs'),
+      shmPoll: ms('shmPollMs'),
+      shmVideoSize: map['shmVideoSize'] as int?,
+      scaler: scaler,
+      decodeThreads: map['decodeThreads'] as int?,
+      lowDelay: map['lowDelay'] as bool?,
+      fastDecode: map['fastDecode'] as bool?,
+      keyframeRequestType: map['keyframeRequestType'] as int?,
+      decodeWorker: map['decodeWorker'] as bool?,
+      decodeCgroup: map['decodeCgroup'] as String?,
+      decodeCpuPercent: map['decodeCpuPercent'] as int?,
+      prefaultMemory: map['prefaultMemory'] as bool?,
+      hugePages: map['hugePages'] as bool?,
+      memoryLockBudget: map['memoryLockBudget'] as int?,
+      threadPolicy: map['threadPolicy'] as String?,
+    );
+  }
+
+  /// How often decoded frames are pushed to Flutter textures (default 16 ms).
+  final Duration? pumpInterval;
+
+  /// How long each connect attempt waits for the phone (default 5 s).
+  /// Applies from the next connect.
+  final Duration? transportWait;
+
+  /// Poll interval while waiting to connect (default 1 ms).
+  final Duration? transportPoll;
+
+  /// Reconnect backoff after the first failed attempt (default 250 ms), and
+  /// its cap (default 10 s).
+  final Duration? reconnectInitialBackoff;
+  final Duration? reconnectMaxBackoff;
+
+  /// Shared-memory consumer wait timeout (default 10 ms). Applies when the
+  /// consumer next starts.
+  final Duration? shmPoll;
+
+  /// Shared-memory video region size in bytes (default 1920*1080*3).
+  /// Applies when the consumer next starts.
+  final int? shmVideoSize;
+
+  /// Scaler for the I420 copy (default [ScalerMode.bilinear]).
+  final ScalerMode? scaler;
+
+  /// libavcodec threads per decoder; 0 uses one per core (default 1).
+  /// Changing this or [lowDelay]/[fastDecode] reopens running decoders,
+  /// which then wait for the next keyframe.
+  final int? decodeThreads;
+  final bool? lowDelay;
+  final bool? fastDecode;
+
+  /// Message type used to request keyframes after decode errors; -1 disables.
+  final int? keyframeRequestType;
+
+  /// Decode in a helper process (openautoflutter_decode_worker) that is
+  /// restarted if it crashes or hangs (default false). Applies to decoders
+  /// created afterwards; falls back to in-process decoding if the worker
+  /// cannot start.
+  final bool? decodeWorker;
+
+  /// cgroup v2 directory the worker moves into, created if missing; needs a
+  /// delegated subtree. Empty leaves it in the app's cgroup.
+  final String? decodeCgroup;
+
+  /// CPU cap for [decodeCgroup] in percent of one core; 0 for none.
+  final int? decodeCpuPercent;
+
+  /// Fault the shared-memory mappings in when they are made, instead of
+  /// during the first frames (default false).
+  final bool? prefaultMemory;
+
+  /// Ask for transparent hugepages on frame buffers of 2 MiB and up
+  /// (default false).
+  final bool? hugePages;
+
+  /// Bytes of mappings and frame buffers that may be mlocked; 0 locks
+  /// nothing (default). Needs RLIMIT_MEMLOCK to match.
+  ///
+  /// These three apply to memory mapped or allocated afterwards.
+  final int? memoryLockBudget;
+
+  /// Thread placement spec, same syntax as OPENAUTOFLUTTER_THREAD_POLICY.
+  final String? threadPolicy;
+
+  Map<String, Object?> toMap() {
+    return <String, Object?>{
+      if (pumpInterval != null) 'pumpIntervalMs': pumpInterval!.inMilliseconds,
+      if (transportWait != null) 'transportWaitMs': transportWait!.inMilliseconds,
+      if (transportPoll != null) 'transportPollUs': transportPoll!.inMicroseconds,
+      if (reconnectInitialBackoff != null) 'reconnectInitialBackoffMs': reconnectInitialBackoff!.inMilliseconds,
+      if (reconnectMaxBackoff != null) 'reconnectMaxBackoffMs': reconnectMaxBackoff!.inMilliseconds,
+      if (shmPoll != null) 'shmPollMs': shmPoll!.inMilliseconds,
+      if (shmVideoSize != null) 'shmVideoSize': shmVideoSize,
+      if (scaler != null) 'scaler': scaler!.wireName,
+      if (decodeThreads != null) 'decodeThreads': decodeThreads,
+      if (lowDelay != null) 'lowDelay': lowDelay,
+      if (fastDecode != null) 'fastDecode': fastDecode,
+      if (keyframeRequestType != null) 'keyframeRequestType': keyframeRequestType,
+      if (decodeWorker != null) 'decodeWorker': decodeWorker,
+      if (decodeCgroup != null) 'decodeCgroup': decodeCgroup,
+      if (decodeCpuPercent != null) 'decodeCpuPercent': decodeCpuPercent,
+      if (prefaultMemory != null) 'prefaultMemory': prefaultMemory,
+      if (hugePages != null) 'hugePages': hugePages,
+      if (memoryLockBudget != null) 'memoryLockBudget': memoryLockBudget,
+      if (threadPolicy != null) 'threadPolicy': threadPolicy,
+    };
+  }
+}
+
+/// Native log levels, lowest to highest.
+enum LogLevel {
+  trace,
+  debug,
+  info,
+  warn,
+  error,
+  off,
+}
+
 class Openautoflutter {
   Future<String?> getPlatformVersion() {
     return OpenautoflutterPlatform.instance.getPlatformVersion();
@@ -36,6 +463,98 @@ class Openautoflutter {
     return OpenautoflutterPlatform.instance.getVideoTextureId();
   }
 
+  /// The transport is brought up in the background and reconnected with
+  /// exponential backoff, so video may start some time after the first frame.
+  Future<TransportStatus> getConnectionStatus() async {
+    return TransportStatus.fromMap(await OpenautoflutterPlatform.instance.getConnectionState());
+  }
+
+  /// Milestones from plugin registration to the first video frame on screen,
+  /// for measuring cold and warm (reconnect) start times.
+  Future<StartupTimeline> getStartupTimeline() async {
+    return StartupTimeline.fromMap(await OpenautoflutterPlatform.instance.getStartupTimeline());
+  }
+
+  /// Transport state changes, starting with the current state.
+  Stream<TransportStatus> get connectionStatus {
+    return OpenautoflutterPlatform.instance.connectionEvents().map(TransportStatus.fromMap);
+  }
+
+  /// Creates an additional video pipeline with its own decoder and texture.
+  /// When [messageType] is given, transport messages of that type are decoded
+  /// into it; otherwise it is fed only by replay. Streams decode in parallel
+  /// on a shared worker pool. [codec] selects the stream's decoder.
+  Future<VideoStream> createVideoStream({int? messageType, VideoCodec codec = VideoCodec.h264}) async {
+    final result = await OpenautoflutterPlatform.instance.createVideoStream(
+      messageType: messageType,
+      codec: codec.name,
+    );
+    return VideoStream(
+      streamId: result['streamId'] as int? ?? -1,
+      textureId: result['textureId'] as int? ?? 0,
+    );
+  }
+
+  /// Switches [stream] to another codec, e.g. once the head unit has
+  /// negotiated HEVC. The new decoder starts at the next config record and
+  /// keyframe. The primary stream starts as H.264 unless
+  /// OPENAUTOFLUTTER_VIDEO_CODEC says otherwise.
+  Future<void> setVideoStreamCodec(VideoStream stream, VideoCodec codec) {
+    return OpenautoflutterPlatform.instance.setVideoStreamCodec(stream.streamId, codec.name);
+  }
+
+  /// Releases a stream created with [createVideoStream] and unregisters its
+  /// texture. The primary stream cannot be destroyed.
+  Future<void> destroyVideoStream(VideoStream stream) {
+    return OpenautoflutterPlatform.instance.destroyVideoStream(stream.streamId);
+  }
+
+  /// Registers one more texture id for [stream], e.g. for a picture-in-picture
+  /// preview next to the full-screen view. All views of a stream share the
+  /// same GPU plane and RGBA textures, so each frame is decoded, uploaded and
+  /// converted once regardless of how many widgets show it.
+  Future<int> addVideoStreamView(VideoStream stream) {
+    return OpenautoflutterPlatform.instance.addVideoStreamView(stream.streamId);
+  }
+
+  /// Unregisters a texture id returned by [addVideoStreamView].
+  Future<void> removeVideoStreamView(VideoStream stream, int textureId) {
+    return OpenautoflutterPlatform.instance.removeVideoStreamView(stream.streamId, textureId);
+  }
+
+  /// Tells the plugin how many physical pixels [textureId] covers on screen so
+  /// YUV->RGBA conversion renders at that size (never above the decoded
+  /// size), with mipmapped sampling for strong downscaling. Pass 0x0 to go
+  /// back to full resolution. [VideoTextureView] does this automatically.
+  Future<void> setVideoDisplaySize(int textureId, int width, int height) {
+    return OpenautoflutterPlatform.instance.setVideoDisplaySize(textureId, width, height);
+  }
+
+  /// Tells the plugin whether [textureId] is on screen. While none of a
+  /// stream's textures is visible, only keyframes are decoded and nothing is
+  /// uploaded; once one is visible again the newest keyframe is shown at once
+  /// and full decoding resumes from the next IDR. [VideoTextureView] reports
+  /// this automatically from its route and the app lifecycle.
+  Future<void> setVideoVisible(int textureId, bool visible) {
+    return OpenautoflutterPlatform.instance.setVideoVisible(textureId, visible);
+  }
+
+  /// Shows only the [width] x [height] region at ([x], [y]) of [stream], in
+  /// decoded pixels, e.g. to cut away the margins a head unit adds around the
+  /// projected screen. Only that region is uploaded and converted, and the
+  /// texture takes its size. Touches sent afterwards are relative to the
+  /// cropped view and are mapped back to the full screen (primary stream
+  /// only). Pass a 0x0 size to show the whole picture again.
+  Future<void> setVideoCrop(VideoStream stream, int x, int y, int width, int height) {
+    return OpenautoflutterPlatform.instance.setVideoCrop(stream.streamId, x, y, width, height);
+  }
+
+  /// Bitrate, frame rate, NAL mix, GOP structure and SPS of [stream]'s
+  /// compressed video, for checking what the phone actually sends.
+  Future<BitstreamStats> getBitstreamStats(VideoStream stream) async {
+    return BitstreamStats.fromMap(await OpenautoflutterPlatform.instance.getBitstreamStats(stream.streamId));
+  }
+
   Future<void> sendTouchEvent({
     required int pointerId,
     required double x,
@@ -49,4 +568,54 @@ class Openautoflutter {
       actionCode: action.code,
     );
   }
+
+  /// Sends several touches in one binary message. Consecutive moves of the
+  /// same pointer may be merged natively before they reach the transport.
+  Future<void> sendTouchEvents(List<TouchEvent> events) {
+    if (events.isEmpty) return Future<void>.value();
+    return OpenautoflutterPlatform.instance.sendTouchBatch(TouchEvent.pack(events));
+  }
+
+  /// Record every VIDEO message (raw bytes plus timestamps) to [path].
+  Future<void> startVideoCapture(String path) {
+    return OpenautoflutterPlatform.instance.startVideoCapture(path);
+  }
+
+  /// Finish the current capture; returns the number of recorded messages.
+  Future<int> stopVideoCapture() {
+    return OpenautoflutterPlatform.instance.stopVideoCapture();
+  }
+
+  /// Feed a capture back into the decoder, paced by the recorded receive
+  /// times when [realtime] is true, otherwise as fast as possible. Replays
+  /// into [stream], or the primary stream when omitted.
+  Future<void> startVideoReplay(String path, {bool realtime = true, bool loop = false, VideoStream? stream}) {
+    return OpenautoflutterPlatform.instance.startVideoReplay(
+      path,
+      realtime: realtime,
+      loop: loop,
+      streamId: stream?.streamId,
+    );
+  }
+
+  Future<void> stopVideoReplay() {
+    return OpenautoflutterPlatform.instance.stopVideoReplay();
+  }
+
+  /// Tune the native pipeline at runtime. Only non-null fields of [config]
+  /// change; out-of-range values are clamped. Returns the full configuration
+  /// now in effect.
+  Future<PipelineConfig> configurePipeline(PipelineConfig config) async {
+    return PipelineConfig.fromMap(await OpenautoflutterPlatform.instance.configurePipeline(config.toMap()));
+  }
+
+  /// Change the native log level and/or sinks at runtime. [sinks] entries are
+  /// `console` or `file:/path`. Returns the active configuration, including
+  /// the number of messages dropped because the log ring was full.
+  Future<Map<String, Object?>> configureLogging({LogLevel? level, List<String>? sinks}) {
+    return OpenautoflutterPlatform.instance.configureLogging(
+      level: level?.name,
+      sinks: sinks?.join(','),
+    );
+  }
 }
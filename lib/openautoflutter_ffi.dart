@@ -0,0 +1,341 @@
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+
+import 'openautoflutter.dart';
+
+final class _NativeTouch extends Struct {
+  @Float()
+  external double x;
+  @Float()
+  external double y;
+  @Uint32()
+  external int pointerId;
+  @Uint32()
+  external int action;
+}
+
+final class _NativeStats extends Struct {
+  @Uint64()
+  external int videoPackets;
+  @Uint64()
+  external int videoBytes;
+  @Uint64()
+  external int framesDecoded;
+  @Uint64()
+  external int decodeFailures;
+  @Uint64()
+  external int framesPresented;
+  @Int64()
+  external int lastDecodeUs;
+  @Int64()
+  external int lastPresentUs;
+  @Int64()
+  external int width;
+  @Int64()
+  external int height;
+  @Int64()
+  external int transportRunning;
+  @Uint64()
+  external int touchEnqueued;
+  @Uint64()
+  external int touchCoalesced;
+  @Uint64()
+  external int touchSent;
+  @Uint64()
+  external int touchFailed;
+  @Uint64()
+  external int touchDropped;
+  @Int64()
+  external int touchLastLatencyUs;
+  @Uint64()
+  external int framesDiscarded;
+  @Uint64()
+  external int decodeRecoveries;
+  @Int64()
+  external int lastRecoverUs;
+  @Uint64()
+  external int keyframeRequests;
+}
+
+final class _NativeTapFrame extends Struct {
+  @Uint64()
+  external int sequence;
+  @Int64()
+  external int streamId;
+  @Int64()
+  external int decodeTsUs;
+  @Uint32()
+  external int format;
+  @Uint32()
+  external int width;
+  @Uint32()
+  external int height;
+  @Uint32()
+  external int stride;
+  external Pointer<Uint8> data;
+  @Uint64()
+  external int size;
+  external Pointer<Void> reserved;
+}
+
+/// What a stream's frame tap publishes.
+enum FrameTapFormat {
+  off(0),
+
+  /// The 8-bit luma plane, scaled down to the configured bounds.
+  luma(1),
+
+  /// The whole decoded picture, packed as [Y][U][V] with half-size chroma.
+  i420(2);
+
+  const FrameTapFormat(this.code);
+
+  final int code;
+
+  static FrameTapFormat fromCode(int code) =>
+      FrameTapFormat.values.firstWhere((f) => f.code == code, orElse: () => FrameTapFormat.off);
+}
+
+/// A decoded frame in native memory, shared with the decoder without a copy.
+/// The memory stays valid until [release]; release every acquired frame,
+/// since a stream has only a few buffers and skips frames while readers hold
+/// all of them.
+class TapFrame {
+  TapFrame._(this._native, this._release) {
+    final f = _native.ref;
+    sequence = f.sequence;
+    streamId = f.streamId;
+    decodeTimestamp = Duration(microseconds: f.decodeTsUs);
+    format = FrameTapFormat.fromCode(f.format);
+    width = f.width;
+    height = f.height;
+    stride = f.stride;
+    data = f.data;
+    size = f.size;
+  }
+
+  final Pointer<_NativeTapFrame> _native;
+  final _TapReleaseDart _release;
+  bool _released = false;
+
+  late final int sequence;
+  late final int streamId;
+
+  /// Decode completion on the native steady clock.
+  late final Duration decodeTimestamp;
+  late final FrameTapFormat format;
+  late final int width;
+  late final int height;
+
+  /// Bytes per luma row.
+  late final int stride;
+  late final Pointer<Uint8> data;
+  late final int size;
+
+  /// A view of the pixels; not valid after [release].
+  Uint8List get bytes => data.asTypedList(size);
+
+  void release() {
+    if (_released) return;
+    _released = true;
+    _release(_native);
+  }
+}
+
+/// Snapshot of the native pipeline counters.
+class PipelineStats {
+  const PipelineStats({
+    required this.videoPackets,
+    required this.videoBytes,
+    required this.framesDecoded,
+    required this.decodeFailures,
+    required this.framesPresented,
+    required this.lastDecodeLatency,
+    required this.lastPresentLatency,
+    required this.width,
+    required this.height,
+    required this.transportRunning,
+    required this.touchEnqueued,
+    required this.touchCoalesced,
+    required this.touchSent,
+    required this.touchFailed,
+    required this.touchDropped,
+    required this.lastTouchLatency,
+    required this.framesDiscarded,
+    required this.decodeRecoveries,
+    required this.lastRecoverTime,
+    required this.keyframeRequests,
+  });
+
+  final int videoPackets;
+  final int videoBytes;
+  final int framesDecoded;
+  final int decodeFailures;
+  final int framesPresented;
+
+  /// Packet received to frame decoded, for the most recent frame.
+  final Duration lastDecodeLatency;
+
+  /// Packet received to frame handed to the texture, for the most recent frame.
+  final Duration lastPresentLatency;
+  final int width;
+  final int height;
+  final bool transportRunning;
+  final int touchEnqueued;
+  final int touchCoalesced;
+  final int touchSent;
+  final int touchFailed;
+  final int touchDropped;
+
+  /// Touch queued to handed to the transport, for the most recent batch.
+  final Duration lastTouchLatency;
+
+  /// Packets dropped while waiting for an IDR after a decode error.
+  final int framesDiscarded;
+  final int decodeRecoveries;
+
+  /// First decode error to first clean frame, for the most recent recovery.
+  final Duration lastRecoverTime;
+  final int keyframeRequests;
+}
+
+typedef _SendTouchC = Int32 Function(Uint32 pointerId, Float x, Float y, Uint32 action);
+typedef _SendTouchDart = int Function(int pointerId, double x, double y, int action);
+typedef _SendTouchBatchC = Int32 Function(Pointer<_NativeTouch> touches, Uint32 count);
+typedef _SendTouchBatchDart = int Function(Pointer<_NativeTouch> touches, int count);
+typedef _ReadStatsC = Uint32 Function(Pointer<_NativeStats> out, Uint32 size);
+typedef _ReadStatsDart = int Function(Pointer<_NativeStats> out, int size);
+typedef _TapConfigureC = Int32 Function(Int64 streamId, Uint32 format, Uint32 maxWidth, Uint32 maxHeight, Uint32 intervalMs);
+typedef _TapConfigureDart = int Function(int streamId, int format, int maxWidth, int maxHeight, int intervalMs);
+typedef _TapAcquireC = Pointer<_NativeTapFrame> Function(Int64 streamId, Uint64 afterSequence);
+typedef _TapAcquireDart = Pointer<_NativeTapFrame> Function(int streamId, int afterSequence);
+typedef _TapReleaseC = Void Function(Pointer<_NativeTapFrame> frame);
+typedef _TapReleaseDart = void Function(Pointer<_NativeTapFrame> frame);
+
+/// Synchronous bindings to the plugin's exported C ABI. Calls skip the
+/// platform channel and the main loop, so they are cheap enough to make per
+/// pointer event from the UI isolate. Linux only.
+class OpenautoflutterFfi {
+  OpenautoflutterFfi._(DynamicLibrary lib)
+      : _sendTouch = lib.lookupFunction<_SendTouchC, _SendTouchDart>('openautoflutter_send_touch', isLeaf: true),
+        _sendTouchBatch =
+            lib.lookupFunction<_SendTouchBatchC, _SendTouchBatchDart>('openautoflutter_send_touch_batch', isLeaf: true),
+        _readStats = lib.lookupFunction<_ReadStatsC, _ReadStatsDart>('openautoflutter_read_stats', isLeaf: true),
+        _tapConfigure = lib.lookupFunction<_TapConfigureC, _TapConfigureDart>('openautoflutter_frame_tap_configure'),
+        _tapAcquire =
+            lib.lookupFunction<_TapAcquireC, _TapAcquireDart>('openautoflutter_frame_tap_acquire', isLeaf: true),
+        _tapRelease =
+            lib.lookupFunction<_TapReleaseC, _TapReleaseDart>('openautoflutter_frame_tap_release', isLeaf: true),
+        _stats = calloc<_NativeStats>();
+
+  static OpenautoflutterFfi? _instance;
+
+  /// The shared binding, or null when the native library is not available
+  /// (other platforms, or the plugin is not linked into this process).
+  static OpenautoflutterFfi? get instance {
+    if (_instance != null || !Platform.isLinux) return _instance;
+    for (final open in <DynamicLibrary Function()>[
+      DynamicLibrary.process,
+      () => DynamicLibrary.open('libopenautoflutter_plugin.so'),
+    ]) {
+      try {
+        return _instance = OpenautoflutterFfi._(open());
+      } on Object {
+        continue;
+      }
+    }
+    return null;
+  }
+
+  final _SendTouchDart _sendTouch;
+  final _SendTouchBatchDart _sendTouchBatch;
+  final _ReadStatsDart _readStats;
+  final _TapConfigureDart _tapConfigure;
+  final _TapAcquireDart _tapAcquire;
+  final _TapReleaseDart _tapRelease;
+  final Pointer<_NativeStats> _stats;
+  Pointer<_NativeTouch> _batch = nullptr;
+  int _batchCapacity = 0;
+
+  /// Queues one touch. Returns false if it was rejected or no plugin is
+  /// registered yet.
+  bool sendTouch(TouchEvent event) {
+    return _sendTouch(event.pointerId, event.x, event.y, event.action.code) == 1;
+  }
+
+  /// Queues [events]; returns how many were accepted.
+  int sendTouchBatch(List<TouchEvent> events) {
+    if (events.isEmpty) return 0;
+    if (events.length > _batchCapacity) {
+      if (_batch != nullptr) calloc.free(_batch);
+      _batchCapacity = events.length < 16 ? 16 : events.length;
+      _batch = calloc<_NativeTouch>(_batchCapacity);
+    }
+    for (var i = 0; i < events.length; ++i) {
+      final native = _batch[i];
+      final event = events[i];
+      native
+        ..x = event.x
+        ..y = event.y
+        ..pointerId = event.pointerId
+        ..action = event.action.code;
+    }
+    final accepted = _sendTouchBatch(_batch, events.length);
+    return accepted < 0 ? 0 : accepted;
+  }
+
+  /// Starts, changes or stops ([FrameTapFormat.off]) publishing decoded
+  /// frames of stream [streamId] (0 is the primary stream). Luma frames are
+  /// scaled down to fit [maxWidth] x [maxHeight] (0 = decoded size); at most
+  /// one frame per [interval] is published. Returns false for an unknown
+  /// stream. Usable from any isolate.
+  bool configureFrameTap(
+    int streamId, {
+    FrameTapFormat format = FrameTapFormat.luma,
+    int maxWidth = 0,
+    int maxHeight = 0,
+    Duration interval = Duration.zero,
+  }) {
+    return _tapConfigure(streamId, format.code, maxWidth, maxHeight, interval.inMilliseconds) == 1;
+  }
+
+  /// The newest tapped frame of [streamId] newer than [afterSequence], or
+  /// null. Poll with the last frame's [TapFrame.sequence] and [TapFrame.release]
+  /// each frame when done with it.
+  TapFrame? acquireTapFrame(int streamId, {int afterSequence = 0}) {
+    final native = _tapAcquire(streamId, afterSequence);
+    if (native == nullptr) return null;
+    return TapFrame._(native, _tapRelease);
+  }
+
+  /// Reads the native counters without a platform-channel round trip.
+  PipelineStats readStats() {
+    _readStats(_stats, sizeOf<_NativeStats>());
+    final s = _stats.ref;
+    return PipelineStats(
+      videoPackets: s.videoPackets,
+      videoBytes: s.videoBytes,
+      framesDecoded: s.framesDecoded,
+      decodeFailures: s.decodeFailures,
+      framesPresented: s.framesPresented,
+      lastDecodeLatency: Duration(microseconds: s.lastDecodeUs),
+      lastPresentLatency: Duration(microseconds: s.lastPresentUs),
+      width: s.width,
+      height: s.height,
+      transportRunning: s.transportRunning != 0,
+      touchEnqueued: s.touchEnqueued,
+      touchCoalesced: s.touchCoalesced,
+      touchSent: s.touchSent,
+      touchFailed: s.touchFailed,
+      touchDropped: s.touchDropped,
+      lastTouchLatency: Duration(microseconds: s.touchLastLatencyUs),
+      framesDiscarded: s.framesDiscarded,
+      decodeRecoveries: s.decodeRecoveries,
+      lastRecoverTime: Duration(microseconds: s.lastRecoverUs),
+      keyframeRequests: s.keyframeRequests,
+    );
+  }
+}
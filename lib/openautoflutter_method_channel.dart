@@ -9,6 +9,14 @@ class MethodChannelOpenautoflutter extends OpenautoflutterPlatform {
   @visibleForTesting
   final methodChannel = const MethodChannel('openautoflutter');
 
+  /// Binary channel carrying packed touch batches.
+  @visibleForTesting
+  final touchChannel = const BasicMessageChannel<ByteData>('openautoflutter/touch', BinaryCodec());
+
+  /// Transport connection state events.
+  @visibleForTesting
+  final connectionChannel = const EventChannel('openautoflutter/connection');
+
   @override
   Future<String?> getPlatformVersion() async {
     final version = await methodChannel.invokeMethod<String>('getPlatformVersion');
@@ -21,6 +29,74 @@ class MethodChannelOpenautoflutter extends OpenautoflutterPlatform {
     return id;
   }
 
+  @override
+  Future<Map<String, Object?>> createVideoStream({int? messageType, String? codec}) async {
+    final result = await methodChannel.invokeMapMethod<String, Object?>('createVideoStream', <String, dynamic>{
+      if (messageType != null) 'messageType': messageType,
+      if (codec != null) 'codec': codec,
+    });
+    return result ?? <String, Object?>{};
+  }
+
+  @override
+  Future<void> destroyVideoStream(int streamId) async {
+    await methodChannel.invokeMethod<void>('destroyVideoStream', <String, dynamic>{
+      'streamId': streamId,
+    });
+  }
+
+  @override
+  Future<void> setVideoStreamCodec(int streamId, String codec) async {
+    await methodChannel.invokeMethod<void>('setVideoStreamCodec', <String, dynamic>{
+      'streamId': streamId,
+      'codec': codec,
+    });
+  }
+
+  @override
+  Future<int> addVideoStreamView(int streamId) async {
+    final id = await methodChannel.invokeMethod<int>('addVideoStreamView', <String, dynamic>{
+      'streamId': streamId,
+    });
+    return id ?? 0;
+  }
+
+  @override
+  Future<void> removeVideoStreamView(int streamId, int textureId) async {
+    await methodChannel.invokeMethod<void>('removeVideoStreamView', <String, dynamic>{
+      'streamId': streamId,
+      'textureId': textureId,
+    });
+  }
+
+  @override
+  Future<void> setVideoDisplaySize(int textureId, int width, int height) async {
+    await methodChannel.invokeMethod<void>('setVideoDisplaySize', <String, dynamic>{
+      'textureId': textureId,
+      'width': width,
+      'height': height,
+    });
+  }
+
+  @override
+  Future<void> setVideoVisible(int textureId, bool visible) async {
+    await methodChannel.invokeMethod<void>('setVideoVisible', <String, dynamic>{
+      'textureId': textureId,
+      'visible': visible,
+    });
+  }
+
+  @override
+  Future<void> setVideoCrop(int streamId, int x, int y, int width, int height) async {
+    await methodChannel.invokeMethod<void>('setVideoCrop', <String, dynamic>{
+      'streamId': streamId,
+      'x': x,
+      'y': y,
+      'width': width,
+      'height': height,
+    });
+  }
+
   @override
   Future<void> sendTouchEvent({
     required int pointerId,
@@ -35,4 +111,80 @@ class MethodChannelOpenautoflutter extends OpenautoflutterPlatform {
       'action': actionCode,
     });
   }
+
+  @override
+  Future<void> sendTouchBatch(ByteData packed) async {
+    if (packed.lengthInBytes == 0) return;
+    await touchChannel.send(packed);
+  }
+
+  @override
+  Future<void> startVideoCapture(String path) async {
+    await methodChannel.invokeMethod<void>('startVideoCapture', <String, dynamic>{
+      'path': path,
+    });
+  }
+
+  @override
+  Future<int> stopVideoCapture() async {
+    final records = await methodChannel.invokeMethod<int>('stopVideoCapture');
+    return records ?? 0;
+  }
+
+  @override
+  Future<void> startVideoReplay(String path, {bool realtime = true, bool loop = false, int? streamId}) async {
+    await methodChannel.invokeMethod<void>('startVideoReplay', <String, dynamic>{
+      'path': path,
+      'realtime': realtime,
+      'loop': loop,
+      if (streamId != null) 'streamId': streamId,
+    });
+  }
+
+  @override
+  Future<void> stopVideoReplay() async {
+    await methodChannel.invokeMethod<void>('stopVideoReplay');
+  }
+
+  @override
+  Future<Map<String, Object?>> configureLogging({String? level, String? sinks}) async {
+    final result = await methodChannel.invokeMapMethod<String, Object?>('configureLogging', <String, dynamic>{
+      if (level != null) 'level': level,
+      if (sinks != null) 'sinks': sinks,
+    });
+    return result ?? <String, Object?>{};
+  }
+
+  @override
+  Future<Map<String, Object?>> configurePipeline(Map<String, Object?> settings) async {
+    final result = await methodChannel.invokeMapMethod<String, Object?>('configurePipeline', settings);
+    return result ?? <String, Object?>{};
+  }
+
+  @override
+  Future<Map<String, Object?>> getConnectionState() async {
+    final result = await methodChannel.invokeMapMethod<String, Object?>('getConnectionState');
+    return result ?? <String, Object?>{};
+  }
+
+  @override
+  Future<Map<String, Object?>> getStartupTimeline() async {
+    final result = await methodChannel.invokeMapMethod<String, Object?>('getStartupTimeline');
+    return result ?? <String, Object?>{};
+  }
+
+  @override
+  Future<Map<String, Object?>> getBitstreamStats(int streamId) async {
+    final result = await methodChannel.invokeMapMethod<String, Object?>('getBitstreamStats', <String, dynamic>{
+      'streamId': streamId,
+    });
+    return result ?? <String, Object?>{};
+  }
+
+  @override
+  Stream<Map<String, Object?>> connectionEvents() {
+    return connectionChannel
+        .receiveBroadcastStream()
+        .map((event) => Map<String, Object?>.from(event as Map));
+  }
 }
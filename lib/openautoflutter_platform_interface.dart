@@ -1,3 +1,5 @@
+import 'dart:typed_data';
+
 import 'package:plugin_platform_interface/plugin_platform_interface.dart';
 
 import 'openautoflutter_method_channel.dart';
@@ -31,6 +33,41 @@ abstract class OpenautoflutterPlatform extends PlatformInterface {
     throw UnimplementedError('getVideoTextureId() has not been implemented.');
   }
 
+  /// Returns a map with `streamId` and `textureId`.
+  Future<Map<String, Object?>> createVideoStream({int? messageType, String? codec}) {
+    throw UnimplementedError('createVideoStream() has not been implemented.');
+  }
+
+  Future<void> destroyVideoStream(int streamId) {
+    throw UnimplementedError('destroyVideoStream() has not been implemented.');
+  }
+
+  /// [codec] is `h264` or `h265`.
+  Future<void> setVideoStreamCodec(int streamId, String codec) {
+    throw UnimplementedError('setVideoStreamCodec() has not been implemented.');
+  }
+
+  /// Returns the texture id of a new view sharing the stream's GL frames.
+  Future<int> addVideoStreamView(int streamId) {
+    throw UnimplementedError('addVideoStreamView() has not been implemented.');
+  }
+
+  Future<void> removeVideoStreamView(int streamId, int textureId) {
+    throw UnimplementedError('removeVideoStreamView() has not been implemented.');
+  }
+
+  Future<void> setVideoDisplaySize(int textureId, int width, int height) {
+    throw UnimplementedError('setVideoDisplaySize() has not been implemented.');
+  }
+
+  Future<void> setVideoVisible(int textureId, bool visible) {
+    throw UnimplementedError('setVideoVisible() has not been implemented.');
+  }
+
+  Future<void> setVideoCrop(int streamId, int x, int y, int width, int height) {
+    throw UnimplementedError('setVideoCrop() has not been implemented.');
+  }
+
   Future<void> sendTouchEvent({
     required int pointerId,
     required double x,
@@ -39,4 +76,59 @@ abstract class OpenautoflutterPlatform extends PlatformInterface {
   }) {
     throw UnimplementedError('sendTouchEvent() has not been implemented.');
   }
+
+  /// Sends packed 16-byte touch records (little-endian f32 x, f32 y,
+  /// u32 pointerId, u32 action).
+  Future<void> sendTouchBatch(ByteData packed) {
+    throw UnimplementedError('sendTouchBatch() has not been implemented.');
+  }
+
+  Future<void> startVideoCapture(String path) {
+    throw UnimplementedError('startVideoCapture() has not been implemented.');
+  }
+
+  Future<int> stopVideoCapture() {
+    throw UnimplementedError('stopVideoCapture() has not been implemented.');
+  }
+
+  Future<void> startVideoReplay(String path, {bool realtime = true, bool loop = false, int? streamId}) {
+    throw UnimplementedError('startVideoReplay() has not been implemented.');
+  }
+
+  Future<void> stopVideoReplay() {
+    throw UnimplementedError('stopVideoReplay() has not been implemented.');
+  }
+
+  Future<Map<String, Object?>> configureLogging({String? level, String? sinks}) {
+    throw UnimplementedError('configureLogging() has not been implemented.');
+  }
+
+  /// Applies the given pipeline settings (missing keys keep their value) and
+  /// returns every setting now in effect.
+  Future<Map<String, Object?>> configurePipeline(Map<String, Object?> settings) {
+    throw UnimplementedError('configurePipeline() has not been implemented.');
+  }
+
+  /// Returns a map with `state`, `attempt`, `retryInMs` and `connects`.
+  Future<Map<String, Object?>> getConnectionState() {
+    throw UnimplementedError('getConnectionState() has not been implemented.');
+  }
+
+  /// Returns milestone name -> microseconds since plugin registration, plus
+  /// `lastConnectToFrame` once a frame was shown after a connect.
+  Future<Map<String, Object?>> getStartupTimeline() {
+    throw UnimplementedError('getStartupTimeline() has not been implemented.');
+  }
+
+  /// Returns the compressed-stream statistics of stream [streamId] (0 is the
+  /// primary stream); see `BitstreamStats.fromMap` for the keys.
+  Future<Map<String, Object?>> getBitstreamStats(int streamId) {
+    throw UnimplementedError('getBitstreamStats() has not been implemented.');
+  }
+
+  /// Transport state changes, as maps like [getConnectionState]. The current
+  /// state is delivered first on listen.
+  Stream<Map<String, Object?>> connectionEvents() {
+    throw UnimplementedError('connectionEvents() has not been implemented.');
+  }
 }
@@ -0,0 +1,126 @@
+import 'package:flutter/widgets.dart';
+
+import 'openautoflutter.dart';
+
+/// A [Texture] for a plugin video texture that reports its on-screen size in
+/// physical pixels, so frames are converted at that size on the GPU instead
+/// of at the full decoded resolution and then scaled down by Flutter.
+///
+/// It also reports when it is off screen (its route is covered, or the app
+/// is hidden or paused), so the plugin can drop to keyframe-only decoding.
+class VideoTextureView extends StatefulWidget {
+  const VideoTextureView({
+    super.key,
+    required this.textureId,
+    this.plugin,
+    this.filterQuality = FilterQuality.low,
+  });
+
+  final int textureId;
+
+  /// Plugin facade used to report the size; a default instance if null.
+  final Openautoflutter? plugin;
+
+  final FilterQuality filterQuality;
+
+  @override
+  State<VideoTextureView> createState() => _VideoTextureViewState();
+}
+
+class _VideoTextureViewState extends State<VideoTextureView> with WidgetsBindingObserver {
+  late final Openautoflutter _plugin = widget.plugin ?? Openautoflutter();
+  int _reportedWidth = 0;
+  int _reportedHeight = 0;
+  int? _reportedTexture;
+  bool _appVisible = true;
+  bool _reportedVisible = true;
+  int? _visibilityTexture;
+
+  @override
+  void initState() {
+    super.initState();
+    WidgetsBinding.instance.addObserver(this);
+  }
+
+  @override
+  void didChangeAppLifecycleState(AppLifecycleState state) {
+    final bool visible = state == AppLifecycleState.resumed || state == AppLifecycleState.inactive;
+    if (visible != _appVisible) setState(() => _appVisible = visible);
+  }
+
+  void _reportVisible(int textureId, bool visible) {
+    if (textureId == _visibilityTexture && visible == _reportedVisible) return;
+    if (_visibilityTexture != textureId && visible) {
+      // A texture starts out visible; only a change needs reporting.
+      _visibilityTexture = textureId;
+      _reportedVisible = true;
+      return;
+    }
+    _visibilityTexture = textureId;
+    _reportedVisible = visible;
+    _plugin.setVideoVisible(textureId, visible).catchError((Object _) {});
+  }
+
+  void _report(int textureId, int width, int height) {
+    if (textureId == _reportedTexture && width == _reportedWidth && height == _reportedHeight) return;
+    _reportedTexture = textureId;
+    _reportedWidth = width;
+    _reportedHeight = height;
+    _plugin.setVideoDisplaySize(textureId, width, height).catchError((Object _) {});
+  }
+
+  @override
+  void didUpdateWidget(VideoTextureView oldWidget) {
+    super.didUpdateWidget(oldWidget);
+    if (oldWidget.textureId != widget.textureId) {
+      _plugin.setVideoDisplaySize(oldWidget.textureId, 0, 0).catchError((Object _) {});
+      _reportedTexture = null;
+      _restoreVisible();
+    }
+  }
+
+  // Leave the texture in its default (visible) state for whoever shows it next.
+  void _restoreVisible() {
+    final textureId = _visibilityTexture;
+    if (textureId != null && !_reportedVisible) {
+      _plugin.setVideoVisible(textureId, true).catchError((Object _) {});
+    }
+    _visibilityTexture = null;
+    _reportedVisible = true;
+  }
+
+  @override
+  void dispose() {
+    WidgetsBinding.instance.removeObserver(this);
+    final textureId = _reportedTexture;
+    if (textureId != null) {
+      _plugin.setVideoDisplaySize(textureId, 0, 0).catchError((Object _) {});
+    }
+    _restoreVisible();
+    super.dispose();
+  }
+
+  @override
+  Widget build(BuildContext context) {
+    final double dpr = MediaQuery.devicePixelRatioOf(context);
+    // Tickers are muted for routes that are covered or offstage.
+    final bool visible = _appVisible && TickerMode.of(context);
+    final int visibilityTexture = widget.textureId;
+    WidgetsBinding.instance.addPostFrameCallback((_) {
+      if (mounted) _reportVisible(visibilityTexture, visible);
+    });
+    return LayoutBuilder(
+      builder: (context, constraints) {
+        if (constraints.hasBoundedWidth && constraints.hasBoundedHeight) {
+          final int width = (constraints.maxWidth * dpr).round();
+          final int height = (constraints.maxHeight * dpr).round();
+          final int textureId = widget.textureId;
+          WidgetsBinding.instance.addPostFrameCallback((_) {
+            if (mounted) _report(textureId, width, height);
+          });
+        }
+        return Texture(textureId: widget.textureId, filterQuality: widget.filterQuality);
+      },
+    );
+  }
+}
@@ -2,18 +2,20 @@
 
 #include "av_consumer.h"
 #include "../common/SharedMemoryConsumer.hpp"
+#include "../common/Log.hpp"
+#include "../common/MemoryResidency.hpp"
+#include "../common/ThreadPolicy.hpp"
 
-#include <iostream>
+#include <atomic>
 #include <memory>
 #include <thread>
 #include <cstdint>
 #include <cstring>
 #include <vector>
 #include <mutex>
-#include <sstream>
-#include <iomanip>
 
 #include "h264_decoder.h"
+#include "pipeline_config.h"
 
 struct AVConsumer::Impl {
 	std::unique_ptr<SharedMemoryConsumer> videoConsumer;
@@ -30,21 +32,11 @@ struct AVConsumer::Impl {
 	std::mutex frameMutex;
 	bool newFrameAvailable = false;
 
-	static std::string hex_head(const unsigned char* data, size_t size, size_t max_bytes = 32) {
-		std::ostringstream oss;
-		const size_t n = std::min(size, max_bytes);
-		for (size_t i = 0; i < n; ++i) {
-			if (i) oss << ' ';
-			oss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(data[i]);
-		}
-		if (size > max_bytes) oss << " ...";
-		return oss.str();
-	}
-
 	void start() {
 		const std::string videoShm = "/openauto_video_shm";
 		const std::string videoSem = "/openauto_video_shm_sem";
-		const size_t videoSize = 1920 * 1080 * 3;   
+		const PipelineConfig config = pipeline_config();
+		const size_t videoSize = config.shm_video_size;
 
 		const std::string audioShm = "/openauto_audio_shm";
 		const std::string audioSem = "/openauto_audio_shm_sem";
@@ -54,10 +46,12 @@ struct AVConsumer::Impl {
 		videoConsumer = std::make_unique<SharedMemoryConsumer>(
 			videoShm, videoSem, videoSize,
 			[this](const unsigned char* buffer, size_t size) {
+				oa_thread::refresh(oa_thread::Role::Consumer, "oa-shm-video");
+				oa_memory::count_faults(oa_thread::Role::Consumer);
 				// Expect header: uint64_t timestamp + uint32_t payload_size, followed by H.264 payload
 				const size_t header = sizeof(uint64_t) + sizeof(uint32_t);
 				if (size < header) {
-					std::cout << "[AVConsumer] Video buffer too small: " << size << std::endl;
+					OA_LOG_RATE(Warn, 5, "AVConsumer", "Video buffer too small: {}", size);
 					return;
 				}
 				uint64_t ts = 0; uint32_t payload = 0;
@@ -65,12 +59,8 @@ struct AVConsumer::Impl {
 				std::memcpy(&payload, buffer + sizeof(uint64_t), sizeof(uint32_t));
 				const uint8_t* h264 = buffer + header;
 				const size_t h264_size = size - header;
-				int pkt_id = ++video_pkt_counter;
-				if (pkt_id <= 10) {
-					std::cout << "[AVConsumer] pkt=" << pkt_id << " ts=" << ts << " size=" << size
-						<< " payload=" << payload << " h264=" << h264_size
-						<< " head=" << hex_head(h264, h264_size, 32) << std::endl;
-				}
+				OA_LOG_FIRST_N(Info, 10, "AVConsumer", "pkt={} ts={} size={} payload={} h264={} head={}",
+					++video_pkt_counter, ts, size, payload, h264_size, oa_log::hex(h264, h264_size, 32));
 
 				// Decode to YUV420P and store
 				int w=0,h=0; std::vector<uint8_t> yuv;
@@ -80,29 +70,34 @@ struct AVConsumer::Impl {
 					lastH = h;
 					lastYuv420p = std::move(yuv);
 					newFrameAvailable = true;
-					//std::cout << "[AVConsumer] Decoded frame " << w << "x" << h << " (YUV420P)\n";
 				}
 			},
-			10);
+			config.shm_poll_ms);
 
 		audioConsumer = std::make_unique<SharedMemoryConsumer>(
 			audioShm, audioSem, audioSize,
 			[](const unsigned char* buffer, size_t size) {
+				oa_thread::refresh(oa_thread::Role::Consumer, "oa-shm-audio");
 				// Expect header: uint64_t timestamp + uint32_t payload_size
 				if (size < (sizeof(uint64_t) + sizeof(uint32_t))) {
-					std::cout << "[AVConsumer] Audio buffer too small: " << size << std::endl;
+					OA_LOG_RATE(Warn, 5, "AVConsumer", "Audio buffer too small: {}", size);
 					return;
 				}
 				uint64_t ts = 0;
 				uint32_t payload = 0;
 				std::memcpy(&ts, buffer, sizeof(uint64_t));
 				std::memcpy(&payload, buffer + sizeof(uint64_t), sizeof(uint32_t));
-				//std::cout << "[AVConsumer] Audio timestamp=" << ts << ", payloadSize=" << payload << std::endl;
 			},
-			10);
-
-		videoThread = std::thread([this]() { videoConsumer->run(); });
-		audioThread = std::thread([this]() { audioConsumer->run(); });
+			config.shm_poll_ms);
+
+		videoThread = std::thread([this]() {
+			oa_thread::refresh(oa_thread::Role::Consumer, "oa-shm-video");
+			videoConsumer->run();
+		});
+		audioThread = std::thread([this]() {
+			oa_thread::refresh(oa_thread::Role::Consumer, "oa-shm-audio");
+			audioConsumer->run();
+		});
 	}
 
 	void join() {
@@ -0,0 +1,468 @@
+#include "bitstream.h"
+
+#include <algorithm>
+
+namespace {
+
+// Minimal Exp-Golomb reader over an RBSP prefix.
+class BitReader {
+public:
+	BitReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+	bool read_bit(uint32_t& out) {
+		if (pos_ >= size_ * 8) return false;
+		out = (data_[pos_ / 8] >> (7 - pos_ % 8)) & 1u;
+		++pos_;
+		return true;
+	}
+
+	bool read_bits(int count, uint32_t& out) {
+		out = 0;
+		uint32_t bit = 0;
+		for (int i = 0; i < count; ++i) {
+			if (!read_bit(bit)) return false;
+			out = (out << 1) | bit;
+		}
+		return true;
+	}
+
+	bool skip_bits(size_t count) {
+		if (pos_ + count > size_ * 8) return false;
+		pos_ += count;
+		return true;
+	}
+
+	bool read_se(int32_t& out) {
+		uint32_t code = 0;
+		if (!read_ue(code)) return false;
+		out = (code & 1) ? static_cast<int32_t>((code + 1) / 2) : -static_cast<int32_t>(code / 2);
+		return true;
+	}
+
+	bool read_ue(uint32_t& out) {
+		int zeros = 0;
+		uint32_t bit = 0;
+		while (read_bit(bit) && bit == 0) {
+			if (++zeros > 31) return false;
+		}
+		if (bit != 1) return false;
+		uint32_t value = 0;
+		for (int i = 0; i < zeros; ++i) {
+			if (!read_bit(bit)) return false;
+			value = (value << 1) | bit;
+		}
+		out = (1u << zeros) - 1 + value;
+		return true;
+	}
+
+private:
+	const uint8_t* data_;
+	size_t size_;
+	size_t pos_ = 0;
+};
+
+// Strip emulation prevention bytes (00 00 03 -> 00 00) from at most
+// `limit` bytes of RBSP.
+std::vector<uint8_t> unescape_rbsp(const uint8_t* nal, size_t size, size_t limit) {
+	std::vector<uint8_t> rbsp;
+	rbsp.reserve(std::min(size, limit));
+	int zeros = 0;
+	for (size_t i = 0; i < size && rbsp.size() < limit; ++i) {
+		if (zeros >= 2 && nal[i] == 3) {
+			zeros = 0;
+			continue;
+		}
+		zeros = nal[i] == 0 ? zeros + 1 : 0;
+		rbsp.push_back(nal[i]);
+	}
+	return rbsp;
+}
+
+// slice_type of an H.264 coded slice NAL (header byte excluded), or -1.
+int h264_slice_type(const uint8_t* nal, size_t size) {
+	// Unescape just enough bytes for first_mb_in_slice and slice_type.
+	const std::vector<uint8_t> rbsp = unescape_rbsp(nal, size, 16);
+	BitReader reader(rbsp.data(), rbsp.size());
+	uint32_t first_mb = 0;
+	uint32_t type = 0;
+	if (!reader.read_ue(first_mb) || !reader.read_ue(type)) return -1;
+	return static_cast<int>(type % 5);
+}
+
+// Calls fn(nal, nal_size) for every NAL unit after a 3- or 4-byte start code.
+template <typename Fn>
+void for_each_nal(const uint8_t* data, size_t size, Fn&& fn) {
+	if (!data) return;
+	size_t i = 0;
+	while (i + 3 <= size) {
+		if (!(data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1)) {
+			++i;
+			continue;
+		}
+		const size_t nal = i + 3;
+		if (nal >= size) break;
+		size_t next = nal;
+		while (next + 3 <= size && !(data[next] == 0 && data[next + 1] == 0 && data[next + 2] == 1)) ++next;
+		if (next + 3 > size) next = size;
+		// A 4-byte start code leaves its leading zero on the previous NAL.
+		size_t end = next;
+		if (end < size && end > nal && data[end - 1] == 0) --end;
+		fn(data + nal, end - nal);
+		i = next;
+	}
+}
+
+enum H265NalType : uint8_t {
+	kH265BlaWLp = 16,
+	kH265IdrWRadl = 19,
+	kH265IdrNLp = 20,
+	kH265Cra = 21,
+	kH265Vps = 32,
+	kH265Sps = 33,
+	kH265Pps = 34,
+};
+
+uint8_t h265_nal_type(const uint8_t* nal) { return (nal[0] >> 1) & 0x3F; }
+
+uint16_t read_u16(const uint8_t* p) { return static_cast<uint16_t>((p[0] << 8) | p[1]); }
+
+// Append one length-prefixed NAL from `data + offset` as Annex-B.
+bool append_nal(const uint8_t* data, size_t size, size_t& offset, std::vector<uint8_t>& out) {
+	if (offset + 2 > size) return false;
+	const uint16_t nal_len = read_u16(data + offset);
+	offset += 2;
+	if (nal_len == 0 || offset + nal_len > size) return false;
+	out.insert(out.end(), {0x00, 0x00, 0x00, 0x01});
+	out.insert(out.end(), data + offset, data + offset + nal_len);
+	offset += nal_len;
+	return true;
+}
+
+} // namespace
+
+AccessUnitInfo scan_h264_access_unit(const uint8_t* data, size_t size) {
+	AccessUnitInfo info;
+	for_each_nal(data, size, [&info](const uint8_t* nal, size_t nal_size) {
+		switch (nal[0] & 0x1F) {
+		case 5:
+			info.idr = true;
+			info.intra = true;
+			break;
+		case 1: {
+			const int st = h264_slice_type(nal + 1, nal_size - 1);
+			if (st == 2 || st == 4) info.intra = true; // I or SI
+			break;
+		}
+		case 7:
+			info.sps = true;
+			break;
+		case 8:
+			info.pps = true;
+			break;
+		default:
+			break;
+		}
+	});
+	info.parameter_sets = info.sps && info.pps;
+	return info;
+}
+
+AccessUnitInfo scan_h265_access_unit(const uint8_t* data, size_t size) {
+	AccessUnitInfo info;
+	for_each_nal(data, size, [&info](const uint8_t* nal, size_t nal_size) {
+		if (nal_size < 2) return;
+		const uint8_t type = h265_nal_type(nal);
+		if (type == kH265IdrWRadl || type == kH265IdrNLp) {
+			info.idr = true;
+			info.intra = true;
+		} else if (type >= kH265BlaWLp && type <= kH265Cra) {
+			// BLA/CRA: random access points whose leading pictures the decoder skips.
+			info.intra = true;
+		} else if (type == kH265Vps) {
+			info.vps = true;
+		} else if (type == kH265Sps) {
+			info.sps = true;
+		} else if (type == kH265Pps) {
+			info.pps = true;
+		}
+	});
+	info.parameter_sets = info.vps && info.sps && info.pps;
+	return info;
+}
+
+bool is_h264_parameter_sets_only(const uint8_t* data, size_t size) {
+	if (!data || size < 6) return false;
+	bool saw_nal = false;
+	bool only_config = true;
+	for_each_nal(data, size, [&](const uint8_t* nal, size_t) {
+		const uint8_t type = nal[0] & 0x1F;
+		if (type != 7 && type != 8) only_config = false;
+		saw_nal = true;
+	});
+	return saw_nal && only_config;
+}
+
+bool is_h265_parameter_sets_only(const uint8_t* data, size_t size) {
+	if (!data || size < 6) return false;
+	bool saw_nal = false;
+	bool only_config = true;
+	for_each_nal(data, size, [&](const uint8_t* nal, size_t nal_size) {
+		const uint8_t type = nal_size >= 2 ? h265_nal_type(nal) : 0;
+		if (type != kH265Vps && type != kH265Sps && type != kH265Pps) only_config = false;
+		saw_nal = true;
+	});
+	return saw_nal && only_config;
+}
+
+bool parse_avcc_config(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+	if (!data || size < 7) return false;
+	if (data[0] != 1) return false; // configurationVersion must be 1
+	size_t offset = 5;
+	const uint8_t num_sps = data[offset] & 0x1F;
+	offset++;
+	for (uint8_t i = 0; i < num_sps; ++i) {
+		if (!append_nal(data, size, offset, out)) return false;
+	}
+	if (offset >= size) return false;
+	const uint8_t num_pps = data[offset];
+	offset++;
+	for (uint8_t i = 0; i < num_pps; ++i) {
+		if (!append_nal(data, size, offset, out)) return false;
+	}
+	return !out.empty();
+}
+
+bool parse_hvcc_config(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+	// 22 bytes of profile/tier/level and format fields, then numOfArrays.
+	constexpr size_t kHeader = 23;
+	if (!data || size < kHeader) return false;
+	if (data[0] != 1) return false; // configurationVersion must be 1
+	const uint8_t num_arrays = data[22];
+	size_t offset = kHeader;
+	std::vector<uint8_t> sets;
+	for (uint8_t a = 0; a < num_arrays; ++a) {
+		if (offset + 3 > size) return false;
+		const uint8_t type = data[offset] & 0x3F;
+		const uint16_t num_nalus = read_u16(data + offset + 1);
+		offset += 3;
+		for (uint16_t n = 0; n < num_nalus; ++n) {
+			// Arrays may also carry SEI; only parameter sets are kept.
+			if (type == kH265Vps || type == kH265Sps || type == kH265Pps) {
+				if (!append_nal(data, size, offset, sets)) return false;
+			} else {
+				if (offset + 2 > size) return false;
+				offset += 2 + read_u16(data + offset);
+				if (offset > size) return false;
+			}
+		}
+	}
+	// The record is the whole message; anything left over means this was not one.
+	if (offset != size || sets.empty()) return false;
+	out.insert(out.end(), sets.begin(), sets.end());
+	return true;
+}
+
+namespace {
+
+// Window offsets count chroma samples; scale them to luma for `chroma_format_idc`.
+void apply_crop(uint32_t chroma_format_idc, uint32_t height_factor, uint32_t left, uint32_t right, uint32_t top,
+				uint32_t bottom, int& width, int& height) {
+	const uint32_t sub_w = (chroma_format_idc == 1 || chroma_format_idc == 2) ? 2 : 1;
+	const uint32_t sub_h = chroma_format_idc == 1 ? 2 : 1;
+	const int64_t crop_w = static_cast<int64_t>(sub_w) * (static_cast<int64_t>(left) + right);
+	const int64_t crop_h = static_cast<int64_t>(sub_h) * height_factor * (static_cast<int64_t>(top) + bottom);
+	if (crop_w < width) width -= static_cast<int>(crop_w);
+	if (crop_h < height) height -= static_cast<int>(crop_h);
+}
+
+void skip_h264_scaling_list(BitReader& r, int entries) {
+	int32_t last = 8;
+	int32_t next = 8;
+	for (int i = 0; i < entries; ++i) {
+		if (next != 0) {
+			int32_t delta = 0;
+			if (!r.read_se(delta)) return;
+			next = (last + delta + 256) % 256;
+		}
+		last = next == 0 ? last : next;
+	}
+}
+
+// seq_parameter_set_rbsp() up to frame cropping (H.264 7.3.2.1.1).
+bool h264_sps(const uint8_t* nal, size_t size, SpsInfo& out) {
+	const std::vector<uint8_t> rbsp = unescape_rbsp(nal + 1, size - 1, 512);
+	BitReader r(rbsp.data(), rbsp.size());
+	uint32_t profile_idc = 0, level_idc = 0, v = 0;
+	if (!r.read_bits(8, profile_idc) || !r.skip_bits(8) || !r.read_bits(8, level_idc) || !r.read_ue(v)) return false;
+	uint32_t chroma_format_idc = 1;
+	switch (profile_idc) {
+	case 100: case 110: case 122: case 244: case 44: case 83:
+	case 86: case 118: case 128: case 138: case 139: case 134: case 135: {
+		if (!r.read_ue(chroma_format_idc) || chroma_format_idc > 3) return false;
+		if (chroma_format_idc == 3 && !r.read_bit(v)) return false;       // separate_colour_plane_flag
+		if (!r.read_ue(v) || !r.read_ue(v) || !r.read_bit(v)) return false; // bit depths, qpprime bypass
+		uint32_t scaling_matrix = 0;
+		if (!r.read_bit(scaling_matrix)) return false;
+		if (scaling_matrix) {
+			const int lists = chroma_format_idc == 3 ? 12 : 8;
+			for (int i = 0; i < lists; ++i) {
+				uint32_t present = 0;
+				if (!r.read_bit(present)) return false;
+				if (present) skip_h264_scaling_list(r, i < 6 ? 16 : 64);
+			}
+		}
+		break;
+	}
+	default:
+		break;
+	}
+	uint32_t poc_type = 0;
+	if (!r.read_ue(v) || !r.read_ue(poc_type)) return false; // log2_max_frame_num_minus4
+	if (poc_type == 0) {
+		if (!r.read_ue(v)) return false;
+	} else if (poc_type == 1) {
+		int32_t se = 0;
+		uint32_t cycle = 0;
+		if (!r.read_bit(v) || !r.read_se(se) || !r.read_se(se) || !r.read_ue(cycle) || cycle > 255) return false;
+		for (uint32_t i = 0; i < cycle; ++i) {
+			if (!r.read_se(se)) return false;
+		}
+	}
+	uint32_t width_mbs = 0, height_units = 0, frame_mbs_only = 0;
+	if (!r.read_ue(v) || !r.read_bit(v)) return false; // max_num_ref_frames, gaps
+	if (!r.read_ue(width_mbs) || !r.read_ue(height_units) || !r.read_bit(frame_mbs_only)) return false;
+	if (!frame_mbs_only && !r.read_bit(v)) return false; // mb_adaptive_frame_field_flag
+	uint32_t cropping = 0;
+	if (!r.read_bit(v) || !r.read_bit(cropping)) return false; // direct_8x8_inference_flag
+	if (width_mbs >= 1024 || height_units >= 1024) return false;
+	int width = static_cast<int>((width_mbs + 1) * 16);
+	int height = static_cast<int>((2 - frame_mbs_only) * (height_units + 1) * 16);
+	if (cropping) {
+		uint32_t left = 0, right = 0, top = 0, bottom = 0;
+		if (!r.read_ue(left) || !r.read_ue(right) || !r.read_ue(top) || !r.read_ue(bottom)) return false;
+		// Monochrome crops in luma samples (SubWidthC = SubHeightC = 1).
+		apply_crop(chroma_format_idc, 2 - frame_mbs_only, left, right, top, bottom, width, height);
+	}
+	if (width <= 0 || height <= 0) return false;
+	out.profile_idc = static_cast<int>(profile_idc);
+	out.level_idc = static_cast<int>(level_idc);
+	out.width = width;
+	out.height = height;
+	return true;
+}
+
+// profile_tier_level(1, max_sub_layers_minus1) (H.265 7.3.3).
+bool read_h265_profile_tier_level(BitReader& r, uint32_t max_sub_layers_minus1, uint32_t& profile_idc,
+								  uint32_t& level_idc) {
+	// general_profile_space, tier, profile_idc, then 80 bits of compatibility
+	// and constraint flags before general_level_idc.
+	if (!r.skip_bits(3) || !r.read_bits(5, profile_idc) || !r.skip_bits(80) || !r.read_bits(8, level_idc)) {
+		return false;
+	}
+	uint32_t profile_present[8] = {};
+	uint32_t level_present[8] = {};
+	for (uint32_t i = 0; i < max_sub_layers_minus1; ++i) {
+		if (!r.read_bit(profile_present[i]) || !r.read_bit(level_present[i])) return false;
+	}
+	if (max_sub_layers_minus1 > 0 && !r.skip_bits(2 * (8 - max_sub_layers_minus1))) return false;
+	for (uint32_t i = 0; i < max_sub_layers_minus1; ++i) {
+		if (profile_present[i] && !r.skip_bits(88)) return false;
+		if (level_present[i] && !r.skip_bits(8)) return false;
+	}
+	return true;
+}
+
+// seq_parameter_set_rbsp() up to the conformance window (H.265 7.3.2.2.1).
+bool h265_sps(const uint8_t* nal, size_t size, SpsInfo& out) {
+	if (size < 3) return false;
+	const std::vector<uint8_t> rbsp = unescape_rbsp(nal + 2, size - 2, 512);
+	BitReader r(rbsp.data(), rbsp.size());
+	uint32_t v = 0, max_sub_layers_minus1 = 0, profile_idc = 0, level_idc = 0;
+	if (!r.skip_bits(4) || !r.read_bits(3, max_sub_layers_minus1) || !r.read_bit(v)) return false;
+	if (max_sub_layers_minus1 > 6 ||
+		!read_h265_profile_tier_level(r, max_sub_layers_minus1, profile_idc, level_idc)) {
+		return false;
+	}
+	uint32_t chroma_format_idc = 0;
+	if (!r.read_ue(v) || !r.read_ue(chroma_format_idc) || chroma_format_idc > 3) return false;
+	if (chroma_format_idc == 3 && !r.read_bit(v)) return false; // separate_colour_plane_flag
+	uint32_t luma_w = 0, luma_h = 0, window = 0;
+	if (!r.read_ue(luma_w) || !r.read_ue(luma_h) || !r.read_bit(window)) return false;
+	if (luma_w == 0 || luma_h == 0 || luma_w > 16888 || luma_h > 16888) return false;
+	int width = static_cast<int>(luma_w);
+	int height = static_cast<int>(luma_h);
+	if (window) {
+		uint32_t left = 0, right = 0, top = 0, bottom = 0;
+		if (!r.read_ue(left) || !r.read_ue(right) || !r.read_ue(top) || !r.read_ue(bottom)) return false;
+		apply_crop(chroma_format_idc, 1, left, right, top, bottom, width, height);
+	}
+	if (width <= 0 || height <= 0) return false;
+	out.profile_idc = static_cast<int>(profile_idc);
+	out.level_idc = static_cast<int>(level_idc);
+	out.width = width;
+	out.height = height;
+	return true;
+}
+
+} // namespace
+
+void for_each_annexb_nal(const uint8_t* data, size_t size,
+						 const std::function<void(const uint8_t* nal, size_t nal_size)>& fn) {
+	for_each_nal(data, size, fn);
+}
+
+bool parse_h264_sps(const uint8_t* data, size_t size, SpsInfo& out) {
+	bool found = false;
+	for_each_nal(data, size, [&](const uint8_t* nal, size_t nal_size) {
+		if (!found && (nal[0] & 0x1F) == 7 && nal_size > 4) found = h264_sps(nal, nal_size, out);
+	});
+	return found;
+}
+
+bool parse_h265_sps(const uint8_t* data, size_t size, SpsInfo& out) {
+	bool found = false;
+	for_each_nal(data, size, [&](const uint8_t* nal, size_t nal_size) {
+		if (!found && nal_size >= 2 && h265_nal_type(nal) == kH265Sps) found = h265_sps(nal, nal_size, out);
+	});
+	return found;
+}
+
+bool parse_h264_sps_size(const uint8_t* data, size_t size, int& width, int& height) {
+	SpsInfo info;
+	if (!parse_h264_sps(data, size, info)) return false;
+	width = info.width;
+	height = info.height;
+	return true;
+}
+
+bool parse_h265_sps_size(const uint8_t* data, size_t size, int& width, int& height) {
+	SpsInfo info;
+	if (!parse_h265_sps(data, size, info)) return false;
+	width = info.width;
+	height = info.height;
+	return true;
+}
+
+bool extract_h264_parameter_sets(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+	bool found = false;
+	for_each_nal(data, size, [&](const uint8_t* nal, size_t nal_size) {
+		const uint8_t type = nal[0] & 0x1F;
+		if (type != 7 && type != 8) return;
+		out.insert(out.end(), {0x00, 0x00, 0x00, 0x01});
+		out.insert(out.end(), nal, nal + nal_size);
+		found = true;
+	});
+	return found;
+}
+
+bool extract_h265_parameter_sets(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+	bool found = false;
+	for_each_nal(data, size, [&](const uint8_t* nal, size_t nal_size) {
+		const uint8_t type = nal_size >= 2 ? h265_nal_type(nal) : 0;
+		if (type != kH265Vps && type != kH265Sps && type != kH265Pps) return;
+		out.insert(out.end(), {0x00, 0x00, 0x00, 0x01});
+		out.insert(out.end(), nal, nal + nal_size);
+		found = true;
+	});
+	return found;
+}
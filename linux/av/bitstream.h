@@ -0,0 +1,57 @@
+// Annex-B / length-prefixed bitstream helpers for the H.264 and H.265 decoders.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// What an Annex-B access unit carries, as far as decoding and recovery care.
+struct AccessUnitInfo {
+	bool idr = false;            // H.264 NAL type 5; H.265 IDR_W_RADL / IDR_N_LP
+	bool intra = false;          // IDR, an H.264 I/SI slice, or an H.265 IRAP (BLA/CRA)
+	bool vps = false;            // H.265 only
+	bool sps = false;
+	bool pps = false;
+	bool parameter_sets = false; // every parameter set the codec needs is present
+};
+
+AccessUnitInfo scan_h264_access_unit(const uint8_t* data, size_t size);
+AccessUnitInfo scan_h265_access_unit(const uint8_t* data, size_t size);
+
+// True if the Annex-B payload holds nothing but parameter sets (H.264 SPS/PPS,
+// H.265 VPS/SPS/PPS), i.e. it is a codec config rather than a picture.
+bool is_h264_parameter_sets_only(const uint8_t* data, size_t size);
+bool is_h265_parameter_sets_only(const uint8_t* data, size_t size);
+
+// AVCDecoderConfigurationRecord (avcC) / HEVCDecoderConfigurationRecord (hvcC)
+// -> Annex-B parameter sets appended to `out`. False if `data` is not one.
+bool parse_avcc_config(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+bool parse_hvcc_config(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+
+// Calls fn(nal, nal_size) for every NAL unit (header included) after a 3- or
+// 4-byte start code.
+void for_each_annexb_nal(const uint8_t* data, size_t size,
+						 const std::function<void(const uint8_t* nal, size_t nal_size)>& fn);
+
+// What the first SPS of an Annex-B buffer declares.
+struct SpsInfo {
+	int profile_idc = 0; // H.264 profile_idc; H.265 general_profile_idc
+	int level_idc = 0;   // H.264: level x 10; H.265 general_level_idc: level x 30
+	int width = 0;       // with the frame cropping / conformance window applied
+	int height = 0;
+};
+
+bool parse_h264_sps(const uint8_t* data, size_t size, SpsInfo& out);
+bool parse_h265_sps(const uint8_t* data, size_t size, SpsInfo& out);
+
+// Picture size from the first SPS in an Annex-B buffer, with the frame
+// cropping (H.264) or conformance window (H.265) applied. Lets the pipeline
+// size its buffers before the first picture decodes.
+bool parse_h264_sps_size(const uint8_t* data, size_t size, int& width, int& height);
+bool parse_h265_sps_size(const uint8_t* data, size_t size, int& width, int& height);
+
+// Append just the parameter-set NAL units of an Annex-B access unit to `out`,
+// as Annex-B. False if it has none.
+bool extract_h264_parameter_sets(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+bool extract_h265_parameter_sets(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
@@ -0,0 +1,183 @@
+#include "bitstream_analyzer.h"
+#include "../common/Log.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace {
+
+int64_t steady_now_us() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool has_start_code(const uint8_t* data, size_t size) {
+	return size >= 4 && data[0] == 0 && data[1] == 0 && (data[2] == 1 || (data[2] == 0 && data[3] == 1));
+}
+
+// The 4-byte length-prefixed layout the decoders accept as well. Stops at
+// the first length that does not fit.
+template <typename Fn>
+void for_each_prefixed_nal(const uint8_t* data, size_t size, Fn&& fn) {
+	size_t offset = 0;
+	while (offset + 4 <= size) {
+		const uint32_t len = (static_cast<uint32_t>(data[offset]) << 24) | (static_cast<uint32_t>(data[offset + 1]) << 16) |
+							 (static_cast<uint32_t>(data[offset + 2]) << 8) | data[offset + 3];
+		offset += 4;
+		if (len == 0 || len > size - offset) return;
+		fn(data + offset, len);
+		offset += len;
+	}
+}
+
+} // namespace
+
+std::string video_profile_name(VideoCodec codec, int profile_idc) {
+	if (codec == VideoCodec::H265) {
+		switch (profile_idc) {
+		case 1: return "Main";
+		case 2: return "Main 10";
+		case 3: return "Main Still Picture";
+		case 4: return "Range Extensions";
+		case 9: return "Screen Content";
+		default: break;
+		}
+	} else {
+		switch (profile_idc) {
+		case 66: return "Baseline";
+		case 77: return "Main";
+		case 88: return "Extended";
+		case 100: return "High";
+		case 110: return "High 10";
+		case 122: return "High 4:2:2";
+		case 244: return "High 4:4:4 Predictive";
+		default: break;
+		}
+	}
+	return std::to_string(profile_idc);
+}
+
+double video_level(VideoCodec codec, int level_idc) {
+	return level_idc / (codec == VideoCodec::H265 ? 30.0 : 10.0);
+}
+
+void BitstreamAnalyzer::on_access_unit(VideoCodec codec, const uint8_t* data, size_t size, int64_t now_us) {
+	if (!data || size == 0) return;
+	if (now_us <= 0) now_us = steady_now_us();
+
+	// One pass over the NAL headers; the SPS is only parsed when present.
+	const bool h265 = codec == VideoCodec::H265;
+	std::array<uint32_t, 64> types{};
+	bool picture = false;
+	bool keyframe = false;
+	const uint8_t* sps = nullptr;
+	size_t sps_size = 0;
+	auto visit = [&](const uint8_t* nal, size_t nal_size) {
+		if (h265 && nal_size < 2) return;
+		const uint8_t type = h265 ? (nal[0] >> 1) & 0x3F : nal[0] & 0x1F;
+		++types[type];
+		if (h265) {
+			picture = picture || type < 32;
+			keyframe = keyframe || (type >= 16 && type <= 23); // IRAP: BLA, IDR, CRA
+			if (type == 33 && !sps) {
+				sps = nal;
+				sps_size = nal_size;
+			}
+		} else {
+			picture = picture || (type >= 1 && type <= 5);
+			keyframe = keyframe || type == 5;
+			if (type == 7 && !sps) {
+				sps = nal;
+				sps_size = nal_size;
+			}
+		}
+	};
+	if (has_start_code(data, size)) {
+		for_each_annexb_nal(data, size, visit);
+	} else {
+		for_each_prefixed_nal(data, size, visit);
+	}
+
+	SpsInfo sps_info;
+	bool sps_ok = false;
+	if (sps) {
+		std::vector<uint8_t> annexb{0x00, 0x00, 0x00, 0x01};
+		annexb.insert(annexb.end(), sps, sps + sps_size);
+		sps_ok = h265 ? parse_h265_sps(annexb.data(), annexb.size(), sps_info)
+					  : parse_h264_sps(annexb.data(), annexb.size(), sps_info);
+	}
+
+	const uint32_t bytes = static_cast<uint32_t>(std::min<size_t>(size, UINT32_MAX));
+	std::lock_guard<std::mutex> lk(mutex_);
+	BitstreamStats& t = totals_;
+	if (t.access_units > 0 && codec != t.codec) {
+		// Codec switch: the old figures describe another stream.
+		t = BitstreamStats();
+		last_keyframe_us_ = 0;
+		window_.clear();
+	}
+	t.codec = codec;
+	++t.access_units;
+	t.bytes += size;
+	for (size_t i = 0; i < types.size(); ++i) t.nal_counts[i] += types[i];
+	if (picture) {
+		++t.frames;
+		t.largest_frame = std::max(t.largest_frame, bytes);
+		if (keyframe) {
+			++t.keyframes;
+			t.largest_keyframe = std::max(t.largest_keyframe, bytes);
+			if (last_keyframe_us_ != 0) {
+				t.gop_length = t.current_gop;
+				t.keyframe_interval_us = now_us - last_keyframe_us_;
+			}
+			last_keyframe_us_ = now_us;
+			t.current_gop = 0;
+		}
+		++t.current_gop;
+	}
+	if (sps_ok) {
+		const bool changed = !t.have_sps || sps_info.profile_idc != t.sps.profile_idc ||
+							 sps_info.level_idc != t.sps.level_idc || sps_info.width != t.sps.width ||
+							 sps_info.height != t.sps.height;
+		t.have_sps = true;
+		t.sps = sps_info;
+		if (changed) {
+			OA_LOG(Info, "BitstreamAnalyzer", "{} {} level {} {}x{}", codec_name(codec),
+				   video_profile_name(codec, sps_info.profile_idc), video_level(codec, sps_info.level_idc),
+				   sps_info.width, sps_info.height);
+		}
+	}
+	window_.push_back(Sample{now_us, bytes, picture});
+	trim(now_us);
+}
+
+void BitstreamAnalyzer::trim(int64_t now_us) {
+	while (!window_.empty() && window_.front().t_us <= now_us - kLongWindowUs) window_.pop_front();
+}
+
+BitstreamStats BitstreamAnalyzer::stats(int64_t now_us) const {
+	if (now_us <= 0) now_us = steady_now_us();
+	std::lock_guard<std::mutex> lk(mutex_);
+	BitstreamStats out = totals_;
+	uint64_t short_bytes = 0, long_bytes = 0, short_frames = 0;
+	for (const Sample& s : window_) {
+		if (s.t_us <= now_us - kLongWindowUs) continue;
+		long_bytes += s.bytes;
+		if (s.frame) out.largest_recent_frame = std::max(out.largest_recent_frame, s.bytes);
+		if (s.t_us <= now_us - kShortWindowUs) continue;
+		short_bytes += s.bytes;
+		if (s.frame) ++short_frames;
+	}
+	out.bitrate_short_bps = static_cast<int64_t>(short_bytes * 8 * 1000000 / kShortWindowUs);
+	out.bitrate_long_bps = static_cast<int64_t>(long_bytes * 8 * 1000000 / kLongWindowUs);
+	out.fps_short = static_cast<double>(short_frames) * 1000000.0 / kShortWindowUs;
+	return out;
+}
+
+void BitstreamAnalyzer::reset() {
+	std::lock_guard<std::mutex> lk(mutex_);
+	totals_ = BitstreamStats();
+	last_keyframe_us_ = 0;
+	window_.clear();
+}
@@ -0,0 +1,68 @@
+// Per-stream statistics of the compressed video as it arrives: bitrate, NAL
+// mix, GOP structure and the stream's SPS. Costs one NAL header scan per
+// access unit.
+#pragma once
+
+#include "bitstream.h"
+#include "video_decoder.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+
+struct BitstreamStats {
+	VideoCodec codec = VideoCodec::H264;
+	uint64_t access_units = 0;
+	uint64_t bytes = 0;
+	uint64_t frames = 0;        // access units carrying a picture
+	uint64_t keyframes = 0;     // GOP starts, see BitstreamAnalyzer
+	int64_t bitrate_short_bps = 0; // over kShortWindowUs
+	int64_t bitrate_long_bps = 0;  // over kLongWindowUs
+	double fps_short = 0.0;
+	// NAL units seen per nal_unit_type (H.264 uses 0..31, H.265 0..63).
+	std::array<uint64_t, 64> nal_counts{};
+	uint32_t gop_length = 0;    // frames in the last complete GOP, 0 until one completes
+	uint32_t current_gop = 0;   // frames since the last keyframe
+	int64_t keyframe_interval_us = -1; // between the last two keyframes
+	uint32_t largest_frame = 0;        // bytes, since start
+	uint32_t largest_keyframe = 0;
+	uint32_t largest_recent_frame = 0; // bytes, within kLongWindowUs
+	bool have_sps = false;
+	SpsInfo sps;
+};
+
+// "High", "Main 10", ...; the number for profiles without a name here.
+std::string video_profile_name(VideoCodec codec, int profile_idc);
+// level_idc as the level number, e.g. 31 (H.264) or 93 (H.265) -> 3.1.
+double video_level(VideoCodec codec, int level_idc);
+
+// Fed by the decode strand, read from the main thread. A keyframe (GOP
+// start) is an IDR for H.264 and any IRAP picture (IDR, CRA, BLA) for
+// H.265. Accepts Annex-B or 4-byte length-prefixed access units.
+class BitstreamAnalyzer {
+public:
+	static constexpr int64_t kShortWindowUs = 1000000;
+	static constexpr int64_t kLongWindowUs = 10000000;
+
+	void on_access_unit(VideoCodec codec, const uint8_t* data, size_t size, int64_t now_us);
+	// Windows are measured back from `now_us` (steady clock; 0 = now).
+	BitstreamStats stats(int64_t now_us = 0) const;
+	void reset();
+
+private:
+	struct Sample {
+		int64_t t_us;
+		uint32_t bytes;
+		bool frame;
+	};
+
+	void trim(int64_t now_us);
+
+	mutable std::mutex mutex_;
+	BitstreamStats totals_; // everything but the window figures
+	int64_t last_keyframe_us_ = 0;
+	std::deque<Sample> window_; // newest last, at most kLongWindowUs old
+};
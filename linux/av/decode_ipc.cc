@@ -0,0 +1,172 @@
+#include "decode_ipc.h"
+#include "../common/Log.hpp"
+#include "../common/MemoryResidency.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace decode_ipc {
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+			  "cross-process atomics must be lock-free");
+
+namespace {
+
+constexpr size_t kPage = 4096;
+
+size_t page_align(size_t n) {
+	return (n + kPage - 1) & ~(kPage - 1);
+}
+
+} // namespace
+
+Channel::Channel(int fd, uint8_t* base, size_t size)
+	: fd_(fd), base_(base), size_(size), header_(reinterpret_cast<Header*>(base)) {}
+
+Channel::~Channel() {
+	if (base_) {
+		oa_memory::release(base_);
+		munmap(base_, size_);
+	}
+	if (fd_ >= 0) close(fd_);
+}
+
+std::shared_ptr<Channel> Channel::create(uint32_t codec, size_t ring_size, int slot_count, size_t slot_size) {
+	if (slot_count <= 0 || slot_count > kMaxSlots || ring_size < 64 * 1024) return nullptr;
+	ring_size = page_align(ring_size);
+	slot_size = page_align(slot_size);
+	const size_t ring_offset = page_align(sizeof(Header));
+	const size_t slots_offset = ring_offset + ring_size;
+	const size_t total = slots_offset + slot_size * static_cast<size_t>(slot_count);
+
+	const int fd = memfd_create("openautoflutter-decode", MFD_CLOEXEC);
+	if (fd < 0) {
+		OA_LOG(Error, "DecodeIpc", "memfd_create failed: {}", std::strerror(errno));
+		return nullptr;
+	}
+	if (ftruncate(fd, static_cast<off_t>(total)) != 0) {
+		OA_LOG(Error, "DecodeIpc", "ftruncate({}) failed: {}", total, std::strerror(errno));
+		close(fd);
+		return nullptr;
+	}
+	void* base = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED | oa_memory::map_flags(), fd, 0);
+	if (base == MAP_FAILED) {
+		OA_LOG(Error, "DecodeIpc", "mmap({}) failed: {}", total, std::strerror(errno));
+		close(fd);
+		return nullptr;
+	}
+	oa_memory::make_resident(base, total);
+	// The file starts zeroed, which is every atomic's initial value.
+	Header* h = new (base) Header();
+	h->codec = codec;
+	h->slot_count = static_cast<uint32_t>(slot_count);
+	h->ring_size = ring_size;
+	h->ring_offset = ring_offset;
+	h->slot_size = slot_size;
+	h->slots_offset = slots_offset;
+	h->done_slot.store(-1, std::memory_order_relaxed);
+	h->version = kVersion;
+	h->magic = kMagic;
+	return std::shared_ptr<Channel>(new Channel(fd, static_cast<uint8_t*>(base), total));
+}
+
+std::shared_ptr<Channel> Channel::attach(int fd) {
+	struct stat st;
+	if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) return nullptr;
+	const size_t total = static_cast<size_t>(st.st_size);
+	void* base = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED | oa_memory::map_flags(), fd, 0);
+	if (base == MAP_FAILED) return nullptr;
+	oa_memory::make_resident(base, total);
+	auto channel = std::shared_ptr<Channel>(new Channel(fd, static_cast<uint8_t*>(base), total));
+	const Header& h = channel->header();
+	if (h.magic != kMagic || h.version != kVersion || h.slot_count == 0 || h.slot_count > kMaxSlots ||
+		h.ring_offset + h.ring_size > total || h.slots_offset + h.slot_size * h.slot_count > total) {
+		OA_LOG(Error, "DecodeIpc", "fd {} is not a decode channel (magic {} version {})", fd, h.magic, h.version);
+		return nullptr;
+	}
+	return channel;
+}
+
+uint8_t* Channel::slot_pixels(int index) const {
+	return base_ + header_->slots_offset + header_->slot_size * static_cast<size_t>(index);
+}
+
+bool Channel::write(RecordType type, uint64_t seq, const void* data, size_t size) {
+	Header& h = *header_;
+	const uint64_t ring = h.ring_size;
+	const size_t span = record_span(size);
+	if (size > UINT32_MAX || span > ring) return false;
+	uint64_t head = h.ring_head.load(std::memory_order_relaxed);
+	const uint64_t tail = h.ring_tail.load(std::memory_order_acquire);
+	const uint64_t offset = head % ring;
+	const uint64_t pad = offset + span > ring ? ring - offset : 0;
+	if (head - tail + pad + span > ring) return false;
+
+	uint8_t* ring_base = base_ + h.ring_offset;
+	if (pad) {
+		const RecordHeader filler{static_cast<uint32_t>(RecordType::Pad), 0, 0};
+		std::memcpy(ring_base + offset, &filler, sizeof(filler));
+		head += pad;
+	}
+	const RecordHeader record{static_cast<uint32_t>(type), static_cast<uint32_t>(size), seq};
+	uint8_t* at = ring_base + head % ring;
+	std::memcpy(at, &record, sizeof(record));
+	if (size) std::memcpy(at + sizeof(record), data, size);
+	h.ring_head.store(head + span, std::memory_order_release);
+	return true;
+}
+
+bool Channel::peek(RecordHeader& record, const uint8_t*& payload) {
+	Header& h = *header_;
+	const uint64_t ring = h.ring_size;
+	const uint8_t* ring_base = base_ + h.ring_offset;
+	uint64_t tail = h.ring_tail.load(std::memory_order_relaxed);
+	for (;;) {
+		const uint64_t head = h.ring_head.load(std::memory_order_acquire);
+		if (tail == head) return false;
+		std::memcpy(&record, ring_base + tail % ring, sizeof(record));
+		if (record.type == static_cast<uint32_t>(RecordType::Pad)) {
+			tail += ring - tail % ring;
+			h.ring_tail.store(tail, std::memory_order_release);
+			continue;
+		}
+		const size_t span = record_span(record.size);
+		if (span > head - tail || tail % ring + span > ring) {
+			// Only a corrupted ring gets here; drop everything queued.
+			OA_LOG(Error, "DecodeIpc", "bad record type={} size={}; ring reset", record.type, record.size);
+			h.ring_tail.store(head, std::memory_order_release);
+			return false;
+		}
+		payload = ring_base + tail % ring + sizeof(record);
+		peeked_ = span;
+		return true;
+	}
+}
+
+void Channel::consume() {
+	Header& h = *header_;
+	h.ring_tail.store(h.ring_tail.load(std::memory_order_relaxed) + peeked_, std::memory_order_release);
+	peeked_ = 0;
+}
+
+int Channel::claim_slot() {
+	Header& h = *header_;
+	for (uint32_t i = 0; i < h.slot_count; ++i) {
+		uint32_t expected = kSlotFree;
+		if (h.slots[i].state.compare_exchange_strong(expected, kSlotWriting, std::memory_order_acquire)) {
+			return static_cast<int>(i);
+		}
+	}
+	return -1;
+}
+
+void Channel::release_slot(int index) {
+	if (index < 0 || index >= static_cast<int>(header_->slot_count)) return;
+	header_->slots[index].state.store(kSlotFree, std::memory_order_release);
+}
+
+} // namespace decode_ipc
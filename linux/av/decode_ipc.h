@@ -0,0 +1,128 @@
+// Shared memory between the plugin and its decode worker process: a packet
+// ring in, decoded I420 frame slots out.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace decode_ipc {
+
+constexpr uint32_t kMagic = 0x5744414F; // "OADW"
+constexpr uint32_t kVersion = 1;
+constexpr int kMaxSlots = 8;
+
+// Ring records, in submission order. Payloads are contiguous: a record that
+// would straddle the end of the ring is preceded by a Pad to the end.
+enum class RecordType : uint32_t {
+	Pad = 0,
+	Packet = 1,        // an access unit or config record; answered through done_seq
+	Options = 2,       // WireOptions
+	ResetSession = 3,
+	KeyframesOnly = 4, // one byte, 0 or 1
+	SkipToKeyframe = 5,
+};
+
+struct RecordHeader {
+	uint32_t type;
+	uint32_t size; // payload bytes
+	uint64_t seq;
+};
+static_assert(sizeof(RecordHeader) == 16, "records are 16-byte aligned");
+
+// DecoderOptions on the wire.
+struct WireOptions {
+	int32_t threads;
+	uint8_t low_delay;
+	uint8_t fast;
+	uint8_t scaler;
+	uint8_t reserved;
+};
+
+// A frame slot belongs to the worker while Free or Writing and to the plugin
+// while Ready; the plugin frees it when the last reference to the frame goes.
+enum SlotState : uint32_t { kSlotFree = 0, kSlotWriting = 1, kSlotReady = 2 };
+
+struct Slot {
+	std::atomic<uint32_t> state;
+	uint32_t width;
+	uint32_t height;
+	uint32_t reserved;
+	uint64_t size; // packed [Y][U][V] bytes
+};
+
+struct Header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t codec;      // VideoCodec
+	uint32_t slot_count;
+	uint64_t ring_size;
+	uint64_t ring_offset;
+	uint64_t slot_size;  // pixel bytes per slot
+	uint64_t slots_offset;
+
+	alignas(64) std::atomic<uint64_t> ring_head; // bytes written, plugin only
+	alignas(64) std::atomic<uint64_t> ring_tail; // bytes consumed, worker only
+
+	// Written by the worker.
+	alignas(64) std::atomic<uint32_t> ready;     // decoder open
+	std::atomic<uint64_t> done_seq;              // last Packet handled
+	std::atomic<int32_t> done_slot;              // its picture, -1 for none
+	std::atomic<uint64_t> announced;             // width << 32 | height from the newest SPS
+	std::atomic<uint32_t> recovering;
+	std::atomic<uint64_t> keyframe_requests;
+	std::atomic<uint64_t> frames_discarded;
+	std::atomic<uint64_t> decode_recoveries;
+	std::atomic<int64_t> last_recover_us;
+
+	Slot slots[kMaxSlots];
+};
+
+// One memfd mapping. The plugin creates a fresh one per worker it starts, so
+// frames still held from a worker that died stay readable.
+class Channel {
+public:
+	// Plugin side. Null if the memfd cannot be created or mapped.
+	static std::shared_ptr<Channel> create(uint32_t codec, size_t ring_size, int slot_count, size_t slot_size);
+	// Worker side: map an inherited memfd. Null if it is not a channel of
+	// this version.
+	static std::shared_ptr<Channel> attach(int fd);
+	~Channel();
+
+	Channel(const Channel&) = delete;
+	Channel& operator=(const Channel&) = delete;
+
+	int fd() const { return fd_; }
+	size_t size() const { return size_; } // bytes mapped
+	Header& header() const { return *header_; }
+	uint8_t* slot_pixels(int index) const;
+
+	// Plugin: append a record. False if the ring lacks room.
+	bool write(RecordType type, uint64_t seq, const void* data, size_t size);
+	// Worker: the next record, skipping padding; `payload` is valid until
+	// consume(). False when the ring is empty.
+	bool peek(RecordHeader& record, const uint8_t*& payload);
+	void consume();
+
+	// Worker: a Free slot now Writing, or -1.
+	int claim_slot();
+	// Plugin: give a Ready slot back.
+	void release_slot(int index);
+
+private:
+	Channel(int fd, uint8_t* base, size_t size);
+
+	int fd_;
+	uint8_t* base_;
+	size_t size_;
+	Header* header_;
+	uint64_t peeked_ = 0; // bytes of the record returned by peek()
+};
+
+// Record plus padding, as laid out in the ring.
+constexpr size_t record_span(size_t payload) {
+	return sizeof(RecordHeader) + ((payload + 15) & ~static_cast<size_t>(15));
+}
+
+} // namespace decode_ipc
@@ -0,0 +1,137 @@
+#include "decode_pool.h"
+#include "../common/Log.hpp"
+#include "../common/MemoryResidency.hpp"
+#include "../common/ThreadPolicy.hpp"
+
+#include <algorithm>
+#include <string>
+
+DecodePool::DecodePool(size_t threads) {
+	if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+	threads_.reserve(threads);
+	for (size_t i = 0; i < threads; ++i) {
+		threads_.emplace_back([this, i]() { run(i); });
+	}
+	OA_LOG(Info, "DecodePool", "started {} decode workers", threads);
+}
+
+DecodePool::~DecodePool() {
+	{
+		std::lock_guard<std::mutex> lk(mutex_);
+		stop_ = true;
+	}
+	cv_.notify_all();
+	for (auto& t : threads_) {
+		if (t.joinable()) t.join();
+	}
+}
+
+DecodePool& DecodePool::shared() {
+	// Leaked on purpose: transport callbacks may still post during exit.
+	static DecodePool* pool = new DecodePool();
+	return *pool;
+}
+
+void DecodePool::post(Task task) {
+	{
+		std::lock_guard<std::mutex> lk(mutex_);
+		queue_.push_back(std::move(task));
+	}
+	cv_.notify_one();
+}
+
+void DecodePool::run(size_t index) {
+	const std::string name = "oa-decode-" + std::to_string(index);
+	for (;;) {
+		oa_thread::refresh(oa_thread::Role::Decode, name.c_str());
+		oa_memory::count_faults(oa_thread::Role::Decode);
+		Task task;
+		{
+			std::unique_lock<std::mutex> lk(mutex_);
+			cv_.wait(lk, [this]() { return stop_ || !queue_.empty(); });
+			if (stop_ && queue_.empty()) return;
+			task = std::move(queue_.front());
+			queue_.pop_front();
+		}
+		task();
+	}
+}
+
+void DecodePool::Strand::post(Task task, bool droppable) {
+	bool schedule = false;
+	{
+		std::lock_guard<std::mutex> lk(mutex_);
+		tasks_.push_back(Entry{std::move(task), droppable});
+		depth_.store(tasks_.size(), std::memory_order_relaxed);
+		if (!scheduled_) {
+			scheduled_ = true;
+			schedule = true;
+		}
+	}
+	if (schedule) {
+		auto self = shared_from_this();
+		pool_.post([self]() { self->drain(); });
+	}
+}
+
+size_t DecodePool::Strand::clear() {
+	size_t n = 0;
+	{
+		std::lock_guard<std::mutex> lk(mutex_);
+		n = tasks_.size();
+		tasks_.clear();
+		depth_.store(0, std::memory_order_relaxed);
+	}
+	taken_.notify_all();
+	return n;
+}
+
+size_t DecodePool::Strand::shed(Task front) {
+	std::unique_lock<std::mutex> lk(mutex_);
+	size_t dropped = 0;
+	bool replaced = false;
+	tasks_.erase(std::remove_if(tasks_.begin(), tasks_.end(),
+								[&](const Entry& e) {
+									if (!e.droppable) return false;
+									if (e.shed_front) {
+										replaced = true;
+									} else {
+										++dropped;
+									}
+									return true;
+								}),
+				 tasks_.end());
+	// The strand is still scheduled if anything was queued. `front` is
+	// droppable itself: the next shed() replaces it rather than adding one.
+	if (dropped > 0 || replaced) tasks_.push_front(Entry{std::move(front), true, true});
+	depth_.store(tasks_.size(), std::memory_order_relaxed);
+	lk.unlock();
+	if (dropped > 0) taken_.notify_all();
+	return dropped;
+}
+
+bool DecodePool::Strand::wait_pending(size_t max_pending, std::chrono::milliseconds timeout) {
+	std::unique_lock<std::mutex> lk(mutex_);
+	return taken_.wait_for(lk, timeout, [&]() { return tasks_.size() <= max_pending; });
+}
+
+void DecodePool::Strand::drain() {
+	for (size_t i = 0; i < kBatch; ++i) {
+		Task task;
+		{
+			std::lock_guard<std::mutex> lk(mutex_);
+			if (tasks_.empty()) {
+				scheduled_ = false;
+				return;
+			}
+			task = std::move(tasks_.front().task);
+			tasks_.pop_front();
+			depth_.store(tasks_.size(), std::memory_order_relaxed);
+		}
+		taken_.notify_all();
+		task();
+	}
+	// Still busy: requeue behind other strands so one stream cannot starve the rest.
+	auto self = shared_from_this();
+	pool_.post([self]() { self->drain(); });
+}
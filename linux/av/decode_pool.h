@@ -0,0 +1,80 @@
+// Shared worker pool for decode work, with per-stream ordering via strands.
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class DecodePool {
+public:
+	using Task = std::function<void()>;
+
+	// Runs posted tasks one at a time, in order, on whichever pool thread is
+	// free. Different strands run in parallel. Tasks keep the strand alive.
+	class Strand : public std::enable_shared_from_this<Strand> {
+	public:
+		explicit Strand(DecodePool& pool) : pool_(pool) {}
+
+		// A droppable task may be discarded by shed() before it starts.
+		void post(Task task, bool droppable = false);
+		// Drop queued tasks that have not started yet; returns how many.
+		size_t clear();
+		// Drop the queued droppable tasks and, if there were any, queue
+		// `front` ahead of the remaining ones, itself droppable. Returns how
+		// many were dropped.
+		size_t shed(Task front);
+		// Queued tasks; lock-free, so monitoring can poll it.
+		size_t pending() const { return depth_.load(std::memory_order_relaxed); }
+		// Block until at most `max_pending` tasks are queued; false on
+		// timeout. For producers that can wait, unlike the transport.
+		bool wait_pending(size_t max_pending, std::chrono::milliseconds timeout);
+
+	private:
+		void drain();
+
+		static constexpr size_t kBatch = 8; // tasks per turn before yielding the thread
+
+		struct Entry {
+			Task task;
+			bool droppable = false;
+			bool shed_front = false; // queued by shed(); not counted as dropped
+		};
+
+		DecodePool& pool_;
+		mutable std::mutex mutex_;
+		std::deque<Entry> tasks_;
+		std::atomic<size_t> depth_{0}; // tasks_.size()
+		std::condition_variable taken_; // tasks_ shrank
+		bool scheduled_ = false;
+	};
+
+	// threads == 0 sizes the pool to the number of cores.
+	explicit DecodePool(size_t threads = 0);
+	~DecodePool();
+
+	DecodePool(const DecodePool&) = delete;
+	DecodePool& operator=(const DecodePool&) = delete;
+
+	// Process-wide pool shared by all streams; never destroyed.
+	static DecodePool& shared();
+
+	std::shared_ptr<Strand> make_strand() { return std::make_shared<Strand>(*this); }
+	void post(Task task);
+	size_t size() const { return threads_.size(); }
+
+private:
+	void run(size_t index);
+
+	std::mutex mutex_;
+	std::condition_variable cv_;
+	std::deque<Task> queue_;
+	bool stop_ = false;
+	std::vector<std::thread> threads_;
+};
@@ -0,0 +1,51 @@
+#include "decode_recovery.h"
+
+bool DecodeRecovery::admit(const AccessUnitInfo& info, int64_t now_us) {
+	if (state_ != State::AwaitingKeyframe) return true;
+	const bool fallback = now_us - error_since_us_ >= kIntraFallbackUs;
+	if (info.idr || (fallback && info.intra)) {
+		state_ = State::Resyncing;
+		return true;
+	}
+	++stats_.discarded;
+	return false;
+}
+
+void DecodeRecovery::on_error(int64_t now_us) {
+	if (state_ == State::Decoding || planned_) {
+		planned_ = false;
+		++stats_.errors;
+		error_since_us_ = now_us;
+		last_request_us_ = 0;
+	}
+	// An error while resyncing means the keyframe did not take; wait for the
+	// next one but keep measuring from the first error.
+	state_ = State::AwaitingKeyframe;
+}
+
+void DecodeRecovery::resync(int64_t now_us) {
+	state_ = State::AwaitingKeyframe;
+	planned_ = true;
+	error_since_us_ = now_us;
+	last_request_us_ = 0;
+}
+
+int64_t DecodeRecovery::on_frame(int64_t now_us) {
+	if (state_ == State::Decoding) return -1;
+	state_ = State::Decoding;
+	if (planned_) {
+		planned_ = false;
+		return -1;
+	}
+	++stats_.recoveries;
+	stats_.last_recover_us = now_us - error_since_us_;
+	return stats_.last_recover_us;
+}
+
+bool DecodeRecovery::keyframe_request_due(int64_t now_us) {
+	if (state_ != State::AwaitingKeyframe) return false;
+	if (last_request_us_ != 0 && now_us - last_request_us_ < kKeyframeRequestIntervalUs) return false;
+	last_request_us_ = now_us;
+	++stats_.keyframe_requests;
+	return true;
+}
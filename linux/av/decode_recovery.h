@@ -0,0 +1,58 @@
+// Decoder error recovery: after an error, hold the last good frame and discard input until a keyframe.
+#pragma once
+
+#include "bitstream.h"
+
+#include <cstdint>
+
+// State machine shared by the decoders. Not thread-safe; the owning decoder
+// serializes calls under its own lock.
+//
+//   Decoding --error--> AwaitingKeyframe --IDR admitted--> Resyncing --frame--> Decoding
+//
+// While awaiting a keyframe every non-IDR packet is dropped, so references to
+// lost pictures never reach the screen and the presenter keeps showing the
+// last good frame. If no IDR shows up within kIntraFallbackUs any intra
+// picture (H.264 I-slices, H.265 CRA/BLA) is accepted as well, for encoders
+// that only use intra refresh or open GOPs.
+class DecodeRecovery {
+public:
+	static constexpr int64_t kIntraFallbackUs = 2000000;
+	static constexpr int64_t kKeyframeRequestIntervalUs = 500000;
+
+	struct Stats {
+		uint64_t errors = 0;          // transitions into AwaitingKeyframe
+		uint64_t recoveries = 0;      // completed recoveries
+		uint64_t discarded = 0;       // packets dropped while waiting
+		uint64_t keyframe_requests = 0;
+		int64_t last_recover_us = 0;  // first error -> first good frame, most recent recovery
+	};
+
+	// Whether `info` may be sent to the decoder.
+	bool admit(const AccessUnitInfo& info, int64_t now_us);
+	// Decode error or corrupt output. The decoder should flush.
+	void on_error(int64_t now_us);
+	// The decoder was reopened on purpose: wait for a keyframe without
+	// counting an error or a recovery.
+	void resync(int64_t now_us);
+	// A clean frame came out. Returns the recovery time in microseconds if
+	// this ended a recovery, otherwise -1.
+	int64_t on_frame(int64_t now_us);
+	// True at most once per kKeyframeRequestIntervalUs while waiting.
+	bool keyframe_request_due(int64_t now_us);
+
+	// While true, the next admitted packet is a keyframe and the decoder
+	// should put its stored parameter sets in front of it.
+	bool awaiting_keyframe() const { return state_ == State::AwaitingKeyframe; }
+	bool recovering() const { return state_ != State::Decoding; }
+	const Stats& stats() const { return stats_; }
+
+private:
+	enum class State { Decoding, AwaitingKeyframe, Resyncing };
+
+	State state_ = State::Decoding;
+	int64_t error_since_us_ = 0;
+	int64_t last_request_us_ = 0;
+	bool planned_ = false; // waiting because of resync(), not an error
+	Stats stats_;
+};
@@ -0,0 +1,212 @@
+#include "decode_worker.h"
+#include "decode_ipc.h"
+#include "pipeline_stats.h"
+#include "video_decoder.h"
+#include "../common/Log.hpp"
+#include "../common/ThreadPolicy.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr int64_t kCpuPeriodUs = 100000;
+
+bool parse_int(const char* text, int& out) {
+	char* end = nullptr;
+	errno = 0;
+	const long v = std::strtol(text, &end, 10);
+	if (errno != 0 || end == text || *end != '\0' || v < INT32_MIN || v > INT32_MAX) return false;
+	out = static_cast<int>(v);
+	return true;
+}
+
+bool write_file(const std::string& path, const std::string& value) {
+	std::ofstream out(path);
+	out << value;
+	out.flush();
+	return static_cast<bool>(out);
+}
+
+void signal_fd(int fd) {
+	const uint64_t one = 1;
+	while (write(fd, &one, sizeof(one)) < 0 && errno == EINTR) {
+	}
+}
+
+void handle_packet(decode_ipc::Channel& channel, VideoDecoder& decoder, const decode_ipc::RecordHeader& record,
+				   const uint8_t* payload, std::vector<uint8_t>& scratch) {
+	decode_ipc::Header& h = channel.header();
+	int width = 0, height = 0;
+	const bool decoded = decoder.decode_to_yuv420p(payload, record.size, scratch, width, height);
+	int32_t done = -1;
+	if (decoded) {
+		const int slot = channel.claim_slot();
+		if (slot < 0) {
+			OA_LOG_RATE(Warn, 1, "DecodeWorker", "all {} frame slots held by the plugin; frame dropped", h.slot_count);
+		} else if (scratch.size() > h.slot_size) {
+			OA_LOG_RATE(Warn, 1, "DecodeWorker", "{}x{} frame exceeds the {} byte slot; dropped", width, height,
+						h.slot_size);
+			channel.release_slot(slot);
+		} else {
+			decode_ipc::Slot& s = h.slots[slot];
+			std::memcpy(channel.slot_pixels(slot), scratch.data(), scratch.size());
+			s.width = static_cast<uint32_t>(width);
+			s.height = static_cast<uint32_t>(height);
+			s.size = scratch.size();
+			s.state.store(decode_ipc::kSlotReady, std::memory_order_release);
+			done = slot;
+		}
+	}
+
+	int announced_w = 0, announced_h = 0;
+	if (decoder.announced_size(announced_w, announced_h)) {
+		h.announced.store((static_cast<uint64_t>(announced_w) << 32) | static_cast<uint32_t>(announced_h),
+						  std::memory_order_relaxed);
+	}
+	const PipelineStats& stats = pipeline_stats();
+	h.recovering.store(decoder.recovering() ? 1 : 0, std::memory_order_relaxed);
+	h.frames_discarded.store(stats.frames_discarded.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	h.decode_recoveries.store(stats.decode_recoveries.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	h.last_recover_us.store(stats.last_recover_us.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	h.done_slot.store(done, std::memory_order_relaxed);
+	h.done_seq.store(record.seq, std::memory_order_release);
+}
+
+} // namespace
+
+std::vector<std::string> format_decode_worker_args(const DecodeWorkerArgs& args) {
+	std::vector<std::string> out = {
+		"--shm-fd=" + std::to_string(args.shm_fd),
+		"--request-fd=" + std::to_string(args.request_fd),
+		"--done-fd=" + std::to_string(args.done_fd),
+	};
+	if (!args.cgroup.empty()) out.push_back("--cgroup=" + args.cgroup);
+	if (args.cpu_percent > 0) out.push_back("--cpu-percent=" + std::to_string(args.cpu_percent));
+	return out;
+}
+
+bool parse_decode_worker_args(int argc, const char* const* argv, DecodeWorkerArgs& out) {
+	DecodeWorkerArgs args;
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		const size_t eq = arg.find('=');
+		if (eq == std::string::npos) return false;
+		const std::string key = arg.substr(0, eq);
+		const std::string value = arg.substr(eq + 1);
+		bool ok = true;
+		if (key == "--shm-fd") {
+			ok = parse_int(value.c_str(), args.shm_fd);
+		} else if (key == "--request-fd") {
+			ok = parse_int(value.c_str(), args.request_fd);
+		} else if (key == "--done-fd") {
+			ok = parse_int(value.c_str(), args.done_fd);
+		} else if (key == "--cgroup") {
+			args.cgroup = value;
+		} else if (key == "--cpu-percent") {
+			ok = parse_int(value.c_str(), args.cpu_percent) && args.cpu_percent >= 0;
+		} else {
+			ok = false;
+		}
+		if (!ok) return false;
+	}
+	if (args.shm_fd < 0 || args.request_fd < 0 || args.done_fd < 0) return false;
+	out = args;
+	return true;
+}
+
+bool join_cgroup(const std::string& path, int cpu_percent) {
+	if (path.empty()) return true;
+	if (mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+		OA_LOG(Warn, "DecodeWorker", "cannot create cgroup {}: {}", path, std::strerror(errno));
+		return false;
+	}
+	bool ok = true;
+	if (cpu_percent > 0) {
+		const int64_t quota = kCpuPeriodUs * cpu_percent / 100;
+		if (!write_file(path + "/cpu.max", std::to_string(quota) + " " + std::to_string(kCpuPeriodUs))) {
+			OA_LOG(Warn, "DecodeWorker", "cannot set {}/cpu.max (cpu controller not delegated?)", path);
+			ok = false;
+		}
+	}
+	if (!write_file(path + "/cgroup.procs", "0")) {
+		OA_LOG(Warn, "DecodeWorker", "cannot join cgroup {}", path);
+		return false;
+	}
+	OA_LOG(Info, "DecodeWorker", "pid {} in cgroup {} cpu={}%", getpid(), path, cpu_percent);
+	return ok;
+}
+
+int run_decode_worker(const DecodeWorkerArgs& args) {
+	auto channel = decode_ipc::Channel::attach(args.shm_fd);
+	if (!channel) return 2;
+	decode_ipc::Header& h = channel->header();
+	const VideoCodec codec = h.codec == static_cast<uint32_t>(VideoCodec::H265) ? VideoCodec::H265 : VideoCodec::H264;
+
+	std::unique_ptr<VideoDecoder> decoder;
+	try {
+		decoder = make_video_decoder(codec);
+	} catch (const std::exception& e) {
+		OA_LOG(Error, "DecodeWorker", "cannot create {} decoder: {}", codec_name(codec), e.what());
+		return 3;
+	}
+	decoder->set_keyframe_request([&h]() { h.keyframe_requests.fetch_add(1, std::memory_order_relaxed); });
+	h.ready.store(1, std::memory_order_release);
+	signal_fd(args.done_fd);
+	OA_LOG(Info, "DecodeWorker", "pid {} decoding {}", getpid(), codec_name(codec));
+
+	const pid_t parent = getppid();
+	std::vector<uint8_t> scratch;
+	for (;;) {
+		oa_thread::refresh(oa_thread::Role::Decode, "oa-decode-proc");
+		pollfd pfd{args.request_fd, POLLIN, 0};
+		const int ready = poll(&pfd, 1, 1000);
+		if (ready < 0 && errno != EINTR) return 4;
+		if (getppid() != parent) return 0; // the plugin's process is gone
+		if (ready <= 0) continue;
+		uint64_t count = 0;
+		if (read(args.request_fd, &count, sizeof(count)) < 0 && errno != EAGAIN && errno != EINTR) return 4;
+
+		decode_ipc::RecordHeader record;
+		const uint8_t* payload = nullptr;
+		while (channel->peek(record, payload)) {
+			switch (static_cast<decode_ipc::RecordType>(record.type)) {
+			case decode_ipc::RecordType::Packet:
+				handle_packet(*channel, *decoder, record, payload, scratch);
+				signal_fd(args.done_fd);
+				break;
+			case decode_ipc::RecordType::Options:
+				if (record.size >= sizeof(decode_ipc::WireOptions)) {
+					decode_ipc::WireOptions wire;
+					std::memcpy(&wire, payload, sizeof(wire));
+					DecoderOptions options;
+					options.threads = wire.threads;
+					options.low_delay = wire.low_delay != 0;
+					options.fast = wire.fast != 0;
+					options.scaler = static_cast<ScalerMode>(std::min<uint8_t>(wire.scaler, 4));
+					decoder->set_options(options);
+				}
+				break;
+			case decode_ipc::RecordType::ResetSession:
+				decoder->reset_session();
+				break;
+			case decode_ipc::RecordType::SkipToKeyframe:
+				decoder->skip_to_keyframe();
+				break;
+			case decode_ipc::RecordType::KeyframesOnly:
+				if (record.size >= 1) decoder->set_keyframes_only(payload[0] != 0);
+				break;
+			default:
+				OA_LOG_RATE(Warn, 1, "DecodeWorker", "unknown record type {}", record.type);
+				break;
+			}
+			channel->consume();
+		}
+	}
+}
@@ -0,0 +1,29 @@
+// The decode worker process's side of decode_ipc: command line, cgroup
+// placement and the serving loop (worker/decode_worker_main.cc).
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct DecodeWorkerArgs {
+	int shm_fd = -1;     // decode_ipc channel memfd
+	int request_fd = -1; // eventfd, signalled when records are queued
+	int done_fd = -1;    // eventfd, signalled when a Packet was handled
+	std::string cgroup;  // see DecodeWorkerOptions
+	int cpu_percent = 0;
+};
+
+// argv[1..] for the worker; argv[0] is left to the caller.
+std::vector<std::string> format_decode_worker_args(const DecodeWorkerArgs& args);
+// False on an unknown option or a missing fd.
+bool parse_decode_worker_args(int argc, const char* const* argv, DecodeWorkerArgs& out);
+
+// Move the calling process into the cgroup v2 directory `path`, creating it
+// and writing cpu.max when cpu_percent > 0. Needs a delegated subtree (e.g.
+// a systemd user slice with Delegate=yes); failures are logged and leave the
+// process where it was.
+bool join_cgroup(const std::string& path, int cpu_percent);
+
+// Decode the channel's packets until the parent exits. Returns the process
+// exit status.
+int run_decode_worker(const DecodeWorkerArgs& args);
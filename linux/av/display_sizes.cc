@@ -0,0 +1,26 @@
+#include "display_sizes.h"
+
+#include <algorithm>
+
+bool DisplaySizes::set(const void* view, int width, int height, int src_w, int src_h) {
+	int before_w = 0, before_h = 0;
+	output(src_w, src_h, before_w, before_h);
+	if (width > 0 && height > 0) {
+		sizes_[view] = std::make_pair(width, height);
+	} else {
+		sizes_.erase(view);
+	}
+	int after_w = 0, after_h = 0;
+	output(src_w, src_h, after_w, after_h);
+	return after_w != before_w || after_h != before_h;
+}
+
+void DisplaySizes::output(int src_w, int src_h, int& out_w, int& out_h) const {
+	int want_w = 0, want_h = 0;
+	for (const auto& entry : sizes_) {
+		want_w = std::max(want_w, entry.second.first);
+		want_h = std::max(want_h, entry.second.second);
+	}
+	out_w = (want_w > 0 && want_w < src_w) ? want_w : src_w;
+	out_h = (want_h > 0 && want_h < src_h) ? want_h : src_h;
+}
@@ -0,0 +1,22 @@
+// Size a picture is converted at, from the on-screen sizes of the textures showing it.
+#pragma once
+
+#include <map>
+#include <utility>
+
+// On-screen sizes in physical pixels, one per texture of a fan-out group.
+// Conversion renders at the largest so no view is upscaled. Not thread-safe;
+// the owner serializes calls.
+class DisplaySizes {
+public:
+	// `view` is shown at width x height; a non-positive size forgets it.
+	// Returns true if that changes output() for a src_w x src_h picture.
+	bool set(const void* view, int width, int height, int src_w, int src_h);
+
+	// The largest reported width and height, each clamped to the src_w x
+	// src_h picture; the picture size while no view reports one.
+	void output(int src_w, int src_h, int& out_w, int& out_h) const;
+
+private:
+	std::map<const void*, std::pair<int, int>> sizes_;
+};
@@ -0,0 +1,264 @@
+#include "frame_tap.h"
+#include "../common/Log.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <vector>
+
+struct TapBuffer {
+	TapFrame frame{};
+	std::atomic<int> refs{0};
+	std::vector<uint8_t> pixels;
+	std::shared_ptr<FrameTap::Pool> pool; // set while handed out, so it outlives the tap
+};
+
+struct FrameTap::Pool {
+	std::mutex mutex;
+	std::vector<std::unique_ptr<TapBuffer>> free;
+	int outstanding = 0;
+	bool keep = false; // whether released buffers are kept for reuse; off while the tap is
+	std::atomic<size_t> bytes{0}; // pixels capacity of every buffer
+};
+
+namespace {
+
+std::mutex g_taps_mutex;
+std::map<int64_t, std::shared_ptr<FrameTap>> g_taps;
+
+// A buffer with one reference, or null when readers hold kMaxBuffers.
+TapBuffer* take_buffer(const std::shared_ptr<FrameTap::Pool>& pool) {
+	std::unique_ptr<TapBuffer> buffer;
+	{
+		std::lock_guard<std::mutex> lk(pool->mutex);
+		if (!pool->free.empty()) {
+			buffer = std::move(pool->free.back());
+			pool->free.pop_back();
+		} else if (pool->outstanding < FrameTap::kMaxBuffers) {
+			buffer = std::make_unique<TapBuffer>();
+		} else {
+			return nullptr;
+		}
+		++pool->outstanding;
+	}
+	buffer->pool = pool;
+	buffer->refs.store(1, std::memory_order_relaxed);
+	buffer->frame.buffer = buffer.get();
+	return buffer.release();
+}
+
+// Copy a w x h plane with `stride` bytes per row to tightly packed `dst`;
+// returns the end of what was written.
+uint8_t* copy_plane(const uint8_t* src, int stride, int w, int h, uint8_t* dst) {
+	const size_t row = static_cast<size_t>(w);
+	if (stride == w) {
+		std::memcpy(dst, src, row * h);
+		return dst + row * h;
+	}
+	for (int y = 0; y < h; ++y, dst += row) std::memcpy(dst, src + static_cast<size_t>(y) * stride, row);
+	return dst;
+}
+
+} // namespace
+
+void fit_size(int width, int height, int max_w, int max_h, int& out_w, int& out_h) {
+	int64_t w = std::max(width, 1);
+	int64_t h = std::max(height, 1);
+	const int64_t src_w = w, src_h = h;
+	if (max_w > 0 && w > max_w) {
+		w = max_w;
+		h = src_h * max_w / src_w;
+	}
+	if (max_h > 0 && h > max_h) {
+		h = max_h;
+		w = src_w * max_h / src_h;
+	}
+	out_w = static_cast<int>(std::max<int64_t>(w, 1));
+	out_h = static_cast<int>(std::max<int64_t>(h, 1));
+}
+
+void downscale_plane(const uint8_t* src, int src_w, int src_h, size_t src_stride, uint8_t* dst, int dst_w,
+					 int dst_h) {
+	if (src_w <= 0 || src_h <= 0 || dst_w <= 0 || dst_h <= 0) return;
+	// Column spans are the same for every row; sum whole source rows into
+	// `acc` first so each source pixel is read once.
+	std::vector<int> x_begin(dst_w), x_end(dst_w);
+	for (int x = 0; x < dst_w; ++x) {
+		x_begin[x] = static_cast<int>(static_cast<int64_t>(x) * src_w / dst_w);
+		x_end[x] = std::max(static_cast<int>(static_cast<int64_t>(x + 1) * src_w / dst_w), x_begin[x] + 1);
+	}
+	std::vector<uint32_t> acc(src_w);
+	for (int y = 0; y < dst_h; ++y) {
+		const int y0 = static_cast<int>(static_cast<int64_t>(y) * src_h / dst_h);
+		const int y1 = std::max(static_cast<int>(static_cast<int64_t>(y + 1) * src_h / dst_h), y0 + 1);
+		std::fill(acc.begin(), acc.end(), 0u);
+		for (int sy = y0; sy < y1; ++sy) {
+			const uint8_t* row = src + static_cast<size_t>(sy) * src_stride;
+			for (int sx = 0; sx < src_w; ++sx) acc[sx] += row[sx];
+		}
+		uint8_t* out = dst + static_cast<size_t>(y) * dst_w;
+		for (int x = 0; x < dst_w; ++x) {
+			uint32_t sum = 0;
+			for (int sx = x_begin[x]; sx < x_end[x]; ++sx) sum += acc[sx];
+			const uint32_t count = static_cast<uint32_t>((x_end[x] - x_begin[x]) * (y1 - y0));
+			out[x] = static_cast<uint8_t>((sum + count / 2) / count);
+		}
+	}
+}
+
+FrameTap::FrameTap(int64_t stream_id) : stream_id_(stream_id), pool_(std::make_shared<Pool>()) {}
+
+FrameTap::~FrameTap() {
+	{
+		std::lock_guard<std::mutex> lk(pool_->mutex);
+		pool_->keep = false;
+	}
+	if (latest_) release(latest_);
+}
+
+void FrameTap::configure(const FrameTapConfig& config) {
+	TapFrame* dropped = nullptr;
+	std::vector<std::unique_ptr<TapBuffer>> idle;
+	{
+		std::lock_guard<std::mutex> lk(mutex_);
+		config_ = config;
+		config_.max_width = std::max(config_.max_width, 0);
+		config_.max_height = std::max(config_.max_height, 0);
+		config_.min_interval_us = std::max<int64_t>(config_.min_interval_us, 0);
+		const bool on = config_.format != FrameTapFormat::Off;
+		enabled_.store(on, std::memory_order_relaxed);
+		if (!on) std::swap(dropped, latest_);
+		// Off gives the idle buffers' memory back; ones still held by readers
+		// are freed as they come back.
+		std::lock_guard<std::mutex> pool_lk(pool_->mutex);
+		pool_->keep = on;
+		if (!on) idle.swap(pool_->free);
+	}
+	if (dropped) release(dropped);
+	if (!idle.empty()) {
+		size_t freed = 0;
+		for (const auto& buffer : idle) freed += buffer->pixels.capacity();
+		pool_->bytes.fetch_sub(freed, std::memory_order_relaxed);
+	}
+	OA_LOG(Info, "FrameTap", "stream {}: format={} max={}x{} interval={}us", stream_id_,
+		   static_cast<uint32_t>(config.format), config.max_width, config.max_height, config.min_interval_us);
+}
+
+FrameTapConfig FrameTap::config() const {
+	std::lock_guard<std::mutex> lk(mutex_);
+	return config_;
+}
+
+void FrameTap::offer(const I420Planes& planes, int width, int height, int64_t decode_ts_us) {
+	if (!enabled() || !planes.data[0] || width <= 0 || height <= 0) return;
+	FrameTapConfig config;
+	{
+		std::lock_guard<std::mutex> lk(mutex_);
+		config = config_;
+	}
+	if (config.format == FrameTapFormat::Off) return;
+	if (last_publish_us_ != 0 && decode_ts_us - last_publish_us_ < config.min_interval_us) return;
+
+	TapBuffer* buffer = take_buffer(pool_);
+	if (!buffer) {
+		skipped_.fetch_add(1, std::memory_order_relaxed);
+		OA_LOG_RATE(Warn, 1, "FrameTap", "stream {}: readers hold all {} buffers, frame skipped", stream_id_,
+					kMaxBuffers);
+		return;
+	}
+
+	TapFrame& f = buffer->frame;
+	const size_t capacity = buffer->pixels.capacity();
+	if (config.format == FrameTapFormat::I420) {
+		const int uv_w = (width + 1) / 2;
+		const int uv_h = (height + 1) / 2;
+		buffer->pixels.resize(static_cast<size_t>(width) * height + 2 * static_cast<size_t>(uv_w) * uv_h);
+		uint8_t* out = buffer->pixels.data();
+		out = copy_plane(planes.data[0], planes.stride[0], width, height, out);
+		out = copy_plane(planes.data[1], planes.stride[1], uv_w, uv_h, out);
+		copy_plane(planes.data[2], planes.stride[2], uv_w, uv_h, out);
+		f.width = static_cast<uint32_t>(width);
+		f.height = static_cast<uint32_t>(height);
+	} else {
+		int out_w = 0, out_h = 0;
+		fit_size(width, height, config.max_width, config.max_height, out_w, out_h);
+		buffer->pixels.resize(static_cast<size_t>(out_w) * out_h);
+		if (out_w == width && out_h == height) {
+			copy_plane(planes.data[0], planes.stride[0], width, height, buffer->pixels.data());
+		} else {
+			downscale_plane(planes.data[0], width, height, static_cast<size_t>(planes.stride[0]),
+							buffer->pixels.data(), out_w, out_h);
+		}
+		f.width = static_cast<uint32_t>(out_w);
+		f.height = static_cast<uint32_t>(out_h);
+	}
+	pool_->bytes.fetch_add(buffer->pixels.capacity() - capacity, std::memory_order_relaxed);
+	f.stream_id = stream_id_;
+	f.decode_ts_us = decode_ts_us;
+	f.format = static_cast<uint32_t>(config.format);
+	f.stride = f.width;
+	f.data = buffer->pixels.data();
+	f.size = buffer->pixels.size();
+
+	TapFrame* replaced = &f;
+	{
+		std::lock_guard<std::mutex> lk(mutex_);
+		if (enabled_.load(std::memory_order_relaxed)) {
+			f.sequence = ++sequence_;
+			std::swap(replaced, latest_);
+		}
+	}
+	if (replaced) release(replaced);
+	if (replaced != &f) {
+		last_publish_us_ = decode_ts_us;
+		published_.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+size_t FrameTap::held_bytes() const {
+	return pool_->bytes.load(std::memory_order_relaxed);
+}
+
+const TapFrame* FrameTap::acquire(uint64_t after_sequence) {
+	std::lock_guard<std::mutex> lk(mutex_);
+	if (!latest_ || latest_->sequence <= after_sequence) return nullptr;
+	static_cast<TapBuffer*>(latest_->buffer)->refs.fetch_add(1, std::memory_order_relaxed);
+	return latest_;
+}
+
+void FrameTap::release(const TapFrame* frame) {
+	if (!frame || !frame->buffer) return;
+	auto* buffer = static_cast<TapBuffer*>(frame->buffer);
+	if (buffer->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+	// Last reference: back to the pool, or freed if the tap is off or gone.
+	// Without this reference the pool may already be gone with its tap, and
+	// the buffer with it.
+	std::shared_ptr<Pool> pool = std::move(buffer->pool);
+	std::unique_ptr<TapBuffer> owned(buffer);
+	std::lock_guard<std::mutex> lk(pool->mutex);
+	--pool->outstanding;
+	if (pool->keep) {
+		pool->free.push_back(std::move(owned));
+	} else {
+		pool->bytes.fetch_sub(owned->pixels.capacity(), std::memory_order_relaxed);
+	}
+}
+
+void register_frame_tap(std::shared_ptr<FrameTap> tap) {
+	if (!tap) return;
+	std::lock_guard<std::mutex> lk(g_taps_mutex);
+	const int64_t id = tap->stream_id();
+	g_taps[id] = std::move(tap);
+}
+
+void unregister_frame_tap(const FrameTap& tap) {
+	std::lock_guard<std::mutex> lk(g_taps_mutex);
+	auto it = g_taps.find(tap.stream_id());
+	if (it != g_taps.end() && it->second.get() == &tap) g_taps.erase(it);
+}
+
+std::shared_ptr<FrameTap> find_frame_tap(int64_t stream_id) {
+	std::lock_guard<std::mutex> lk(g_taps_mutex);
+	auto it = g_taps.find(stream_id);
+	return it == g_taps.end() ? nullptr : it->second;
+}
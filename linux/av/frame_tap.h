@@ -0,0 +1,106 @@
+// Opt-in copy of decoded frames for analytics outside the GL path.
+#pragma once
+
+#include "yuv_convert.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+enum class FrameTapFormat : uint32_t { Off = 0, Luma = 1, I420 = 2 };
+
+struct FrameTapConfig {
+	FrameTapFormat format = FrameTapFormat::Off;
+	// Luma only: scaled down (box filter, aspect kept) to fit; 0 = decoded
+	// size. I420 frames are always published at the decoded size.
+	int max_width = 0;
+	int max_height = 0;
+	int64_t min_interval_us = 0; // between published frames
+};
+
+// A published frame. Same layout as OpenautoflutterTapFrame; the pixels stay
+// valid until the reference is given back with FrameTap::release().
+struct TapFrame {
+	uint64_t sequence;  // per tap, starting at 1
+	int64_t stream_id;
+	int64_t decode_ts_us; // steady clock
+	uint32_t format;      // FrameTapFormat
+	uint32_t width;
+	uint32_t height;
+	uint32_t stride;      // bytes per luma row
+	const uint8_t* data;  // Luma: height rows; I420: packed [Y][U][V]
+	uint64_t size;
+	void* buffer;         // owning buffer, internal
+};
+
+// Fed by the decode strand after each decoded frame. Publishing copies (and
+// scales) into one of a few pooled buffers; when readers hold all of them the
+// frame is skipped, so a slow reader never holds up decoding. Readers on any
+// thread acquire the newest frame and release it when done, in any order and
+// even after the tap is gone.
+class FrameTap {
+public:
+	static constexpr int kMaxBuffers = 4;
+
+	explicit FrameTap(int64_t stream_id);
+	~FrameTap();
+
+	FrameTap(const FrameTap&) = delete;
+	FrameTap& operator=(const FrameTap&) = delete;
+
+	int64_t stream_id() const { return stream_id_; }
+
+	// Any thread. Format Off stops publishing and drops the newest frame.
+	void configure(const FrameTapConfig& config);
+	FrameTapConfig config() const;
+	bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+	// Decode strand. `yuv` is a packed I420 frame.
+	void offer(const uint8_t* yuv, int width, int height, int64_t decode_ts_us) {
+		offer(i420_packed_planes(yuv, width, height), width, height, decode_ts_us);
+	}
+	// Same from separate planes; published frames are packed either way.
+	void offer(const I420Planes& planes, int width, int height, int64_t decode_ts_us);
+
+	// The newest frame with a sequence above `after_sequence`, with a
+	// reference held for the caller; null if there is none yet.
+	const TapFrame* acquire(uint64_t after_sequence);
+	static void release(const TapFrame* frame);
+
+	uint64_t published() const { return published_.load(std::memory_order_relaxed); }
+	uint64_t skipped() const { return skipped_.load(std::memory_order_relaxed); } // no free buffer
+	// Pixel memory of the buffer pool, including buffers readers hold.
+	size_t held_bytes() const;
+
+	struct Pool;
+
+private:
+	const int64_t stream_id_;
+	std::shared_ptr<Pool> pool_;
+	std::atomic<bool> enabled_{false};
+	mutable std::mutex mutex_;
+	FrameTapConfig config_;
+	TapFrame* latest_ = nullptr; // holds one reference
+	uint64_t sequence_ = 0;
+	int64_t last_publish_us_ = 0; // decode strand only
+	std::atomic<uint64_t> published_{0};
+	std::atomic<uint64_t> skipped_{0};
+};
+
+// Box-filter `src` (src_w x src_h, `src_stride` bytes per row) into
+// dst_w x dst_h, tightly packed. Each output pixel averages the source pixels
+// it covers; the scale need not be an integer.
+void downscale_plane(const uint8_t* src, int src_w, int src_h, size_t src_stride, uint8_t* dst, int dst_w,
+					 int dst_h);
+
+// Largest size with the aspect of width x height that fits max_w x max_h (0
+// = unbounded), never above the source; at least 1x1.
+void fit_size(int width, int height, int max_w, int max_h, int& out_w, int& out_h);
+
+// Taps by stream id, for callers without a plugin handle (the exported C
+// ABI). Unregistering leaves a newer tap under the same id in place.
+void register_frame_tap(std::shared_ptr<FrameTap> tap);
+void unregister_frame_tap(const FrameTap& tap);
+std::shared_ptr<FrameTap> find_frame_tap(int64_t stream_id);
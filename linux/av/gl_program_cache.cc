@@ -0,0 +1,163 @@
+#include "gl_program_cache.h"
+#include "../common/Log.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char kMagic[4] = {'O', 'A', 'P', 'B'};
+constexpr uint32_t kVersion = 1;
+// Real program binaries are a few hundred KB at most; anything larger is junk.
+constexpr uint32_t kMaxBinarySize = 16u << 20;
+constexpr uint32_t kMaxKeySize = 1u << 20;
+
+struct FileHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t format;
+	uint32_t key_size;
+	uint32_t data_size;
+};
+
+uint64_t fnv1a64(const std::string& s) {
+	uint64_t h = 0xcbf29ce484222325ull;
+	for (unsigned char c : s) {
+		h ^= c;
+		h *= 0x100000001b3ull;
+	}
+	return h;
+}
+
+std::string entry_path(const std::string& dir, const std::string& key) {
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(fnv1a64(key)));
+	return dir + "/" + name;
+}
+
+bool make_dirs(const std::string& dir) {
+	for (size_t pos = 1; pos <= dir.size(); ++pos) {
+		if (pos != dir.size() && dir[pos] != '/') continue;
+		const std::string part = dir.substr(0, pos);
+		if (::mkdir(part.c_str(), 0755) != 0 && errno != EEXIST) return false;
+	}
+	return true;
+}
+
+bool read_exact(int fd, void* buf, size_t size) {
+	auto* p = static_cast<uint8_t*>(buf);
+	while (size > 0) {
+		const ssize_t n = ::read(fd, p, size);
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) return false;
+		p += n;
+		size -= static_cast<size_t>(n);
+	}
+	return true;
+}
+
+bool write_exact(int fd, const void* buf, size_t size) {
+	auto* p = static_cast<const uint8_t*>(buf);
+	while (size > 0) {
+		const ssize_t n = ::write(fd, p, size);
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) return false;
+		p += n;
+		size -= static_cast<size_t>(n);
+	}
+	return true;
+}
+
+} // namespace
+
+std::string program_cache_key(const std::vector<std::string>& parts) {
+	std::string key;
+	for (const auto& part : parts) {
+		// Length-prefixed so ("ab","c") and ("a","bc") differ.
+		key += std::to_string(part.size());
+		key += ':';
+		key += part;
+	}
+	return key;
+}
+
+std::string program_cache_dir() {
+	if (const char* env = std::getenv("OPENAUTOFLUTTER_GL_CACHE_DIR")) {
+		if (std::strcmp(env, "off") == 0 || std::strcmp(env, "0") == 0) return {};
+		if (*env) return env;
+	}
+	if (const char* xdg = std::getenv("XDG_CACHE_HOME")) {
+		if (*xdg == '/') return std::string(xdg) + "/openautoflutter/gl";
+	}
+	if (const char* home = std::getenv("HOME")) {
+		if (*home) return std::string(home) + "/.cache/openautoflutter/gl";
+	}
+	return {};
+}
+
+bool load_program_binary(const std::string& dir, const std::string& key, ProgramBinary& out) {
+	if (dir.empty()) return false;
+	const int fd = ::open(entry_path(dir, key).c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd == -1) return false;
+	FileHeader hdr{};
+	bool ok = read_exact(fd, &hdr, sizeof(hdr)) && std::memcmp(hdr.magic, kMagic, sizeof(kMagic)) == 0 &&
+			  hdr.version == kVersion && hdr.key_size == key.size() && hdr.key_size <= kMaxKeySize &&
+			  hdr.data_size > 0 && hdr.data_size <= kMaxBinarySize;
+	if (ok) {
+		std::string stored(hdr.key_size, '\0');
+		ok = read_exact(fd, &stored[0], stored.size()) && stored == key;
+	}
+	if (ok) {
+		out.format = hdr.format;
+		out.data.resize(hdr.data_size);
+		ok = read_exact(fd, out.data.data(), out.data.size());
+		// Trailing bytes mean the file is not what we wrote.
+		uint8_t extra = 0;
+		ok = ok && ::read(fd, &extra, 1) == 0;
+	}
+	::close(fd);
+	if (!ok) out.data.clear();
+	return ok;
+}
+
+bool store_program_binary(const std::string& dir, const std::string& key, const ProgramBinary& binary) {
+	if (dir.empty() || binary.data.empty() || binary.data.size() > kMaxBinarySize || key.size() > kMaxKeySize) {
+		return false;
+	}
+	if (!make_dirs(dir)) {
+		OA_LOG(Warn, "GLProgramCache", "cannot create {}: {}", dir, std::strerror(errno));
+		return false;
+	}
+	const std::string path = entry_path(dir, key);
+	const std::string tmp = path + ".tmp." + std::to_string(::getpid());
+	const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (fd == -1) {
+		OA_LOG(Warn, "GLProgramCache", "open failed path={}: {}", tmp, std::strerror(errno));
+		return false;
+	}
+	FileHeader hdr{};
+	std::memcpy(hdr.magic, kMagic, sizeof(kMagic));
+	hdr.version = kVersion;
+	hdr.format = binary.format;
+	hdr.key_size = static_cast<uint32_t>(key.size());
+	hdr.data_size = static_cast<uint32_t>(binary.data.size());
+	bool ok = write_exact(fd, &hdr, sizeof(hdr)) && write_exact(fd, key.data(), key.size()) &&
+			  write_exact(fd, binary.data.data(), binary.data.size());
+	ok = (::close(fd) == 0) && ok;
+	if (ok) ok = ::rename(tmp.c_str(), path.c_str()) == 0;
+	if (!ok) {
+		OA_LOG(Warn, "GLProgramCache", "write failed path={}: {}", path, std::strerror(errno));
+		::unlink(tmp.c_str());
+	}
+	return ok;
+}
+
+void remove_program_binary(const std::string& dir, const std::string& key) {
+	if (dir.empty()) return;
+	::unlink(entry_path(dir, key).c_str());
+}
@@ -0,0 +1,31 @@
+// On-disk cache of linked GL program binaries (glGetProgramBinary output).
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct ProgramBinary {
+	uint32_t format = 0; // GL binary format enum reported by the driver
+	std::vector<uint8_t> data;
+};
+
+// Key for one program build: the driver strings and shader sources joined.
+// A driver update, another GPU or an edited shader all give a new key, so a
+// stale binary is never offered to glProgramBinary.
+std::string program_cache_key(const std::vector<std::string>& parts);
+
+// $OPENAUTOFLUTTER_GL_CACHE_DIR, else $XDG_CACHE_HOME/openautoflutter/gl,
+// else $HOME/.cache/openautoflutter/gl. Empty when the variable is "off" or
+// no home directory is known; an empty dir disables the cache.
+std::string program_cache_dir();
+
+// Read the binary stored for `key`. False when missing, truncated or written
+// for a different key (hash collision).
+bool load_program_binary(const std::string& dir, const std::string& key, ProgramBinary& out);
+
+// Write atomically (temp file + rename), creating `dir` if needed.
+bool store_program_binary(const std::string& dir, const std::string& key, const ProgramBinary& binary);
+
+// Drop the entry for `key`, e.g. after the driver rejected it.
+void remove_program_binary(const std::string& dir, const std::string& key);
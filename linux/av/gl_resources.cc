@@ -0,0 +1,86 @@
+#include "gl_resources.h"
+
+#include <iterator>
+
+void GlResources::track_texture(uint32_t name, const GlTextureFormat& format) {
+	if (name == 0) return;
+	std::lock_guard<std::mutex> lk(mutex_);
+	Storage& s = storage_[name];
+	live_ = live_ - s.bytes + format.bytes();
+	s.format = format;
+	s.bytes = format.bytes();
+	publish();
+}
+
+void GlResources::track_mipmaps(uint32_t name) {
+	std::lock_guard<std::mutex> lk(mutex_);
+	auto it = storage_.find(name);
+	if (it == storage_.end()) return;
+	// A full chain adds a third of level 0.
+	const size_t with_chain = it->second.format.bytes() + it->second.format.bytes() / 3;
+	if (it->second.bytes == with_chain) return;
+	live_ = live_ - it->second.bytes + with_chain;
+	it->second.bytes = with_chain;
+	publish();
+}
+
+uint32_t GlResources::acquire_texture(const GlTextureFormat& format) {
+	std::lock_guard<std::mutex> lk(mutex_);
+	for (auto it = pool_.rbegin(); it != pool_.rend(); ++it) {
+		const Storage& s = storage_.at(*it);
+		if (!(s.format == format)) continue;
+		const uint32_t name = *it;
+		pooled_ -= s.bytes;
+		pool_.erase(std::next(it).base());
+		reused_.fetch_add(1, std::memory_order_relaxed);
+		publish();
+		return name;
+	}
+	return 0;
+}
+
+void GlResources::release_texture(uint32_t name) {
+	if (name == 0) return;
+	std::lock_guard<std::mutex> lk(mutex_);
+	auto it = storage_.find(name);
+	if (it == storage_.end() || it->second.bytes == 0 || it->second.bytes > kMaxPooledBytes) {
+		forget(name);
+		deletions_.push_back(name);
+		publish();
+		return;
+	}
+	pool_.push_back(name);
+	pooled_ += it->second.bytes;
+	while (pool_.size() > kMaxPooled || pooled_ > kMaxPooledBytes) {
+		const uint32_t oldest = pool_.front();
+		pool_.erase(pool_.begin());
+		pooled_ -= storage_.at(oldest).bytes;
+		forget(oldest);
+		deletions_.push_back(oldest);
+	}
+	publish();
+}
+
+std::vector<uint32_t> GlResources::take_deletions() {
+	std::lock_guard<std::mutex> lk(mutex_);
+	std::vector<uint32_t> names;
+	names.swap(deletions_);
+	return names;
+}
+
+void GlResources::forget(uint32_t name) {
+	auto it = storage_.find(name);
+	if (it == storage_.end()) return;
+	live_ -= it->second.bytes;
+	storage_.erase(it);
+}
+
+void GlResources::publish() {
+	live_bytes_.store(live_, std::memory_order_relaxed);
+	pooled_bytes_.store(pooled_, std::memory_order_relaxed);
+}
+
+GlResources& gl_resources() {
+	static GlResources* resources = new GlResources();
+	return *resources;
+}
@@ -0,0 +1,80 @@
+// Lifetime of the video textures' GL objects: deferred deletion, reuse across resizes, live GL memory.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Storage of one 2D texture: level 0 size and internal format.
+struct GlTextureFormat {
+	int width = 0;
+	int height = 0;
+	uint32_t internal_format = 0; // GL enum, e.g. GL_RGBA8
+	int texel_bytes = 0;          // bytes per texel of internal_format
+
+	size_t bytes() const { return static_cast<size_t>(width) * static_cast<size_t>(height) * texel_bytes; }
+	bool operator==(const GlTextureFormat& o) const {
+		return width == o.width && height == o.height && internal_format == o.internal_format;
+	}
+};
+
+// Bookkeeping only; the caller makes the GL calls on the raster thread. GL
+// names may only be deleted with their context current, but surfaces are
+// destroyed wherever their last texture is disposed, so names are released
+// here from any thread and deleted on the next populate. Textures released
+// with storage are kept for reuse by the next one that needs the same storage,
+// e.g. when a stream reconnects or switches back to an earlier resolution.
+//
+// Flutter populates every texture of the plugin on its raster thread with one
+// context, so the plugin has one instance (gl_resources()), like the shared
+// YUV program.
+class GlResources {
+public:
+	// Idle textures kept for reuse; the least recently released go first.
+	static constexpr size_t kMaxPooled = 8;
+	static constexpr size_t kMaxPooledBytes = 48u * 1024 * 1024;
+
+	// `name` now has `format` storage (glTexImage2D), without mipmaps.
+	void track_texture(uint32_t name, const GlTextureFormat& format);
+	// glGenerateMipmap was called on `name`; counts its mip chain.
+	void track_mipmaps(uint32_t name);
+
+	// An idle texture that has `format` storage, or 0. Raster thread.
+	uint32_t acquire_texture(const GlTextureFormat& format);
+	// Done with `name`: pooled if it has storage, deleted later otherwise.
+	// Any thread.
+	void release_texture(uint32_t name);
+
+	// Names to glDeleteTextures now. Raster thread, context current.
+	std::vector<uint32_t> take_deletions();
+
+	// Storage of every texture not yet deleted, and the pooled share of it.
+	size_t live_bytes() const { return live_bytes_.load(std::memory_order_relaxed); }
+	size_t pooled_bytes() const { return pooled_bytes_.load(std::memory_order_relaxed); }
+	uint64_t reused() const { return reused_.load(std::memory_order_relaxed); }
+
+private:
+	struct Storage {
+		GlTextureFormat format;
+		size_t bytes = 0;
+	};
+
+	void forget(uint32_t name); // caller holds mutex_
+	void publish();             // caller holds mutex_
+
+	mutable std::mutex mutex_;
+	std::map<uint32_t, Storage> storage_;
+	std::vector<uint32_t> pool_; // oldest first
+	std::vector<uint32_t> deletions_;
+	size_t live_ = 0;
+	size_t pooled_ = 0;
+	std::atomic<size_t> live_bytes_{0};
+	std::atomic<size_t> pooled_bytes_{0};
+	std::atomic<uint64_t> reused_{0};
+};
+
+GlResources& gl_resources();
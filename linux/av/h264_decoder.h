@@ -1,25 +1,27 @@
-// Simple H.264 -> YUV420P (I420) decoder using libavcodec/libswscale.
+// H.264 -> YUV420P (I420) decoder using libavcodec/libswscale.
 #pragma once
 
-#include <cstddef>
-#include <cstdint>
-#include <vector>
+#include "lavc_decoder.h"
 
-class H264Decoder {
+// Understands avcC config records and SPS/PPS (NAL types 7/8).
+class H264Decoder final : public LavcDecoder {
 public:
-	H264Decoder();
-	~H264Decoder();
+	H264Decoder() : LavcDecoder(VideoCodec::H264) {}
 
-	// Decode to planar YUV420P (I420) and return data packed as [Y][U][V].
-	// out_yuv size will be width*height*3/2 on success.
-	bool decode_to_yuv420p(const uint8_t* data,
-						   size_t size,
-						   std::vector<uint8_t>& out_yuv,
-						   int& out_width,
-						   int& out_height);
-
-private:
-	struct Impl;
-	Impl* impl_;
+protected:
+	bool parse_config_record(const uint8_t* data, size_t size, std::vector<uint8_t>& out) const override {
+		return parse_avcc_config(data, size, out);
+	}
+	bool is_parameter_sets_only(const uint8_t* data, size_t size) const override {
+		return is_h264_parameter_sets_only(data, size);
+	}
+	AccessUnitInfo scan_access_unit(const uint8_t* data, size_t size) const override {
+		return scan_h264_access_unit(data, size);
+	}
+	bool parse_sps_size(const uint8_t* data, size_t size, int& width, int& height) const override {
+		return parse_h264_sps_size(data, size, width, height);
+	}
+	bool extract_parameter_sets(const uint8_t* data, size_t size, std::vector<uint8_t>& out) const override {
+		return extract_h264_parameter_sets(data, size, out);
+	}
 };
-
@@ -0,0 +1,28 @@
+// H.265/HEVC -> YUV420P (I420) decoder using libavcodec/libswscale.
+#pragma once
+
+#include "lavc_decoder.h"
+
+// Understands hvcC config records and VPS/SPS/PPS (NAL types 32-34). Main10
+// output is converted to 8-bit I420 like everything else.
+class H265Decoder final : public LavcDecoder {
+public:
+	H265Decoder() : LavcDecoder(VideoCodec::H265) {}
+
+protected:
+	bool parse_config_record(const uint8_t* data, size_t size, std::vector<uint8_t>& out) const override {
+		return parse_hvcc_config(data, size, out);
+	}
+	bool is_parameter_sets_only(const uint8_t* data, size_t size) const override {
+		return is_h265_parameter_sets_only(data, size);
+	}
+	AccessUnitInfo scan_access_unit(const uint8_t* data, size_t size) const override {
+		return scan_h265_access_unit(data, size);
+	}
+	bool parse_sps_size(const uint8_t* data, size_t size, int& width, int& height) const override {
+		return parse_h265_sps_size(data, size, width, height);
+	}
+	bool extract_parameter_sets(const uint8_t* data, size_t size, std::vector<uint8_t>& out) const override {
+		return extract_h265_parameter_sets(data, size, out);
+	}
+};
@@ -0,0 +1,42 @@
+#include "latency_histogram.h"
+
+#include <algorithm>
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+	Snapshot s;
+	for (int i = 0; i < kBuckets; ++i) {
+		s.counts[i] = counts_[i].load(std::memory_order_relaxed);
+		s.count += s.counts[i];
+	}
+	s.sum_us = sum_us_.load(std::memory_order_relaxed);
+	return s;
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::Snapshot::since(const Snapshot& earlier) const {
+	Snapshot d;
+	for (int i = 0; i < kBuckets; ++i) {
+		d.counts[i] = counts[i] >= earlier.counts[i] ? counts[i] - earlier.counts[i] : counts[i];
+		d.count += d.counts[i];
+	}
+	d.sum_us = sum_us >= earlier.sum_us ? sum_us - earlier.sum_us : sum_us;
+	return d;
+}
+
+double LatencyHistogram::Snapshot::quantile(double q) const {
+	if (count == 0) return 0.0;
+	q = std::min(std::max(q, 0.0), 1.0);
+	const double rank = q * static_cast<double>(count);
+	uint64_t below = 0;
+	for (int i = 0; i < kBuckets; ++i) {
+		if (counts[i] == 0) continue;
+		if (static_cast<double>(below + counts[i]) >= rank) {
+			const double lo = i == 0 ? 0.0 : static_cast<double>(kBoundsUs[i - 1]);
+			if (i == kBuckets - 1) return lo;
+			const double hi = static_cast<double>(kBoundsUs[i]);
+			const double within = (rank - static_cast<double>(below)) / static_cast<double>(counts[i]);
+			return lo + (hi - lo) * std::max(within, 0.0);
+		}
+		below += counts[i];
+	}
+	return static_cast<double>(kBoundsUs[kBuckets - 2]);
+}
@@ -0,0 +1,42 @@
+// Lock-free latency histogram with fixed buckets, for quantiles in metrics.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+class LatencyHistogram {
+public:
+	static constexpr int kBuckets = 13; // the last one has no upper bound
+	// Upper bound (inclusive) of each bounded bucket.
+	static constexpr int64_t kBoundsUs[kBuckets - 1] = {500,   1000,  2000,   4000,   8000,   16000,
+														33000, 50000, 100000, 250000, 500000, 1000000};
+
+	// Any thread; a few relaxed atomic adds.
+	void record(int64_t us) {
+		if (us < 0) us = 0;
+		int i = 0;
+		while (i < kBuckets - 1 && us > kBoundsUs[i]) ++i;
+		counts_[i].fetch_add(1, std::memory_order_relaxed);
+		sum_us_.fetch_add(us, std::memory_order_relaxed);
+	}
+
+	struct Snapshot {
+		uint64_t counts[kBuckets] = {};
+		uint64_t count = 0;
+		int64_t sum_us = 0;
+
+		// What was recorded since `earlier`, a snapshot of the same histogram.
+		Snapshot since(const Snapshot& earlier) const;
+		// Estimated q-quantile (0..1) in microseconds, interpolated within its
+		// bucket; the unbounded bucket reports its lower bound. 0 when empty.
+		double quantile(double q) const;
+	};
+
+	// Counters are read one by one, so a concurrent record() may show up in
+	// count but not yet in sum; fine for monitoring.
+	Snapshot snapshot() const;
+
+private:
+	std::atomic<uint64_t> counts_[kBuckets] = {};
+	std::atomic<int64_t> sum_us_{0};
+};
@@ -0,0 +1,635 @@
+#include "lavc_decoder.h"
+#include "decode_recovery.h"
+#include "pipeline_config.h"
+#include "pipeline_stats.h"
+#include "../common/Log.hpp"
+#include "../common/MemoryResidency.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/imgutils.h>
+#include <libswscale/swscale.h>
+}
+
+static int64_t steady_now_us() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Row and plane alignment of the pooled frame buffers: enough for the
+// codec's SIMD and for GL to unpack rows without realigning them.
+static constexpr int kBufferAlign = 64;
+
+static int align_up(int value, int align) {
+	return (value + align - 1) / align * align;
+}
+
+// What the phones send. Full-range YUVJ420P still goes through swscale,
+// which rescales it to the limited range the renderers expect.
+static bool pooled_format(int format) {
+	return format == AV_PIX_FMT_YUV420P;
+}
+
+// Allocator for the frame buffer pools; counts what they hold in
+// pipeline_stats().decoder_pool_bytes. The buffers live as long as the
+// stream's resolution, so they get the residency policy (hugepages, mlock).
+// Generic because the size parameter is int before FFmpeg 5 and size_t since.
+static const auto pool_alloc = [](auto size) -> AVBufferRef* {
+	uint8_t* data = static_cast<uint8_t*>(oa_memory::alloc_buffer(static_cast<size_t>(size), kBufferAlign));
+	if (!data) return nullptr;
+	AVBufferRef* ref = av_buffer_create(
+		data, size,
+		[](void* opaque, uint8_t* bytes) {
+			pipeline_stats().decoder_pool_bytes.fetch_sub(reinterpret_cast<intptr_t>(opaque), std::memory_order_relaxed);
+			oa_memory::free_buffer(bytes);
+		},
+		reinterpret_cast<void*>(static_cast<intptr_t>(size)), 0);
+	if (!ref) {
+		oa_memory::free_buffer(data);
+		return nullptr;
+	}
+	pipeline_stats().decoder_pool_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+	return ref;
+};
+
+struct LavcDecoder::Impl {
+	const AVCodec* codec = nullptr;
+	AVCodecContext* ctx = nullptr;
+	AVFrame* frame = nullptr;
+	AVPacket* pkt = nullptr;
+	SwsContext* sws = nullptr;
+	std::mutex mutex;
+	int sws_w = 0;
+	int sws_h = 0;
+	AVPixelFormat sws_fmt = AV_PIX_FMT_NONE;
+	std::vector<uint8_t> config_annexb;
+	bool have_config = false;
+	bool injected_config = false;
+	int announced_w = 0; // from the newest SPS, before any frame decodes
+	int announced_h = 0;
+	// Numbers this decoder's packets and frames in log lines. Which lines get
+	// logged is decided per call site (OA_LOG_FIRST_N and friends), across
+	// all decoders.
+	std::atomic<uint64_t> packet_count{0};
+	std::atomic<uint64_t> frame_count{0};
+	DecodeRecovery recovery;
+	// recovery.recovering(), mirrored for readers that must not wait for a
+	// decode holding the mutex (metrics).
+	std::atomic<bool> recovering{false};
+	KeyframeRequestFn keyframe_request;
+	bool request_pending = false; // keyframe request to send once the lock is released
+	bool keyframes_only = false;  // set_keyframes_only(); survives reopening the context
+	// Buffers the codec decodes into (get_buffer2). A picture is lent out by
+	// reference and its buffer returns here when the last reference goes.
+	// Replaced when the picture size changes; the old pool is freed once its
+	// lent buffers come back.
+	AVBufferPool* pool = nullptr;
+	size_t pool_buffer_size = 0;
+
+	DecoderOptions options;
+
+	Impl(VideoCodec video_codec, const DecoderOptions& opts) : options(opts) {
+		codec = avcodec_find_decoder(video_codec == VideoCodec::H265 ? AV_CODEC_ID_HEVC : AV_CODEC_ID_H264);
+		if (!codec) throw std::runtime_error(std::string(codec_name(video_codec)) + " codec not found");
+		if (!open_context()) throw std::runtime_error("Failed to open codec");
+		frame = av_frame_alloc();
+		pkt = av_packet_alloc();
+		if (!frame || !pkt) throw std::runtime_error("Failed to alloc frame/pkt");
+	}
+
+	bool open_context() {
+		AVCodecContext* next = avcodec_alloc_context3(codec);
+		if (!next) return false;
+		next->thread_count = options.threads;
+		// Slice threads only: frame threading adds a frame of latency per thread.
+		next->thread_type = FF_THREAD_SLICE;
+		if (options.low_delay) next->flags |= AV_CODEC_FLAG_LOW_DELAY;
+		if (options.fast) next->flags2 |= AV_CODEC_FLAG2_FAST;
+		if (keyframes_only) next->skip_frame = AVDISCARD_NONKEY;
+		next->opaque = this;
+		if (codec->capabilities & AV_CODEC_CAP_DR1) next->get_buffer2 = &Impl::get_buffer;
+		if (avcodec_open2(next, codec, nullptr) < 0) {
+			avcodec_free_context(&next);
+			return false;
+		}
+		if (ctx) avcodec_free_context(&ctx);
+		ctx = next;
+		return true;
+	}
+
+	int sws_flags() const {
+		switch (options.scaler) {
+		case ScalerMode::FastBilinear: return SWS_FAST_BILINEAR;
+		case ScalerMode::Bicubic: return SWS_BICUBIC;
+		case ScalerMode::Point: return SWS_POINT;
+		case ScalerMode::Area: return SWS_AREA;
+		case ScalerMode::Bilinear: break;
+		}
+		return SWS_BILINEAR;
+	}
+
+	// (Re)create the scaler for `format` at width x height if it differs.
+	bool ensure_scaler(int width, int height, AVPixelFormat format) {
+		if (sws && sws_w == width && sws_h == height && sws_fmt == format) return true;
+		if (sws) sws_freeContext(sws);
+		sws = sws_getContext(width, height, format, width, height, AV_PIX_FMT_YUV420P, sws_flags(), nullptr, nullptr,
+							 nullptr);
+		sws_w = width;
+		sws_h = height;
+		sws_fmt = format;
+		OA_LOG(Info, "VideoDecoder", "Recreated SWS context for {}x{} fmt={}", width, height, static_cast<int>(format));
+		return sws != nullptr;
+	}
+
+	// AVCodecContext::get_buffer2 for 8-bit 4:2:0: one pooled buffer per
+	// picture holding all three planes, rows padded to kBufferAlign. Other
+	// formats get libavcodec's default buffers. Runs on the decoding thread
+	// with `mutex` held (slice threading never calls it from elsewhere).
+	static int get_buffer(AVCodecContext* ctx, AVFrame* frame, int flags) {
+		Impl* impl = static_cast<Impl*>(ctx->opaque);
+		if (!pooled_format(frame->format)) return avcodec_default_get_buffer2(ctx, frame, flags);
+		int w = frame->width;
+		int h = frame->height;
+		int align[AV_NUM_DATA_POINTERS];
+		avcodec_align_dimensions2(ctx, &w, &h, align);
+		const int y_stride = align_up(w, std::max(kBufferAlign, align[0]));
+		const int uv_stride = align_up((w + 1) / 2, std::max(kBufferAlign, align[1]));
+		const size_t y_size = static_cast<size_t>(y_stride) * h;
+		const size_t uv_size = static_cast<size_t>(uv_stride) * ((h + 1) / 2);
+		// The codec's SIMD may read a little past the last row.
+		const size_t size = y_size + uv_size * 2 + kBufferAlign;
+		if (!impl->pool || impl->pool_buffer_size != size) {
+			av_buffer_pool_uninit(&impl->pool);
+			impl->pool = av_buffer_pool_init(size, pool_alloc);
+			impl->pool_buffer_size = impl->pool ? size : 0;
+			if (!impl->pool) return AVERROR(ENOMEM);
+			OA_LOG(Info, "VideoDecoder", "Frame buffer pool for {}x{}: {} bytes per picture", frame->width,
+				   frame->height, size);
+		}
+		frame->buf[0] = av_buffer_pool_get(impl->pool);
+		if (!frame->buf[0]) return AVERROR(ENOMEM);
+		uint8_t* base = frame->buf[0]->data;
+		frame->data[0] = base;
+		frame->data[1] = base + y_size;
+		frame->data[2] = base + y_size + uv_size;
+		frame->linesize[0] = y_stride;
+		frame->linesize[1] = uv_stride;
+		frame->linesize[2] = uv_stride;
+		frame->extended_data = frame->data;
+		return 0;
+	}
+
+	// Hand the validated picture in `frame` out: by reference when it is in
+	// 8-bit 4:2:0 already, otherwise through swscale into `out_yuv` (or a
+	// buffer of its own when lending). Unrefs `frame`.
+	bool emit(SharedPicture* shared, std::vector<uint8_t>* out_yuv) {
+		AVFrame* f = frame;
+		const int width = f->width;
+		const int height = f->height;
+		if (pooled_format(f->format)) {
+			if (shared) {
+				AVFrame* ref = av_frame_alloc();
+				if (!ref) {
+					av_frame_unref(f);
+					return false;
+				}
+				av_frame_move_ref(ref, f);
+				for (int i = 0; i < 3; ++i) {
+					shared->planes.data[i] = ref->data[i];
+					shared->planes.stride[i] = ref->linesize[i];
+				}
+				shared->hold = std::shared_ptr<const void>(ref, [](const void* p) {
+					AVFrame* held = static_cast<AVFrame*>(const_cast<void*>(p));
+					av_frame_free(&held);
+				});
+			} else {
+				copy_planes(f, *out_yuv);
+				av_frame_unref(f);
+			}
+		} else {
+			std::shared_ptr<std::vector<uint8_t>> converted;
+			if (shared) {
+				converted = std::make_shared<std::vector<uint8_t>>();
+				out_yuv = converted.get();
+			}
+			if (!ensure_scaler(width, height, static_cast<AVPixelFormat>(f->format))) {
+				av_frame_unref(f);
+				return false;
+			}
+			const int y_size = width * height;
+			const int uv_w = (width + 1) / 2;
+			const int uv_size = uv_w * ((height + 1) / 2);
+			out_yuv->resize(y_size + uv_size * 2);
+			uint8_t* dst_data[4] = {
+				out_yuv->data(),                         // Y
+				out_yuv->data() + y_size,                // U
+				out_yuv->data() + y_size + uv_size,      // V
+				nullptr
+			};
+			int dst_linesize[4] = {width, uv_w, uv_w, 0};
+			sws_scale(sws, f->data, f->linesize, 0, height, dst_data, dst_linesize);
+			av_frame_unref(f);
+			if (shared) {
+				shared->planes = i420_packed_planes(converted->data(), width, height);
+				shared->hold = std::move(converted);
+			}
+		}
+		if (shared) {
+			shared->width = width;
+			shared->height = height;
+		}
+		return true;
+	}
+
+	// Pack the planes of 4:2:0 `f` into `out` as [Y][U][V].
+	static void copy_planes(const AVFrame* f, std::vector<uint8_t>& out) {
+		const int uv_w = (f->width + 1) / 2;
+		const int uv_h = (f->height + 1) / 2;
+		out.resize(static_cast<size_t>(f->width) * f->height + static_cast<size_t>(uv_w) * uv_h * 2);
+		uint8_t* dst = out.data();
+		const int widths[3] = {f->width, uv_w, uv_w};
+		const int heights[3] = {f->height, uv_h, uv_h};
+		for (int i = 0; i < 3; ++i) {
+			for (int row = 0; row < heights[i]; ++row, dst += widths[i]) {
+				std::memcpy(dst, f->data[i] + static_cast<size_t>(row) * f->linesize[i], widths[i]);
+			}
+		}
+	}
+
+	~Impl() {
+		if (sws) sws_freeContext(sws);
+		if (pkt) av_packet_free(&pkt);
+		if (frame) av_frame_free(&frame);
+		if (ctx) avcodec_free_context(&ctx);
+		// Pictures still lent out keep their buffers until released.
+		av_buffer_pool_uninit(&pool);
+	}
+
+	// Take the picture of the packet just sent and hand it out through
+	// emit(). The caller unrefs `frame` whatever the outcome. Caller holds
+	// mutex.
+	bool receive_picture(SharedPicture* shared, std::vector<uint8_t>* out_yuv, int& out_width, int& out_height) {
+		const int ret = avcodec_receive_frame(ctx, frame);
+		if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) return false;
+		if (ret < 0) {
+			enter_recovery("avcodec_receive_frame failed", ret);
+			return false;
+		}
+
+		AVFrame* f = frame;
+		if ((f->flags & AV_FRAME_FLAG_CORRUPT) || f->decode_error_flags) {
+			enter_recovery("corrupt frame", f->decode_error_flags);
+			return false;
+		}
+		out_width = f->width;
+		out_height = f->height;
+		if (out_width <= 0 || out_height <= 0) {
+			OA_LOG_RATE(Warn, 5, "VideoDecoder", "Invalid frame dimensions: {}x{}", out_width, out_height);
+			return false;
+		}
+		if (out_width > 8192 || out_height > 4320) {
+			OA_LOG_RATE(Warn, 5, "VideoDecoder", "Frame too large: {}x{}", out_width, out_height);
+			return false; // guard against corrupted sizes
+		}
+		if (!f->data[0] || !f->data[1] || !f->data[2]) {
+			OA_LOG_RATE(Warn, 5, "VideoDecoder", "Missing plane data");
+			return false;
+		}
+		if (f->linesize[0] <= 0 || f->linesize[1] <= 0 || f->linesize[2] <= 0) {
+			OA_LOG_RATE(Warn, 5, "VideoDecoder", "Invalid linesize");
+			return false;
+		}
+
+		if (!emit(shared, out_yuv)) return false;
+		const uint64_t count = frame_count.fetch_add(1, std::memory_order_relaxed) + 1;
+		OA_LOG_FIRST_N_EVERY(Info, 5, 60, "VideoDecoder", "Decoded frame {}x{} ({})", out_width, out_height, count);
+		const int64_t recovered_us = recovery.on_frame(steady_now_us());
+		publish_recovery();
+		if (recovered_us >= 0) {
+			PipelineStats& stats = pipeline_stats();
+			stats.decode_recoveries.fetch_add(1, std::memory_order_relaxed);
+			stats.last_recover_us.store(recovered_us, std::memory_order_relaxed);
+			OA_LOG(Info, "VideoDecoder", "Recovered after {} ms ({} packets discarded so far)",
+				recovered_us / 1000, recovery.stats().discarded);
+		}
+		return true;
+	}
+
+	// Leave the draining state entered by sending a null packet. Caller
+	// holds mutex.
+	void end_drain() {
+		avcodec_flush_buffers(ctx);
+		injected_config = false;
+	}
+
+	// Caller holds mutex, after changing `recovery`.
+	void publish_recovery() { recovering.store(recovery.recovering(), std::memory_order_relaxed); }
+
+	// Caller holds mutex.
+	void enter_recovery(const char* reason, int code) {
+		const bool was_recovering = recovery.recovering();
+		const int64_t now_us = steady_now_us();
+		avcodec_flush_buffers(ctx);
+		recovery.on_error(now_us);
+		publish_recovery();
+		if (recovery.keyframe_request_due(now_us)) request_pending = true;
+		if (!was_recovering) {
+			OA_LOG_RATE(Warn, 5, "VideoDecoder", "{} ({}); holding last frame until next IDR", reason, code);
+		}
+	}
+};
+
+LavcDecoder::LavcDecoder(VideoCodec codec) : codec_(codec), impl_(new Impl(codec, pipeline_config().decoder)) {}
+LavcDecoder::~LavcDecoder() { delete impl_; }
+
+bool LavcDecoder::set_options(const DecoderOptions& options) {
+	std::lock_guard<std::mutex> lock(impl_->mutex);
+	const DecoderOptions previous = impl_->options;
+	if (options == previous) return true;
+	impl_->options = options;
+	if (options.scaler != previous.scaler && impl_->sws) {
+		sws_freeContext(impl_->sws);
+		impl_->sws = nullptr;
+	}
+	if (options.threads == previous.threads && options.low_delay == previous.low_delay && options.fast == previous.fast) {
+		return true;
+	}
+	if (!impl_->open_context()) {
+		impl_->options = previous;
+		OA_LOG(Warn, "VideoDecoder", "Reopening decoder with threads={} failed; keeping previous settings", options.threads);
+		return false;
+	}
+	// The new context has no reference pictures or parameter sets.
+	impl_->recovery.resync(steady_now_us());
+	impl_->publish_recovery();
+	impl_->injected_config = false;
+	OA_LOG(Info, "VideoDecoder", "Reopened decoder threads={} low_delay={} fast={}; waiting for IDR",
+		options.threads, options.low_delay, options.fast);
+	return true;
+}
+
+void LavcDecoder::set_keyframe_request(KeyframeRequestFn fn) {
+	std::lock_guard<std::mutex> lock(impl_->mutex);
+	impl_->keyframe_request = std::move(fn);
+}
+
+bool LavcDecoder::recovering() const {
+	return impl_->recovering.load(std::memory_order_relaxed);
+}
+
+void LavcDecoder::reset_session() {
+	std::lock_guard<std::mutex> lock(impl_->mutex);
+	avcodec_flush_buffers(impl_->ctx);
+	impl_->recovery.resync(steady_now_us());
+	impl_->publish_recovery();
+	impl_->injected_config = false;
+	OA_LOG(Info, "VideoDecoder", "New session; waiting for IDR ({} bytes of parameter sets kept)",
+		impl_->config_annexb.size());
+}
+
+void LavcDecoder::skip_to_keyframe() {
+	{
+		std::lock_guard<std::mutex> lock(impl_->mutex);
+		const int64_t now_us = steady_now_us();
+		avcodec_flush_buffers(impl_->ctx);
+		impl_->recovery.on_error(now_us);
+		impl_->publish_recovery();
+		if (impl_->recovery.keyframe_request_due(now_us)) impl_->request_pending = true;
+	}
+	OA_LOG_RATE(Warn, 5, "VideoDecoder", "Packets dropped before decode; holding last frame until next IDR");
+	flush_keyframe_request();
+}
+
+void LavcDecoder::set_keyframes_only(bool enable) {
+	std::lock_guard<std::mutex> lock(impl_->mutex);
+	if (impl_->keyframes_only == enable) return;
+	impl_->keyframes_only = enable;
+	impl_->ctx->skip_frame = enable ? AVDISCARD_NONKEY : AVDISCARD_DEFAULT;
+	if (!enable) {
+		// The next pictures reference ones that were skipped; start over at
+		// an IDR, requesting one as the first non-IDR packet is dropped.
+		avcodec_flush_buffers(impl_->ctx);
+		impl_->recovery.resync(steady_now_us());
+		impl_->publish_recovery();
+		impl_->injected_config = false;
+	}
+	OA_LOG(Info, "VideoDecoder", "{}", enable ? "Decoding keyframes only" : "Decoding all frames; waiting for IDR");
+}
+
+bool LavcDecoder::announced_size(int& width, int& height) const {
+	std::lock_guard<std::mutex> lock(impl_->mutex);
+	if (impl_->announced_w <= 0 || impl_->announced_h <= 0) return false;
+	width = impl_->announced_w;
+	height = impl_->announced_h;
+	return true;
+}
+
+void LavcDecoder::store_parameter_sets(std::vector<uint8_t> annexb) {
+	Impl* impl = impl_;
+	int width = 0, height = 0;
+	if (parse_sps_size(annexb.data(), annexb.size(), width, height) && width <= 8192 && height <= 4320 &&
+		(width != impl->announced_w || height != impl->announced_h)) {
+		impl->announced_w = width;
+		impl->announced_h = height;
+		// 8-bit 4:2:0 is what the phones send; a different format just
+		// recreates the scaler on the first frame.
+		if (!impl->sws) impl->ensure_scaler(width, height, AV_PIX_FMT_YUV420P);
+		OA_LOG(Info, "VideoDecoder", "SPS announces {}x{}", width, height);
+	}
+	impl->config_annexb = std::move(annexb);
+	impl->have_config = true;
+}
+
+bool LavcDecoder::decode_to_yuv420p(const uint8_t* data,
+									size_t size,
+									std::vector<uint8_t>& out_yuv,
+									int& out_width,
+									int& out_height) {
+	const bool ok = decode_packet(data, size, nullptr, &out_yuv, out_width, out_height);
+	flush_keyframe_request();
+	return ok;
+}
+
+bool LavcDecoder::decode_shared(const uint8_t* data, size_t size, SharedPicture& out) {
+	int width = 0, height = 0;
+	const bool ok = decode_packet(data, size, &out, nullptr, width, height);
+	flush_keyframe_request();
+	return ok;
+}
+
+void LavcDecoder::flush_keyframe_request() {
+	KeyframeRequestFn request;
+	{
+		std::lock_guard<std::mutex> lock(impl_->mutex);
+		if (impl_->request_pending) {
+			impl_->request_pending = false;
+			request = impl_->keyframe_request;
+		}
+	}
+	if (request) {
+		pipeline_stats().keyframe_requests.fetch_add(1, std::memory_order_relaxed);
+		request();
+	}
+}
+
+bool LavcDecoder::decode_packet(const uint8_t* data,
+								size_t size,
+								SharedPicture* shared,
+								std::vector<uint8_t>* out_yuv,
+								int& out_width,
+								int& out_height) {
+	if (!data || size == 0) {
+		OA_LOG_RATE(Warn, 5, "VideoDecoder", "Reject packet: empty input");
+		return false;
+	}
+	if (size < 5 || size > 4 * 1024 * 1024) {
+		OA_LOG_RATE(Warn, 5, "VideoDecoder", "Reject packet: size={}", size);
+		return false; // guard malformed payloads
+	}
+	const uint64_t pkt_log_id = impl_->packet_count.fetch_add(1, std::memory_order_relaxed) + 1;
+	OA_LOG_FIRST_N(Info, 10, "VideoDecoder", "Packet {} size={} startCode={} head={}",
+		pkt_log_id, size,
+		(size >= 4 && data[0] == 0 && data[1] == 0 && ((data[2] == 0 && data[3] == 1) || data[2] == 1)) ? "yes" : "no",
+		oa_log::hex(data, size, 32));
+	bool has_start_code = (size >= 4 && data[0] == 0 && data[1] == 0 && ((data[2] == 0 && data[3] == 1) || data[2] == 1));
+	std::vector<uint8_t> avcc_to_annexb;
+	const uint8_t* payload = data;
+	size_t payload_size = size;
+	if (!has_start_code) {
+		// Treat a small timestamp-0 codec config (avcC/hvcC) specially: stash the parameter sets and skip decode
+		std::vector<uint8_t> config;
+		if (parse_config_record(data, size, config)) {
+			std::lock_guard<std::mutex> lock(impl_->mutex);
+			store_parameter_sets(std::move(config));
+			impl_->injected_config = false;
+			OA_LOG(Info, "VideoDecoder", "Stored {} configuration record ({} bytes) head={}", codec_name(codec_), size,
+				oa_log::hex(data, size, 32));
+			return false;
+		}
+
+		// Handle 4-byte length-prefixed (AVCC/HVCC) access units by converting to Annex-B start codes
+		size_t offset = 0;
+		avcc_to_annexb.clear();
+		while (offset + 4 <= size) {
+			uint32_t nal_len = (static_cast<uint32_t>(data[offset]) << 24) |
+							(static_cast<uint32_t>(data[offset + 1]) << 16) |
+							(static_cast<uint32_t>(data[offset + 2]) << 8) |
+							(static_cast<uint32_t>(data[offset + 3]));
+			offset += 4;
+			if (nal_len == 0 || offset + nal_len > size) {
+				OA_LOG_RATE(Warn, 5, "VideoDecoder", "Reject packet: invalid NAL length at offset={} len={} size={}",
+					offset - 4, nal_len, size);
+				return false;
+			}
+			avcc_to_annexb.insert(avcc_to_annexb.end(), {0x00, 0x00, 0x00, 0x01});
+			avcc_to_annexb.insert(avcc_to_annexb.end(), data + offset, data + offset + nal_len);
+			offset += nal_len;
+		}
+		if (offset != size) {
+			OA_LOG_RATE(Warn, 5, "VideoDecoder", "Reject packet: trailing bytes after length-prefixed parse offset={} size={}", offset, size);
+			return false;
+		}
+		if (avcc_to_annexb.empty()) {
+			OA_LOG_RATE(Warn, 5, "VideoDecoder", "Reject packet: missing Annex B start code and length-prefixed conversion failed");
+			return false;
+		}
+		payload = avcc_to_annexb.data();
+		payload_size = avcc_to_annexb.size();
+	} else {
+		// If Annex-B and contains only parameter sets, treat as configuration and skip decode
+		if (is_parameter_sets_only(payload, payload_size)) {
+			std::lock_guard<std::mutex> lock(impl_->mutex);
+			store_parameter_sets(std::vector<uint8_t>(payload, payload + payload_size));
+			impl_->injected_config = false;
+			OA_LOG(Info, "VideoDecoder", "Stored {} Annex-B parameter sets ({} bytes) head={}", codec_name(codec_), payload_size,
+				oa_log::hex(payload, payload_size, 32));
+			return false;
+		}
+	}
+	auto* impl = impl_;
+	std::lock_guard<std::mutex> lock(impl->mutex);
+
+	// Gate on the recovery state: while waiting for an IDR, references to
+	// lost pictures would only produce smeared output.
+	const int64_t now_us = steady_now_us();
+	const AccessUnitInfo au = scan_access_unit(payload, payload_size);
+	// Keyframes-only mode: nothing else would be output, so do not even
+	// copy it into a packet.
+	if (impl->keyframes_only && !au.intra) return false;
+	const bool resync = impl->recovery.awaiting_keyframe();
+	if (!impl->recovery.admit(au, now_us)) {
+		if (impl->recovery.keyframe_request_due(now_us)) impl->request_pending = true;
+		pipeline_stats().frames_discarded.fetch_add(1, std::memory_order_relaxed);
+		OA_LOG_RATE(Debug, 1, "VideoDecoder", "Discarding non-IDR packet while recovering");
+		return false;
+	}
+	if (resync) {
+		// The flush dropped the decoder's parameter sets; re-send ours unless
+		// the keyframe carries its own.
+		if (!au.parameter_sets) impl->injected_config = false;
+		OA_LOG(Info, "VideoDecoder", "Resyncing on {} ({} bytes)", au.idr ? "IDR" : "intra picture", payload_size);
+	}
+	if (au.parameter_sets) {
+		// Keep in-band parameter sets too: after a reconnect they are re-sent
+		// in front of a keyframe that might not repeat them.
+		std::vector<uint8_t> sets;
+		if (extract_parameter_sets(payload, payload_size, sets) && sets != impl->config_annexb) {
+			store_parameter_sets(std::move(sets));
+		}
+		impl->injected_config = true; // this access unit carries its own
+	}
+
+	av_packet_unref(impl->pkt);
+	// Prepend stored parameter sets once before first decode if we saw an AVC config packet
+	std::vector<uint8_t> with_config;
+	const uint8_t* final_payload = payload;
+	size_t final_size = payload_size;
+	if (impl->have_config && !impl->injected_config) {
+		with_config.reserve(impl->config_annexb.size() + payload_size);
+		with_config.insert(with_config.end(), impl->config_annexb.begin(), impl->config_annexb.end());
+		with_config.insert(with_config.end(), payload, payload + payload_size);
+		final_payload = with_config.data();
+		final_size = with_config.size();
+		impl->injected_config = true;
+		OA_LOG(Info, "VideoDecoder", "Injected stored parameter sets ({} bytes)", impl->config_annexb.size());
+	}
+	if (av_new_packet(impl->pkt, static_cast<int>(final_size)) < 0) {
+		OA_LOG_RATE(Error, 5, "VideoDecoder", "Failed to allocate packet of size {}", final_size);
+		return false;
+	}
+	std::memcpy(impl->pkt->data, final_payload, final_size);
+
+	int ret = avcodec_send_packet(impl->ctx, impl->pkt);
+	if (ret < 0) {
+		impl->enter_recovery("avcodec_send_packet failed", ret);
+		return false;
+	}
+	// Keyframes only: no later packet will push this picture out of the
+	// reorder queue, so drain now and flush once it is out. Each keyframe
+	// decodes on its own anyway.
+	const bool drain = impl->keyframes_only;
+	if (drain) {
+		ret = avcodec_send_packet(impl->ctx, nullptr);
+		if (ret < 0) {
+			impl->enter_recovery("avcodec_send_packet(drain) failed", ret);
+			return false;
+		}
+	}
+	// Every exit from here leaves the frame unreferenced and, when draining,
+	// the codec out of EOF: otherwise the next keyframe would be refused.
+	const bool ok = impl->receive_picture(shared, out_yuv, out_width, out_height);
+	av_frame_unref(impl->frame);
+	if (drain) impl->end_drain();
+	return ok;
+}
+
@@ -0,0 +1,61 @@
+// libavcodec/libswscale decoder shared by the H.264 and H.265 decoders.
+#pragma once
+
+#include "bitstream.h"
+#include "video_decoder.h"
+
+// Owns the codec context, swscale, parameter-set storage, error recovery and
+// the pool the codec decodes into.
+// Subclasses only describe their bitstream: how a config record and a
+// parameter-set-only payload look, and what an access unit carries.
+class LavcDecoder : public VideoDecoder {
+public:
+	~LavcDecoder() override;
+
+	VideoCodec codec() const override { return codec_; }
+	bool set_options(const DecoderOptions& options) override;
+	bool decode_to_yuv420p(const uint8_t* data,
+						   size_t size,
+						   std::vector<uint8_t>& out_yuv,
+						   int& out_width,
+						   int& out_height) override;
+	void set_keyframe_request(KeyframeRequestFn fn) override;
+	bool recovering() const override;
+	void reset_session() override;
+	void skip_to_keyframe() override;
+	void set_keyframes_only(bool enable) override;
+	bool announced_size(int& width, int& height) const override;
+	// Pictures stay in the codec's pooled frame buffers and are lent out.
+	bool shares_output() const override { return true; }
+	bool decode_shared(const uint8_t* data, size_t size, SharedPicture& out) override;
+
+protected:
+	// Starts with pipeline_config().decoder.
+	explicit LavcDecoder(VideoCodec codec);
+
+	// Convert an out-of-band config record to Annex-B parameter sets.
+	virtual bool parse_config_record(const uint8_t* data, size_t size, std::vector<uint8_t>& out) const = 0;
+	virtual bool is_parameter_sets_only(const uint8_t* data, size_t size) const = 0;
+	virtual AccessUnitInfo scan_access_unit(const uint8_t* data, size_t size) const = 0;
+	virtual bool parse_sps_size(const uint8_t* data, size_t size, int& width, int& height) const = 0;
+	virtual bool extract_parameter_sets(const uint8_t* data, size_t size, std::vector<uint8_t>& out) const = 0;
+
+private:
+	// Keep `annexb` as the parameter sets to inject, and size ahead from its
+	// SPS. Caller holds the decoder mutex.
+	void store_parameter_sets(std::vector<uint8_t> annexb);
+	// Decode one access unit. The picture is lent out through `shared` when
+	// set, else converted into `out_yuv`.
+	bool decode_packet(const uint8_t* data,
+					   size_t size,
+					   SharedPicture* shared,
+					   std::vector<uint8_t>* out_yuv,
+					   int& out_width,
+					   int& out_height);
+	// Send a keyframe request queued while the decoder mutex was held.
+	void flush_keyframe_request();
+
+	const VideoCodec codec_;
+	struct Impl;
+	Impl* impl_;
+};
@@ -0,0 +1,284 @@
+#include "metrics_server.h"
+#include "../common/Log.hpp"
+#include "../common/ThreadPolicy.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr double kQuantiles[] = {0.5, 0.9, 0.99};
+constexpr int kRequestWaitMs = 100;
+constexpr int kDefaultNice = 10;
+
+struct Registry {
+	std::mutex mutex; // held for a whole scrape
+	int next_id = 1;
+	std::map<int, MetricsCollector> collectors;
+	std::map<std::string, LatencyHistogram::Snapshot> previous;
+};
+
+Registry& registry() {
+	static Registry r;
+	return r;
+}
+
+int64_t steady_now_ms() {
+	using namespace std::chrono;
+	return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+std::string format_value(double v) {
+	if (std::isnan(v)) return "NaN";
+	if (std::isinf(v)) return v > 0 ? "+Inf" : "-Inf";
+	char buf[32];
+	if (v == std::floor(v) && std::fabs(v) < 1e15) {
+		std::snprintf(buf, sizeof(buf), "%.0f", v);
+	} else {
+		std::snprintf(buf, sizeof(buf), "%.9g", v);
+	}
+	return buf;
+}
+
+std::string format_labels(const MetricsWriter::Labels& labels, const char* extra_key = nullptr,
+						  const std::string& extra_value = {}) {
+	if (labels.empty() && !extra_key) return {};
+	std::string out = "{";
+	auto append = [&out](const std::string& key, const std::string& value) {
+		if (out.size() > 1) out += ',';
+		out += key;
+		out += "=\"";
+		for (char c : value) {
+			if (c == '\\' || c == '"') {
+				out += '\\';
+				out += c;
+			} else if (c == '\n') {
+				out += "\\n";
+			} else {
+				out += c;
+			}
+		}
+		out += '"';
+	};
+	for (const auto& label : labels) append(label.first, label.second);
+	if (extra_key) append(extra_key, extra_value);
+	out += '}';
+	return out;
+}
+
+bool send_all(int fd, const char* data, size_t size) {
+	while (size > 0) {
+		const ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) return false;
+		data += n;
+		size -= static_cast<size_t>(n);
+	}
+	return true;
+}
+
+} // namespace
+
+MetricsWriter::Family& MetricsWriter::family(const char* name, const char* help, const char* type) {
+	for (auto& f : families_) {
+		if (f.name == name) return f;
+	}
+	families_.push_back(Family{name, help, type, {}});
+	return families_.back();
+}
+
+void MetricsWriter::counter(const char* name, const char* help, uint64_t value, const Labels& labels) {
+	family(name, help, "counter").samples.push_back(name + format_labels(labels) + " " + std::to_string(value));
+}
+
+void MetricsWriter::gauge(const char* name, const char* help, double value, const Labels& labels) {
+	family(name, help, "gauge").samples.push_back(name + format_labels(labels) + " " + format_value(value));
+}
+
+void MetricsWriter::latency(const char* name, const char* help, const LatencyHistogram& histogram,
+							const Labels& labels) {
+	const LatencyHistogram::Snapshot now = histogram.snapshot();
+	LatencyHistogram::Snapshot window = now;
+	if (previous_) {
+		const std::string key = name + format_labels(labels);
+		auto it = previous_->find(key);
+		if (it != previous_->end()) window = now.since(it->second);
+		(*previous_)[key] = now;
+	}
+	Family& f = family(name, help, "summary");
+	for (double q : kQuantiles) {
+		char quantile[16];
+		std::snprintf(quantile, sizeof(quantile), "%g", q);
+		const double value = window.count ? window.quantile(q) / 1e6 : NAN;
+		f.samples.push_back(name + format_labels(labels, "quantile", quantile) + " " + format_value(value));
+	}
+	const std::string suffix = format_labels(labels);
+	f.samples.push_back(std::string(name) + "_sum" + suffix + " " + format_value(static_cast<double>(now.sum_us) / 1e6));
+	f.samples.push_back(std::string(name) + "_count" + suffix + " " + std::to_string(now.count));
+}
+
+std::string MetricsWriter::text() const {
+	std::string out;
+	for (const auto& f : families_) {
+		out += "# HELP " + f.name + " " + f.help + "\n";
+		out += "# TYPE " + f.name + " " + f.type + "\n";
+		for (const auto& sample : f.samples) {
+			out += sample;
+			out += '\n';
+		}
+	}
+	return out;
+}
+
+int add_metrics_collector(MetricsCollector collector) {
+	Registry& r = registry();
+	std::lock_guard<std::mutex> lk(r.mutex);
+	const int id = r.next_id++;
+	r.collectors[id] = std::move(collector);
+	return id;
+}
+
+void remove_metrics_collector(int id) {
+	Registry& r = registry();
+	MetricsCollector dropped;
+	{
+		std::lock_guard<std::mutex> lk(r.mutex);
+		auto it = r.collectors.find(id);
+		if (it == r.collectors.end()) return;
+		dropped = std::move(it->second);
+		r.collectors.erase(it);
+	}
+	// `dropped` (and what it captured) goes here, outside the lock.
+}
+
+std::string render_metrics() {
+	Registry& r = registry();
+	std::lock_guard<std::mutex> lk(r.mutex);
+	MetricsWriter writer(&r.previous);
+	for (auto& entry : r.collectors) entry.second(writer);
+	return writer.text();
+}
+
+MetricsServer::~MetricsServer() {
+	stop();
+}
+
+bool MetricsServer::start(const std::string& path) {
+	if (running()) return false;
+	sockaddr_un addr{};
+	if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+		OA_LOG(Error, "Metrics", "socket path '{}' is empty or too long", path);
+		return false;
+	}
+	addr.sun_family = AF_UNIX;
+	std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+	struct stat st;
+	if (lstat(path.c_str(), &st) == 0) {
+		if (!S_ISSOCK(st.st_mode)) {
+			OA_LOG(Error, "Metrics", "{} exists and is not a socket", path);
+			return false;
+		}
+		unlink(path.c_str()); // left behind by an earlier run
+	}
+	listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (listen_fd_ < 0 || wake_fd_ < 0 || bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+		listen(listen_fd_, 4) != 0) {
+		OA_LOG(Error, "Metrics", "cannot listen on {}: {}", path, std::strerror(errno));
+		if (listen_fd_ >= 0) close(listen_fd_);
+		if (wake_fd_ >= 0) close(wake_fd_);
+		listen_fd_ = wake_fd_ = -1;
+		return false;
+	}
+	chmod(path.c_str(), 0660);
+	path_ = path;
+	thread_ = std::thread([this]() { run(); });
+	OA_LOG(Info, "Metrics", "serving on {}", path);
+	return true;
+}
+
+void MetricsServer::stop() {
+	if (!running()) return;
+	const uint64_t one = 1;
+	(void)write(wake_fd_, &one, sizeof(one));
+	thread_.join();
+	close(listen_fd_);
+	close(wake_fd_);
+	listen_fd_ = wake_fd_ = -1;
+	unlink(path_.c_str());
+}
+
+void MetricsServer::run() {
+	oa_thread::refresh(oa_thread::Role::Metrics, "oa-metrics");
+	const oa_thread::Policy policy = oa_thread::policy(oa_thread::Role::Metrics);
+	if (policy.cpus.empty() && policy.sched == oa_thread::Sched::Other && !policy.has_nice) {
+		oa_thread::Policy low;
+		low.nice = kDefaultNice;
+		low.has_nice = true;
+		oa_thread::apply_current(low);
+	}
+	for (;;) {
+		oa_thread::refresh(oa_thread::Role::Metrics, "oa-metrics");
+		pollfd fds[2] = {{listen_fd_, POLLIN, 0}, {wake_fd_, POLLIN, 0}};
+		if (poll(fds, 2, 1000) < 0 && errno != EINTR) {
+			OA_LOG(Error, "Metrics", "poll failed: {}", std::strerror(errno));
+			return;
+		}
+		if (fds[1].revents) return;
+		if (!(fds[0].revents & POLLIN)) continue;
+		const int client = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+		if (client < 0) continue;
+		serve(client);
+		close(client);
+	}
+}
+
+void MetricsServer::serve(int client) {
+	const timeval send_timeout{1, 0};
+	setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout));
+
+	// Read the request head, if the client sends one.
+	std::string request;
+	const int64_t deadline = steady_now_ms() + kRequestWaitMs;
+	while (request.find("\r\n\r\n") == std::string::npos && request.size() < 4096) {
+		const int64_t left = deadline - steady_now_ms();
+		pollfd pfd{client, POLLIN, 0};
+		if (left <= 0 || poll(&pfd, 1, static_cast<int>(left)) <= 0) break;
+		char buf[1024];
+		const ssize_t n = recv(client, buf, sizeof(buf), 0);
+		if (n <= 0) break;
+		request.append(buf, static_cast<size_t>(n));
+	}
+
+	const bool http = request.compare(0, 4, "GET ") == 0 || request.compare(0, 5, "HEAD ") == 0;
+	if (http) {
+		const size_t begin = request.find(' ') + 1;
+		const std::string target = request.substr(begin, request.find(' ', begin) - begin);
+		if (target != "/metrics" && target != "/") {
+			const std::string head = "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+			send_all(client, head.data(), head.size());
+			return;
+		}
+	}
+	const std::string body = render_metrics();
+	scrapes_.fetch_add(1, std::memory_order_relaxed);
+	if (!http) {
+		send_all(client, body.data(), body.size());
+		return;
+	}
+	const std::string head = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+							 "Content-Length: " +
+							 std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n";
+	if (send_all(client, head.data(), head.size()) && request[0] == 'G') send_all(client, body.data(), body.size());
+}
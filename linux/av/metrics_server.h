@@ -0,0 +1,90 @@
+// Prometheus text-format metrics served on a UNIX domain socket.
+#pragma once
+
+#include "latency_histogram.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Collects one scrape. Samples of the same metric are grouped under a single
+// HELP/TYPE header however many collectors add to it.
+class MetricsWriter {
+public:
+	using Labels = std::vector<std::pair<std::string, std::string>>;
+
+	// `previous` holds each latency series' snapshot from the last scrape.
+	explicit MetricsWriter(std::map<std::string, LatencyHistogram::Snapshot>* previous = nullptr)
+		: previous_(previous) {}
+
+	void counter(const char* name, const char* help, uint64_t value, const Labels& labels = {});
+	void gauge(const char* name, const char* help, double value, const Labels& labels = {});
+	// A summary in seconds. The quantiles cover what was recorded since the
+	// previous scrape (NaN if nothing was); _sum and _count are totals.
+	void latency(const char* name, const char* help, const LatencyHistogram& histogram, const Labels& labels = {});
+
+	std::string text() const;
+
+private:
+	struct Family {
+		std::string name;
+		std::string help;
+		const char* type;
+		std::vector<std::string> samples;
+	};
+
+	Family& family(const char* name, const char* help, const char* type);
+
+	std::map<std::string, LatencyHistogram::Snapshot>* previous_;
+	std::vector<Family> families_;
+};
+
+// Collectors add samples to every scrape. They run on the metrics thread and
+// must only read atomics (or locks no hot path takes). add/remove may be
+// called from any thread except from inside a collector; remove waits for a
+// scrape in progress, so a collector may capture an object its owner removes
+// it before destroying.
+using MetricsCollector = std::function<void(MetricsWriter&)>;
+int add_metrics_collector(MetricsCollector collector);
+void remove_metrics_collector(int id);
+
+// One scrape of all collectors.
+std::string render_metrics();
+
+// Serves render_metrics() to each client of a UNIX stream socket. A client
+// that sends an HTTP request (curl --unix-socket, most scrape agents) gets an
+// HTTP/1.0 response; one that sends nothing within 100 ms gets the bare text.
+// Runs on its own thread at nice 10 unless the "metrics" thread policy says
+// otherwise.
+class MetricsServer {
+public:
+	MetricsServer() = default;
+	~MetricsServer();
+
+	MetricsServer(const MetricsServer&) = delete;
+	MetricsServer& operator=(const MetricsServer&) = delete;
+
+	// Binds `path` (replacing a stale socket file), mode 0660, and starts the
+	// thread. False if it is already running or the socket cannot be bound.
+	bool start(const std::string& path);
+	// Stops the thread and removes the socket file.
+	void stop();
+	bool running() const { return thread_.joinable(); }
+	const std::string& path() const { return path_; }
+	uint64_t scrapes() const { return scrapes_.load(std::memory_order_relaxed); }
+
+private:
+	void run();
+	void serve(int client);
+
+	std::string path_;
+	int listen_fd_ = -1;
+	int wake_fd_ = -1; // eventfd, signalled by stop()
+	std::thread thread_;
+	std::atomic<uint64_t> scrapes_{0};
+};
@@ -1,45 +1,86 @@
 #include "oa_video_texture.h"
+#include "display_sizes.h"
+#include "gl_program_cache.h"
+#include "gl_resources.h"
+#include "startup_timeline.h"
+#include "video_crop.h"
+#include "yuv_convert.h"
+#include "../common/Log.hpp"
 
 #include <epoxy/gl.h>
 #include <flutter_linux/flutter_linux.h>
 #include <atomic>
-#include <iostream>
 #include <string.h>
+#include <algorithm>
+#include <chrono>
 #include <cstdlib>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
+
+
+// Frame data and GL objects shared by every texture in a fan-out group.
+// Flutter populates all textures on its raster thread with one context, so
+// the GL names can be shared: each new frame is uploaded and converted once,
+// by whichever texture is populated first.
+struct OAVideoSurface {
+	std::mutex mutex; // protects the pending frame fields
+
+	int width = 0;
+	int height = 0;
+	std::vector<guint8> pixels; // RGBA8 buffer (width*height*4)
+	std::vector<guint8> yuv;    // YUV420P packed buffer: [Y][U][V]
+	bool has_yuv = false;
+	// Planes of the current YUV frame: into `yuv`, or into a frame lent by
+	// set_yuv420p_planes, which yuv_release hands back once it is replaced.
+	const guint8* planes[3] = {};
+	int strides[3] = {};
+	GDestroyNotify yuv_release = nullptr;
+	gpointer yuv_release_data = nullptr;
+	uint64_t generation = 0;    // bumped for every frame set
+	// Set on the raster thread once the shader path has failed for good; the
+	// stream then supplies CPU-converted RGBA frames instead of YUV.
+	std::atomic<bool> cpu_fallback{false};
+	// Picture size announced ahead of the first frame (SPS); the plane
+	// textures are allocated at that size on the next populate.
+	int prepare_w = 0;
+	int prepare_h = 0;
+	// On-screen size reported per texture of the group; conversion renders
+	// at the largest so no view is upscaled.
+	DisplaySizes display_sizes;
+	// Region of the decoded picture to show; empty shows all of it. Only
+	// this window is uploaded and converted.
+	VideoCrop crop;
+
+	// Raster thread only.
+	uint64_t rendered_generation = 0; // frame currently in gl_tex
+	int rendered_w = 0;
+	int rendered_h = 0;
+	GLuint gl_tex = 0;                      // converted RGBA texture handed to Flutter
+	int alloc_w = 0, alloc_h = 0;           // gl_tex storage size
+	GLuint y_tex = 0, u_tex = 0, v_tex = 0; // plane textures
+	int plane_w = 0, plane_h = 0;           // Y plane storage size; updates use glTexSubImage2D
+	std::vector<guint8> crop_scratch;       // cropped rows when GL cannot unpack a sub-rectangle
+	int gpu_failures = 0;                   // consecutive failed YUV draws
+	bool profile_known = false;
+	bool is_es = false;
+	float glsl_version = 0.0f;
 
+	~OAVideoSurface() {
+		if (yuv_release) yuv_release(yuv_release_data);
+		// Usually no context is current here; the textures are pooled for the
+		// next surface or deleted on the next populate.
+		for (GLuint tex : {gl_tex, y_tex, u_tex, v_tex}) gl_resources().release_texture(tex);
+	}
+};
 
 struct _OAVideoTexture {
 	FlTextureGL parent_instance;
 
-	GLuint gl_tex = 0;        // GL texture name
-	int* width = nullptr;
-	int* height = nullptr;
-
-	// Optional RGBA buffer path
-	GByteArray* pixels = nullptr; // RGBA8 buffer (width*height*4)
-
-	// Optional YUV420P packed buffer: [Y][U][V]
-	GByteArray* yuv = nullptr;
-	gboolean has_yuv = FALSE;
-
-	// GL resources for YUV->RGBA conversion
-	GLuint y_tex = 0, u_tex = 0, v_tex = 0; // plane textures
-	GLuint fbo = 0;                         // framebuffer to render into gl_tex
-	GLuint program = 0;                     // YUV->RGBA shader program
-	GLuint vbo = 0;                         // full-screen quad VBO
-	GLint loc_aPos = -1, loc_aTex = -1;
-	GLint loc_texY = -1, loc_texU = -1, loc_texV = -1;
+	std::shared_ptr<OAVideoSurface> surface;
 	int64_t registered_id = 0;    // Flutter texture id once registered
-
-	std::mutex mutex; // protects pixels/width/height
-
-	// (no debug fields)
-};
-
-struct _OAVideoTextureClass {
-	FlTextureGLClass parent_class;
 };
 
 G_DEFINE_TYPE(OAVideoTexture, oa_video_texture, fl_texture_gl_get_type())
@@ -53,7 +94,7 @@ static GLuint compile_shader(GLenum type, const char* src) {
 		char log[512];
 		GLsizei len = 0;
 		glGetShaderInfoLog(s, sizeof(log) - 1, &len, log);
-		std::cerr << "[OAVideoTexture][GL] shader compile failed: " << std::string(log, (size_t)len) << std::endl;
+		OA_LOG(Error, "OAVideoTexture", "GL shader compile failed: {}", std::string(log, (size_t)len));
 		glDeleteShader(s);
 		return 0;
 	}
@@ -80,64 +121,125 @@ static bool log_gl_errors(const char* stage) {
 	GLenum err = GL_NO_ERROR;
 	while ((err = glGetError()) != GL_NO_ERROR) {
 		had_error = true;
-		std::cerr << "[OAVideoTexture][GL] error 0x" << std::hex << err << std::dec << " at " << stage << std::endl;
+		OA_LOG_RATE(Error, 5, "OAVideoTexture", "GL error {} at {}", static_cast<unsigned>(err), stage);
 	}
 	return had_error;
 }
 
-static GLuint create_yuv_program(bool use_es,
-								   GLint& loc_aPos, GLint& loc_aTex,
-								   GLint& loc_texY, GLint& loc_texU, GLint& loc_texV) {
-	// Two shader variants: desktop GLSL 120 and GLES 100 (softpipe / ES contexts)
-	static const char* vsrc_desktop =
-		"#version 120\n"
-		"attribute vec2 aPos;\n"
-		"attribute vec2 aTex;\n"
-		"varying vec2 vTex;\n"
-		"void main(){ gl_Position=vec4(aPos,0.0,1.0); vTex=aTex; }\n";
-	static const char* fsrc_desktop =
-		"#version 120\n"
-		"varying vec2 vTex;\n"
-		"uniform sampler2D texY;\n"
-		"uniform sampler2D texU;\n"
-		"uniform sampler2D texV;\n"
-		"void main(){\n"
-		"  float y = texture2D(texY, vTex).r;\n"
-		"  float u = texture2D(texU, vTex).r - 0.5;\n"
-		"  float v = texture2D(texV, vTex).r - 0.5;\n"
-		"  float r = y + 1.402 * v;\n"
-		"  float g = y - 0.344136 * u - 0.714136 * v;\n"
-		"  float b = y + 1.772 * u;\n"
-		"  gl_FragColor = vec4(r, g, b, 1.0);\n"
-		"}\n";
-
-	static const char* vsrc_es =
-		"#version 100\n"
-		"precision mediump float;\n"
-		"attribute vec2 aPos;\n"
-		"attribute vec2 aTex;\n"
-		"varying vec2 vTex;\n"
-		"void main(){ gl_Position=vec4(aPos,0.0,1.0); vTex=aTex; }\n";
-	static const char* fsrc_es =
-		"#version 100\n"
-		"precision mediump float;\n"
-		"varying vec2 vTex;\n"
-		"uniform sampler2D texY;\n"
-		"uniform sampler2D texU;\n"
-		"uniform sampler2D texV;\n"
-		"void main(){\n"
-		"  float y = texture2D(texY, vTex).r;\n"
-		"  float u = texture2D(texU, vTex).r - 0.5;\n"
-		"  float v = texture2D(texV, vTex).r - 0.5;\n"
-		"  float r = y + 1.402 * v;\n"
-		"  float g = y - 0.344136 * u - 0.714136 * v;\n"
-		"  float b = y + 1.772 * u;\n"
-		"  gl_FragColor = vec4(r, g, b, 1.0);\n"
-		"}\n";
-
-	const char* vsrc = use_es ? vsrc_es : vsrc_desktop;
-	const char* fsrc = use_es ? fsrc_es : fsrc_desktop;
+// Two shader variants: desktop GLSL 120 and GLES 100 (softpipe / ES contexts)
+static const char* kVertexDesktop =
+	"#version 120\n"
+	"attribute vec2 aPos;\n"
+	"attribute vec2 aTex;\n"
+	"varying vec2 vTex;\n"
+	"void main(){ gl_Position=vec4(aPos,0.0,1.0); vTex=aTex; }\n";
+static const char* kFragmentDesktop =
+	"#version 120\n"
+	"varying vec2 vTex;\n"
+	"uniform sampler2D texY;\n"
+	"uniform sampler2D texU;\n"
+	"uniform sampler2D texV;\n"
+	"uniform mat3 uMatrix;\n"
+	"uniform float uYOffset;\n"
+	"void main(){\n"
+	"  vec3 yuv = vec3(texture2D(texY, vTex).r - uYOffset,\n"
+	"                  texture2D(texU, vTex).r - 0.5,\n"
+	"                  texture2D(texV, vTex).r - 0.5);\n"
+	"  gl_FragColor = vec4(clamp(uMatrix * yuv, 0.0, 1.0), 1.0);\n"
+	"}\n";
+
+static const char* kVertexEs =
+	"#version 100\n"
+	"precision mediump float;\n"
+	"attribute vec2 aPos;\n"
+	"attribute vec2 aTex;\n"
+	"varying vec2 vTex;\n"
+	"void main(){ gl_Position=vec4(aPos,0.0,1.0); vTex=aTex; }\n";
+static const char* kFragmentEs =
+	"#version 100\n"
+	"precision mediump float;\n"
+	"varying vec2 vTex;\n"
+	"uniform sampler2D texY;\n"
+	"uniform sampler2D texU;\n"
+	"uniform sampler2D texV;\n"
+	"uniform mat3 uMatrix;\n"
+	"uniform float uYOffset;\n"
+	"void main(){\n"
+	"  vec3 yuv = vec3(texture2D(texY, vTex).r - uYOffset,\n"
+	"                  texture2D(texU, vTex).r - 0.5,\n"
+	"                  texture2D(texV, vTex).r - 0.5);\n"
+	"  gl_FragColor = vec4(clamp(uMatrix * yuv, 0.0, 1.0), 1.0);\n"
+	"}\n";
+
+// The linked YUV->RGBA program, with the quad it draws and the framebuffer
+// it renders through. All textures populate on the raster thread with one
+// context, so these are built once per process and shared.
+struct YuvProgram {
+	bool attempted = false;
+	GLuint program = 0;
+	GLuint vbo = 0; // full-screen quad
+	GLuint fbo = 0; // attached to each surface's gl_tex in turn
+	GLint loc_aPos = -1, loc_aTex = -1;
+	GLint loc_texY = -1, loc_texU = -1, loc_texV = -1;
+	GLint loc_matrix = -1, loc_y_offset = -1;
+};
+
+static YuvProgram g_yuv_program; // raster thread only
+
+// glGetProgramBinary/glProgramBinary: core in GL 4.1 and GLES 3.0, otherwise
+// by extension. Mesa may expose the entry points with zero formats (e.g. on
+// some software paths); there is nothing to cache then.
+static bool program_binary_supported() {
+	const int version = epoxy_gl_version();
+	const bool available = epoxy_is_desktop_gl()
+		? (version >= 41 || epoxy_has_gl_extension("GL_ARB_get_program_binary"))
+		: (version >= 30 || epoxy_has_gl_extension("GL_OES_get_program_binary"));
+	if (!available) return false;
+	GLint formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	return formats > 0;
+}
+
+static std::string gl_string(GLenum name) {
+	const char* s = reinterpret_cast<const char*>(glGetString(name));
+	return s ? s : "";
+}
+
+static GLuint load_program_from_cache(const std::string& dir, const std::string& key) {
+	ProgramBinary binary;
+	if (!load_program_binary(dir, key, binary)) return 0;
+	GLuint prog = glCreateProgram();
+	glProgramBinary(prog, binary.format, binary.data.data(), static_cast<GLsizei>(binary.data.size()));
+	GLint linked = 0; glGetProgramiv(prog, GL_LINK_STATUS, &linked);
+	if (!linked) {
+		// Expected after a driver update that kept its version strings.
+		while (glGetError() != GL_NO_ERROR) {}
+		glDeleteProgram(prog);
+		remove_program_binary(dir, key);
+		OA_LOG(Info, "OAVideoTexture", "cached GL program rejected by the driver; recompiling");
+		return 0;
+	}
+	return prog;
+}
+
+static void store_program_to_cache(const std::string& dir, const std::string& key, GLuint prog) {
+	GLint length = 0;
+	glGetProgramiv(prog, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) return;
+	ProgramBinary binary;
+	binary.data.resize(static_cast<size_t>(length));
+	GLenum format = 0;
+	GLsizei written = 0;
+	glGetProgramBinary(prog, length, &written, &format, binary.data.data());
+	if (log_gl_errors("program_binary") || written <= 0) return;
+	binary.data.resize(static_cast<size_t>(written));
+	binary.format = format;
+	if (store_program_binary(dir, key, binary)) {
+		OA_LOG(Info, "OAVideoTexture", "cached GL program binary ({} bytes) in {}", written, dir);
+	}
+}
 
+static GLuint compile_yuv_program(const char* vsrc, const char* fsrc, bool retrievable) {
 	GLuint vs = compile_shader(GL_VERTEX_SHADER, vsrc);
 	GLuint fs = compile_shader(GL_FRAGMENT_SHADER, fsrc);
 	if (vs == 0 || fs == 0) {
@@ -147,6 +249,8 @@ static GLuint create_yuv_program(bool use_es,
 	}
 
 	GLuint prog = glCreateProgram();
+	// Some drivers only keep a retrievable binary when asked before linking.
+	if (retrievable) glProgramParameteri(prog, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 	glAttachShader(prog, vs);
 	glAttachShader(prog, fs);
 	glLinkProgram(prog);
@@ -157,264 +261,439 @@ static GLuint create_yuv_program(bool use_es,
 		char log[512];
 		GLsizei len = 0;
 		glGetProgramInfoLog(prog, sizeof(log) - 1, &len, log);
-		std::cerr << "[OAVideoTexture][GL] program link failed: " << std::string(log, (size_t)len) << std::endl;
+		OA_LOG(Error, "OAVideoTexture", "GL program link failed: {}", std::string(log, (size_t)len));
 		glDeleteProgram(prog);
 		return 0;
 	}
-	loc_aPos  = glGetAttribLocation(prog, "aPos");
-	loc_aTex  = glGetAttribLocation(prog, "aTex");
-	loc_texY  = glGetUniformLocation(prog, "texY");
-	loc_texU  = glGetUniformLocation(prog, "texU");
-	loc_texV  = glGetUniformLocation(prog, "texV");
 	return prog;
 }
 
-static gboolean oa_video_texture_populate(FlTextureGL* texture,
-							uint32_t* target,
-							uint32_t* name,
-							uint32_t* width,
-							uint32_t* height,
-							GError** error) {
-	OAVideoTexture* self = (OAVideoTexture*)texture;
+// Build the shared program on first use: from the on-disk binary cache when
+// the driver supports it, otherwise by compiling (and then caching) it. A
+// failure is final; the caller falls back to CPU conversion.
+static const YuvProgram& ensure_yuv_program(bool use_es) {
+	YuvProgram& p = g_yuv_program;
+	if (p.attempted) return p;
+	p.attempted = true;
+
+	const auto start = std::chrono::steady_clock::now();
+	const char* vsrc = use_es ? kVertexEs : kVertexDesktop;
+	const char* fsrc = use_es ? kFragmentEs : kFragmentDesktop;
+	const bool cacheable = program_binary_supported();
+	const std::string dir = cacheable ? program_cache_dir() : std::string();
+	const std::string key = program_cache_key({gl_string(GL_VENDOR), gl_string(GL_RENDERER), gl_string(GL_VERSION),
+											   gl_string(GL_SHADING_LANGUAGE_VERSION), vsrc, fsrc});
+
+	const char* source = "cache";
+	GLuint prog = dir.empty() ? 0 : load_program_from_cache(dir, key);
+	if (prog == 0) {
+		source = "compile";
+		// glProgramParameteri is core from GL 4.1 / GLES 3.0 (or the ARB extension).
+		const bool hint = cacheable && (epoxy_is_desktop_gl() || epoxy_gl_version() >= 30);
+		prog = compile_yuv_program(vsrc, fsrc, hint);
+		if (prog != 0 && !dir.empty()) store_program_to_cache(dir, key, prog);
+	}
+	if (prog == 0) return p;
+
+	p.program = prog;
+	p.loc_aPos  = glGetAttribLocation(prog, "aPos");
+	p.loc_aTex  = glGetAttribLocation(prog, "aTex");
+	p.loc_texY  = glGetUniformLocation(prog, "texY");
+	p.loc_texU  = glGetUniformLocation(prog, "texU");
+	p.loc_texV  = glGetUniformLocation(prog, "texV");
+	p.loc_matrix = glGetUniformLocation(prog, "uMatrix");
+	p.loc_y_offset = glGetUniformLocation(prog, "uYOffset");
+
+	const GLfloat quad[] = {
+		-1.f,-1.f,  0.f,0.f,
+		 1.f,-1.f,  1.f,0.f,
+		-1.f, 1.f,  0.f,1.f,
+		 1.f, 1.f,  1.f,1.f,
+	};
+	glGenBuffers(1, &p.vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, p.vbo);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glGenFramebuffers(1, &p.fbo);
+	const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+	OA_LOG(Info, "OAVideoTexture", "YUV program ready via {} in {} us", source, static_cast<int64_t>(elapsed.count()));
+	startup_timeline().mark(Milestone::GlProgramReady);
+	return p;
+}
+
+enum class PlaneFilter { Nearest, Linear, Mipmap };
+
+// Point `tex` at a texture with w x h storage of `internal_format`: an idle
+// one from gl_resources() when there is one, else a new name. The previous
+// texture is released for reuse. Binds the texture; returns true when its
+// storage still has to be specified.
+static bool resize_texture(GLuint& tex, int w, int h, GLenum internal_format, int texel_bytes) {
+	GlResources& resources = gl_resources();
+	resources.release_texture(tex);
+	tex = resources.acquire_texture(GlTextureFormat{w, h, internal_format, texel_bytes});
+	const bool fresh = tex == 0;
+	if (fresh) glGenTextures(1, &tex);
+	glBindTexture(GL_TEXTURE_2D, tex);
+	return fresh;
+}
+
+// `resize` gives the plane new storage; otherwise the existing storage of
+// the same size is updated in place, which drivers handle without a realloc.
+// Null `data` only sizes the storage.
+static void upload_plane(GLuint& tex, int w, int h, const guint8* data, bool use_luminance, PlaneFilter filter,
+						 bool resize) {
+	const GLenum internal_format = use_luminance ? GL_LUMINANCE : GL_R8;
+	const GLenum format = use_luminance ? GL_LUMINANCE : GL_RED;
+	if (resize && resize_texture(tex, w, h, internal_format, 1)) {
+		glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(internal_format), w, h, 0, format, GL_UNSIGNED_BYTE, data);
+		gl_resources().track_texture(tex, GlTextureFormat{w, h, internal_format, 1});
+	} else {
+		glBindTexture(GL_TEXTURE_2D, tex);
+		if (data) glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, format, GL_UNSIGNED_BYTE, data);
+	}
+	GLint min_filter = GL_NEAREST;
+	GLint mag_filter = GL_NEAREST;
+	if (filter == PlaneFilter::Linear) {
+		min_filter = mag_filter = GL_LINEAR;
+	} else if (filter == PlaneFilter::Mipmap) {
+		glGenerateMipmap(GL_TEXTURE_2D);
+		gl_resources().track_mipmaps(tex);
+		min_filter = GL_LINEAR_MIPMAP_LINEAR;
+		mag_filter = GL_LINEAR;
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag_filter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+// GL_UNPACK_ROW_LENGTH/SKIP_*: desktop GL, GLES 3.0, or GLES2 with
+// GL_EXT_unpack_subimage. Same context for every texture, so query once.
+static bool unpack_subimage_supported() {
+	static int supported = -1; // raster thread only
+	if (supported < 0) {
+		supported = (epoxy_is_desktop_gl() || epoxy_gl_version() >= 30 ||
+					 epoxy_has_gl_extension("GL_EXT_unpack_subimage")) ? 1 : 0;
+	}
+	return supported == 1;
+}
+
+// Source pixels for uploading a w x h window at (x, y) of a plane that is
+// `stride` pixels wide. GL reads the window straight out of the frame via
+// the unpack state when it can; otherwise the rows are copied into
+// `scratch`. The unpack state is restored when this goes out of scope.
+class UnpackWindow {
+public:
+	UnpackWindow(const guint8* plane, int stride, int bpp, int x, int y, int w, int h, std::vector<guint8>& scratch) {
+		if (x == 0 && y == 0 && w == stride) {
+			pixels_ = plane; // whole rows: nothing to skip
+		} else if (unpack_subimage_supported()) {
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, stride);
+			glPixelStorei(GL_UNPACK_SKIP_PIXELS, x);
+			glPixelStorei(GL_UNPACK_SKIP_ROWS, y);
+			pixels_ = plane;
+			set_ = true;
+		} else {
+			const size_t row = static_cast<size_t>(w) * bpp;
+			scratch.resize(row * h);
+			for (int r = 0; r < h; ++r) {
+				memcpy(scratch.data() + row * r, plane + (static_cast<size_t>(y + r) * stride + x) * bpp, row);
+			}
+			pixels_ = scratch.data();
+		}
+	}
+	~UnpackWindow() {
+		if (!set_) return;
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+		glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+		glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+	}
+	UnpackWindow(const UnpackWindow&) = delete;
+	UnpackWindow& operator=(const UnpackWindow&) = delete;
 
-	// (no debug print)
+	const guint8* pixels() const { return pixels_; }
 
-	if (self->gl_tex == 0) {
-		glGenTextures(1, &self->gl_tex);
-		glBindTexture(GL_TEXTURE_2D, self->gl_tex);
+private:
+	const guint8* pixels_ = nullptr;
+	bool set_ = false;
+};
+
+// GLES2 has no single-channel GL_R8; use GL_LUMINANCE there.
+static bool es2_profile(const OAVideoSurface& s) {
+	return s.is_es && s.glsl_version > 0.0f && s.glsl_version < 3.0f;
+}
+
+// Program, quad and FBO for the YUV path; the plane textures are sized on
+// first use. Called from the first populate, before any video, so the shader
+// build stays off the first frame.
+static bool ensure_yuv_resources(OAVideoSurface& s) {
+	// Prefer ES shaders whenever GL reports ES.
+	return ensure_yuv_program(s.is_es).program != 0;
+}
+
+// Give s.gl_tex w x h RGBA8 storage if it has another size, then upload
+// `pixels` (tightly packed, or per the unpack state) if given. Binds s.gl_tex.
+static void size_output(OAVideoSurface& s, int w, int h, const guint8* pixels) {
+	if (s.gl_tex == 0 || s.alloc_w != w || s.alloc_h != h) {
+		if (resize_texture(s.gl_tex, w, h, GL_RGBA8, 4)) {
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+			gl_resources().track_texture(s.gl_tex, GlTextureFormat{w, h, GL_RGBA8, 4});
+			pixels = nullptr;
+		}
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		s.alloc_w = w;
+		s.alloc_h = h;
 	} else {
-		glBindTexture(GL_TEXTURE_2D, self->gl_tex);
+		glBindTexture(GL_TEXTURE_2D, s.gl_tex);
+	}
+	if (pixels) glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+}
+
+// Upload the `view` window of the pending cur_w x cur_h YUV frame (s.planes) and convert
+// it into s.gl_tex at out_w x out_h. Caller holds s.mutex.
+static bool render_yuv(OAVideoSurface& s, int cur_w, int cur_h, const VideoCrop& view, int out_w, int out_h) {
+	const bool es2 = es2_profile(s);
+	const bool use_luminance = es2;
+
+	if (!ensure_yuv_resources(s)) return false;
+	const YuvProgram& prog = g_yuv_program;
+
+	// (Re)allocate destination RGBA texture storage only when the size changes
+	size_output(s, out_w, out_h, nullptr);
+
+	// Sample the planes 1:1 when rendering at full size. When shrinking,
+	// filter; past 2:1 bilinear skips source pixels, so use mipmaps. ES2 does
+	// not allow mipmapped NPOT textures, so it stays bilinear there.
+	const float ratio = std::max(static_cast<float>(view.width) / out_w, static_cast<float>(view.height) / out_h);
+	PlaneFilter filter = PlaneFilter::Nearest;
+	if (ratio >= 2.0f && !es2) {
+		filter = PlaneFilter::Mipmap;
+	} else if (ratio > 1.0f) {
+		filter = PlaneFilter::Linear;
 	}
 
-	// Safe for odd widths/strides
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-	// Guard reads with mutex to avoid races with setters
-	std::unique_lock<std::mutex> lk(self->mutex);
-	const int cur_w = (self->width != nullptr) ? *self->width : 0;
-	const int cur_h = (self->height != nullptr) ? *self->height : 0;
-	const int expected = cur_w * cur_h * 4;
-	const gboolean have_rgba = (self->pixels != nullptr && cur_w > 0 && cur_h > 0 && (int)self->pixels->len >= expected);
-	const gboolean have_yuv  = (self->has_yuv && self->yuv != nullptr && cur_w > 0 && cur_h > 0);
+	// Upload planes as single-channel textures (GL_LUMINANCE for broad compat),
+	// only the visible window. view.x/y are even, so the chroma window
+	// starts on a whole sample.
+	const int cx = view.x / 2;
+	const int cy = view.y / 2;
+	const int cw = (view.width + 1) / 2;
+	const int ch = (view.height + 1) / 2;
+	const bool resize = s.y_tex == 0 || s.plane_w != view.width || s.plane_h != view.height;
+	{
+		UnpackWindow y(s.planes[0], s.strides[0], 1, view.x, view.y, view.width, view.height, s.crop_scratch);
+		upload_plane(s.y_tex, view.width, view.height, y.pixels(), use_luminance, filter, resize);
+	}
+	{
+		UnpackWindow u(s.planes[1], s.strides[1], 1, cx, cy, cw, ch, s.crop_scratch);
+		upload_plane(s.u_tex, cw, ch, u.pixels(), use_luminance, filter, resize);
+	}
+	{
+		UnpackWindow v(s.planes[2], s.strides[2], 1, cx, cy, cw, ch, s.crop_scratch);
+		upload_plane(s.v_tex, cw, ch, v.pixels(), use_luminance, filter, resize);
+	}
+	s.plane_w = view.width;
+	s.plane_h = view.height;
+
+	// Render YUV->RGBA into s.gl_tex
+	glBindFramebuffer(GL_FRAMEBUFFER, prog.fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, s.gl_tex, 0);
+	glViewport(0, 0, out_w, out_h);
+	glUseProgram(prog.program);
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, s.y_tex);
+	glUniform1i(prog.loc_texY, 0);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, s.u_tex);
+	glUniform1i(prog.loc_texU, 1);
+	glActiveTexture(GL_TEXTURE2);
+	glBindTexture(GL_TEXTURE_2D, s.v_tex);
+	glUniform1i(prog.loc_texV, 2);
+
+	// Same matrix as the CPU fallback (yuv_convert.h). GLES2 only takes
+	// column-major matrices, so transpose here.
+	const YuvShaderMatrix cm = yuv_shader_matrix(default_color_space(cur_w, cur_h));
+	const GLfloat column_major[9] = {
+		cm.m[0], cm.m[3], cm.m[6],
+		cm.m[1], cm.m[4], cm.m[7],
+		cm.m[2], cm.m[5], cm.m[8],
+	};
+	glUniformMatrix3fv(prog.loc_matrix, 1, GL_FALSE, column_major);
+	glUniform1f(prog.loc_y_offset, cm.y_offset);
+
+	glBindBuffer(GL_ARRAY_BUFFER, prog.vbo);
+	glEnableVertexAttribArray(prog.loc_aPos);
+	glVertexAttribPointer(prog.loc_aPos, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (const void*)0);
+	glEnableVertexAttribArray(prog.loc_aTex);
+	glVertexAttribPointer(prog.loc_aTex, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (const void*)(2 * sizeof(GLfloat)));
+
+	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	const bool ok = !log_gl_errors("yuv_draw");
+
+	// Cleanup state
+	glDisableVertexAttribArray(prog.loc_aPos);
+	glDisableVertexAttribArray(prog.loc_aTex);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glUseProgram(0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glActiveTexture(GL_TEXTURE0);
+	return ok;
+}
+
+// Consecutive failed YUV draws before giving up on the shader path.
+static constexpr int kMaxGpuFailures = 3;
+
+static gboolean oa_video_texture_populate(FlTextureGL* texture,
+							uint32_t* target,
+							uint32_t* name,
+							uint32_t* width,
+							uint32_t* height,
+							GError** error) {
+	OAVideoTexture* self = (OAVideoTexture*)texture;
+	OAVideoSurface& s = *self->surface;
 	static std::atomic<int> frame_counter{0};
 	static bool logged_fallback = false;
-	bool is_es = false;
-	float glsl_version = 0.0f;
-	query_glsl_profile(is_es, glsl_version);
-	const bool es2_profile = is_es && glsl_version > 0.0f && glsl_version < 3.0f;
-	const bool use_luminance = es2_profile;
-	const bool use_es_shaders = is_es; // Prefer ES shaders whenever GL reports ES
-
-	auto fallback = [&]() {
-		glTexImage2D(GL_TEXTURE_2D,
-					 0,
-					 GL_RGBA8,
-					 1,
-					 1,
-					 0,
-					 GL_RGBA,
-					 GL_UNSIGNED_BYTE,
-					 (const unsigned char[4]){0xFF, 0x00, 0x00, 0xFF});
-		*width = 1;
-		*height = 1;
-		if (!logged_fallback) {
-			std::cout << "[OAVideoTexture] Using 1x1 fallback texture (no frame data yet)" << std::endl;
-			logged_fallback = true;
-		}
-	};
 
-	if (have_yuv) {
-		bool ok = true;
-		// Lazy-init GL resources
-		if (self->program == 0) {
-			self->program = create_yuv_program(use_es_shaders, self->loc_aPos, self->loc_aTex, self->loc_texY, self->loc_texU, self->loc_texV);
-			if (self->program == 0) {
-				ok = false;
-			}
-		}
-		if (!ok) {
-			lk.unlock();
-			fallback();
-			goto populate_done;
+	// Textures released since the last populate (disposed streams, pool
+	// overflow) can only be deleted now that the context is current.
+	const std::vector<uint32_t> released = gl_resources().take_deletions();
+	if (!released.empty()) glDeleteTextures(static_cast<GLsizei>(released.size()), released.data());
+
+	if (!s.profile_known) {
+		query_glsl_profile(s.is_es, s.glsl_version);
+		s.profile_known = true;
+		// Build the shader now, while the view still shows the placeholder.
+		if (!s.cpu_fallback.load(std::memory_order_relaxed) && !ensure_yuv_resources(s)) {
+			s.cpu_fallback.store(true, std::memory_order_relaxed);
+			OA_LOG(Warn, "OAVideoTexture", "GL YUV conversion unavailable; switching to CPU conversion ({})",
+				   i420_to_rgba_impl());
 		}
-		if (self->vbo == 0) {
-			const GLfloat quad[] = {
-				-1.f,-1.f,  0.f,0.f,
-				 1.f,-1.f,  1.f,0.f,
-				-1.f, 1.f,  0.f,1.f,
-				 1.f, 1.f,  1.f,1.f,
-			};
-			glGenBuffers(1, &self->vbo);
-			glBindBuffer(GL_ARRAY_BUFFER, self->vbo);
-			glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
-		}
-		if (self->y_tex == 0) glGenTextures(1, &self->y_tex);
-		if (self->u_tex == 0) glGenTextures(1, &self->u_tex);
-		if (self->v_tex == 0) glGenTextures(1, &self->v_tex);
-		if (self->fbo   == 0) glGenFramebuffers(1, &self->fbo);
-
-		// Allocate destination RGBA texture storage
-		glBindTexture(GL_TEXTURE_2D, self->gl_tex);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, cur_w, cur_h, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
 
-		const int y_size = cur_w * cur_h;
-		const int uv_w = (cur_w + 1) / 2;
-		const int uv_h = (cur_h + 1) / 2;
-		const int uv_size = uv_w * uv_h;
-		const guint8* base = self->yuv->data;
-		const guint8* y_ptr = base;
-		const guint8* u_ptr = base + y_size;
-		const guint8* v_ptr = base + y_size + uv_size;
-
-		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-
-		// Upload planes as single-channel textures (GL_LUMINANCE for broad compat)
-	glBindTexture(GL_TEXTURE_2D, self->y_tex);
-	glTexImage2D(GL_TEXTURE_2D,
-			 0,
-			 use_luminance ? GL_LUMINANCE : GL_R8,
-			 cur_w,
-			 cur_h,
-			 0,
-			 use_luminance ? GL_LUMINANCE : GL_RED,
-			 GL_UNSIGNED_BYTE,
-			 y_ptr);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	*target = GL_TEXTURE_2D;
 
-	glBindTexture(GL_TEXTURE_2D, self->u_tex);
-	glTexImage2D(GL_TEXTURE_2D,
-			 0,
-			 use_luminance ? GL_LUMINANCE : GL_R8,
-			 uv_w,
-			 uv_h,
-			 0,
-			 use_luminance ? GL_LUMINANCE : GL_RED,
-			 GL_UNSIGNED_BYTE,
-			 u_ptr);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	// Guard reads with mutex to avoid races with setters
+	std::unique_lock<std::mutex> lk(s.mutex);
+
+	// The stream announced its picture size: allocate plane storage now so
+	// the first frame only uploads. The RGBA texture keeps whatever is shown.
+	if (s.prepare_w > 0 && s.prepare_h > 0) {
+		const VideoCrop view = effective_crop(s.crop, s.prepare_w, s.prepare_h);
+		if (!s.cpu_fallback.load(std::memory_order_relaxed) && g_yuv_program.program != 0 &&
+			(s.y_tex == 0 || s.plane_w != view.width || s.plane_h != view.height)) {
+			const bool use_luminance = es2_profile(s);
+			const int uv_w = (view.width + 1) / 2;
+			const int uv_h = (view.height + 1) / 2;
+			upload_plane(s.y_tex, view.width, view.height, nullptr, use_luminance, PlaneFilter::Nearest, true);
+			upload_plane(s.u_tex, uv_w, uv_h, nullptr, use_luminance, PlaneFilter::Nearest, true);
+			upload_plane(s.v_tex, uv_w, uv_h, nullptr, use_luminance, PlaneFilter::Nearest, true);
+			s.plane_w = view.width;
+			s.plane_h = view.height;
+			log_gl_errors("prepare_planes");
+		}
+		s.prepare_w = s.prepare_h = 0;
+	}
 
-	glBindTexture(GL_TEXTURE_2D, self->v_tex);
-	glTexImage2D(GL_TEXTURE_2D,
-			 0,
-			 use_luminance ? GL_LUMINANCE : GL_R8,
-			 uv_w,
-			 uv_h,
-			 0,
-			 use_luminance ? GL_LUMINANCE : GL_RED,
-			 GL_UNSIGNED_BYTE,
-			 v_ptr);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	// Another texture of the group (or an earlier populate) already converted
+	// this frame: hand out the same RGBA texture without touching GL.
+	if (s.rendered_generation != 0 && s.rendered_generation == s.generation) {
+		*name = s.gl_tex;
+		*width = (uint32_t)s.rendered_w;
+		*height = (uint32_t)s.rendered_h;
+		return TRUE;
+	}
 
-		// Render YUV->RGBA into self->gl_tex
-		glBindFramebuffer(GL_FRAMEBUFFER, self->fbo);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, self->gl_tex, 0);
-		glViewport(0, 0, cur_w, cur_h);
-		glUseProgram(self->program);
-
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, self->y_tex);
-		glUniform1i(self->loc_texY, 0);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, self->u_tex);
-		glUniform1i(self->loc_texU, 1);
-	glActiveTexture(GL_TEXTURE2);
-	glBindTexture(GL_TEXTURE_2D, self->v_tex);
-	glUniform1i(self->loc_texV, 2);
-
-		glBindBuffer(GL_ARRAY_BUFFER, self->vbo);
-		glEnableVertexAttribArray(self->loc_aPos);
-		glVertexAttribPointer(self->loc_aPos, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (const void*)0);
-		glEnableVertexAttribArray(self->loc_aTex);
-		glVertexAttribPointer(self->loc_aTex, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (const void*)(2 * sizeof(GLfloat)));
-
-		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-		ok = !log_gl_errors("yuv_draw");
-
-		// (no debug dumping)
-
-		// Cleanup state
-		glDisableVertexAttribArray(self->loc_aPos);
-		glDisableVertexAttribArray(self->loc_aTex);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glUseProgram(0);
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-		if (!ok) {
-			lk.unlock();
-			fallback();
-		} else {
-			*width = (uint32_t)cur_w;
-			*height = (uint32_t)cur_h;
-			int count = ++frame_counter;
-			if (count <= 5 || count % 120 == 0) {
-				std::cout << "[OAVideoTexture] YUV frame -> GL " << cur_w << "x" << cur_h << " (" << count << ")" << std::endl;
-			}
-			logged_fallback = false;
-			lk.unlock();
-		}
+	// Safe for odd widths/strides
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	const int cur_w = s.width;
+	const int cur_h = s.height;
+	const VideoCrop view = effective_crop(s.crop, cur_w, cur_h);
+	const size_t expected = (size_t)cur_w * (size_t)cur_h * 4;
+	const bool have_yuv  = (s.has_yuv && cur_w > 0 && cur_h > 0);
+	const bool have_rgba = (!have_yuv && cur_w > 0 && cur_h > 0 && s.pixels.size() >= expected);
+	const char* kind = nullptr;
+	int out_w = view.width;
+	int out_h = view.height;
+
+	const bool try_gpu = have_yuv && !s.cpu_fallback.load(std::memory_order_relaxed);
+	if (try_gpu) s.display_sizes.output(view.width, view.height, out_w, out_h);
+	if (try_gpu && render_yuv(s, cur_w, cur_h, view, out_w, out_h)) {
+		kind = "YUV";
+		s.gpu_failures = 0;
 	} else if (have_rgba) {
-		glTexImage2D(GL_TEXTURE_2D,
-					 0,
-					 GL_RGBA8,
-					 cur_w,
-					 cur_h,
-					 0,
-					 GL_RGBA,
-					 GL_UNSIGNED_BYTE,
-					 self->pixels->data);
-
-		// (no debug dumping)
-		*width = (uint32_t)cur_w;
-		*height = (uint32_t)cur_h;
+		out_w = view.width;
+		out_h = view.height;
+		UnpackWindow rgba(s.pixels.data(), cur_w, 4, view.x, view.y, view.width, view.height, s.crop_scratch);
+		size_output(s, out_w, out_h, rgba.pixels());
+		kind = "RGBA";
+	}
+
+	if (kind) {
+		// generation 0 is the placeholder from oa_video_texture_new().
+		if (s.generation != 0) startup_timeline().mark_populated();
+		s.rendered_generation = s.generation;
+		s.rendered_w = out_w;
+		s.rendered_h = out_h;
+		lk.unlock();
+		*name = s.gl_tex;
+		*width = (uint32_t)out_w;
+		*height = (uint32_t)out_h;
 		int count = ++frame_counter;
 		if (count <= 5 || count % 120 == 0) {
-			std::cout << "[OAVideoTexture] RGBA frame -> GL " << cur_w << "x" << cur_h << " (" << count << ")" << std::endl;
+			OA_LOG(Info, "OAVideoTexture", "{} frame {}x{} -> GL {}x{} ({})", kind, cur_w, cur_h, out_w, out_h, count);
 		}
 		logged_fallback = false;
-		lk.unlock();
-	} else {
-		lk.unlock();
-		fallback();
+		return TRUE;
+	}
+	if (try_gpu) {
+		// A missing program will not come back; draw errors get a few retries.
+		if (g_yuv_program.program == 0 || ++s.gpu_failures >= kMaxGpuFailures) {
+			s.cpu_fallback.store(true, std::memory_order_relaxed);
+			OA_LOG(Warn, "OAVideoTexture", "GL YUV conversion unavailable; switching to CPU conversion ({})",
+				   i420_to_rgba_impl());
+		}
+	}
+	if (s.rendered_generation != 0) {
+		// Keep showing the last converted frame rather than going red.
+		*name = s.gl_tex;
+		*width = (uint32_t)s.rendered_w;
+		*height = (uint32_t)s.rendered_h;
+		return TRUE;
+	}
+	lk.unlock();
+
+	static const guint8 kRed[4] = {0xFF, 0x00, 0x00, 0xFF};
+	size_output(s, 1, 1, kRed);
+	*name = s.gl_tex;
+	*width = 1;
+	*height = 1;
+	if (!logged_fallback) {
+		OA_LOG(Info, "OAVideoTexture", "Using 1x1 fallback texture (no frame data yet)");
+		logged_fallback = true;
 	}
-
-	*target = GL_TEXTURE_2D;
-	*name = self->gl_tex;
-
-populate_done:
 	return TRUE;
 }
 
 static void oa_video_texture_dispose(GObject* obj) {
 	OAVideoTexture* self = OA_VIDEO_TEXTURE(obj);
-	// Important: Only call OpenGL when Flutter has made a GL context current
-	// (inside populate()). To respect that constraint, do not delete GL objects
-	// here since dispose() may run without a current context. The GL texture will
-	// be cleaned up when the context is torn down. If you need explicit cleanup,
-	// add a flag and perform glDeleteTextures in the next populate() call.
-	self->gl_tex = 0;
-	if (self->pixels) {
-		g_byte_array_unref(self->pixels);
-		self->pixels = nullptr;
-	}
-	if (self->width) { g_free(self->width); self->width = nullptr; }
-	if (self->height) { g_free(self->height); self->height = nullptr; }
+	// No GL here: dispose() may run without a current context. The last
+	// texture of a group takes the surface with it, whose textures go to
+	// gl_resources() for reuse or deletion on the next populate.
+	if (self->surface) {
+		OAVideoSurface& s = *self->surface;
+		std::lock_guard<std::mutex> lk(s.mutex);
+		const VideoCrop view = effective_crop(s.crop, s.width, s.height);
+		// The remaining views may want a smaller conversion now.
+		if (s.display_sizes.set(self, 0, 0, view.width, view.height)) ++s.generation;
+	}
+	self->surface.reset();
 	G_OBJECT_CLASS(oa_video_texture_parent_class)->dispose(obj);
 }
 
@@ -424,18 +703,23 @@ static void oa_video_texture_class_init(OAVideoTextureClass* klass) {
 }
 
 static void oa_video_texture_init(OAVideoTexture* self) {
-	self->pixels = g_byte_array_new();
-	self->yuv = g_byte_array_new();
+	self->registered_id = 0;
 }
 
 OAVideoTexture* oa_video_texture_new(int width, int height) {
 	OAVideoTexture* self = OA_VIDEO_TEXTURE(g_object_new(OA_VIDEO_TEXTURE_TYPE, nullptr));
-	self->width = g_new(int, 1);
-	self->height = g_new(int, 1);
-	*self->width = width;
-	*self->height = height;
-	const int cap = (width > 0 && height > 0) ? width * height * 4 : 0;
-	if (cap > 0) g_byte_array_set_size(self->pixels, cap);
+	self->surface = std::make_shared<OAVideoSurface>();
+	self->surface->width = width;
+	self->surface->height = height;
+	const size_t cap = (width > 0 && height > 0) ? (size_t)width * (size_t)height * 4 : 0;
+	if (cap > 0) self->surface->pixels.resize(cap);
+	return self;
+}
+
+OAVideoTexture* oa_video_texture_new_shared(OAVideoTexture* source) {
+	g_return_val_if_fail(source != nullptr && source->surface, nullptr);
+	OAVideoTexture* self = OA_VIDEO_TEXTURE(g_object_new(OA_VIDEO_TEXTURE_TYPE, nullptr));
+	self->surface = source->surface;
 	return self;
 }
 
@@ -448,24 +732,42 @@ int64_t oa_video_texture_register(OAVideoTexture* self, FlTextureRegistrar* regi
 	return self->registered_id;
 }
 
+// Drop the lent YUV frame, if any, returning what must be called once
+// s.mutex is released. Caller holds s.mutex.
+static std::pair<GDestroyNotify, gpointer> take_yuv_release(OAVideoSurface& s) {
+	const std::pair<GDestroyNotify, gpointer> release(s.yuv_release, s.yuv_release_data);
+	s.yuv_release = nullptr;
+	s.yuv_release_data = nullptr;
+	return release;
+}
+
+static void run_release(const std::pair<GDestroyNotify, gpointer>& release) {
+	if (release.first) release.first(release.second);
+}
+
 void oa_video_texture_set_frame(OAVideoTexture* self,
 							const guint8* rgba_bytes,
 							gsize length,
 							int width,
 							int height) {
-	std::lock_guard<std::mutex> lk(self->mutex);
-	if (!self->width) self->width = g_new(int, 1);
-	if (!self->height) self->height = g_new(int, 1);
-	*self->width = width;
-	*self->height = height;
-	const gsize needed = (gsize)width * (gsize)height * 4u;
-	if (self->pixels->len != needed) {
-		g_byte_array_set_size(self->pixels, needed);
-	}
-	if (rgba_bytes && length >= needed) {
-		memcpy(self->pixels->data, rgba_bytes, needed);
+	OAVideoSurface& s = *self->surface;
+	std::pair<GDestroyNotify, gpointer> release;
+	{
+		std::lock_guard<std::mutex> lk(s.mutex);
+		s.width = width;
+		s.height = height;
+		const gsize needed = (gsize)width * (gsize)height * 4u;
+		if (s.pixels.size() != needed) {
+			s.pixels.resize(needed);
+		}
+		if (rgba_bytes && length >= needed) {
+			memcpy(s.pixels.data(), rgba_bytes, needed);
+		}
+		s.has_yuv = false;
+		release = take_yuv_release(s);
+		++s.generation;
 	}
-	self->has_yuv = FALSE;
+	run_release(release);
 }
 
 void oa_video_texture_set_yuv420p_frame(OAVideoTexture* self,
@@ -473,29 +775,100 @@ void oa_video_texture_set_yuv420p_frame(OAVideoTexture* self,
 										gsize length,
 										int width,
 										int height) {
-	std::lock_guard<std::mutex> lk(self->mutex);
-	if (!self->width) self->width = g_new(int, 1);
-	if (!self->height) self->height = g_new(int, 1);
-	*self->width = width;
-	*self->height = height;
-	const gsize y_size = (gsize)width * (gsize)height;
-	const gsize uv_w = (width + 1) / 2;
-	const gsize uv_h = (height + 1) / 2;
-	const gsize uv_size = uv_w * uv_h;
-	const gsize needed = y_size + uv_size * 2;
-	if (self->yuv->len != needed) {
-		g_byte_array_set_size(self->yuv, needed);
-	}
-	if (yuv_bytes && length >= needed) {
-		memcpy(self->yuv->data, yuv_bytes, needed);
-		self->has_yuv = TRUE;
-	} else {
-		self->has_yuv = FALSE;
+	OAVideoSurface& s = *self->surface;
+	std::pair<GDestroyNotify, gpointer> release;
+	{
+		std::lock_guard<std::mutex> lk(s.mutex);
+		s.width = width;
+		s.height = height;
+		const gsize y_size = (gsize)width * (gsize)height;
+		const gsize uv_w = (width + 1) / 2;
+		const gsize uv_h = (height + 1) / 2;
+		const gsize uv_size = uv_w * uv_h;
+		const gsize needed = y_size + uv_size * 2;
+		if (s.yuv.size() != needed) {
+			s.yuv.resize(needed);
+		}
+		if (yuv_bytes && length >= needed) {
+			memcpy(s.yuv.data(), yuv_bytes, needed);
+			const I420Planes packed = i420_packed_planes(s.yuv.data(), width, height);
+			std::copy(packed.data, packed.data + 3, s.planes);
+			std::copy(packed.stride, packed.stride + 3, s.strides);
+			s.has_yuv = true;
+		} else {
+			s.has_yuv = false;
+		}
+		release = take_yuv_release(s);
+		++s.generation;
+	}
+	run_release(release);
+}
+
+void oa_video_texture_set_yuv420p_planes(OAVideoTexture* self,
+										 const guint8* const planes[3],
+										 const int strides[3],
+										 int width,
+										 int height,
+										 GDestroyNotify release,
+										 gpointer release_data) {
+	OAVideoSurface& s = *self->surface;
+	std::pair<GDestroyNotify, gpointer> previous;
+	{
+		std::lock_guard<std::mutex> lk(s.mutex);
+		previous = take_yuv_release(s);
+		s.width = width;
+		s.height = height;
+		s.has_yuv = planes[0] && planes[1] && planes[2] && width > 0 && height > 0;
+		for (int i = 0; i < 3; ++i) {
+			s.planes[i] = planes[i];
+			s.strides[i] = strides[i];
+		}
+		s.yuv_release = release;
+		s.yuv_release_data = release_data;
+		// The lent frame replaces the copy; give that memory back.
+		std::vector<guint8>().swap(s.yuv);
+		++s.generation;
 	}
+	run_release(previous);
+}
+
+void oa_video_texture_prepare(OAVideoTexture* self, int width, int height) {
+	OAVideoSurface& s = *self->surface;
+	std::lock_guard<std::mutex> lk(s.mutex);
+	s.prepare_w = width;
+	s.prepare_h = height;
+}
+
+gboolean oa_video_texture_wants_rgba(OAVideoTexture* self) {
+	g_return_val_if_fail(self != nullptr && self->surface, FALSE);
+	return self->surface->cpu_fallback.load(std::memory_order_relaxed) ? TRUE : FALSE;
+}
+
+void oa_video_texture_set_display_size(OAVideoTexture* self, int width, int height) {
+	OAVideoSurface& s = *self->surface;
+	std::lock_guard<std::mutex> lk(s.mutex);
+	const VideoCrop view = effective_crop(s.crop, s.width, s.height);
+	// Re-convert the retained frame at the new size on the next populate.
+	if (s.display_sizes.set(self, width, height, view.width, view.height)) ++s.generation;
+}
+
+void oa_video_texture_set_crop(OAVideoTexture* self, int x, int y, int width, int height) {
+	OAVideoSurface& s = *self->surface;
+	VideoCrop crop;
+	if (width > 0 && height > 0) {
+		crop.x = std::max(x, 0);
+		crop.y = std::max(y, 0);
+		crop.width = width;
+		crop.height = height;
+	}
+	std::lock_guard<std::mutex> lk(s.mutex);
+	if (crop == s.crop) return;
+	s.crop = crop;
+	// Re-convert the retained frame with the new window on the next populate.
+	++s.generation;
 }
 
 void oa_video_texture_mark_frame_available(OAVideoTexture* self,
 								 FlTextureRegistrar* registrar) {
 	fl_texture_registrar_mark_texture_frame_available(registrar, FL_TEXTURE(self));
 }
-
@@ -15,6 +15,12 @@ G_DECLARE_FINAL_TYPE(OAVideoTexture, oa_video_texture, OA, VIDEO_TEXTURE, FlText
 // This texture supports YUV420P input and converts to RGBA in GL.
 OAVideoTexture* oa_video_texture_new(int width, int height);
 
+// Create a texture that shows the same frames as `source`. The group shares
+// one set of GL plane textures and one converted RGBA texture, so each frame
+// is uploaded and converted once however many textures display it. Frames
+// may be supplied through any texture of the group; mark each one available.
+OAVideoTexture* oa_video_texture_new_shared(OAVideoTexture* source);
+
 // Register the texture with the Flutter engine and return its texture ID.
 // Call once; subsequent calls return the same ID.
 int64_t oa_video_texture_register(OAVideoTexture* self, FlTextureRegistrar* registrar);
@@ -30,6 +36,52 @@ void oa_video_texture_set_yuv420p_frame(OAVideoTexture* self,
                                         int width,
                                         int height);
 
+// Supply a YUV420P (I420) frame as three planes with their row strides in
+// bytes, without copying it: GL uploads straight from the planes, which must
+// stay valid until the texture calls release(release_data). That happens
+// once another frame replaces this one or the texture group is destroyed,
+// from whichever thread does so.
+void oa_video_texture_set_yuv420p_planes(OAVideoTexture* self,
+                                         const guint8* const planes[3],
+                                         const int strides[3],
+                                         int width,
+                                         int height,
+                                         GDestroyNotify release,
+                                         gpointer release_data);
+
+// Supply an RGBA8 frame (width*height*4 bytes, tightly packed). Uploaded
+// as-is in populate(), with no GL conversion.
+void oa_video_texture_set_frame(OAVideoTexture* self,
+                                const guint8* rgba_bytes,
+                                gsize length,
+                                int width,
+                                int height);
+
+// Announce the size of the YUV frames to come (e.g. parsed from the SPS)
+// before the first one decodes. The next populate allocates the plane
+// textures at that size, so the first frame only uploads into them. What
+// the texture currently shows is kept. Mark the texture available afterwards.
+void oa_video_texture_prepare(OAVideoTexture* self, int width, int height);
+
+// TRUE once the GL YUV->RGBA path has failed for this texture's group (no
+// shader support, or repeated draw errors, e.g. on some software GL setups).
+// From then on YUV frames are not drawn; supply CPU-converted frames through
+// oa_video_texture_set_frame instead.
+gboolean oa_video_texture_wants_rgba(OAVideoTexture* self);
+
+// Report the on-screen size of this texture in physical pixels (0x0 to
+// clear). YUV frames are converted directly at that size (never above the
+// decoded size); for a shared group the largest reported size wins. Call
+// mark_frame_available afterwards to re-render the current frame.
+void oa_video_texture_set_display_size(OAVideoTexture* self, int width, int height);
+
+// Show only the width x height window at (x, y) of each decoded frame, in
+// decoded pixels (0x0 to show the whole frame). The window is clamped to the
+// frame and its origin rounded down to even; only it is uploaded and
+// converted, and the texture takes its size. Applies to the whole shared
+// group. Call mark_frame_available afterwards to re-render the current frame.
+void oa_video_texture_set_crop(OAVideoTexture* self, int x, int y, int width, int height);
+
 // Notify Flutter that a new frame is available for this texture.
 void oa_video_texture_mark_frame_available(OAVideoTexture* self,
                                           FlTextureRegistrar* registrar);
@@ -0,0 +1,66 @@
+#include "pipeline_config.h"
+
+#include <algorithm>
+#include <mutex>
+
+namespace {
+
+struct ScalerEntry {
+	ScalerMode mode;
+	const char* name;
+};
+
+constexpr ScalerEntry kScalers[] = {
+	{ScalerMode::FastBilinear, "fast_bilinear"},
+	{ScalerMode::Bilinear, "bilinear"},
+	{ScalerMode::Bicubic, "bicubic"},
+	{ScalerMode::Point, "point"},
+	{ScalerMode::Area, "area"},
+};
+
+std::mutex g_mutex;
+PipelineConfig g_config;
+
+} // namespace
+
+const char* scaler_name(ScalerMode mode) {
+	for (const auto& s : kScalers) {
+		if (s.mode == mode) return s.name;
+	}
+	return "bilinear";
+}
+
+bool parse_scaler(const std::string& name, ScalerMode& out) {
+	for (const auto& s : kScalers) {
+		if (name == s.name) {
+			out = s.mode;
+			return true;
+		}
+	}
+	return false;
+}
+
+PipelineConfig sanitize_pipeline_config(PipelineConfig c) {
+	c.pump_interval_ms = std::clamp(c.pump_interval_ms, 1, 1000);
+	c.transport_wait_ms = std::clamp(c.transport_wait_ms, 10, 60000);
+	c.transport_poll_us = std::clamp(c.transport_poll_us, 50, 100000);
+	c.reconnect_initial_ms = std::clamp(c.reconnect_initial_ms, 1, 60000);
+	c.reconnect_max_ms = std::clamp(c.reconnect_max_ms, c.reconnect_initial_ms, 300000);
+	c.shm_poll_ms = std::clamp(c.shm_poll_ms, 1, 1000);
+	c.shm_video_size = std::clamp<size_t>(c.shm_video_size, 64 * 1024, 64 * 1024 * 1024);
+	c.decoder.threads = std::clamp(c.decoder.threads, 0, 16);
+	c.keyframe_request_type = std::max(c.keyframe_request_type, -1);
+	c.worker.cpu_percent = std::clamp(c.worker.cpu_percent, 0, 6400);
+	c.memory.lock_budget = std::min<size_t>(c.memory.lock_budget, size_t{1} << 30);
+	return c;
+}
+
+PipelineConfig pipeline_config() {
+	std::lock_guard<std::mutex> lk(g_mutex);
+	return g_config;
+}
+
+void set_pipeline_config(const PipelineConfig& config) {
+	std::lock_guard<std::mutex> lk(g_mutex);
+	g_config = sanitize_pipeline_config(config);
+}
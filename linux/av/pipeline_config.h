@@ -0,0 +1,63 @@
+// Runtime-tunable pipeline settings (configurePipeline), with their defaults.
+#pragma once
+
+#include "../common/MemoryResidency.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+enum class ScalerMode : uint8_t { FastBilinear, Bilinear, Bicubic, Point, Area };
+
+const char* scaler_name(ScalerMode mode);
+bool parse_scaler(const std::string& name, ScalerMode& out);
+
+// Settings for each VideoDecoder. Changing them reopens existing decoders,
+// which then resync on the next IDR.
+struct DecoderOptions {
+	int threads = 1;          // libavcodec threads per decoder; 0 = one per core
+	bool low_delay = false;   // AV_CODEC_FLAG_LOW_DELAY
+	bool fast = false;        // AV_CODEC_FLAG2_FAST (non-spec-compliant speedups)
+	ScalerMode scaler = ScalerMode::Bilinear; // swscale algorithm for the I420 copy
+
+	bool operator==(const DecoderOptions& o) const {
+		return threads == o.threads && low_delay == o.low_delay && fast == o.fast && scaler == o.scaler;
+	}
+	bool operator!=(const DecoderOptions& o) const { return !(*this == o); }
+};
+
+// Decoding in a helper process (RemoteDecoder), so a crash in libavcodec
+// only costs a worker restart and decode CPU time can be capped apart from
+// the Flutter engine. Applies to decoders created afterwards.
+struct DecodeWorkerOptions {
+	bool enabled = false;
+	std::string cgroup;  // cgroup v2 directory the worker moves into (created if missing); empty = stay
+	int cpu_percent = 0; // cpu.max of that cgroup, in percent of one CPU; 0 = no limit
+
+	bool operator==(const DecodeWorkerOptions& o) const {
+		return enabled == o.enabled && cgroup == o.cgroup && cpu_percent == o.cpu_percent;
+	}
+	bool operator!=(const DecodeWorkerOptions& o) const { return !(*this == o); }
+};
+
+struct PipelineConfig {
+	int pump_interval_ms = 16;        // main-loop frame pump
+	int transport_wait_ms = 5000;     // startAsB wait, per connect attempt
+	int transport_poll_us = 1000;     // startAsB poll
+	int reconnect_initial_ms = 250;   // first reconnect backoff
+	int reconnect_max_ms = 10000;     // backoff cap
+	int shm_poll_ms = 10;             // SharedMemoryConsumer semaphore timeout
+	size_t shm_video_size = 1920 * 1080 * 3;
+	DecoderOptions decoder;
+	int keyframe_request_type = -1;   // -1 disables keyframe requests
+	DecodeWorkerOptions worker;
+	oa_memory::Policy memory;         // residency of the SHM mappings and frame buffers
+};
+
+// Clamp every field to a range the pipeline can run with.
+PipelineConfig sanitize_pipeline_config(PipelineConfig config);
+
+// Process-wide current settings. Components read them when they start or
+// reconnect; the plugin pushes changes to running ones.
+PipelineConfig pipeline_config();
+void set_pipeline_config(const PipelineConfig& config);
@@ -0,0 +1,33 @@
+// Process-wide video pipeline counters. Writers use relaxed atomics; readers
+// (method channel, exported C ABI) never take a lock.
+#pragma once
+
+#include "latency_histogram.h"
+
+#include <atomic>
+#include <cstdint>
+
+struct PipelineStats {
+	std::atomic<uint64_t> video_packets{0};
+	std::atomic<uint64_t> video_bytes{0};
+	std::atomic<uint64_t> frames_decoded{0};
+	std::atomic<uint64_t> decode_failures{0};
+	std::atomic<uint64_t> frames_presented{0};
+	std::atomic<int64_t> last_decode_us{0};  // packet received -> frame decoded
+	std::atomic<int64_t> last_present_us{0}; // packet received -> handed to the texture
+	std::atomic<int32_t> width{0};
+	std::atomic<int32_t> height{0};
+	std::atomic<bool> transport_running{false};
+	std::atomic<uint64_t> frames_discarded{0};  // dropped while waiting for an IDR, or from a backlogged decode queue
+	std::atomic<uint64_t> decode_recoveries{0};
+	std::atomic<int64_t> last_recover_us{0};    // first decode error -> first clean frame
+	std::atomic<uint64_t> keyframe_requests{0};
+	std::atomic<int64_t> decoder_pool_bytes{0}; // frame buffers LavcDecoder allocated, pooled or lent out
+	LatencyHistogram decode_latency;  // every last_decode_us
+	LatencyHistogram present_latency; // every last_present_us
+};
+
+inline PipelineStats& pipeline_stats() {
+	static PipelineStats stats;
+	return stats;
+}
@@ -0,0 +1,386 @@
+#include "remote_decoder.h"
+#include "bitstream.h"
+#include "decode_worker.h"
+#include "pipeline_stats.h"
+#include "../common/Log.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <stdexcept>
+#include <sys/eventfd.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace {
+
+// Where the worker finds its inherited fds.
+constexpr int kChildShmFd = 3;
+constexpr int kChildRequestFd = 4;
+constexpr int kChildDoneFd = 5;
+
+int64_t steady_now_us() {
+	using namespace std::chrono;
+	return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void close_fd(int& fd) {
+	if (fd >= 0) close(fd);
+	fd = -1;
+}
+
+void signal_fd(int fd) {
+	const uint64_t one = 1;
+	while (write(fd, &one, sizeof(one)) < 0 && errno == EINTR) {
+	}
+}
+
+} // namespace
+
+std::string decode_worker_path() {
+	if (const char* path = std::getenv("OPENAUTOFLUTTER_DECODE_WORKER_PATH")) {
+		if (*path) return path;
+	}
+	Dl_info info{};
+	if (dladdr(reinterpret_cast<void*>(&decode_worker_path), &info) && info.dli_fname) {
+		std::string dir = info.dli_fname;
+		const size_t slash = dir.rfind('/');
+		dir = slash == std::string::npos ? "." : dir.substr(0, slash);
+		return dir + "/openautoflutter_decode_worker";
+	}
+	return "openautoflutter_decode_worker";
+}
+
+RemoteDecoder::RemoteDecoder(VideoCodec codec, const DecodeWorkerOptions& options)
+	: codec_(codec), options_(options), worker_path_(decode_worker_path()) {
+	decoder_options_ = pipeline_config().decoder;
+	if (!start_worker()) {
+		throw std::runtime_error("decode worker " + worker_path_ + " did not start");
+	}
+}
+
+RemoteDecoder::~RemoteDecoder() {
+	if (pid_ > 0) {
+		kill(pid_, SIGKILL);
+		while (waitpid(pid_, nullptr, 0) < 0 && errno == EINTR) {
+		}
+	}
+	close_fd(request_fd_);
+	close_fd(done_fd_);
+}
+
+bool RemoteDecoder::start_worker() {
+	channel_ = decode_ipc::Channel::create(static_cast<uint32_t>(codec_), kRingSize, kSlots, kSlotSize);
+	if (!channel_) return false;
+	shared_bytes_.store(channel_->size(), std::memory_order_relaxed);
+	request_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	done_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (request_fd_ < 0 || done_fd_ < 0) {
+		OA_LOG(Error, "RemoteDecoder", "eventfd failed: {}", std::strerror(errno));
+		stop_worker(nullptr);
+		return false;
+	}
+
+	// Lift the fds above the child's numbers first so no dup2 overwrites a
+	// source that has not been moved yet.
+	const int sources[3] = {channel_->fd(), request_fd_, done_fd_};
+	int lifted[3] = {-1, -1, -1};
+	for (int i = 0; i < 3; ++i) lifted[i] = fcntl(sources[i], F_DUPFD_CLOEXEC, 10);
+
+	DecodeWorkerArgs args;
+	args.shm_fd = kChildShmFd;
+	args.request_fd = kChildRequestFd;
+	args.done_fd = kChildDoneFd;
+	args.cgroup = options_.cgroup;
+	args.cpu_percent = options_.cpu_percent;
+	std::vector<std::string> strings = format_decode_worker_args(args);
+	strings.insert(strings.begin(), worker_path_);
+	std::vector<char*> argv;
+	for (auto& s : strings) argv.push_back(&s[0]);
+	argv.push_back(nullptr);
+
+	int rc = -1;
+	if (lifted[0] >= 0 && lifted[1] >= 0 && lifted[2] >= 0) {
+		posix_spawn_file_actions_t actions;
+		posix_spawn_file_actions_init(&actions);
+		posix_spawn_file_actions_adddup2(&actions, lifted[0], kChildShmFd);
+		posix_spawn_file_actions_adddup2(&actions, lifted[1], kChildRequestFd);
+		posix_spawn_file_actions_adddup2(&actions, lifted[2], kChildDoneFd);
+		rc = posix_spawn(&pid_, worker_path_.c_str(), &actions, nullptr, argv.data(), environ);
+		posix_spawn_file_actions_destroy(&actions);
+	}
+	for (int& fd : lifted) close_fd(fd);
+	if (rc != 0) {
+		pid_ = -1;
+		OA_LOG(Error, "RemoteDecoder", "cannot spawn {}: {}", worker_path_, std::strerror(rc > 0 ? rc : errno));
+		stop_worker(nullptr);
+		return false;
+	}
+	if (!await(0, kStartTimeoutUs)) {
+		stop_worker("did not become ready");
+		return false;
+	}
+
+	seen_keyframe_requests_ = seen_discarded_ = seen_recoveries_ = 0;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		settings_dirty_ = true;
+	}
+	flush_settings();
+	OA_LOG(Info, "RemoteDecoder", "{} worker pid {} started (restart {})", codec_name(codec_), pid_,
+		   restarts_.load(std::memory_order_relaxed));
+	return true;
+}
+
+void RemoteDecoder::stop_worker(const char* reason) {
+	if (reason) {
+		OA_LOG(Warn, "RemoteDecoder", "{} worker {}; restarting in {} ms", codec_name(codec_), reason,
+			   backoff_us_ / 1000);
+	}
+	if (pid_ > 0) {
+		kill(pid_, SIGKILL);
+		while (waitpid(pid_, nullptr, 0) < 0 && errno == EINTR) {
+		}
+	}
+	pid_ = -1;
+	close_fd(request_fd_);
+	close_fd(done_fd_);
+	// Frames still on screen keep their own reference to the old channel.
+	channel_.reset();
+	shared_bytes_.store(0, std::memory_order_relaxed);
+	next_start_us_ = steady_now_us() + backoff_us_;
+	backoff_us_ = std::min(backoff_us_ * 2, kMaxBackoffUs);
+	recovering_.store(true, std::memory_order_relaxed);
+}
+
+bool RemoteDecoder::worker_exited() {
+	if (pid_ <= 0) return true;
+	int status = 0;
+	if (waitpid(pid_, &status, WNOHANG) != pid_) return false;
+	if (WIFSIGNALED(status)) {
+		OA_LOG(Error, "RemoteDecoder", "worker pid {} killed by signal {}", pid_, WTERMSIG(status));
+	} else {
+		OA_LOG(Error, "RemoteDecoder", "worker pid {} exited with {}", pid_, WEXITSTATUS(status));
+	}
+	pid_ = -1;
+	return true;
+}
+
+bool RemoteDecoder::ensure_worker() {
+	if (channel_ && pid_ > 0) return true;
+	if (steady_now_us() < next_start_us_) return false;
+	restarts_.fetch_add(1, std::memory_order_relaxed);
+	if (!start_worker()) return false;
+
+	// The new decoder has no parameter sets and no references.
+	if (!parameter_sets_.empty()) {
+		int32_t slot = -1;
+		send_packet(parameter_sets_.data(), parameter_sets_.size(), slot);
+		if (slot >= 0) channel_->release_slot(slot);
+	}
+	KeyframeRequestFn request;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		request = keyframe_request_;
+	}
+	if (request) {
+		pipeline_stats().keyframe_requests.fetch_add(1, std::memory_order_relaxed);
+		request();
+	}
+	return channel_ != nullptr;
+}
+
+bool RemoteDecoder::await(uint64_t seq, int64_t timeout_us) {
+	const decode_ipc::Header& h = channel_->header();
+	const int64_t deadline = steady_now_us() + timeout_us;
+	for (;;) {
+		if (seq == 0 ? h.ready.load(std::memory_order_acquire) != 0
+					 : h.done_seq.load(std::memory_order_acquire) >= seq) {
+			return true;
+		}
+		if (worker_exited()) return false;
+		const int64_t left = deadline - steady_now_us();
+		if (left <= 0) return false;
+		pollfd pfd{done_fd_, POLLIN, 0};
+		if (poll(&pfd, 1, static_cast<int>(std::min<int64_t>(left / 1000 + 1, 100))) > 0) {
+			uint64_t count = 0;
+			(void)read(done_fd_, &count, sizeof(count));
+		}
+	}
+}
+
+bool RemoteDecoder::send_packet(const uint8_t* data, size_t size, int32_t& slot) {
+	slot = -1;
+	const uint64_t seq = ++seq_;
+	if (!channel_->write(decode_ipc::RecordType::Packet, seq, data, size)) {
+		OA_LOG_RATE(Warn, 1, "RemoteDecoder", "{} byte packet does not fit the {} byte ring; dropped", size,
+					kRingSize);
+		return false;
+	}
+	signal_fd(request_fd_);
+	if (!await(seq, kReplyTimeoutUs)) {
+		stop_worker(pid_ > 0 ? "stopped answering" : "died");
+		return false;
+	}
+	slot = channel_->header().done_slot.load(std::memory_order_relaxed);
+	mirror_worker_stats();
+	return true;
+}
+
+void RemoteDecoder::flush_settings() {
+	DecoderOptions options;
+	bool keyframes_only = false, dirty = false, reset = false, skip = false;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		options = decoder_options_;
+		keyframes_only = keyframes_only_;
+		dirty = settings_dirty_;
+		reset = reset_pending_;
+		skip = skip_pending_;
+		settings_dirty_ = reset_pending_ = skip_pending_ = false;
+	}
+	bool queued = false;
+	if (dirty) {
+		decode_ipc::WireOptions wire{};
+		wire.threads = options.threads;
+		wire.low_delay = options.low_delay ? 1 : 0;
+		wire.fast = options.fast ? 1 : 0;
+		wire.scaler = static_cast<uint8_t>(options.scaler);
+		const uint8_t flag = keyframes_only ? 1 : 0;
+		queued |= channel_->write(decode_ipc::RecordType::Options, 0, &wire, sizeof(wire));
+		queued |= channel_->write(decode_ipc::RecordType::KeyframesOnly, 0, &flag, 1);
+	}
+	if (reset) queued |= channel_->write(decode_ipc::RecordType::ResetSession, 0, nullptr, 0);
+	if (skip) queued |= channel_->write(decode_ipc::RecordType::SkipToKeyframe, 0, nullptr, 0);
+	if (queued) signal_fd(request_fd_);
+}
+
+void RemoteDecoder::remember_parameter_sets(const uint8_t* data, size_t size) {
+	std::vector<uint8_t> sets;
+	const bool h265 = codec_ == VideoCodec::H265;
+	const bool found = h265 ? parse_hvcc_config(data, size, sets) || extract_h265_parameter_sets(data, size, sets)
+							: parse_avcc_config(data, size, sets) || extract_h264_parameter_sets(data, size, sets);
+	if (found) parameter_sets_ = std::move(sets);
+}
+
+void RemoteDecoder::mirror_worker_stats() {
+	const decode_ipc::Header& h = channel_->header();
+	announced_.store(h.announced.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	recovering_.store(h.recovering.load(std::memory_order_relaxed) != 0, std::memory_order_relaxed);
+
+	PipelineStats& stats = pipeline_stats();
+	const uint64_t discarded = h.frames_discarded.load(std::memory_order_relaxed);
+	const uint64_t recoveries = h.decode_recoveries.load(std::memory_order_relaxed);
+	stats.frames_discarded.fetch_add(discarded - seen_discarded_, std::memory_order_relaxed);
+	if (recoveries != seen_recoveries_) {
+		stats.decode_recoveries.fetch_add(recoveries - seen_recoveries_, std::memory_order_relaxed);
+		stats.last_recover_us.store(h.last_recover_us.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+	seen_discarded_ = discarded;
+	seen_recoveries_ = recoveries;
+
+	// The worker's decoder rate-limits its requests; forward each one.
+	const uint64_t requests = h.keyframe_requests.load(std::memory_order_relaxed);
+	if (requests == seen_keyframe_requests_) return;
+	seen_keyframe_requests_ = requests;
+	KeyframeRequestFn request;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		request = keyframe_request_;
+	}
+	if (request) {
+		pipeline_stats().keyframe_requests.fetch_add(1, std::memory_order_relaxed);
+		request();
+	}
+}
+
+bool RemoteDecoder::decode_shared(const uint8_t* data, size_t size, SharedPicture& out) {
+	remember_parameter_sets(data, size);
+	if (!ensure_worker()) {
+		pipeline_stats().frames_discarded.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	flush_settings();
+	int32_t slot = -1;
+	if (!send_packet(data, size, slot) || slot < 0) return false;
+
+	const decode_ipc::Slot& s = channel_->header().slots[slot];
+	const uint64_t width = s.width, height = s.height;
+	if (s.state.load(std::memory_order_acquire) != decode_ipc::kSlotReady || width == 0 || height == 0 ||
+		width > 16384 || height > 16384 || s.size != width * height * 3 / 2 || s.size > channel_->header().slot_size) {
+		OA_LOG_RATE(Error, 1, "RemoteDecoder", "worker returned a bad slot {} ({}x{}, {} bytes)", slot, width, height,
+					s.size);
+		channel_->release_slot(slot);
+		return false;
+	}
+	backoff_us_ = kMinBackoffUs;
+
+	std::shared_ptr<decode_ipc::Channel> channel = channel_;
+	const uint8_t* pixels = channel->slot_pixels(slot);
+	out.planes = i420_packed_planes(pixels, static_cast<int>(width), static_cast<int>(height));
+	out.width = static_cast<int>(width);
+	out.height = static_cast<int>(height);
+	out.hold = std::shared_ptr<const void>(pixels, [channel, slot](const void*) { channel->release_slot(slot); });
+	return true;
+}
+
+bool RemoteDecoder::decode_to_yuv420p(const uint8_t* data,
+									  size_t size,
+									  std::vector<uint8_t>& out_yuv,
+									  int& out_width,
+									  int& out_height) {
+	SharedPicture picture;
+	if (!decode_shared(data, size, picture)) return false;
+	const uint8_t* yuv = picture.planes.data[0];
+	out_yuv.assign(yuv, yuv + static_cast<size_t>(picture.width) * picture.height * 3 / 2);
+	out_width = picture.width;
+	out_height = picture.height;
+	return true;
+}
+
+bool RemoteDecoder::set_options(const DecoderOptions& options) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	decoder_options_ = options;
+	settings_dirty_ = true;
+	return true;
+}
+
+void RemoteDecoder::set_keyframe_request(KeyframeRequestFn fn) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	keyframe_request_ = std::move(fn);
+}
+
+void RemoteDecoder::reset_session() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	reset_pending_ = true;
+}
+
+void RemoteDecoder::skip_to_keyframe() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	skip_pending_ = true;
+	recovering_.store(true, std::memory_order_relaxed);
+}
+
+void RemoteDecoder::set_keyframes_only(bool enable) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (keyframes_only_ == enable) return;
+	keyframes_only_ = enable;
+	settings_dirty_ = true;
+}
+
+bool RemoteDecoder::announced_size(int& width, int& height) const {
+	const uint64_t packed = announced_.load(std::memory_order_relaxed);
+	if (packed == 0) return false;
+	width = static_cast<int>(packed >> 32);
+	height = static_cast<int>(packed & 0xffffffffu);
+	return true;
+}
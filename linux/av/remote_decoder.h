@@ -0,0 +1,112 @@
+// VideoDecoder that decodes in a separate openautoflutter_decode_worker
+// process.
+#pragma once
+
+#include "decode_ipc.h"
+#include "pipeline_config.h"
+#include "video_decoder.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+// Packets go to the worker over a decode_ipc ring; pictures come back in
+// shared frame slots and are handed on through decode_shared() without a
+// copy. Decoding stays synchronous per packet, so ordering, recovery and
+// keyframes-only behave as with the in-process decoder.
+//
+// If the worker crashes or stops answering it is killed and a new one is
+// started, with backoff, on a fresh channel. The new worker gets the
+// stream's latest parameter sets and a keyframe is requested. Packets in
+// between are dropped while the last frame stays on screen, as after a
+// decode error.
+class RemoteDecoder : public VideoDecoder {
+public:
+	static constexpr int kSlots = 4;
+	static constexpr size_t kRingSize = 8 * 1024 * 1024;
+	static constexpr size_t kSlotSize = 4096 * 2304 * 3 / 2; // largest picture handed back
+	static constexpr int64_t kStartTimeoutUs = 3000000;
+	static constexpr int64_t kReplyTimeoutUs = 2000000;
+	static constexpr int64_t kMinBackoffUs = 250000;
+	static constexpr int64_t kMaxBackoffUs = 10000000;
+
+	// Starts the first worker; throws std::runtime_error if it does not come
+	// up (binary missing, spawn or channel failure).
+	RemoteDecoder(VideoCodec codec, const DecodeWorkerOptions& options);
+	~RemoteDecoder() override;
+
+	RemoteDecoder(const RemoteDecoder&) = delete;
+	RemoteDecoder& operator=(const RemoteDecoder&) = delete;
+
+	VideoCodec codec() const override { return codec_; }
+	// Sent to the worker ahead of the next packet; always true.
+	bool set_options(const DecoderOptions& options) override;
+	// Copies out of the frame slot; the stream uses decode_shared().
+	bool decode_to_yuv420p(const uint8_t* data,
+						   size_t size,
+						   std::vector<uint8_t>& out_yuv,
+						   int& out_width,
+						   int& out_height) override;
+	void set_keyframe_request(KeyframeRequestFn fn) override;
+	bool recovering() const override { return recovering_.load(std::memory_order_relaxed); }
+	void reset_session() override;
+	void skip_to_keyframe() override;
+	void set_keyframes_only(bool enable) override;
+	bool announced_size(int& width, int& height) const override;
+	bool shares_output() const override { return true; }
+	bool decode_shared(const uint8_t* data, size_t size, SharedPicture& out) override;
+
+	uint64_t restarts() const { return restarts_.load(std::memory_order_relaxed); }
+	// Size of the current worker's channel mapping (ring and frame slots).
+	size_t shared_bytes() const { return shared_bytes_.load(std::memory_order_relaxed); }
+
+private:
+	// Decode strand (and the constructor) only.
+	bool ensure_worker();
+	bool start_worker();
+	void stop_worker(const char* reason);
+	bool worker_exited();
+	// Wait until the worker answered packet `seq` (0: until it is ready).
+	bool await(uint64_t seq, int64_t timeout_us);
+	bool send_packet(const uint8_t* data, size_t size, int32_t& slot);
+	void flush_settings();
+	void remember_parameter_sets(const uint8_t* data, size_t size);
+	void mirror_worker_stats();
+
+	const VideoCodec codec_;
+	const DecodeWorkerOptions options_;
+	const std::string worker_path_;
+
+	std::shared_ptr<decode_ipc::Channel> channel_;
+	pid_t pid_ = -1;
+	int request_fd_ = -1;
+	int done_fd_ = -1;
+	uint64_t seq_ = 0;
+	int64_t next_start_us_ = 0;
+	int64_t backoff_us_ = kMinBackoffUs;
+	std::vector<uint8_t> parameter_sets_; // Annex-B, re-sent to a new worker
+	uint64_t seen_keyframe_requests_ = 0;  // worker counters already mirrored
+	uint64_t seen_discarded_ = 0;
+	uint64_t seen_recoveries_ = 0;
+
+	// Settings from other threads, applied before the next packet.
+	mutable std::mutex mutex_;
+	DecoderOptions decoder_options_;
+	bool keyframes_only_ = false;
+	bool settings_dirty_ = true;
+	bool reset_pending_ = false;
+	bool skip_pending_ = false;
+	KeyframeRequestFn keyframe_request_;
+
+	std::atomic<bool> recovering_{false};
+	std::atomic<uint64_t> announced_{0}; // width << 32 | height
+	std::atomic<uint64_t> restarts_{0};
+	std::atomic<size_t> shared_bytes_{0};
+};
+
+// Where the worker binary is looked for: OPENAUTOFLUTTER_DECODE_WORKER_PATH,
+// else next to the plugin library.
+std::string decode_worker_path();
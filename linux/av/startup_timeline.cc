@@ -0,0 +1,83 @@
+#include "startup_timeline.h"
+#include "../common/Log.hpp"
+
+#include <chrono>
+
+namespace {
+
+int64_t steady_now_us() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+const char* milestone_name(Milestone milestone) {
+	switch (milestone) {
+	case Milestone::PluginRegistered: return "pluginRegistered";
+	case Milestone::GlProgramReady: return "glProgramReady";
+	case Milestone::TransportConnected: return "transportConnected";
+	case Milestone::FirstVideoPacket: return "firstVideoPacket";
+	case Milestone::ParameterSets: return "parameterSets";
+	case Milestone::FirstFrameDecoded: return "firstFrameDecoded";
+	case Milestone::FirstFramePresented: return "firstFramePresented";
+	case Milestone::FirstFramePopulated: return "firstFramePopulated";
+	case Milestone::Count: break;
+	}
+	return "unknown";
+}
+
+void StartupTimeline::mark(Milestone milestone, int64_t now_us) {
+	const size_t index = static_cast<size_t>(milestone);
+	if (index >= kCount) return;
+	std::atomic<int64_t>& slot = marks_[index];
+	// Cheap check first: this is called per packet and per frame.
+	if (slot.load(std::memory_order_relaxed) != 0) return;
+	int64_t expected = 0;
+	const int64_t t = now_us > 0 ? now_us : steady_now_us();
+	if (!slot.compare_exchange_strong(expected, t, std::memory_order_relaxed)) return;
+	const int64_t origin = marks_[0].load(std::memory_order_relaxed);
+	OA_LOG(Info, "Startup", "{} at +{} ms", milestone_name(milestone), origin > 0 ? (t - origin) / 1000 : 0);
+}
+
+int64_t StartupTimeline::at(Milestone milestone) const {
+	const size_t index = static_cast<size_t>(milestone);
+	return index < kCount ? marks_[index].load(std::memory_order_relaxed) : 0;
+}
+
+void StartupTimeline::mark_connected(int64_t now_us) {
+	const int64_t t = now_us > 0 ? now_us : steady_now_us();
+	mark(Milestone::TransportConnected, t);
+	last_connect_us_.store(t, std::memory_order_relaxed);
+	awaiting_frame_.store(true, std::memory_order_release);
+}
+
+void StartupTimeline::mark_populated(int64_t now_us) {
+	const bool first_since_connect = awaiting_frame_.load(std::memory_order_relaxed) &&
+									 awaiting_frame_.exchange(false, std::memory_order_acquire);
+	if (first_since_connect || at(Milestone::FirstFramePopulated) == 0) {
+		const int64_t t = now_us > 0 ? now_us : steady_now_us();
+		mark(Milestone::FirstFramePopulated, t);
+		if (first_since_connect) {
+			const int64_t elapsed = t - last_connect_us_.load(std::memory_order_relaxed);
+			connect_to_frame_us_.store(elapsed, std::memory_order_relaxed);
+			OA_LOG(Info, "Startup", "connect -> first frame {} ms", elapsed / 1000);
+		}
+	}
+}
+
+int64_t StartupTimeline::last_connect_to_frame_us() const {
+	return connect_to_frame_us_.load(std::memory_order_relaxed);
+}
+
+void StartupTimeline::reset() {
+	for (auto& slot : marks_) slot.store(0, std::memory_order_relaxed);
+	last_connect_us_.store(0, std::memory_order_relaxed);
+	awaiting_frame_.store(false, std::memory_order_relaxed);
+	connect_to_frame_us_.store(-1, std::memory_order_relaxed);
+}
+
+StartupTimeline& startup_timeline() {
+	static StartupTimeline timeline;
+	return timeline;
+}
@@ -0,0 +1,49 @@
+// Time-to-first-video milestones, from plugin registration to the first
+// frame Flutter composited. Written from any thread with relaxed atomics.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+enum class Milestone : uint8_t {
+	PluginRegistered,
+	GlProgramReady,     // YUV shader linked or loaded from the program cache
+	TransportConnected,
+	FirstVideoPacket,
+	ParameterSets,      // SPS parsed: picture size known, buffers preallocated
+	FirstFrameDecoded,
+	FirstFramePresented, // handed to the texture on the main thread
+	FirstFramePopulated, // uploaded/converted in populate() on the raster thread
+	Count,
+};
+
+// camelCase, as reported over the method channel.
+const char* milestone_name(Milestone milestone);
+
+class StartupTimeline {
+public:
+	static constexpr size_t kCount = static_cast<size_t>(Milestone::Count);
+
+	// Record the first occurrence only; later calls are ignored.
+	void mark(Milestone milestone, int64_t now_us = 0);
+	// steady_clock microseconds of the first occurrence, or 0.
+	int64_t at(Milestone milestone) const;
+
+	// Every (re)connect restarts the connect -> first populated frame clock, so
+	// warm starts after a reconnect can be measured as well as the cold one.
+	void mark_connected(int64_t now_us = 0);
+	void mark_populated(int64_t now_us = 0);
+	// Most recent connect -> first populated frame after it, or -1.
+	int64_t last_connect_to_frame_us() const;
+
+	void reset();
+
+private:
+	std::atomic<int64_t> marks_[kCount] = {};
+	std::atomic<int64_t> last_connect_us_{0};
+	std::atomic<bool> awaiting_frame_{false};
+	std::atomic<int64_t> connect_to_frame_us_{-1};
+};
+
+StartupTimeline& startup_timeline();
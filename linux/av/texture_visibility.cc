@@ -0,0 +1,26 @@
+#include "texture_visibility.h"
+
+bool TextureVisibility::add(int64_t texture_id) {
+	const bool before = visible();
+	textures_.insert(texture_id);
+	hidden_.erase(texture_id);
+	return visible() != before;
+}
+
+bool TextureVisibility::remove(int64_t texture_id) {
+	const bool before = visible();
+	textures_.erase(texture_id);
+	hidden_.erase(texture_id);
+	return visible() != before;
+}
+
+bool TextureVisibility::set(int64_t texture_id, bool visible) {
+	if (!known(texture_id)) return false;
+	const bool before = this->visible();
+	if (visible) {
+		hidden_.erase(texture_id);
+	} else {
+		hidden_.insert(texture_id);
+	}
+	return this->visible() != before;
+}
@@ -0,0 +1,27 @@
+// Whether any of the textures showing a stream is on screen.
+#pragma once
+
+#include <cstdint>
+#include <set>
+
+// Textures are identified by their Flutter texture id and start out visible.
+// The stream counts as visible while at least one of its textures is, and
+// while it has none. Not thread-safe; the owning stream uses it on the main
+// thread.
+class TextureVisibility {
+public:
+	// A new texture, visible until told otherwise; returns true if that
+	// flips visible().
+	bool add(int64_t texture_id);
+	// Forget a texture; returns true if that flips visible().
+	bool remove(int64_t texture_id);
+	bool known(int64_t texture_id) const { return textures_.count(texture_id) != 0; }
+
+	// Returns true if this flips visible(). Unknown ids change nothing.
+	bool set(int64_t texture_id, bool visible);
+	bool visible() const { return textures_.empty() || hidden_.size() < textures_.size(); }
+
+private:
+	std::set<int64_t> textures_;
+	std::set<int64_t> hidden_; // subset of textures_
+};
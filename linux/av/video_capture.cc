@@ -0,0 +1,344 @@
+#include "video_capture.h"
+#include "../common/Log.hpp"
+#include "../common/MemoryResidency.hpp"
+#include "../common/ThreadPolicy.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char kFileMagic[8] = {'O', 'A', 'V', 'C', 'A', 'P', '0', '1'};
+constexpr char kIndexMagic[8] = {'O', 'A', 'V', 'I', 'D', 'X', '0', '1'};
+
+size_t pad8(size_t n) { return (8 - (n & 7)) & 7; }
+
+bool write_all(int fd, const struct iovec* iov, int iovcnt) {
+	std::vector<struct iovec> v(iov, iov + iovcnt);
+	size_t idx = 0;
+	while (idx < v.size()) {
+		const ssize_t n = writev(fd, v.data() + idx, static_cast<int>(v.size() - idx));
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			return false;
+		}
+		size_t left = static_cast<size_t>(n);
+		while (idx < v.size() && left >= v[idx].iov_len) {
+			left -= v[idx].iov_len;
+			++idx;
+		}
+		if (idx < v.size() && left > 0) {
+			v[idx].iov_base = static_cast<uint8_t*>(v[idx].iov_base) + left;
+			v[idx].iov_len -= left;
+		}
+	}
+	return true;
+}
+
+} // namespace
+
+// ---- VideoCaptureWriter ----
+
+VideoCaptureWriter::~VideoCaptureWriter() { close(); }
+
+bool VideoCaptureWriter::open(const std::string& path) {
+	std::lock_guard<std::mutex> life(lifecycle_mutex_);
+	if (thread_.joinable()) return false;
+	fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (fd_ == -1) {
+		OA_LOG(Error, "VideoCapture", "open failed path={}: {}", path, std::strerror(errno));
+		return false;
+	}
+	oa_capture::FileHeader hdr{};
+	std::memcpy(hdr.magic, kFileMagic, sizeof(hdr.magic));
+	hdr.version = oa_capture::kVersion;
+	hdr.header_size = sizeof(hdr);
+	hdr.created_unix_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count());
+	struct iovec iov{&hdr, sizeof(hdr)};
+	if (!write_all(fd_, &iov, 1)) {
+		::close(fd_);
+		fd_ = -1;
+		return false;
+	}
+	offset_ = sizeof(hdr);
+	offsets_.clear();
+	path_ = path;
+	{
+		std::lock_guard<std::mutex> lk(mutex_);
+		queue_.clear();
+		queued_bytes_ = 0;
+		accepted_ = 0;
+		open_ = true;
+		stopping_ = false;
+	}
+	thread_ = std::thread([this]() { run(); });
+	OA_LOG(Info, "VideoCapture", "recording to {}", path);
+	return true;
+}
+
+bool VideoCaptureWriter::append(uint64_t transport_ts, uint64_t recv_us, const uint8_t* data, size_t size) {
+	if (!data || size == 0 || size > UINT32_MAX) return false;
+	std::unique_lock<std::mutex> lk(mutex_);
+	if (!open_ || stopping_) return false;
+	if (queue_.size() >= kMaxQueuedRecords || queued_bytes_ + size > kMaxQueuedBytes) {
+		const uint64_t dropped = dropped_.fetch_add(1, std::memory_order_relaxed) + 1;
+		lk.unlock();
+		OA_LOG_RATE(Warn, 1, "VideoCapture", "writer behind, dropping messages (dropped={})", dropped);
+		return false;
+	}
+	queue_.push_back(Pending{transport_ts, recv_us, std::vector<uint8_t>(data, data + size)});
+	queued_bytes_ += size;
+	++accepted_;
+	lk.unlock();
+	cv_.notify_one();
+	return true;
+}
+
+void VideoCaptureWriter::run() {
+	oa_thread::refresh(oa_thread::Role::Logger, "oa-capture");
+	std::unique_lock<std::mutex> lk(mutex_);
+	for (;;) {
+		cv_.wait(lk, [this]() { return stopping_ || !queue_.empty(); });
+		if (queue_.empty()) return; // stopping and drained
+		Pending rec = std::move(queue_.front());
+		queue_.pop_front();
+		lk.unlock();
+		const bool ok = write_record(rec);
+		lk.lock();
+		queued_bytes_ -= rec.data.size();
+		if (!ok) {
+			// Nothing queued can be written any more; count it as lost.
+			dropped_.fetch_add(queue_.size() + 1, std::memory_order_relaxed);
+			accepted_ -= queue_.size() + 1;
+			queue_.clear();
+			queued_bytes_ = 0;
+			open_ = false;
+			return;
+		}
+	}
+}
+
+bool VideoCaptureWriter::write_record(const Pending& pending) {
+	oa_capture::RecordHeader rec{};
+	rec.magic = oa_capture::kRecordMagic;
+	rec.size = static_cast<uint32_t>(pending.data.size());
+	rec.transport_ts = pending.transport_ts;
+	rec.recv_us = pending.recv_us;
+	static const uint8_t zeros[8] = {0};
+	const size_t pad = pad8(pending.data.size());
+	struct iovec iov[3] = {
+		{&rec, sizeof(rec)},
+		{const_cast<uint8_t*>(pending.data.data()), pending.data.size()},
+		{const_cast<uint8_t*>(zeros), pad},
+	};
+	if (!write_all(fd_, iov, pad ? 3 : 2)) {
+		OA_LOG(Error, "VideoCapture", "write failed: {}; stopping capture", std::strerror(errno));
+		::close(fd_);
+		fd_ = -1;
+		return false;
+	}
+	offsets_.push_back(offset_);
+	offset_ += sizeof(rec) + pending.data.size() + pad;
+	return true;
+}
+
+void VideoCaptureWriter::close() {
+	std::lock_guard<std::mutex> life(lifecycle_mutex_);
+	if (!thread_.joinable()) return;
+	{
+		std::lock_guard<std::mutex> lk(mutex_);
+		stopping_ = true;
+	}
+	cv_.notify_one();
+	thread_.join();
+	{
+		std::lock_guard<std::mutex> lk(mutex_);
+		open_ = false;
+	}
+	if (fd_ == -1) return; // a write failed; the reader recovers by scanning
+	oa_capture::IndexFooter footer{};
+	footer.count = offsets_.size();
+	footer.index_offset = offset_;
+	std::memcpy(footer.magic, kIndexMagic, sizeof(footer.magic));
+	struct iovec iov[2] = {
+		{offsets_.data(), offsets_.size() * sizeof(uint64_t)},
+		{&footer, sizeof(footer)},
+	};
+	if (!write_all(fd_, iov, 2)) {
+		OA_LOG(Error, "VideoCapture", "index write failed: {}", std::strerror(errno));
+	}
+	::close(fd_);
+	fd_ = -1;
+	OA_LOG(Info, "VideoCapture", "closed {} records={} dropped={}", path_, offsets_.size(), dropped());
+}
+
+bool VideoCaptureWriter::is_open() const {
+	std::lock_guard<std::mutex> lk(mutex_);
+	return open_;
+}
+
+uint64_t VideoCaptureWriter::record_count() const {
+	std::lock_guard<std::mutex> lk(mutex_);
+	return accepted_;
+}
+
+// ---- VideoCaptureReader ----
+
+VideoCaptureReader::~VideoCaptureReader() { close(); }
+
+bool VideoCaptureReader::open(const std::string& path) {
+	close();
+	const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd == -1) {
+		OA_LOG(Error, "VideoCapture", "cannot open {}: {}", path, std::strerror(errno));
+		return false;
+	}
+	struct stat st{};
+	if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(oa_capture::FileHeader))) {
+		::close(fd);
+		OA_LOG(Error, "VideoCapture", "not a capture file: {}", path);
+		return false;
+	}
+	void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (p == MAP_FAILED) {
+		OA_LOG(Error, "VideoCapture", "mmap failed: {}", std::strerror(errno));
+		return false;
+	}
+	base_ = static_cast<const uint8_t*>(p);
+	length_ = static_cast<size_t>(st.st_size);
+
+	oa_capture::FileHeader hdr{};
+	std::memcpy(&hdr, base_, sizeof(hdr));
+	if (std::memcmp(hdr.magic, kFileMagic, sizeof(hdr.magic)) != 0 || hdr.version != oa_capture::kVersion ||
+		hdr.header_size != sizeof(hdr)) {
+		OA_LOG(Error, "VideoCapture", "bad header in {}", path);
+		close();
+		return false;
+	}
+	madvise(const_cast<uint8_t*>(base_), length_, MADV_SEQUENTIAL);
+
+	indexed_ = load_footer_index();
+	if (!indexed_) scan_records();
+	return true;
+}
+
+void VideoCaptureReader::close() {
+	if (base_) munmap(const_cast<uint8_t*>(base_), length_);
+	base_ = nullptr;
+	length_ = 0;
+	offsets_.clear();
+	indexed_ = false;
+}
+
+bool VideoCaptureReader::load_footer_index() {
+	if (length_ < sizeof(oa_capture::FileHeader) + sizeof(oa_capture::IndexFooter)) return false;
+	oa_capture::IndexFooter footer{};
+	std::memcpy(&footer, base_ + length_ - sizeof(footer), sizeof(footer));
+	if (std::memcmp(footer.magic, kIndexMagic, sizeof(footer.magic)) != 0) return false;
+	const uint64_t index_bytes = footer.count * sizeof(uint64_t);
+	if (footer.index_offset < sizeof(oa_capture::FileHeader) ||
+		footer.count > length_ / sizeof(oa_capture::RecordHeader) ||
+		footer.index_offset + index_bytes + sizeof(footer) != length_) {
+		return false;
+	}
+	offsets_.resize(footer.count);
+	std::memcpy(offsets_.data(), base_ + footer.index_offset, index_bytes);
+	for (uint64_t off : offsets_) {
+		if (off + sizeof(oa_capture::RecordHeader) > footer.index_offset) {
+			offsets_.clear();
+			return false;
+		}
+	}
+	return true;
+}
+
+void VideoCaptureReader::scan_records() {
+	offsets_.clear();
+	size_t off = sizeof(oa_capture::FileHeader);
+	while (off + sizeof(oa_capture::RecordHeader) <= length_) {
+		oa_capture::RecordHeader rec{};
+		std::memcpy(&rec, base_ + off, sizeof(rec));
+		if (rec.magic != oa_capture::kRecordMagic) break;
+		const size_t end = off + sizeof(rec) + rec.size;
+		if (rec.size == 0 || end > length_) break; // truncated tail
+		offsets_.push_back(off);
+		off = end + pad8(rec.size);
+	}
+}
+
+bool VideoCaptureReader::record(size_t index, Record& out) const {
+	if (index >= offsets_.size()) return false;
+	const uint64_t off = offsets_[index];
+	oa_capture::RecordHeader rec{};
+	std::memcpy(&rec, base_ + off, sizeof(rec));
+	if (rec.magic != oa_capture::kRecordMagic || off + sizeof(rec) + rec.size > length_) return false;
+	out.transport_ts = rec.transport_ts;
+	out.recv_us = rec.recv_us;
+	out.data = base_ + off + sizeof(rec);
+	out.size = rec.size;
+	return true;
+}
+
+// ---- VideoReplaySource ----
+
+VideoReplaySource::~VideoReplaySource() { stop(); }
+
+bool VideoReplaySource::start(const std::string& path, PacketSink sink, bool realtime, bool loop) {
+	if (running_.load()) return false;
+	if (thread_.joinable()) thread_.join(); // previous replay ran to completion
+	if (!sink || !reader_.open(path)) return false;
+	sink_ = std::move(sink);
+	stop_requested_ = false;
+	packets_sent_ = 0;
+	running_ = true;
+	OA_LOG(Info, "VideoReplay", "replaying {} records={} indexed={} realtime={}",
+		path, reader_.size(), reader_.indexed(), realtime);
+	thread_ = std::thread([this, realtime, loop]() { run(realtime, loop); });
+	return true;
+}
+
+void VideoReplaySource::stop() {
+	stop_requested_ = true;
+	if (thread_.joinable()) thread_.join();
+	running_ = false;
+	reader_.close();
+	sink_ = nullptr;
+}
+
+void VideoReplaySource::run(bool realtime, bool loop) {
+	if (reader_.size() == 0) loop = false;
+	do {
+		const auto wall_start = std::chrono::steady_clock::now();
+		uint64_t first_recv_us = 0;
+		for (size_t i = 0; i < reader_.size() && !stop_requested_.load(std::memory_order_relaxed); ++i) {
+			// Replay stands in for the transport, so it runs under its policy.
+			oa_thread::refresh(oa_thread::Role::TransportRx, "oa-replay");
+			oa_memory::count_faults(oa_thread::Role::TransportRx);
+			VideoCaptureReader::Record rec;
+			if (!reader_.record(i, rec)) continue;
+			if (realtime) {
+				if (i == 0) first_recv_us = rec.recv_us;
+				const uint64_t rel_us = rec.recv_us >= first_recv_us ? rec.recv_us - first_recv_us : 0;
+				const auto due = wall_start + std::chrono::microseconds(rel_us);
+				// Sleep in short slices so stop() stays responsive across long gaps.
+				while (!stop_requested_.load(std::memory_order_relaxed) && std::chrono::steady_clock::now() < due) {
+					std::this_thread::sleep_until(std::min(due, std::chrono::steady_clock::now() + std::chrono::milliseconds(50)));
+				}
+				if (stop_requested_.load(std::memory_order_relaxed)) break;
+			}
+			sink_(rec.transport_ts, rec.data, rec.size);
+			packets_sent_.fetch_add(1, std::memory_order_relaxed);
+		}
+	} while (loop && !stop_requested_.load(std::memory_order_relaxed));
+	OA_LOG(Info, "VideoReplay", "finished packets={}", packets_sent_.load());
+	running_ = false;
+}
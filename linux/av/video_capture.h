@@ -0,0 +1,179 @@
+// Record/replay of raw VIDEO transport messages.
+//
+// Capture file layout (little-endian, every block 8-byte aligned so records can
+// be read in place from an mmap):
+//   FileHeader                           magic "OAVCAP01", version, create time
+//   RecordHeader + payload + pad ...     one per VIDEO message, append-only
+//   offsets[count] + IndexFooter         written by close(); optional
+//
+// A capture that was not closed cleanly (crash, power loss) has no footer; the
+// reader then rebuilds the index by walking the records and drops a truncated
+// tail record.
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace oa_capture {
+
+struct FileHeader {
+	char magic[8];           // "OAVCAP01"
+	uint32_t version;        // kVersion
+	uint32_t header_size;    // sizeof(FileHeader)
+	uint64_t created_unix_us;
+};
+
+struct RecordHeader {
+	uint32_t magic;          // kRecordMagic
+	uint32_t size;           // payload bytes (excluding padding)
+	uint64_t transport_ts;   // timestamp handed to the transport handler
+	uint64_t recv_us;        // steady_clock microseconds when received
+};
+
+struct IndexFooter {
+	uint64_t count;          // number of records
+	uint64_t index_offset;   // file offset of offsets[count]
+	char magic[8];           // "OAVIDX01"
+};
+
+static_assert(sizeof(FileHeader) == 24, "FileHeader layout unexpected");
+static_assert(sizeof(RecordHeader) == 24, "RecordHeader layout unexpected");
+static_assert(sizeof(IndexFooter) == 24, "IndexFooter layout unexpected");
+
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kRecordMagic = 0x5256414F; // "OAVR"
+
+} // namespace oa_capture
+
+// Appends VIDEO messages to a capture file. Thread-safe. append() runs on the
+// transport receive thread, so it only copies the message into a bounded queue;
+// the writer's own thread does the file writes. A message that does not fit
+// (the disk fell behind) is dropped and counted rather than stalling receive.
+class VideoCaptureWriter {
+public:
+	static constexpr size_t kMaxQueuedRecords = 512;
+	static constexpr size_t kMaxQueuedBytes = 32u * 1024 * 1024;
+
+	VideoCaptureWriter() = default;
+	~VideoCaptureWriter();
+
+	VideoCaptureWriter(const VideoCaptureWriter&) = delete;
+	VideoCaptureWriter& operator=(const VideoCaptureWriter&) = delete;
+
+	// Create/truncate the file, write the header and start the writer thread.
+	bool open(const std::string& path);
+	// Queue one message; returns false if not open, the queue is full or an
+	// earlier write failed.
+	bool append(uint64_t transport_ts, uint64_t recv_us, const uint8_t* data, size_t size);
+	// Write the queued messages and the index footer, then close. Safe to call
+	// more than once.
+	void close();
+
+	bool is_open() const;
+	// Messages accepted by append() and not lost to a failed write.
+	uint64_t record_count() const;
+	// Messages append() turned away because the queue was full, or that were
+	// queued when a write failed.
+	uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+	const std::string& path() const { return path_; }
+
+private:
+	struct Pending {
+		uint64_t transport_ts;
+		uint64_t recv_us;
+		std::vector<uint8_t> data;
+	};
+
+	void run();
+	bool write_record(const Pending& rec); // writer thread
+
+	std::mutex lifecycle_mutex_; // serializes open() and close()
+	mutable std::mutex mutex_;
+	std::condition_variable cv_;
+	std::deque<Pending> queue_;
+	size_t queued_bytes_ = 0;
+	uint64_t accepted_ = 0;
+	bool open_ = false;
+	bool stopping_ = false;
+	std::atomic<uint64_t> dropped_{0};
+	std::thread thread_;
+
+	// Owned by the writer thread while it runs, by open()/close() otherwise.
+	int fd_ = -1;
+	uint64_t offset_ = 0;
+	std::vector<uint64_t> offsets_;
+	std::string path_;
+};
+
+// Read-only, mmap-backed view of a capture file.
+class VideoCaptureReader {
+public:
+	struct Record {
+		uint64_t transport_ts = 0;
+		uint64_t recv_us = 0;
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+	};
+
+	VideoCaptureReader() = default;
+	~VideoCaptureReader();
+
+	VideoCaptureReader(const VideoCaptureReader&) = delete;
+	VideoCaptureReader& operator=(const VideoCaptureReader&) = delete;
+
+	bool open(const std::string& path);
+	void close();
+
+	size_t size() const { return offsets_.size(); }
+	// True if the index came from the footer rather than a record scan.
+	bool indexed() const { return indexed_; }
+	bool record(size_t index, Record& out) const;
+
+private:
+	bool load_footer_index();
+	void scan_records();
+
+	const uint8_t* base_ = nullptr;
+	size_t length_ = 0;
+	std::vector<uint64_t> offsets_;
+	bool indexed_ = false;
+};
+
+// Feeds a capture back into a packet sink on its own thread, either paced by
+// the recorded receive times or as fast as the sink accepts packets.
+class VideoReplaySource {
+public:
+	using PacketSink = std::function<void(uint64_t transport_ts, const uint8_t* data, size_t size)>;
+
+	VideoReplaySource() = default;
+	~VideoReplaySource();
+
+	VideoReplaySource(const VideoReplaySource&) = delete;
+	VideoReplaySource& operator=(const VideoReplaySource&) = delete;
+
+	// Open the capture and start the replay thread. Fails if already running.
+	bool start(const std::string& path, PacketSink sink, bool realtime, bool loop);
+	// Stop and join the replay thread.
+	void stop();
+
+	bool is_running() const { return running_.load(std::memory_order_relaxed); }
+	uint64_t packets_sent() const { return packets_sent_.load(std::memory_order_relaxed); }
+
+private:
+	void run(bool realtime, bool loop);
+
+	VideoCaptureReader reader_;
+	PacketSink sink_;
+	std::thread thread_;
+	std::atomic<bool> stop_requested_{false};
+	std::atomic<bool> running_{false};
+	std::atomic<uint64_t> packets_sent_{0};
+};
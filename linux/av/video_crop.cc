@@ -0,0 +1,35 @@
+#include "video_crop.h"
+
+#include <algorithm>
+
+VideoCrop effective_crop(const VideoCrop& crop, int frame_w, int frame_h) {
+	VideoCrop full;
+	full.width = std::max(frame_w, 0);
+	full.height = std::max(frame_h, 0);
+	if (crop.empty() || full.empty()) return full;
+
+	const int x0 = std::clamp(crop.x, 0, frame_w) & ~1;
+	const int y0 = std::clamp(crop.y, 0, frame_h) & ~1;
+	// Wide enough values would overflow x + width; clamp in 64 bits.
+	const int x1 = static_cast<int>(std::min<long long>(static_cast<long long>(crop.x) + crop.width, frame_w));
+	const int y1 = static_cast<int>(std::min<long long>(static_cast<long long>(crop.y) + crop.height, frame_h));
+	if (x1 <= x0 || y1 <= y0) return full;
+
+	VideoCrop out;
+	out.x = x0;
+	out.y = y0;
+	out.width = x1 - x0;
+	out.height = y1 - y0;
+	return out;
+}
+
+CropRegion crop_region(const VideoCrop& crop, int frame_w, int frame_h) {
+	CropRegion region;
+	if (frame_w <= 0 || frame_h <= 0) return region;
+	const VideoCrop c = effective_crop(crop, frame_w, frame_h);
+	region.x = static_cast<float>(c.x) / frame_w;
+	region.y = static_cast<float>(c.y) / frame_h;
+	region.width = static_cast<float>(c.width) / frame_w;
+	region.height = static_cast<float>(c.height) / frame_h;
+	return region;
+}
@@ -0,0 +1,38 @@
+// Visible region of a decoded picture (letterbox / encoder margin crop).
+#pragma once
+
+// In decoded pixels. An empty crop means the whole picture.
+struct VideoCrop {
+	int x = 0;
+	int y = 0;
+	int width = 0;
+	int height = 0;
+
+	bool empty() const { return width <= 0 || height <= 0; }
+	bool operator==(const VideoCrop& o) const {
+		return x == o.x && y == o.y && width == o.width && height == o.height;
+	}
+	bool operator!=(const VideoCrop& o) const { return !(*this == o); }
+};
+
+// `crop` clamped to a frame_w x frame_h picture. The origin is rounded down
+// to even coordinates (keeping the right and bottom edges) so 4:2:0 chroma
+// planes crop on whole samples. An empty crop, or one outside the picture,
+// gives the whole picture.
+VideoCrop effective_crop(const VideoCrop& crop, int frame_w, int frame_h);
+
+// The effective crop as fractions of the picture, for mapping view
+// coordinates back to the full frame. {0, 0, 1, 1} without a crop.
+struct CropRegion {
+	float x = 0.0f;
+	float y = 0.0f;
+	float width = 1.0f;
+	float height = 1.0f;
+
+	bool operator==(const CropRegion& o) const {
+		return x == o.x && y == o.y && width == o.width && height == o.height;
+	}
+	bool operator!=(const CropRegion& o) const { return !(*this == o); }
+};
+
+CropRegion crop_region(const VideoCrop& crop, int frame_w, int frame_h);
@@ -0,0 +1,34 @@
+#include "video_decoder.h"
+#include "h264_decoder.h"
+#include "h265_decoder.h"
+#include "remote_decoder.h"
+#include "../common/Log.hpp"
+
+const char* codec_name(VideoCodec codec) {
+	return codec == VideoCodec::H265 ? "h265" : "h264";
+}
+
+bool parse_codec(const std::string& name, VideoCodec& out) {
+	if (name == "h264" || name == "avc") {
+		out = VideoCodec::H264;
+		return true;
+	}
+	if (name == "h265" || name == "hevc") {
+		out = VideoCodec::H265;
+		return true;
+	}
+	return false;
+}
+
+std::unique_ptr<VideoDecoder> make_video_decoder(VideoCodec codec) {
+	const DecodeWorkerOptions worker = pipeline_config().worker;
+	if (worker.enabled) {
+		try {
+			return std::make_unique<RemoteDecoder>(codec, worker);
+		} catch (const std::exception& e) {
+			OA_LOG(Warn, "VideoDecoder", "{}; decoding {} in-process", e.what(), codec_name(codec));
+		}
+	}
+	if (codec == VideoCodec::H265) return std::make_unique<H265Decoder>();
+	return std::make_unique<H264Decoder>();
+}
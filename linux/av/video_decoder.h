@@ -0,0 +1,101 @@
+// Codec-agnostic compressed video -> YUV420P (I420) decoder interface.
+#pragma once
+
+#include "pipeline_config.h"
+#include "yuv_convert.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class VideoCodec : uint8_t { H264, H265 };
+
+const char* codec_name(VideoCodec codec);
+// Accepts "h264"/"avc" and "h265"/"hevc".
+bool parse_codec(const std::string& name, VideoCodec& out);
+
+class VideoDecoder {
+public:
+	virtual ~VideoDecoder() = default;
+
+	virtual VideoCodec codec() const = 0;
+
+	// Apply new settings. Codec settings reopen the decoder, which then
+	// waits for the next IDR. Returns false if reopening failed.
+	virtual bool set_options(const DecoderOptions& options) = 0;
+
+	// Decode to planar YUV420P (I420) and return data packed as [Y][U][V].
+	// out_yuv size will be width*height*3/2 on success. Accepts Annex-B or
+	// 4-byte length-prefixed access units; a codec config record (avcC/hvcC)
+	// or a parameter-set-only payload is stored and returns false.
+	//
+	// After a decode error (or a frame flagged corrupt) the decoder flushes and
+	// drops input until the next IDR, which gets the stored parameter sets
+	// re-injected in front of it; see DecodeRecovery. Nothing is output
+	// meanwhile, so the last good frame stays on screen.
+	virtual bool decode_to_yuv420p(const uint8_t* data,
+								   size_t size,
+								   std::vector<uint8_t>& out_yuv,
+								   int& out_width,
+								   int& out_height) = 0;
+
+	// Called from the decoding thread, rate limited, while waiting for an IDR
+	// after an error. Typically asks the producer for a keyframe.
+	using KeyframeRequestFn = std::function<void()>;
+	virtual void set_keyframe_request(KeyframeRequestFn fn) = 0;
+
+	// True between a decode error and the first clean frame after it.
+	// Lock-free, so the metrics collector never waits for a decode.
+	virtual bool recovering() const = 0;
+
+	// The producer started a new session (e.g. the transport reconnected):
+	// drop reference pictures and wait for its first keyframe, holding the
+	// last frame. Parameter sets seen so far are kept and re-sent with that
+	// keyframe, so it decodes even if the new session does not repeat them.
+	virtual void reset_session() = 0;
+
+	// Packets were dropped before reaching the decoder because the stream
+	// fell behind: flush and wait for the next keyframe (asking for one) as
+	// after a decode error. Decoding thread, in order with the packets.
+	virtual void skip_to_keyframe() = 0;
+
+	// While enabled only keyframes are decoded (libavcodec skip_frame =
+	// AVDISCARD_NONKEY); other access units are dropped after a header scan,
+	// before they reach the codec. For streams nobody is looking at. After
+	// disabling, the decoder waits for the next keyframe (and asks for one),
+	// since the pictures in between reference the skipped ones. Any thread.
+	virtual void set_keyframes_only(bool enable) = 0;
+
+	// Picture size from the newest SPS (config record or in-band), known
+	// before the first picture decodes. False until one has been parsed.
+	virtual bool announced_size(int& width, int& height) const = 0;
+
+	// A decoded I420 picture left in memory the decoder owns. `hold` keeps it
+	// valid and hands the memory back when the last copy goes.
+	struct SharedPicture {
+		I420Planes planes;
+		int width = 0;
+		int height = 0;
+		std::shared_ptr<const void> hold;
+	};
+
+	// Decoders whose pictures already sit in memory that can be handed out
+	// (the decode worker's frame slots, libavcodec's pooled frame buffers)
+	// return them through decode_shared() instead of copying them out;
+	// otherwise use decode_to_yuv420p().
+	virtual bool shares_output() const { return false; }
+	virtual bool decode_shared(const uint8_t* data, size_t size, SharedPicture& out) {
+		(void)data;
+		(void)size;
+		(void)out;
+		return false;
+	}
+};
+
+// Starts with pipeline_config().decoder. A RemoteDecoder when
+// pipeline_config().worker is enabled and the worker starts, else in-process.
+// Throws std::runtime_error if libavcodec lacks the codec.
+std::unique_ptr<VideoDecoder> make_video_decoder(VideoCodec codec);
@@ -0,0 +1,459 @@
+#include "video_stream.h"
+#include "metrics_server.h"
+#include "pipeline_stats.h"
+#include "remote_decoder.h"
+#include "startup_timeline.h"
+#include "yuv_convert.h"
+#include "../common/Log.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <exception>
+
+namespace {
+
+int64_t steady_now_us() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Helper: find first Annex-B start code (3 or 4 bytes).
+size_t find_start_code(const uint8_t* p, size_t n) {
+	for (size_t i = 0; i + 3 < n; ++i) {
+		if (p[i] == 0 && p[i + 1] == 0 && ((p[i + 2] == 1) || (p[i + 2] == 0 && p[i + 3] == 1))) {
+			return i;
+		}
+	}
+	return n;
+}
+
+// Locate the access unit in a received packet: strip the common OAT framing
+// [u64 ts][u32 payload_size][payload...], else any leading bytes before the
+// first start code (e.g., 4-byte length + nonce).
+const uint8_t* find_payload(const uint8_t* data, size_t size, size_t& payload_size, uint32_t& declared, bool& stripped) {
+	const uint8_t* payload = data;
+	payload_size = size;
+	stripped = false;
+	declared = 0;
+	if (size >= sizeof(uint64_t) + sizeof(uint32_t)) {
+		std::memcpy(&declared, data + sizeof(uint64_t), sizeof(uint32_t));
+		if (declared > 0 && declared <= size - (sizeof(uint64_t) + sizeof(uint32_t))) {
+			payload = data + sizeof(uint64_t) + sizeof(uint32_t);
+			payload_size = declared;
+			stripped = true;
+		}
+	}
+	if (!stripped) {
+		size_t idx = find_start_code(payload, payload_size);
+		if (idx != 0 && idx < payload_size) {
+			payload += idx;
+			payload_size -= idx;
+			stripped = true;
+		}
+	}
+	return payload;
+}
+
+// Whether dropping the packet only loses pictures up to the next IDR: an
+// Annex-B access unit with neither an IDR nor parameter sets. Config records
+// and length-prefixed units are always kept.
+bool droppable_packet(VideoCodec codec, const uint8_t* data, size_t size) {
+	size_t payload_size = 0;
+	uint32_t declared = 0;
+	bool stripped = false;
+	const uint8_t* payload = find_payload(data, size, payload_size, declared, stripped);
+	if (payload_size == 0 || find_start_code(payload, payload_size) != 0) return false;
+	const AccessUnitInfo au = codec == VideoCodec::H265 ? scan_h265_access_unit(payload, payload_size)
+														: scan_h264_access_unit(payload, payload_size);
+	return !au.idr && !au.parameter_sets;
+}
+
+// Queue depth at which a stream is clearly not keeping up.
+constexpr size_t kBacklogWarn = 60;
+// Queue depth at which queued non-IDR packets are dropped and the decoder
+// skips to the next keyframe; two seconds at 60 fps.
+constexpr size_t kBacklogLimit = 120;
+
+// GDestroyNotify for a frame lent to the texture.
+void release_frame(gpointer data) {
+	delete static_cast<VideoFramePtr*>(data);
+}
+
+} // namespace
+
+void VideoFrameState::ingest_packet(const uint8_t* data, size_t size, VideoDecoder& decoder, int64_t recv_us) {
+	if (!data || size == 0) return;
+
+	const int64_t now_us = recv_us > 0 ? recv_us : steady_now_us();
+
+	size_t payload_size = 0;
+	uint32_t declared = 0;
+	bool stripped = false;
+	const uint8_t* payload = find_payload(data, size, payload_size, declared, stripped);
+
+	PipelineStats& stats = pipeline_stats();
+	StartupTimeline& timeline = startup_timeline();
+	timeline.mark(Milestone::FirstVideoPacket, now_us);
+	stats.video_packets.fetch_add(1, std::memory_order_relaxed);
+	stats.video_bytes.fetch_add(payload_size, std::memory_order_relaxed);
+	analyzer_.on_access_unit(decoder.codec(), payload, payload_size, now_us);
+
+	OA_LOG_FIRST_N(Info, 8, "VideoFrameState", "in_size={} payload_size={} stripped={} head={}",
+				   size, payload_size, stripped, oa_log::hex(payload, payload_size, 24));
+
+	std::shared_ptr<VideoFrame> frame = spare_ ? std::move(spare_) : std::make_shared<VideoFrame>();
+	frame->shared = VideoDecoder::SharedPicture();
+	bool decoded = false;
+	if (decoder.shares_output()) {
+		decoded = decoder.decode_shared(payload, payload_size, frame->shared);
+		frame->width = frame->shared.width;
+		frame->height = frame->shared.height;
+	} else {
+		decoded = decoder.decode_to_yuv420p(payload, payload_size, frame->yuv, frame->width, frame->height);
+	}
+
+	int announced_w = 0, announced_h = 0;
+	if (decoder.announced_size(announced_w, announced_h)) {
+		const uint64_t packed = (static_cast<uint64_t>(announced_w) << 32) | static_cast<uint32_t>(announced_h);
+		if (announced_.exchange(packed, std::memory_order_relaxed) != packed) {
+			timeline.mark(Milestone::ParameterSets);
+			if (!decoded && !decoder.shares_output()) {
+				// Size the next output buffer now rather than on the first IDR.
+				frame->yuv.reserve(static_cast<size_t>(announced_w) * announced_h * 3 / 2);
+			}
+		}
+	}
+	if (!decoded) {
+		spare_ = std::move(frame);
+		stats.decode_failures.fetch_add(1, std::memory_order_relaxed);
+		OA_LOG_FIRST_N(Info, 8, "VideoFrameState", "decode failed size={} declared={}", payload_size, declared);
+		return;
+	}
+	if (want_rgba_.load(std::memory_order_relaxed)) {
+		frame->rgba.resize(static_cast<size_t>(frame->width) * frame->height * 4);
+		i420_to_rgba(frame->planes(), frame->width, frame->height, frame->rgba.data(),
+					 static_cast<size_t>(frame->width) * 4, default_color_space(frame->width, frame->height));
+	}
+	frame->recv_ts_us = now_us;
+	frame->decode_ts_us = steady_now_us();
+	stats.frames_decoded.fetch_add(1, std::memory_order_relaxed);
+	timeline.mark(Milestone::FirstFrameDecoded, frame->decode_ts_us);
+	stats.last_decode_us.store(frame->decode_ts_us - now_us, std::memory_order_relaxed);
+	stats.decode_latency.record(frame->decode_ts_us - now_us);
+	stats.width.store(frame->width, std::memory_order_relaxed);
+	stats.height.store(frame->height, std::memory_order_relaxed);
+	OA_LOG_FIRST_N(Info, 8, "VideoFrameState", "decoded {}x{} in {}", frame->width, frame->height,
+				   frame->shared.hold ? "decoder memory" : "a copy");
+	tap_.offer(frame->planes(), frame->width, frame->height, frame->decode_ts_us);
+	frame_bytes_.store(frame->yuv.capacity() + frame->rgba.capacity(), std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> lk(mutex_);
+	latest_ = std::move(frame);
+	has_new_ = true;
+}
+
+bool VideoFrameState::announced_size(int& width, int& height) const {
+	const uint64_t packed = announced_.load(std::memory_order_relaxed);
+	if (packed == 0) return false;
+	width = static_cast<int>(packed >> 32);
+	height = static_cast<int>(packed & 0xFFFFFFFFu);
+	return true;
+}
+
+VideoFramePtr VideoFrameState::take_latest() {
+	std::lock_guard<std::mutex> lk(mutex_);
+	if (!has_new_ || !latest_ || !latest_->has_picture()) {
+		return nullptr;
+	}
+	has_new_ = false;
+	return latest_;
+}
+
+VideoStream::VideoStream(int64_t id, DecodePool& pool, VideoCodec codec)
+	: id_(id),
+	  decoder_(make_video_decoder(codec)),
+	  frame_state_(std::make_shared<VideoFrameState>(id)),
+	  strand_(pool.make_strand()) {
+	register_frame_tap(std::shared_ptr<FrameTap>(frame_state_, &frame_state_->tap()));
+	metrics_id_ = add_metrics_collector([this](MetricsWriter& writer) { collect_metrics(writer); });
+}
+
+VideoStream::~VideoStream() {
+	remove_metrics_collector(metrics_id_);
+	unregister_frame_tap(frame_state_->tap());
+	for (auto& view : views_) g_object_unref(view.second);
+	if (texture_) g_object_unref(texture_);
+}
+
+VideoCodec VideoStream::codec() const {
+	return std::atomic_load(&decoder_)->codec();
+}
+
+bool VideoStream::set_codec(VideoCodec codec) {
+	auto current = std::atomic_load(&decoder_);
+	if (current->codec() == codec) return true;
+	std::shared_ptr<VideoDecoder> next;
+	try {
+		next = make_video_decoder(codec);
+	} catch (const std::exception& e) {
+		OA_LOG(Error, "VideoStream", "stream {}: cannot create {} decoder: {}", id_, codec_name(codec), e.what());
+		return false;
+	}
+	if (keyframe_request_) next->set_keyframe_request(keyframe_request_);
+	if (!visible_) next->set_keyframes_only(true);
+	std::atomic_store(&decoder_, next);
+	OA_LOG(Info, "VideoStream", "stream {} switched to {}", id_, codec_name(codec));
+	return true;
+}
+
+void VideoStream::set_keyframe_request(VideoDecoder::KeyframeRequestFn fn) {
+	keyframe_request_ = fn;
+	std::atomic_load(&decoder_)->set_keyframe_request(std::move(fn));
+}
+
+bool VideoStream::set_decoder_options(const DecoderOptions& options) {
+	return std::atomic_load(&decoder_)->set_options(options);
+}
+
+int64_t VideoStream::attach_texture(FlTextureRegistrar* registrar) {
+	if (texture_) return texture_id_;
+	texture_ = oa_video_texture_new(1, 1);
+	texture_id_ = oa_video_texture_register(texture_, registrar);
+	registrar_ = registrar;
+	if (texture_id_ != 0 && visibility_.add(texture_id_)) apply_visibility();
+	return texture_id_;
+}
+
+int64_t VideoStream::add_view() {
+	if (!texture_ || !registrar_) return 0;
+	OAVideoTexture* view = oa_video_texture_new_shared(texture_);
+	const int64_t id = view ? oa_video_texture_register(view, registrar_) : 0;
+	if (id == 0) {
+		if (view) g_object_unref(view);
+		return 0;
+	}
+	views_.emplace_back(id, view);
+	// A new view is on screen until told otherwise.
+	if (visibility_.add(id)) apply_visibility();
+	return id;
+}
+
+bool VideoStream::remove_view(int64_t texture_id) {
+	for (auto it = views_.begin(); it != views_.end(); ++it) {
+		if (it->first != texture_id) continue;
+		if (registrar_) fl_texture_registrar_unregister_texture(registrar_, FL_TEXTURE(it->second));
+		g_object_unref(it->second);
+		views_.erase(it);
+		if (visibility_.remove(texture_id)) apply_visibility();
+		return true;
+	}
+	return false;
+}
+
+bool VideoStream::set_display_size(int64_t texture_id, int width, int height) {
+	OAVideoTexture* target = (texture_ && texture_id == texture_id_) ? texture_ : nullptr;
+	for (auto& view : views_) {
+		if (view.first == texture_id) target = view.second;
+	}
+	if (!target) return false;
+	oa_video_texture_set_display_size(target, width, height);
+	// Re-render the retained frame at the new size.
+	if (registrar_) oa_video_texture_mark_frame_available(target, registrar_);
+	return true;
+}
+
+bool VideoStream::set_texture_visible(int64_t texture_id, bool visible) {
+	if (!visibility_.known(texture_id)) return false;
+	if (visibility_.set(texture_id, visible)) apply_visibility();
+	return true;
+}
+
+void VideoStream::apply_visibility() {
+	const bool visible = visibility_.visible();
+	visible_ = visible;
+	std::atomic_load(&decoder_)->set_keyframes_only(!visible);
+	OA_LOG(Info, "VideoStream", "stream {} {}", id_, visible ? "visible" : "hidden; decoding keyframes only");
+}
+
+void VideoStream::set_crop(const VideoCrop& crop) {
+	crop_ = crop;
+	if (texture_) {
+		oa_video_texture_set_crop(texture_, crop.x, crop.y, crop.width, crop.height);
+		if (registrar_) {
+			oa_video_texture_mark_frame_available(texture_, registrar_);
+			for (auto& view : views_) oa_video_texture_mark_frame_available(view.second, registrar_);
+		}
+	}
+	update_region();
+}
+
+void VideoStream::set_region_listener(RegionFn fn) {
+	region_listener_ = std::move(fn);
+	if (region_listener_) region_listener_(region_);
+}
+
+void VideoStream::update_region() {
+	const CropRegion region = crop_region(crop_, frame_w_, frame_h_);
+	if (region == region_) return;
+	region_ = region;
+	if (region_listener_) region_listener_(region_);
+}
+
+void VideoStream::reset_session() {
+	if (closed_.load(std::memory_order_acquire)) return;
+	std::weak_ptr<VideoStream> weak = weak_from_this();
+	strand_->post([weak]() {
+		auto self = weak.lock();
+		if (!self || self->closed_.load(std::memory_order_acquire)) return;
+		std::atomic_load(&self->decoder_)->reset_session();
+	});
+}
+
+void VideoStream::submit(const uint8_t* data, size_t size) {
+	if (!data || size == 0 || closed_.load(std::memory_order_acquire)) return;
+
+	const int64_t recv_us = steady_now_us();
+	auto packet = std::make_shared<std::vector<uint8_t>>(data, data + size);
+	auto decoder = std::atomic_load(&decoder_);
+	auto state = frame_state_;
+	std::weak_ptr<VideoStream> weak = weak_from_this();
+	strand_->post(
+		[weak, decoder, state, packet, recv_us]() {
+			auto self = weak.lock();
+			if (!self || self->closed_.load(std::memory_order_acquire)) return;
+			state->ingest_packet(packet->data(), packet->size(), *decoder, recv_us);
+		},
+		droppable_packet(decoder->codec(), data, size));
+
+	const size_t backlog = strand_->pending();
+	if (backlog < kBacklogWarn) return;
+	if (backlog < kBacklogLimit) {
+		OA_LOG_RATE(Warn, 1, "VideoStream", "stream {} decode backlog {} packets", id_, backlog);
+		return;
+	}
+	// Decoding cannot keep up: rather than fall further behind, drop what
+	// only leads up to the next keyframe and wait for that one.
+	auto skip = [weak, decoder]() {
+		auto self = weak.lock();
+		if (!self || self->closed_.load(std::memory_order_acquire)) return;
+		decoder->skip_to_keyframe();
+	};
+	size_t dropped = strand_->shed(skip);
+	if (dropped == 0) {
+		// Nothing but keyframes and parameter sets queued; start over.
+		dropped = strand_->clear();
+		strand_->post(skip);
+	}
+	pipeline_stats().frames_discarded.fetch_add(dropped, std::memory_order_relaxed);
+	OA_LOG_RATE(Warn, 1, "VideoStream", "stream {} decode backlog {} packets; dropped {} and waiting for a keyframe",
+				id_, backlog, dropped);
+}
+
+size_t VideoStream::pending() const {
+	return strand_->pending();
+}
+
+bool VideoStream::wait_pending(size_t max_pending, std::chrono::milliseconds timeout) {
+	return strand_->wait_pending(max_pending, timeout);
+}
+
+bool VideoStream::present() {
+	if (!texture_ || !registrar_ || !visible_) return false;
+	if (!frame_state_->want_rgba() && oa_video_texture_wants_rgba(texture_)) {
+		// Converted on the decode threads from the next frame on.
+		OA_LOG(Info, "VideoStream", "stream {}: converting frames to RGBA on the CPU ({})", id_, i420_to_rgba_impl());
+		frame_state_->set_want_rgba(true);
+	}
+	int announced_w = 0, announced_h = 0;
+	if (frame_state_->announced_size(announced_w, announced_h) &&
+		(announced_w != prepared_w_ || announced_h != prepared_h_)) {
+		prepared_w_ = announced_w;
+		prepared_h_ = announced_h;
+		oa_video_texture_prepare(texture_, announced_w, announced_h);
+		oa_video_texture_mark_frame_available(texture_, registrar_);
+	}
+	VideoFramePtr frame = frame_state_->take_latest();
+	if (!frame) return false;
+
+	if (!frame->rgba.empty()) {
+		oa_video_texture_set_frame(texture_,
+								   reinterpret_cast<const guint8*>(frame->rgba.data()),
+								   static_cast<gsize>(frame->rgba.size()),
+								   frame->width,
+								   frame->height);
+	} else {
+		// The texture reads the planes where the decoder left them and holds
+		// the frame until the next one replaces it.
+		const I420Planes planes = frame->planes();
+		oa_video_texture_set_yuv420p_planes(texture_, planes.data, planes.stride, frame->width, frame->height,
+											release_frame, new VideoFramePtr(frame));
+	}
+	oa_video_texture_mark_frame_available(texture_, registrar_);
+	for (auto& view : views_) oa_video_texture_mark_frame_available(view.second, registrar_);
+	if (frame->width != frame_w_ || frame->height != frame_h_) {
+		frame_w_ = frame->width;
+		frame_h_ = frame->height;
+		update_region();
+	}
+
+	const int64_t now_us = steady_now_us();
+	PipelineStats& stats = pipeline_stats();
+	stats.frames_presented.fetch_add(1, std::memory_order_relaxed);
+	startup_timeline().mark(Milestone::FirstFramePresented, now_us);
+	if (frame->recv_ts_us > 0) {
+		stats.last_present_us.store(now_us - frame->recv_ts_us, std::memory_order_relaxed);
+		stats.present_latency.record(now_us - frame->recv_ts_us);
+	}
+
+	const double decode_ms = (frame->decode_ts_us - frame->recv_ts_us) / 1000.0;
+	const double upload_ms = (now_us - frame->decode_ts_us) / 1000.0;
+	const double total_ms = (now_us - frame->recv_ts_us) / 1000.0;
+	OA_LOG_EVERY_N(Info, 60, "Timing", "stream={} decode_ms={} upload_ms={} total_ms={} size={}x{}",
+				   id_, decode_ms, upload_ms, total_ms, frame->width, frame->height);
+	return true;
+}
+
+void VideoStream::close(bool unregister_texture) {
+	closed_.store(true, std::memory_order_release);
+	strand_->clear();
+	unregister_frame_tap(frame_state_->tap());
+	remove_metrics_collector(metrics_id_);
+	if (registrar_ && unregister_texture) {
+		for (auto& view : views_) fl_texture_registrar_unregister_texture(registrar_, FL_TEXTURE(view.second));
+		if (texture_) fl_texture_registrar_unregister_texture(registrar_, FL_TEXTURE(texture_));
+	}
+	registrar_ = nullptr;
+}
+
+void VideoStream::collect_metrics(MetricsWriter& writer) const {
+	const MetricsWriter::Labels stream = {{"stream", std::to_string(id_)}};
+	const auto decoder = std::atomic_load(&decoder_);
+	const auto* remote = dynamic_cast<const RemoteDecoder*>(decoder.get());
+	writer.gauge("oaf_stream_decoder_info", "Decoder of each stream; always 1", 1,
+				 {stream[0], {"codec", codec_name(decoder->codec())}, {"process", remote ? "worker" : "plugin"}});
+	writer.gauge("oaf_stream_decoder_recovering", "1 while waiting for a keyframe after a decode error",
+				 decoder->recovering() ? 1 : 0, stream);
+	if (remote) {
+		writer.counter("oaf_decode_worker_restarts_total", "Decode worker restarts after a crash or hang",
+					   remote->restarts(), stream);
+	}
+	writer.gauge("oaf_stream_visible", "1 while one of the stream's textures is on screen",
+				 visible_.load(std::memory_order_relaxed) ? 1 : 0, stream);
+	writer.gauge("oaf_stream_decode_queue_depth", "Packets queued for the stream's decode strand",
+				 static_cast<double>(strand_->pending()), stream);
+
+	const FrameTap& tap = frame_state_->tap();
+	writer.counter("oaf_frame_tap_published_total", "Frames published by the frame tap", tap.published(), stream);
+	writer.counter("oaf_frame_tap_skipped_total", "Frames the frame tap skipped because readers held every buffer",
+				   tap.skipped(), stream);
+
+	const char* kMemoryHelp = "Memory held per pipeline stage";
+	writer.gauge("oaf_memory_bytes", kMemoryHelp, static_cast<double>(frame_state_->frame_bytes()),
+				 {stream[0], {"stage", "decoded_frame"}});
+	writer.gauge("oaf_memory_bytes", kMemoryHelp, static_cast<double>(tap.held_bytes()),
+				 {stream[0], {"stage", "frame_tap"}});
+	if (remote) {
+		writer.gauge("oaf_memory_bytes", kMemoryHelp, static_cast<double>(remote->shared_bytes()),
+					 {stream[0], {"stage", "decode_worker_shm"}});
+	}
+}
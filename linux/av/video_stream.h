@@ -0,0 +1,211 @@
+// One video pipeline: decoder, latest-frame slot and Flutter texture.
+#pragma once
+
+#include "bitstream_analyzer.h"
+#include "decode_pool.h"
+#include "frame_tap.h"
+#include "texture_visibility.h"
+#include "video_crop.h"
+#include "video_decoder.h"
+#include "oa_video_texture.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// A decoded I420 picture, shared read-only between decoder and presenter.
+struct VideoFrame {
+	std::vector<uint8_t> yuv; // packed YUV420P [Y][U][V]
+	// Instead of `yuv` when the picture stays in decoder-owned memory; see
+	// VideoDecoder::decode_shared().
+	VideoDecoder::SharedPicture shared;
+	std::vector<uint8_t> rgba; // CPU-converted copy, only while the texture wants RGBA
+	int width = 0;
+	int height = 0;
+	int64_t recv_ts_us = 0;   // when the packet was received
+	int64_t decode_ts_us = 0; // when decode completed
+
+	bool has_picture() const {
+		return width > 0 && height > 0 &&
+			   (shared.hold || yuv.size() >= static_cast<size_t>(width) * height * 3 / 2);
+	}
+	I420Planes planes() const {
+		return shared.hold ? shared.planes : i420_packed_planes(yuv.data(), width, height);
+	}
+};
+
+using VideoFramePtr = std::shared_ptr<const VideoFrame>;
+
+// Latest decoded frame of a stream. Decode workers publish, the main thread
+// takes; older unpresented frames are simply replaced.
+class VideoFrameState {
+public:
+	explicit VideoFrameState(int64_t stream_id = 0) : tap_(stream_id) {}
+
+	// Extract payload (optionally strip 8-byte ts + 4-byte payload header) and decode.
+	void ingest_packet(const uint8_t* data, size_t size, VideoDecoder& decoder, int64_t recv_us = 0);
+	// The newest frame not yet taken, or null.
+	VideoFramePtr take_latest();
+
+	// Picture size announced by the decoder's newest SPS, before the first
+	// frame of that size decodes. Any thread.
+	bool announced_size(int& width, int& height) const;
+
+	// Also convert each decoded frame to RGBA on the decode thread, for a
+	// texture whose GL conversion failed.
+	void set_want_rgba(bool want) { want_rgba_.store(want, std::memory_order_relaxed); }
+	bool want_rgba() const { return want_rgba_.load(std::memory_order_relaxed); }
+
+	const BitstreamAnalyzer& analyzer() const { return analyzer_; }
+	// Offered every decoded frame; see FrameTap.
+	FrameTap& tap() { return tap_; }
+	const FrameTap& tap() const { return tap_; }
+
+	// Heap bytes of the newest decoded frame's I420 and RGBA buffers
+	// (pictures left in decoder memory not included). Any thread.
+	size_t frame_bytes() const { return frame_bytes_.load(std::memory_order_relaxed); }
+
+private:
+	BitstreamAnalyzer analyzer_;
+	FrameTap tap_;
+	std::atomic<bool> want_rgba_{false};
+	std::atomic<uint64_t> announced_{0}; // width << 32 | height
+	std::atomic<size_t> frame_bytes_{0};
+	// Decode strand only: output frame allocated ahead from the announced
+	// size, or kept from a packet that produced no picture.
+	std::shared_ptr<VideoFrame> spare_;
+	std::mutex mutex_;
+	VideoFramePtr latest_;
+	bool has_new_ = false;
+};
+
+class MetricsWriter;
+
+class VideoStream : public std::enable_shared_from_this<VideoStream> {
+public:
+	VideoStream(int64_t id, DecodePool& pool, VideoCodec codec = VideoCodec::H264);
+	~VideoStream();
+
+	VideoStream(const VideoStream&) = delete;
+	VideoStream& operator=(const VideoStream&) = delete;
+
+	int64_t id() const { return id_; }
+	VideoCodec codec() const;
+
+	// Switch the stream to another codec, e.g. after the head unit negotiated
+	// HEVC. Packets already queued finish on the old decoder; the new one
+	// waits for a config and keyframe. False if libavcodec lacks the codec.
+	// Main thread.
+	bool set_codec(VideoCodec codec);
+
+	// Create and register the stream's texture. Returns the Flutter texture id
+	// (0 on failure). Main thread.
+	int64_t attach_texture(FlTextureRegistrar* registrar);
+	int64_t texture_id() const { return texture_id_; }
+
+	// Register another texture showing this stream. It shares the primary
+	// texture's GL planes and converted RGBA texture, so decode, upload and
+	// conversion happen once per frame regardless of the number of views.
+	// Returns the Flutter texture id (0 on failure). Main thread.
+	int64_t add_view();
+	// Unregister a texture added with add_view(). Main thread.
+	bool remove_view(int64_t texture_id);
+	size_t view_count() const { return views_.size(); }
+
+	// Forward the on-screen size of one of this stream's textures (primary or
+	// view) so conversion renders at that size. Returns false if texture_id
+	// does not belong to this stream. Main thread.
+	bool set_display_size(int64_t texture_id, int width, int height);
+
+	// Whether one of this stream's textures (primary or view) is on screen.
+	// While none is, the decoder only decodes keyframes and present() does
+	// nothing, leaving the newest keyframe to be shown as soon as a texture
+	// is visible again. Returns false if texture_id does not belong to this
+	// stream. Main thread.
+	bool set_texture_visible(int64_t texture_id, bool visible);
+	bool visible() const { return visible_; }
+
+	// Show only `crop` of each decoded frame (empty shows it all), e.g. to
+	// cut away the margins a head unit adds around the projected screen.
+	// Applies to every view of the stream. Main thread.
+	void set_crop(const VideoCrop& crop);
+	VideoCrop crop() const { return crop_; }
+
+	// Called on the main thread with the shown part of the picture, as
+	// fractions of the decoded frame, whenever the crop or frame size changes
+	// it; used to map touches on the view back to the full remote screen.
+	using RegionFn = std::function<void(const CropRegion& region)>;
+	void set_region_listener(RegionFn fn);
+
+	// Invoked on a decode thread, rate limited, while the decoder waits for an
+	// IDR after an error. Set before packets flow.
+	void set_keyframe_request(VideoDecoder::KeyframeRequestFn fn);
+	// See VideoDecoder::set_options().
+	bool set_decoder_options(const DecoderOptions& options);
+
+	// The producer started a new session (transport reconnect). Queued in
+	// order with the packets: the decoder then waits for the new session's
+	// keyframe, re-sending the cached parameter sets, while the texture keeps
+	// the last frame. Any thread.
+	void reset_session();
+
+	// Copy the packet and decode it on the pool. Packets of one stream are
+	// decoded in submission order; different streams decode in parallel.
+	// When decoding falls too far behind, queued packets other than IDRs and
+	// parameter sets are dropped (counted as frames_discarded) and the
+	// decoder waits for the next keyframe, so the queue stays bounded.
+	void submit(const uint8_t* data, size_t size);
+	size_t pending() const;
+	// Block until at most `max_pending` packets wait for the decoder; false
+	// on timeout. For replay, which may wait where the transport may not.
+	bool wait_pending(size_t max_pending, std::chrono::milliseconds timeout);
+
+	// What the producer is sending, measured on the packets as they are
+	// decoded. Any thread.
+	BitstreamStats bitstream_stats() const { return frame_state_->analyzer().stats(); }
+
+	// Decoded frames for analytics, off until configured. Registered under
+	// the stream id (find_frame_tap) until close(). Any thread.
+	FrameTap& frame_tap() { return frame_state_->tap(); }
+
+	// Upload the newest decoded frame to the texture, if any. Main thread.
+	bool present();
+
+	// Stop accepting packets and drop queued ones. With unregister_texture the
+	// texture is also removed from the registrar. Main thread.
+	void close(bool unregister_texture);
+
+private:
+	void update_region();
+	// After `visibility_` flipped: follow it with the decoder.
+	void apply_visibility();
+	// Metrics thread; reads atomics only.
+	void collect_metrics(MetricsWriter& writer) const;
+
+	const int64_t id_;
+	std::shared_ptr<VideoDecoder> decoder_; // replaced by set_codec(); std::atomic_load/store
+	VideoDecoder::KeyframeRequestFn keyframe_request_; // carried over to a new decoder
+	std::shared_ptr<VideoFrameState> frame_state_;
+	std::shared_ptr<DecodePool::Strand> strand_;
+	OAVideoTexture* texture_ = nullptr;
+	std::vector<std::pair<int64_t, OAVideoTexture*>> views_; // texture id -> shared-surface texture
+	FlTextureRegistrar* registrar_ = nullptr;
+	int64_t texture_id_ = 0;
+	int prepared_w_ = 0; // size the texture was last prepared for
+	int prepared_h_ = 0;
+	TextureVisibility visibility_;
+	std::atomic<bool> visible_{true}; // visibility_.visible(), read by the metrics collector
+	VideoCrop crop_;
+	int frame_w_ = 0; // size of the last presented frame
+	int frame_h_ = 0;
+	CropRegion region_;
+	RegionFn region_listener_;
+	std::atomic<bool> closed_{false};
+	int metrics_id_ = 0; // add_metrics_collector
+};
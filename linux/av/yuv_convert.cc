@@ -0,0 +1,282 @@
+#include "yuv_convert.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define OA_YUV_X86 1
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define OA_YUV_NEON 1
+#endif
+
+namespace {
+
+// Fixed point shared by every implementation so they agree bit for bit:
+// samples become int16 `(x - offset) << 7`, coefficients are Q13, and a
+// signed 16x16 high multiply leaves each term in Q4.
+struct Coefficients {
+	int16_t y_offset;
+	int16_t cy, crv, cgu, cgv, cbu; // cgu/cgv are negative
+};
+
+struct FloatCoefficients {
+	double cy, crv, cgu, cgv, cbu;
+	double y_offset; // in 8-bit units
+};
+
+FloatCoefficients float_coefficients(YuvColorSpace cs) {
+	const double kr = cs.matrix == YuvMatrix::Bt709 ? 0.2126 : 0.299;
+	const double kb = cs.matrix == YuvMatrix::Bt709 ? 0.0722 : 0.114;
+	const double kg = 1.0 - kr - kb;
+	const double y_scale = cs.full_range ? 1.0 : 255.0 / 219.0;
+	const double c_scale = cs.full_range ? 1.0 : 255.0 / 224.0;
+	FloatCoefficients f;
+	f.cy = y_scale;
+	f.crv = 2.0 * (1.0 - kr) * c_scale;
+	f.cgu = -2.0 * kb * (1.0 - kb) / kg * c_scale;
+	f.cgv = -2.0 * kr * (1.0 - kr) / kg * c_scale;
+	f.cbu = 2.0 * (1.0 - kb) * c_scale;
+	f.y_offset = cs.full_range ? 0.0 : 16.0;
+	return f;
+}
+
+Coefficients coefficients(YuvColorSpace cs) {
+	const FloatCoefficients f = float_coefficients(cs);
+	auto q13 = [](double c) { return static_cast<int16_t>(std::lround(c * 8192.0)); };
+	return Coefficients{static_cast<int16_t>(f.y_offset), q13(f.cy), q13(f.crv), q13(f.cgu), q13(f.cgv), q13(f.cbu)};
+}
+
+inline int mulhi(int a, int b) { return (a * b) >> 16; }
+
+inline uint8_t clamp_q4(int v) { return static_cast<uint8_t>(std::clamp((v + 8) >> 4, 0, 255)); }
+
+// Pixels [x0, width) of one row.
+void row_scalar(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* out, int x0, int width,
+				const Coefficients& c) {
+	for (int x = x0; x < width; ++x) {
+		const int yy = mulhi((y[x] - c.y_offset) * 128, c.cy);
+		const int uu = (u[x / 2] - 128) * 128;
+		const int vv = (v[x / 2] - 128) * 128;
+		uint8_t* px = out + x * 4;
+		px[0] = clamp_q4(yy + mulhi(vv, c.crv));
+		px[1] = clamp_q4(yy + mulhi(uu, c.cgu) + mulhi(vv, c.cgv));
+		px[2] = clamp_q4(yy + mulhi(uu, c.cbu));
+		px[3] = 255;
+	}
+}
+
+using RowFn = int (*)(const uint8_t*, const uint8_t*, const uint8_t*, uint8_t*, int, const Coefficients&);
+
+#if OA_YUV_X86
+// Interleave 16 R, G, B bytes (plus opaque alpha) into 64 bytes of RGBA.
+inline void store_rgba16_sse2(uint8_t* out, __m128i r, __m128i g, __m128i b) {
+	const __m128i a = _mm_set1_epi8(static_cast<char>(0xFF));
+	const __m128i rg_lo = _mm_unpacklo_epi8(r, g);
+	const __m128i rg_hi = _mm_unpackhi_epi8(r, g);
+	const __m128i ba_lo = _mm_unpacklo_epi8(b, a);
+	const __m128i ba_hi = _mm_unpackhi_epi8(b, a);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi16(rg_lo, ba_lo));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_unpackhi_epi16(rg_lo, ba_lo));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 32), _mm_unpacklo_epi16(rg_hi, ba_hi));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 48), _mm_unpackhi_epi16(rg_hi, ba_hi));
+}
+
+// 8 pixels: Y as 8 int16, U/V already duplicated per pixel as 8 int16.
+inline void convert8_sse2(__m128i y, __m128i u, __m128i v, const Coefficients& c, __m128i& r, __m128i& g,
+						  __m128i& b) {
+	const __m128i round = _mm_set1_epi16(8);
+	y = _mm_slli_epi16(_mm_sub_epi16(y, _mm_set1_epi16(c.y_offset)), 7);
+	u = _mm_slli_epi16(_mm_sub_epi16(u, _mm_set1_epi16(128)), 7);
+	v = _mm_slli_epi16(_mm_sub_epi16(v, _mm_set1_epi16(128)), 7);
+	const __m128i yy = _mm_mulhi_epi16(y, _mm_set1_epi16(c.cy));
+	r = _mm_add_epi16(yy, _mm_mulhi_epi16(v, _mm_set1_epi16(c.crv)));
+	g = _mm_add_epi16(yy, _mm_add_epi16(_mm_mulhi_epi16(u, _mm_set1_epi16(c.cgu)),
+										_mm_mulhi_epi16(v, _mm_set1_epi16(c.cgv))));
+	b = _mm_add_epi16(yy, _mm_mulhi_epi16(u, _mm_set1_epi16(c.cbu)));
+	r = _mm_srai_epi16(_mm_add_epi16(r, round), 4);
+	g = _mm_srai_epi16(_mm_add_epi16(g, round), 4);
+	b = _mm_srai_epi16(_mm_add_epi16(b, round), 4);
+}
+
+// Returns the number of pixels converted (a multiple of 16).
+int row_sse2(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* out, int width, const Coefficients& c) {
+	const __m128i zero = _mm_setzero_si128();
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		const __m128i y8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x));
+		const __m128i u8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + x / 2));
+		const __m128i v8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + x / 2));
+		const __m128i uu = _mm_unpacklo_epi8(u8, u8); // each chroma sample covers two pixels
+		const __m128i vv = _mm_unpacklo_epi8(v8, v8);
+		__m128i r0, g0, b0, r1, g1, b1;
+		convert8_sse2(_mm_unpacklo_epi8(y8, zero), _mm_unpacklo_epi8(uu, zero), _mm_unpacklo_epi8(vv, zero), c, r0, g0,
+					  b0);
+		convert8_sse2(_mm_unpackhi_epi8(y8, zero), _mm_unpackhi_epi8(uu, zero), _mm_unpackhi_epi8(vv, zero), c, r1, g1,
+					  b1);
+		store_rgba16_sse2(out + x * 4, _mm_packus_epi16(r0, r1), _mm_packus_epi16(g0, g1), _mm_packus_epi16(b0, b1));
+	}
+	return x;
+}
+
+// packus works per 128-bit lane; gather the two 8-byte halves back in order.
+__attribute__((target("avx2"))) inline __m128i narrow_avx2(__m256i w) {
+	return _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packus_epi16(w, w), 0xD8));
+}
+
+__attribute__((target("avx2"))) int row_avx2(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* out,
+											  int width, const Coefficients& c) {
+	const __m256i round = _mm256_set1_epi16(8);
+	const __m256i y_off = _mm256_set1_epi16(c.y_offset);
+	const __m256i c_off = _mm256_set1_epi16(128);
+	const __m256i cy = _mm256_set1_epi16(c.cy);
+	const __m256i crv = _mm256_set1_epi16(c.crv);
+	const __m256i cgu = _mm256_set1_epi16(c.cgu);
+	const __m256i cgv = _mm256_set1_epi16(c.cgv);
+	const __m256i cbu = _mm256_set1_epi16(c.cbu);
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		const __m128i u8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + x / 2));
+		const __m128i v8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + x / 2));
+		__m256i yw = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x)));
+		__m256i uw = _mm256_cvtepu8_epi16(_mm_unpacklo_epi8(u8, u8));
+		__m256i vw = _mm256_cvtepu8_epi16(_mm_unpacklo_epi8(v8, v8));
+		yw = _mm256_slli_epi16(_mm256_sub_epi16(yw, y_off), 7);
+		uw = _mm256_slli_epi16(_mm256_sub_epi16(uw, c_off), 7);
+		vw = _mm256_slli_epi16(_mm256_sub_epi16(vw, c_off), 7);
+		const __m256i yy = _mm256_mulhi_epi16(yw, cy);
+		__m256i r = _mm256_add_epi16(yy, _mm256_mulhi_epi16(vw, crv));
+		__m256i g = _mm256_add_epi16(yy, _mm256_add_epi16(_mm256_mulhi_epi16(uw, cgu), _mm256_mulhi_epi16(vw, cgv)));
+		__m256i b = _mm256_add_epi16(yy, _mm256_mulhi_epi16(uw, cbu));
+		r = _mm256_srai_epi16(_mm256_add_epi16(r, round), 4);
+		g = _mm256_srai_epi16(_mm256_add_epi16(g, round), 4);
+		b = _mm256_srai_epi16(_mm256_add_epi16(b, round), 4);
+		store_rgba16_sse2(out + x * 4, narrow_avx2(r), narrow_avx2(g), narrow_avx2(b));
+	}
+	return x;
+}
+#endif
+
+#if OA_YUV_NEON
+inline int16x8_t mulhi_neon(int16x8_t a, int16_t b) {
+	const int32x4_t lo = vmull_n_s16(vget_low_s16(a), b);
+	const int32x4_t hi = vmull_n_s16(vget_high_s16(a), b);
+	return vcombine_s16(vshrn_n_s32(lo, 16), vshrn_n_s32(hi, 16));
+}
+
+inline uint8x8_t narrow_neon(int16x8_t yy, int16x8_t t) {
+	return vqmovun_s16(vshrq_n_s16(vaddq_s16(vaddq_s16(yy, t), vdupq_n_s16(8)), 4));
+}
+
+// 8 pixels: Y and per-pixel U/V as bytes.
+inline void convert8_neon(uint8x8_t y8, uint8x8_t u8, uint8x8_t v8, const Coefficients& c, uint8x8_t& r,
+						  uint8x8_t& g, uint8x8_t& b) {
+	int16x8_t yw = vreinterpretq_s16_u16(vmovl_u8(y8));
+	int16x8_t uw = vreinterpretq_s16_u16(vmovl_u8(u8));
+	int16x8_t vw = vreinterpretq_s16_u16(vmovl_u8(v8));
+	yw = vshlq_n_s16(vsubq_s16(yw, vdupq_n_s16(c.y_offset)), 7);
+	uw = vshlq_n_s16(vsubq_s16(uw, vdupq_n_s16(128)), 7);
+	vw = vshlq_n_s16(vsubq_s16(vw, vdupq_n_s16(128)), 7);
+	const int16x8_t yy = mulhi_neon(yw, c.cy);
+	r = narrow_neon(yy, mulhi_neon(vw, c.crv));
+	g = narrow_neon(yy, vaddq_s16(mulhi_neon(uw, c.cgu), mulhi_neon(vw, c.cgv)));
+	b = narrow_neon(yy, mulhi_neon(uw, c.cbu));
+}
+
+int row_neon(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* out, int width, const Coefficients& c) {
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		const uint8x16_t y16 = vld1q_u8(y + x);
+		const uint8x8_t u8 = vld1_u8(u + x / 2);
+		const uint8x8_t v8 = vld1_u8(v + x / 2);
+		const uint8x8x2_t uu = vzip_u8(u8, u8); // each chroma sample covers two pixels
+		const uint8x8x2_t vv = vzip_u8(v8, v8);
+		uint8x8_t r0, g0, b0, r1, g1, b1;
+		convert8_neon(vget_low_u8(y16), uu.val[0], vv.val[0], c, r0, g0, b0);
+		convert8_neon(vget_high_u8(y16), uu.val[1], vv.val[1], c, r1, g1, b1);
+		uint8x16x4_t px;
+		px.val[0] = vcombine_u8(r0, r1);
+		px.val[1] = vcombine_u8(g0, g1);
+		px.val[2] = vcombine_u8(b0, b1);
+		px.val[3] = vdupq_n_u8(255);
+		vst4q_u8(out + x * 4, px);
+	}
+	return x;
+}
+#endif
+
+struct Impl {
+	RowFn row;
+	const char* name;
+};
+
+Impl select_impl() {
+#if OA_YUV_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) return {row_avx2, "avx2"};
+	return {row_sse2, "sse2"};
+#elif OA_YUV_NEON
+	return {row_neon, "neon"};
+#else
+	return {nullptr, "scalar"};
+#endif
+}
+
+const Impl& impl() {
+	static const Impl selected = select_impl();
+	return selected;
+}
+
+void convert(const I420Planes& planes, int width, int height, uint8_t* rgba, size_t rgba_stride, YuvColorSpace cs,
+			 RowFn row) {
+	if (!planes.data[0] || !planes.data[1] || !planes.data[2] || !rgba || width <= 0 || height <= 0) return;
+	const Coefficients c = coefficients(cs);
+	for (int row_index = 0; row_index < height; ++row_index) {
+		const uint8_t* y = planes.data[0] + static_cast<size_t>(row_index) * planes.stride[0];
+		const uint8_t* u = planes.data[1] + static_cast<size_t>(row_index / 2) * planes.stride[1];
+		const uint8_t* v = planes.data[2] + static_cast<size_t>(row_index / 2) * planes.stride[2];
+		uint8_t* out = rgba + static_cast<size_t>(row_index) * rgba_stride;
+		const int done = row ? row(y, u, v, out, width, c) : 0;
+		row_scalar(y, u, v, out, done, width, c);
+	}
+}
+
+} // namespace
+
+YuvColorSpace default_color_space(int width, int height) {
+	YuvColorSpace cs;
+	cs.matrix = (height >= 720 || width >= 1280) ? YuvMatrix::Bt709 : YuvMatrix::Bt601;
+	return cs;
+}
+
+YuvShaderMatrix yuv_shader_matrix(YuvColorSpace cs) {
+	const FloatCoefficients f = float_coefficients(cs);
+	YuvShaderMatrix out;
+	const float m[9] = {
+		static_cast<float>(f.cy), 0.0f, static_cast<float>(f.crv),
+		static_cast<float>(f.cy), static_cast<float>(f.cgu), static_cast<float>(f.cgv),
+		static_cast<float>(f.cy), static_cast<float>(f.cbu), 0.0f,
+	};
+	std::copy(m, m + 9, out.m);
+	out.y_offset = static_cast<float>(f.y_offset / 255.0);
+	return out;
+}
+
+void i420_to_rgba(const uint8_t* yuv, int width, int height, uint8_t* rgba, size_t rgba_stride, YuvColorSpace cs) {
+	convert(i420_packed_planes(yuv, width, height), width, height, rgba, rgba_stride, cs, impl().row);
+}
+
+void i420_to_rgba(const I420Planes& planes, int width, int height, uint8_t* rgba, size_t rgba_stride,
+				  YuvColorSpace cs) {
+	convert(planes, width, height, rgba, rgba_stride, cs, impl().row);
+}
+
+void i420_to_rgba_scalar(const uint8_t* yuv, int width, int height, uint8_t* rgba, size_t rgba_stride,
+						 YuvColorSpace cs) {
+	convert(i420_packed_planes(yuv, width, height), width, height, rgba, rgba_stride, cs, nullptr);
+}
+
+const char* i420_to_rgba_impl() {
+	return impl().name;
+}
@@ -0,0 +1,58 @@
+// CPU I420 -> RGBA conversion (SSE2/AVX2/NEON), used when the GL shader path fails.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+enum class YuvMatrix : uint8_t { Bt601, Bt709 };
+
+struct YuvColorSpace {
+	YuvMatrix matrix = YuvMatrix::Bt601;
+	bool full_range = false; // false: Y 16-235, UV 16-240
+};
+
+// Decoder output carries no colour description here, so follow the usual
+// convention: BT.601 below 720 lines, BT.709 from 720 up, limited range.
+YuvColorSpace default_color_space(int width, int height);
+
+// Row-major 3x3 matrix applied to (Y - y_offset, U - 0.5, V - 0.5) with
+// components normalised to 0..1; range scaling is folded in. For the shader.
+struct YuvShaderMatrix {
+	float m[9];
+	float y_offset;
+};
+YuvShaderMatrix yuv_shader_matrix(YuvColorSpace cs);
+
+// Plane pointers and row strides in bytes of an I420 picture; the chroma
+// planes are ((w+1)/2) x ((h+1)/2). Rows may be padded, as libavcodec's are.
+struct I420Planes {
+	const uint8_t* data[3] = {};
+	int stride[3] = {};
+};
+
+// The planes of a packed [Y][U][V] frame.
+inline I420Planes i420_packed_planes(const uint8_t* yuv, int width, int height) {
+	const int uv_w = (width + 1) / 2;
+	I420Planes p;
+	if (!yuv) return p;
+	p.data[0] = yuv;
+	p.data[1] = yuv + static_cast<size_t>(width) * height;
+	p.data[2] = p.data[1] + static_cast<size_t>(uv_w) * ((height + 1) / 2);
+	p.stride[0] = width;
+	p.stride[1] = p.stride[2] = uv_w;
+	return p;
+}
+
+// Convert a packed [Y][U][V] I420 frame (chroma planes ((w+1)/2) x ((h+1)/2))
+// into RGBA8 with `rgba_stride` bytes per row. Alpha is 255.
+void i420_to_rgba(const uint8_t* yuv, int width, int height, uint8_t* rgba, size_t rgba_stride, YuvColorSpace cs);
+// Same from separate, possibly padded planes.
+void i420_to_rgba(const I420Planes& planes, int width, int height, uint8_t* rgba, size_t rgba_stride,
+				  YuvColorSpace cs);
+
+// Same arithmetic without SIMD; reference for tests and the row tails.
+void i420_to_rgba_scalar(const uint8_t* yuv, int width, int height, uint8_t* rgba, size_t rgba_stride,
+						 YuvColorSpace cs);
+
+// "avx2", "sse2", "neon" or "scalar": what i420_to_rgba uses on this CPU.
+const char* i420_to_rgba_impl();
@@ -0,0 +1,240 @@
+// Loopback benchmark for the SHM IPC path: SharedMemoryProducer ->
+// SharedMemoryConsumer in one process, reporting wake-up latency, throughput
+// and missed/duplicated/torn frames for each packet size.
+//
+// Every payload carries a sequence number at its head and tail; the frame
+// timestamp is the producer's CLOCK_MONOTONIC time in nanoseconds right before
+// sem_post, so consumer latency = callback time - timestamp.
+//
+// Usage:
+//   shm_ipc_bench [--sizes=1024,65536,262144] [--rate=60] [--duration=5]
+//                 [--polling-ms=10] [--shm-size=6220800]
+// --rate=0 publishes as fast as possible.
+
+#include "../common/SharedMemoryConsumer.hpp"
+#include "../common/SharedMemoryProducer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+struct Options {
+	std::vector<size_t> sizes{1024, 64 * 1024, 256 * 1024};
+	unsigned int rate_hz = 60;
+	double duration_s = 5.0;
+	unsigned int polling_ms = 10;
+	size_t shm_size = 1920 * 1080 * 3;
+};
+
+struct Result {
+	size_t size = 0;
+	uint64_t sent = 0;
+	uint64_t received = 0;
+	uint64_t missed = 0;
+	uint64_t duplicates = 0;
+	uint64_t torn = 0;
+	double elapsed_s = 0.0;
+	std::vector<uint64_t> latencies_ns;
+};
+
+uint64_t monotonic_ns() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+bool parse_size_list(const std::string& s, std::vector<size_t>& out) {
+	out.clear();
+	std::stringstream ss(s);
+	std::string item;
+	while (std::getline(ss, item, ',')) {
+		if (item.empty()) continue;
+		char* end = nullptr;
+		const unsigned long long v = std::strtoull(item.c_str(), &end, 10);
+		if (!end || *end != '\0' || v == 0) return false;
+		out.push_back(static_cast<size_t>(v));
+	}
+	return !out.empty();
+}
+
+bool parse_args(int argc, char** argv, Options& opt) {
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		auto value = [&](const char* key) -> const char* {
+			const size_t n = std::strlen(key);
+			return arg.compare(0, n, key) == 0 ? arg.c_str() + n : nullptr;
+		};
+		if (const char* v = value("--sizes=")) {
+			if (!parse_size_list(v, opt.sizes)) return false;
+		} else if (const char* v = value("--rate=")) {
+			opt.rate_hz = static_cast<unsigned int>(std::strtoul(v, nullptr, 10));
+		} else if (const char* v = value("--duration=")) {
+			opt.duration_s = std::strtod(v, nullptr);
+		} else if (const char* v = value("--polling-ms=")) {
+			opt.polling_ms = static_cast<unsigned int>(std::strtoul(v, nullptr, 10));
+		} else if (const char* v = value("--shm-size=")) {
+			opt.shm_size = static_cast<size_t>(std::strtoull(v, nullptr, 10));
+		} else {
+			return false;
+		}
+	}
+	return opt.duration_s > 0.0 && opt.polling_ms > 0;
+}
+
+uint64_t percentile(const std::vector<uint64_t>& sorted, double p) {
+	if (sorted.empty()) return 0;
+	const size_t idx = std::min(sorted.size() - 1, static_cast<size_t>(p * (sorted.size() - 1) + 0.5));
+	return sorted[idx];
+}
+
+Result run_one(const Options& opt, size_t payload_size) {
+	Result r;
+	r.size = payload_size;
+
+	const std::string tag = std::to_string(getpid());
+	const std::string shm_name = "/oaf_bench_shm_" + tag;
+	const std::string sem_name = "/oaf_bench_sem_" + tag;
+
+	SharedMemoryProducer producer(shm_name, sem_name, opt.shm_size);
+	if (!producer.open()) {
+		std::cerr << "[shm_ipc_bench] producer open failed" << std::endl;
+		return r;
+	}
+
+	std::mutex stats_mutex;
+	uint64_t last_seq = 0;
+	std::atomic<bool> connected{false};
+
+	SharedMemoryConsumer consumer(shm_name, sem_name, opt.shm_size,
+		[&](const unsigned char* buffer, size_t size) {
+			const uint64_t now = monotonic_ns();
+			connected.store(true, std::memory_order_relaxed);
+			uint64_t ts = 0;
+			uint32_t declared = 0;
+			std::memcpy(&ts, buffer, sizeof(uint64_t));
+			std::memcpy(&declared, buffer + sizeof(uint64_t), sizeof(uint32_t));
+			if (declared < 2 * sizeof(uint64_t) || SharedMemoryProducer::kHeaderSize + declared > size) return;
+			const unsigned char* payload = buffer + SharedMemoryProducer::kHeaderSize;
+			uint64_t head = 0, tail = 0;
+			std::memcpy(&head, payload, sizeof(uint64_t));
+			std::memcpy(&tail, payload + declared - sizeof(uint64_t), sizeof(uint64_t));
+
+			std::lock_guard<std::mutex> lk(stats_mutex);
+			if (head == 0) return; // warm-up frame
+			if (head != tail) {
+				++r.torn; // producer overwrote the buffer while we were reading
+				return;
+			}
+			if (head <= last_seq) {
+				++r.duplicates; // extra sem count woke us on an already-seen buffer
+				return;
+			}
+			if (head > last_seq + 1) r.missed += head - last_seq - 1;
+			last_seq = head;
+			++r.received;
+			r.latencies_ns.push_back(now > ts ? now - ts : 0);
+		},
+		opt.polling_ms);
+
+	std::thread consumer_thread([&consumer]() { consumer.run(); });
+
+	std::vector<unsigned char> payload(std::max(payload_size, 2 * sizeof(uint64_t)), 0xA5);
+
+	// Publish warm-up frames (seq 0) until the consumer has attached.
+	const auto attach_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+	while (!connected.load(std::memory_order_relaxed) && std::chrono::steady_clock::now() < attach_deadline) {
+		std::memset(payload.data(), 0, sizeof(uint64_t));
+		producer.publish(monotonic_ns(), payload.data(), payload.size());
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	}
+	// Let the consumer drain warm-up posts before measuring.
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	const auto start = std::chrono::steady_clock::now();
+	const auto end = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+		std::chrono::duration<double>(opt.duration_s));
+	const auto period = opt.rate_hz > 0
+		? std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / opt.rate_hz))
+		: std::chrono::steady_clock::duration::zero();
+	auto next = start;
+	uint64_t seq = 0;
+	while (std::chrono::steady_clock::now() < end) {
+		++seq;
+		std::memcpy(payload.data(), &seq, sizeof(uint64_t));
+		std::memcpy(payload.data() + payload.size() - sizeof(uint64_t), &seq, sizeof(uint64_t));
+		if (!producer.publish(monotonic_ns(), payload.data(), payload.size())) break;
+		++r.sent;
+		if (period != std::chrono::steady_clock::duration::zero()) {
+			next += period;
+			std::this_thread::sleep_until(next);
+		}
+	}
+	r.elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	// Give the consumer one polling period plus slack to pick up the tail.
+	std::this_thread::sleep_for(std::chrono::milliseconds(opt.polling_ms * 2 + 20));
+	consumer.stop();
+	consumer_thread.join();
+
+	std::lock_guard<std::mutex> lk(stats_mutex);
+	if (last_seq < seq) r.missed += seq - last_seq;
+	return r;
+}
+
+void print_result(const Result& r) {
+	std::vector<uint64_t> sorted = r.latencies_ns;
+	std::sort(sorted.begin(), sorted.end());
+	const double mb_s = r.elapsed_s > 0.0
+		? (static_cast<double>(r.received) * static_cast<double>(r.size)) / (1024.0 * 1024.0) / r.elapsed_s
+		: 0.0;
+	std::printf("%10zu %8llu %8llu %7llu %6llu %6llu %10.2f %9.1f %9.1f %9.1f %9.1f\n",
+		r.size,
+		static_cast<unsigned long long>(r.sent),
+		static_cast<unsigned long long>(r.received),
+		static_cast<unsigned long long>(r.missed),
+		static_cast<unsigned long long>(r.duplicates),
+		static_cast<unsigned long long>(r.torn),
+		mb_s,
+		percentile(sorted, 0.50) / 1000.0,
+		percentile(sorted, 0.95) / 1000.0,
+		percentile(sorted, 0.99) / 1000.0,
+		sorted.empty() ? 0.0 : sorted.back() / 1000.0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	Options opt;
+	if (!parse_args(argc, argv, opt)) {
+		std::cerr << "usage: " << argv[0]
+			<< " [--sizes=N,N,...] [--rate=HZ] [--duration=SEC] [--polling-ms=MS] [--shm-size=BYTES]" << std::endl;
+		return 2;
+	}
+
+	std::printf("rate=%uHz duration=%.1fs polling=%ums shm=%zu\n", opt.rate_hz, opt.duration_s, opt.polling_ms, opt.shm_size);
+	std::printf("%10s %8s %8s %7s %6s %6s %10s %9s %9s %9s %9s\n",
+		"bytes", "sent", "recv", "missed", "dup", "torn", "MiB/s", "p50_us", "p95_us", "p99_us", "max_us");
+	for (size_t size : opt.sizes) {
+		if (size + SharedMemoryProducer::kHeaderSize > opt.shm_size) {
+			std::cerr << "[shm_ipc_bench] skipping size " << size << " (exceeds shm size)" << std::endl;
+			continue;
+		}
+		print_result(run_one(opt, size));
+		std::fflush(stdout);
+	}
+	return 0;
+}
@@ -0,0 +1,503 @@
+#include "Log.hpp"
+#include "ThreadPolicy.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <time.h>
+
+namespace oa_log {
+
+namespace detail {
+std::atomic<uint8_t> g_level{static_cast<uint8_t>(Level::Info)};
+} // namespace detail
+
+namespace {
+
+constexpr size_t kRingSize = 1024; // power of two
+
+int64_t unix_now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+int64_t steady_now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool build_sinks(const std::string& spec, std::vector<std::shared_ptr<Sink>>& sinks);
+
+// Bounded MPSC ring (Vyukov sequence-per-slot queue): producers claim slots
+// with one CAS, the log thread is the only consumer.
+class Logger {
+public:
+    using SinkList = std::vector<std::shared_ptr<Sink>>;
+
+    static Logger& instance() {
+        // Intentionally leaked so logging from static destructors stays valid.
+        static Logger* logger = new Logger();
+        return *logger;
+    }
+
+    detail::Record* begin(Level level, const char* tag, const char* fmt) {
+        if (stopped_.load(std::memory_order_acquire)) {
+            // Held until commit(); other threads may be logging too.
+            sync_mutex_.lock();
+            sync_.level = level;
+            sync_.tag = tag;
+            sync_.fmt = fmt;
+            sync_.unix_us = unix_now_us();
+            sync_.nargs = 0;
+            sync_.used = 0;
+            return &sync_;
+        }
+        uint64_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Slot* slot = nullptr;
+        for (;;) {
+            slot = &ring_[pos & (kRingSize - 1)];
+            const uint64_t seq = slot->seq.load(std::memory_order_acquire);
+            const int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        detail::Record& r = slot->rec;
+        r.level = level;
+        r.tag = tag;
+        r.fmt = fmt;
+        r.unix_us = unix_now_us();
+        r.nargs = 0;
+        r.used = 0;
+        r.pos = pos;
+        return &r;
+    }
+
+    void commit(detail::Record* rec) {
+        if (rec == &sync_) {
+            write_line(sync_);
+            sync_mutex_.unlock();
+            return;
+        }
+        ring_[rec->pos & (kRingSize - 1)].seq.store(rec->pos + 1, std::memory_order_release);
+        if (rec->level >= Level::Error) wake_.notify_one();
+    }
+
+    // Only swaps the list: the old sinks are flushed by the log thread, so a
+    // caller never waits for a blocked sink.
+    void set_sinks(std::vector<std::shared_ptr<Sink>> sinks) {
+        auto next = std::make_shared<const SinkList>(std::move(sinks));
+        std::shared_ptr<const SinkList> old;
+        bool stopped = false;
+        {
+            std::lock_guard<std::mutex> lk(sinks_mutex_);
+            old = std::move(sinks_);
+            sinks_ = std::move(next);
+            stopped = stopped_.load(std::memory_order_acquire);
+            if (!stopped) retired_.push_back(old);
+        }
+        if (stopped) {
+            // No log thread any more; lines are written by their callers too.
+            flush_sinks(*old);
+        } else {
+            wake_.notify_one();
+        }
+    }
+
+    void set_spec(const std::string& spec) {
+        std::lock_guard<std::mutex> lk(sinks_mutex_);
+        spec_ = spec;
+    }
+
+    std::string spec() {
+        std::lock_guard<std::mutex> lk(sinks_mutex_);
+        return spec_;
+    }
+
+    void flush() {
+        if (stopped_.load(std::memory_order_acquire)) return;
+        const uint64_t target = enqueue_pos_.load(std::memory_order_acquire);
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (dequeue_pos_.load(std::memory_order_acquire) < target && std::chrono::steady_clock::now() < deadline) {
+            wake_.notify_one();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        flush_sinks(*current_sinks());
+    }
+
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    void stop() {
+        if (stopped_.exchange(true)) return;
+        running_.store(false, std::memory_order_release);
+        wake_.notify_one();
+        if (thread_.joinable()) thread_.join();
+        drain();
+        flush_retired();
+        flush_sinks(*current_sinks());
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> seq;
+        detail::Record rec;
+    };
+
+    Logger() : ring_(new Slot[kRingSize]) {
+        for (size_t i = 0; i < kRingSize; ++i) ring_[i].seq.store(i, std::memory_order_relaxed);
+        spec_ = "console";
+        SinkList sinks;
+        const char* env_sinks = std::getenv("OPENAUTOFLUTTER_LOG_SINKS");
+        if (env_sinks && build_sinks(env_sinks, sinks)) {
+            spec_ = env_sinks;
+        } else {
+            sinks.clear();
+            sinks.push_back(std::make_shared<ConsoleSink>());
+        }
+        sinks_ = std::make_shared<const SinkList>(std::move(sinks));
+
+        Level lvl;
+        if (const char* env = std::getenv("OPENAUTOFLUTTER_LOG_LEVEL")) {
+            if (parse_level(env, lvl)) detail::g_level.store(static_cast<uint8_t>(lvl));
+        }
+        thread_ = std::thread([this]() { run(); });
+        std::atexit([]() { Logger::instance().stop(); });
+    }
+
+    bool drain() {
+        bool any = false;
+        for (;;) {
+            const uint64_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+            Slot& slot = ring_[pos & (kRingSize - 1)];
+            if (slot.seq.load(std::memory_order_acquire) != pos + 1) break;
+            write_line(slot.rec);
+            slot.seq.store(pos + kRingSize, std::memory_order_release);
+            dequeue_pos_.store(pos + 1, std::memory_order_release);
+            any = true;
+        }
+        const uint64_t dropped_now = dropped_.load(std::memory_order_relaxed);
+        if (dropped_now != reported_drops_) {
+            std::ostringstream oss;
+            oss << "[Log] dropped " << (dropped_now - reported_drops_) << " messages (ring full)";
+            emit(Level::Warn, oss.str());
+            reported_drops_ = dropped_now;
+        }
+        return any;
+    }
+
+    void run() {
+        while (running_.load(std::memory_order_acquire)) {
+            oa_thread::refresh(oa_thread::Role::Logger, "oa-log");
+            flush_retired();
+            if (drain()) continue;
+            std::unique_lock<std::mutex> lk(wake_mutex_);
+            wake_.wait_for(lk, std::chrono::milliseconds(5));
+        }
+    }
+
+    void write_line(const detail::Record& r) {
+        std::string line;
+        line.reserve(128);
+        format_prefix(r, line);
+        format_message(r, line);
+        emit(r.level, line);
+    }
+
+    // sinks_mutex_ only guards the pointers; sinks are written and flushed
+    // without it, so a blocked sink never holds up set_sinks() or spec().
+    std::shared_ptr<const SinkList> current_sinks() {
+        std::lock_guard<std::mutex> lk(sinks_mutex_);
+        return sinks_;
+    }
+
+    static void flush_sinks(const SinkList& sinks) {
+        for (auto& s : sinks) s->flush();
+    }
+
+    // Log thread (or stop()): flush the sinks replaced by set_sinks().
+    void flush_retired() {
+        std::vector<std::shared_ptr<const SinkList>> retired;
+        {
+            std::lock_guard<std::mutex> lk(sinks_mutex_);
+            if (retired_.empty()) return;
+            retired.swap(retired_);
+        }
+        for (auto& sinks : retired) flush_sinks(*sinks);
+    }
+
+    void emit(Level level, const std::string& line) {
+        const std::shared_ptr<const SinkList> sinks = current_sinks();
+        for (auto& s : *sinks) s->write(level, line);
+    }
+
+    static void format_prefix(const detail::Record& r, std::string& out) {
+        const time_t secs = static_cast<time_t>(r.unix_us / 1000000);
+        struct tm tm_buf;
+        localtime_r(&secs, &tm_buf);
+        char buf[48];
+        std::snprintf(buf, sizeof(buf), "%02d:%02d:%02d.%03d %c ",
+                      tm_buf.tm_hour, tm_buf.tm_min, tm_buf.tm_sec,
+                      static_cast<int>((r.unix_us / 1000) % 1000),
+                      level_name(r.level)[0]);
+        out += buf;
+        if (r.tag && *r.tag) {
+            out += '[';
+            out += r.tag;
+            out += "] ";
+        }
+    }
+
+    static void format_arg(const detail::Record& r, const detail::Arg& a, std::string& out) {
+        char buf[64];
+        switch (a.type) {
+            case detail::Arg::I64:
+                std::snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(a.v.i));
+                out += buf;
+                break;
+            case detail::Arg::U64:
+                std::snprintf(buf, sizeof(buf), "%llu", static_cast<unsigned long long>(a.v.u));
+                out += buf;
+                break;
+            case detail::Arg::F64:
+                std::snprintf(buf, sizeof(buf), "%g", a.v.d);
+                out += buf;
+                break;
+            case detail::Arg::Bool:
+                out += a.v.u ? '1' : '0';
+                break;
+            case detail::Arg::Ptr:
+                std::snprintf(buf, sizeof(buf), "%p", a.v.p);
+                out += buf;
+                break;
+            case detail::Arg::Str:
+                out.append(r.bytes + a.off, a.len);
+                break;
+            case detail::Arg::HexDump: {
+                for (uint16_t i = 0; i < a.len; ++i) {
+                    std::snprintf(buf, sizeof(buf), i ? " %02x" : "%02x", static_cast<unsigned char>(r.bytes[a.off + i]));
+                    out += buf;
+                }
+                if (a.v.u > a.len) out += " ...";
+                break;
+            }
+        }
+    }
+
+    static void format_message(const detail::Record& r, std::string& out) {
+        const char* f = r.fmt ? r.fmt : "";
+        uint8_t next = 0;
+        while (*f) {
+            if (f[0] == '{' && f[1] == '}') {
+                if (next < r.nargs) format_arg(r, r.args[next], out);
+                ++next;
+                f += 2;
+            } else {
+                out += *f++;
+            }
+        }
+    }
+
+    std::unique_ptr<Slot[]> ring_;
+    std::atomic<uint64_t> enqueue_pos_{0};
+    std::atomic<uint64_t> dequeue_pos_{0};
+    std::atomic<uint64_t> dropped_{0};
+    uint64_t reported_drops_ = 0;
+
+    std::atomic<bool> running_{true};
+    std::atomic<bool> stopped_{false};
+    std::thread thread_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+
+    std::mutex sinks_mutex_;
+    std::shared_ptr<const SinkList> sinks_;
+    std::vector<std::shared_ptr<const SinkList>> retired_; // to flush on the log thread
+    std::string spec_;
+
+    // After shutdown (atexit) lines are formatted and written synchronously.
+    std::mutex sync_mutex_;
+    detail::Record sync_{};
+};
+
+std::string lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return s;
+}
+
+bool build_sinks(const std::string& spec, std::vector<std::shared_ptr<Sink>>& sinks) {
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) continue;
+        if (item == "console" || item == "stdout" || item == "stderr") {
+            // Console already routes by level; avoid duplicating lines.
+            if (std::none_of(sinks.begin(), sinks.end(), [](const std::shared_ptr<Sink>& s) {
+                    return dynamic_cast<ConsoleSink*>(s.get()) != nullptr; })) {
+                sinks.push_back(std::make_shared<ConsoleSink>());
+            }
+        } else if (item.compare(0, 5, "file:") == 0 && item.size() > 5) {
+            auto sink = std::make_shared<FileSink>(item.substr(5));
+            if (!sink->ok()) return false;
+            sinks.push_back(sink);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+const char* level_name(Level level) {
+    switch (level) {
+        case Level::Trace: return "TRACE";
+        case Level::Debug: return "DEBUG";
+        case Level::Info: return "INFO";
+        case Level::Warn: return "WARN";
+        case Level::Error: return "ERROR";
+        case Level::Off: return "OFF";
+    }
+    return "?";
+}
+
+bool parse_level(const std::string& name, Level& out) {
+    const std::string n = lower(name);
+    if (n == "trace") out = Level::Trace;
+    else if (n == "debug") out = Level::Debug;
+    else if (n == "info") out = Level::Info;
+    else if (n == "warn" || n == "warning") out = Level::Warn;
+    else if (n == "error") out = Level::Error;
+    else if (n == "off" || n == "none") out = Level::Off;
+    else return false;
+    return true;
+}
+
+void ConsoleSink::write(Level level, const std::string& line) {
+    std::FILE* f = level >= Level::Warn ? stderr : stdout;
+    std::fwrite(line.data(), 1, line.size(), f);
+    std::fputc('\n', f);
+    if (level >= Level::Warn) std::fflush(f);
+}
+
+void ConsoleSink::flush() {
+    std::fflush(stdout);
+    std::fflush(stderr);
+}
+
+FileSink::FileSink(const std::string& path) : file_(std::fopen(path.c_str(), "ae")) {}
+
+FileSink::~FileSink() {
+    if (file_) std::fclose(file_);
+}
+
+void FileSink::write(Level, const std::string& line) {
+    if (!file_) return;
+    std::fwrite(line.data(), 1, line.size(), file_);
+    std::fputc('\n', file_);
+}
+
+void FileSink::flush() {
+    if (file_) std::fflush(file_);
+}
+
+void set_level(Level level) {
+    detail::g_level.store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+}
+
+Level level() {
+    return static_cast<Level>(detail::g_level.load(std::memory_order_relaxed));
+}
+
+void set_sinks(std::vector<std::shared_ptr<Sink>> sinks) {
+    Logger::instance().set_sinks(std::move(sinks));
+}
+
+bool set_sinks_from_spec(const std::string& spec) {
+    std::vector<std::shared_ptr<Sink>> sinks;
+    if (!build_sinks(spec, sinks)) return false;
+    Logger::instance().set_sinks(std::move(sinks));
+    Logger::instance().set_spec(spec);
+    return true;
+}
+
+std::string sinks_spec() {
+    return Logger::instance().spec();
+}
+
+void flush() {
+    Logger::instance().flush();
+}
+
+uint64_t dropped() {
+    return Logger::instance().dropped();
+}
+
+void shutdown() {
+    Logger::instance().stop();
+}
+
+bool RateLimit::allow() {
+    const uint64_t c = count_.fetch_add(1, std::memory_order_relaxed);
+    if (first_n_ && c < first_n_) return true;
+    if (every_n_ && c % every_n_ == 0) return true;
+    if (per_second_) {
+        const int64_t now = steady_now_ms();
+        int64_t start = window_start_ms_.load(std::memory_order_relaxed);
+        if (now - start >= 1000 && window_start_ms_.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+            window_hits_.store(0, std::memory_order_relaxed);
+        }
+        return window_hits_.fetch_add(1, std::memory_order_relaxed) < per_second_;
+    }
+    return false;
+}
+
+namespace detail {
+
+Record* begin(Level level, const char* tag, const char* fmt) {
+    return Logger::instance().begin(level, tag, fmt);
+}
+
+void commit(Record* rec) {
+    Logger::instance().commit(rec);
+}
+
+void put_string(Record& r, const char* s, size_t n) {
+    if (r.nargs >= kMaxArgs) return;
+    const size_t room = kInlineBytes - r.used;
+    const size_t len = std::min(n, room);
+    std::memcpy(r.bytes + r.used, s, len);
+    Arg& a = r.args[r.nargs++];
+    a.type = Arg::Str;
+    a.off = r.used;
+    a.len = static_cast<uint16_t>(len);
+    a.v.u = n;
+    r.used = static_cast<uint16_t>(r.used + len);
+}
+
+void put_hex(Record& r, const Hex& h) {
+    if (r.nargs >= kMaxArgs) return;
+    const size_t want = h.data ? std::min(h.size, h.max_bytes) : 0;
+    const size_t len = std::min(want, kInlineBytes - r.used);
+    if (len) std::memcpy(r.bytes + r.used, h.data, len);
+    Arg& a = r.args[r.nargs++];
+    a.type = Arg::HexDump;
+    a.off = r.used;
+    a.len = static_cast<uint16_t>(len);
+    a.v.u = h.size;
+    r.used = static_cast<uint16_t>(r.used + len);
+}
+
+} // namespace detail
+
+} // namespace oa_log
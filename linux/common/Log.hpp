@@ -0,0 +1,243 @@
+// Asynchronous, rate-limited logging for the plugin's hot paths.
+//
+// Call sites capture their arguments by value into a slot of a lock-free ring;
+// a background thread formats the line and hands it to the configured sinks.
+// A blocked stdout/journald pipe therefore stalls only the log thread, and when
+// the ring is full messages are dropped (and counted) instead of blocking.
+//
+//   OA_LOG(Info, "H264Decoder", "decoded {}x{}", w, h);
+//   OA_LOG_FIRST_N(Info, 10, "H264Decoder", "packet {} head={}", id, oa_log::hex(p, n, 32));
+//   OA_LOG_FIRST_N_EVERY(Info, 5, 60, "H264Decoder", "frame {}", count);
+//   OA_LOG_RATE(Warn, 5, "H264Decoder", "reject size={}", size);
+//
+// `fmt` and `tag` must be string literals (they are formatted later); "{}"
+// is replaced by the next argument. Strings and hex dumps are copied, so any
+// buffer may be passed. Levels and sinks can be changed at runtime, and are
+// initialised from OPENAUTOFLUTTER_LOG_LEVEL / OPENAUTOFLUTTER_LOG_SINKS.
+
+#ifndef OA_LOG_HPP
+#define OA_LOG_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace oa_log {
+
+enum class Level : uint8_t {
+    Trace = 0,
+    Debug = 1,
+    Info = 2,
+    Warn = 3,
+    Error = 4,
+    Off = 5,
+};
+
+const char* level_name(Level level);
+// Accepts trace/debug/info/warn/warning/error/off (case-insensitive).
+bool parse_level(const std::string& name, Level& out);
+
+// Output target. write() is called from the log thread (after shutdown(),
+// from the logging threads one at a time); flush() may run on another thread
+// at the same time, as stdio allows.
+class Sink {
+public:
+    virtual ~Sink() = default;
+    virtual void write(Level level, const std::string& line) = 0;
+    virtual void flush() {}
+};
+
+// Warn and above to stderr, the rest to stdout.
+class ConsoleSink : public Sink {
+public:
+    void write(Level level, const std::string& line) override;
+    void flush() override;
+};
+
+// Appends to a file; falls back to dropping lines if it cannot be opened.
+class FileSink : public Sink {
+public:
+    explicit FileSink(const std::string& path);
+    ~FileSink() override;
+    bool ok() const { return file_ != nullptr; }
+    void write(Level level, const std::string& line) override;
+    void flush() override;
+
+private:
+    std::FILE* file_;
+};
+
+void set_level(Level level);
+Level level();
+
+inline bool enabled(Level level);
+
+// Replace all sinks. An empty list silences output (lines are still drained).
+void set_sinks(std::vector<std::shared_ptr<Sink>> sinks);
+// Comma-separated spec: "console", "stdout", "stderr", "file:/path". Returns
+// false (and leaves sinks unchanged) if any entry is invalid.
+bool set_sinks_from_spec(const std::string& spec);
+std::string sinks_spec();
+
+// Block until everything queued so far has been written.
+void flush();
+// Messages dropped because the ring was full.
+uint64_t dropped();
+// Write everything queued and stop the log thread; later lines are formatted
+// and written by the calling thread. Runs at exit; calling it again does
+// nothing.
+void shutdown();
+
+// Hex preview of a buffer (first max_bytes), formatted on the log thread.
+struct Hex {
+    const void* data;
+    size_t size;
+    size_t max_bytes;
+};
+inline Hex hex(const void* data, size_t size, size_t max_bytes = 32) { return Hex{data, size, max_bytes}; }
+
+// Per-call-site limiter: passes the first `first_n` hits, then every
+// `every_n`-th hit, plus up to `per_second` hits per second. Zero disables a rule.
+class RateLimit {
+public:
+    constexpr RateLimit(uint32_t first_n, uint32_t every_n, uint32_t per_second)
+        : first_n_(first_n), every_n_(every_n), per_second_(per_second) {}
+    bool allow();
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+
+private:
+    const uint32_t first_n_;
+    const uint32_t every_n_;
+    const uint32_t per_second_;
+    std::atomic<uint64_t> count_{0};
+    std::atomic<int64_t> window_start_ms_{0};
+    std::atomic<uint32_t> window_hits_{0};
+};
+
+namespace detail {
+
+constexpr size_t kMaxArgs = 10;
+constexpr size_t kInlineBytes = 192;
+
+struct Arg {
+    enum Type : uint8_t { I64, U64, F64, Bool, Ptr, Str, HexDump };
+    Type type;
+    uint16_t off;  // Str/HexDump: offset into Record::bytes
+    uint16_t len;  // Str/HexDump: bytes stored
+    union {
+        int64_t i;
+        uint64_t u;
+        double d;
+        const void* p;
+    } v;
+};
+
+struct Record {
+    Level level;
+    uint8_t nargs;
+    uint16_t used;
+    uint64_t pos;   // ring position of the claimed slot
+    const char* tag;
+    const char* fmt;
+    int64_t unix_us;
+    Arg args[kMaxArgs];
+    char bytes[kInlineBytes];
+};
+
+// Claim a ring slot; nullptr when the ring is full (the drop is counted).
+Record* begin(Level level, const char* tag, const char* fmt);
+// Make a claimed slot visible to the log thread.
+void commit(Record* rec);
+
+void put_string(Record& r, const char* s, size_t n);
+void put_hex(Record& r, const Hex& h);
+
+inline void put(Record& r, Arg::Type t, uint64_t bits) {
+    if (r.nargs >= kMaxArgs) return;
+    Arg& a = r.args[r.nargs++];
+    a.type = t;
+    a.off = a.len = 0;
+    a.v.u = bits;
+}
+
+inline void add(Record& r, bool v) { put(r, Arg::Bool, v ? 1 : 0); }
+inline void add(Record& r, double v) {
+    if (r.nargs >= kMaxArgs) return;
+    Arg& a = r.args[r.nargs++];
+    a.type = Arg::F64;
+    a.off = a.len = 0;
+    a.v.d = v;
+}
+inline void add(Record& r, float v) { add(r, static_cast<double>(v)); }
+inline void add(Record& r, const char* s) { put_string(r, s ? s : "(null)", s ? std::char_traits<char>::length(s) : 6); }
+inline void add(Record& r, char* s) { add(r, static_cast<const char*>(s)); }
+inline void add(Record& r, const std::string& s) { put_string(r, s.data(), s.size()); }
+inline void add(Record& r, const Hex& h) { put_hex(r, h); }
+inline void add(Record& r, const void* p) {
+    if (r.nargs >= kMaxArgs) return;
+    Arg& a = r.args[r.nargs++];
+    a.type = Arg::Ptr;
+    a.off = a.len = 0;
+    a.v.p = p;
+}
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+add(Record& r, T v) { put(r, Arg::I64, static_cast<uint64_t>(static_cast<int64_t>(v))); }
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value && !std::is_same<T, bool>::value>::type
+add(Record& r, T v) { put(r, Arg::U64, static_cast<uint64_t>(v)); }
+template <typename T>
+inline typename std::enable_if<std::is_enum<T>::value>::type
+add(Record& r, T v) { add(r, static_cast<typename std::underlying_type<T>::type>(v)); }
+
+inline void add_all(Record&) {}
+template <typename T, typename... Rest>
+inline void add_all(Record& r, const T& first, const Rest&... rest) {
+    add(r, first);
+    add_all(r, rest...);
+}
+
+extern std::atomic<uint8_t> g_level;
+
+} // namespace detail
+
+inline bool enabled(Level level) {
+    return static_cast<uint8_t>(level) >= detail::g_level.load(std::memory_order_relaxed) && level != Level::Off;
+}
+
+template <typename... Args>
+void log(Level level, const char* tag, const char* fmt, const Args&... args) {
+    detail::Record* rec = detail::begin(level, tag, fmt);
+    if (!rec) return;
+    detail::add_all(*rec, args...);
+    detail::commit(rec);
+}
+
+} // namespace oa_log
+
+#define OA_LOG(lvl, tag, ...)                                                      \
+    do {                                                                           \
+        if (::oa_log::enabled(::oa_log::Level::lvl))                               \
+            ::oa_log::log(::oa_log::Level::lvl, tag, __VA_ARGS__);                 \
+    } while (0)
+
+#define OA_LOG_LIMITED_(lvl, first_n, every_n, per_sec, tag, ...)                  \
+    do {                                                                           \
+        static ::oa_log::RateLimit oa_log_rl_(first_n, every_n, per_sec);          \
+        if (::oa_log::enabled(::oa_log::Level::lvl) && oa_log_rl_.allow())        \
+            ::oa_log::log(::oa_log::Level::lvl, tag, __VA_ARGS__);                 \
+    } while (0)
+
+#define OA_LOG_FIRST_N(lvl, n, tag, ...) OA_LOG_LIMITED_(lvl, n, 0, 0, tag, __VA_ARGS__)
+#define OA_LOG_EVERY_N(lvl, n, tag, ...) OA_LOG_LIMITED_(lvl, 1, n, 0, tag, __VA_ARGS__)
+#define OA_LOG_FIRST_N_EVERY(lvl, first_n, every_n, tag, ...) \
+    OA_LOG_LIMITED_(lvl, first_n, every_n, 0, tag, __VA_ARGS__)
+#define OA_LOG_RATE(lvl, per_sec, tag, ...) OA_LOG_LIMITED_(lvl, 0, 0, per_sec, tag, __VA_ARGS__)
+
+#endif // OA_LOG_HPP
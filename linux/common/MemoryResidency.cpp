@@ -0,0 +1,167 @@
+#include "MemoryResidency.hpp"
+#include "Log.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace oa_memory {
+
+namespace {
+
+constexpr size_t kRoles = static_cast<size_t>(oa_thread::Role::Count);
+
+struct Registry {
+    std::mutex mutex;
+    Policy policy;
+    std::map<void*, size_t> locked; // ranges make_resident() locked
+    size_t reserved = 0;            // locked bytes, plus ones being locked right now
+    std::atomic<size_t> locked_bytes{0};
+    bool warned_lock = false;
+    std::atomic<uint64_t> minor[kRoles] = {};
+    std::atomic<uint64_t> major[kRoles] = {};
+};
+
+Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+size_t page_size() {
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+size_t round_up(size_t value, size_t align) {
+    return (value + align - 1) / align * align;
+}
+
+} // namespace
+
+void set_policy(const Policy& policy) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lk(r.mutex);
+    if (policy == r.policy) return;
+    r.policy = policy;
+    OA_LOG(Info, "Memory", "residency: prefault={} hugepages={} lock_budget={}B", policy.prefault,
+           policy.hugepages, policy.lock_budget);
+}
+
+Policy policy() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lk(r.mutex);
+    return r.policy;
+}
+
+int map_flags() {
+    return policy().prefault ? MAP_POPULATE : 0;
+}
+
+void make_resident(void* addr, size_t size) {
+    if (!addr || size == 0) return;
+    Registry& r = registry();
+    const Policy p = policy();
+    if (p.hugepages && size >= kHugePage && madvise(addr, size, MADV_HUGEPAGE) != 0) {
+        OA_LOG_FIRST_N(Info, 1, "Memory", "MADV_HUGEPAGE refused: {}", std::strerror(errno));
+    }
+    if (p.lock_budget == 0) return;
+    {
+        std::lock_guard<std::mutex> lk(r.mutex);
+        if (r.locked.count(addr)) return;
+        if (r.reserved + size > p.lock_budget) {
+            OA_LOG_RATE(Warn, 1, "Memory", "mlock budget of {}B spent; {}B left unlocked", p.lock_budget, size);
+            return;
+        }
+        r.reserved += size;
+    }
+    // Faults the whole range in, so keep it outside the lock.
+    const int err = mlock(addr, size) == 0 ? 0 : errno;
+    std::lock_guard<std::mutex> lk(r.mutex);
+    if (err != 0) {
+        r.reserved -= size;
+        if (!r.warned_lock) {
+            r.warned_lock = true;
+            OA_LOG(Warn, "Memory", "mlock of {}B failed: {}; raise RLIMIT_MEMLOCK (ulimit -l) or grant CAP_IPC_LOCK",
+                   size, std::strerror(err));
+        }
+        return;
+    }
+    r.locked[addr] = size;
+    r.locked_bytes.store(r.reserved, std::memory_order_relaxed);
+}
+
+void release(void* addr) {
+    if (!addr) return;
+    Registry& r = registry();
+    size_t size = 0;
+    {
+        std::lock_guard<std::mutex> lk(r.mutex);
+        auto it = r.locked.find(addr);
+        if (it == r.locked.end()) return;
+        size = it->second;
+        r.locked.erase(it);
+        r.reserved -= size;
+        r.locked_bytes.store(r.reserved, std::memory_order_relaxed);
+    }
+    munlock(addr, size);
+}
+
+void* alloc_buffer(size_t size, size_t align) {
+    const Policy p = policy();
+    if (p.hugepages && size >= kHugePage) {
+        align = std::max(align, kHugePage);
+    } else if (p.lock_budget > 0) {
+        align = std::max(align, page_size());
+    }
+    // Whole pages, so locking one buffer never touches a neighbour's.
+    const bool paged = align >= page_size();
+    if (paged) size = round_up(size, align);
+    void* buffer = nullptr;
+    if (posix_memalign(&buffer, align, size) != 0) return nullptr;
+    if (paged) make_resident(buffer, size);
+    return buffer;
+}
+
+void free_buffer(void* buffer) {
+    release(buffer);
+    std::free(buffer);
+}
+
+size_t locked_bytes() {
+    return registry().locked_bytes.load(std::memory_order_relaxed);
+}
+
+void count_faults(oa_thread::Role role) {
+    thread_local long t_minor = 0;
+    thread_local long t_major = 0;
+    rusage usage;
+    if (getrusage(RUSAGE_THREAD, &usage) != 0) return;
+    Registry& r = registry();
+    const size_t i = static_cast<size_t>(role);
+    if (usage.ru_minflt > t_minor) {
+        r.minor[i].fetch_add(static_cast<uint64_t>(usage.ru_minflt - t_minor), std::memory_order_relaxed);
+    }
+    if (usage.ru_majflt > t_major) {
+        r.major[i].fetch_add(static_cast<uint64_t>(usage.ru_majflt - t_major), std::memory_order_relaxed);
+    }
+    t_minor = usage.ru_minflt;
+    t_major = usage.ru_majflt;
+}
+
+Faults faults(oa_thread::Role role) {
+    Registry& r = registry();
+    const size_t i = static_cast<size_t>(role);
+    Faults f;
+    f.minor = r.minor[i].load(std::memory_order_relaxed);
+    f.major = r.major[i].load(std::memory_order_relaxed);
+    return f;
+}
+
+} // namespace oa_memory
@@ -0,0 +1,65 @@
+// Keeping the pipeline's frame memory resident: prefaulted shared mappings,
+// transparent hugepages for large frame buffers, and mlock within a budget.
+// Also counts the page faults taken on the pipeline's threads.
+//
+// The policy applies to memory mapped or allocated after it is set; what is
+// already resident stays so until it is released.
+
+#ifndef MEMORY_RESIDENCY_HPP
+#define MEMORY_RESIDENCY_HPP
+
+#include "ThreadPolicy.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace oa_memory {
+
+struct Policy {
+    bool prefault = false;   // MAP_POPULATE on shared mappings
+    bool hugepages = false;  // MADV_HUGEPAGE on frame buffers of kHugePage and up
+    size_t lock_budget = 0;  // bytes the pipeline may mlock; 0 locks nothing
+
+    bool operator==(const Policy& o) const {
+        return prefault == o.prefault && hugepages == o.hugepages && lock_budget == o.lock_budget;
+    }
+    bool operator!=(const Policy& o) const { return !(*this == o); }
+};
+
+constexpr size_t kHugePage = 2 * 1024 * 1024;
+
+void set_policy(const Policy& policy);
+Policy policy();
+
+// Extra mmap() flags for a mapping the pipeline reads every frame.
+int map_flags();
+
+// Apply the policy to `size` bytes at page-aligned `addr`: hugepage advice
+// for large ranges, then mlock while the budget lasts (which also faults the
+// range in). Undo with release() before unmapping or freeing. Any thread.
+void make_resident(void* addr, size_t size);
+void release(void* addr);
+
+// Heap memory for frame buffers the pipeline reuses. Aligned to `align`, or
+// to the page (2 MiB when hugepages apply) so the buffer can be advised and
+// locked on its own; make_resident() is applied. Free with free_buffer().
+void* alloc_buffer(size_t size, size_t align);
+void free_buffer(void* buffer);
+
+// Bytes currently locked by make_resident().
+size_t locked_bytes();
+
+// Add the page faults the calling thread took since its last call to the
+// counters of `role`. A getrusage() call; once per loop iteration of the
+// pipeline's threads.
+void count_faults(oa_thread::Role role);
+
+struct Faults {
+    uint64_t minor = 0;
+    uint64_t major = 0; // needed I/O, e.g. a reclaimed page read back
+};
+Faults faults(oa_thread::Role role);
+
+} // namespace oa_memory
+
+#endif // MEMORY_RESIDENCY_HPP
@@ -0,0 +1,163 @@
+#include "ReconnectSupervisor.hpp"
+#include "Log.hpp"
+#include "ThreadPolicy.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+
+struct ReconnectSupervisor::Shared {
+    ConnectFn connect;
+    AliveFn alive;
+    DisconnectFn disconnect;
+    StateFn on_state;
+    Options options;
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+    bool in_connect = false; // supervisor thread is inside connect()
+    Status status;
+
+    // Held around on_state so stop() can wait for an in-flight notification.
+    std::mutex callback_mutex;
+
+    // Record and report a state change. False once stop() has been called.
+    bool publish(State state, uint32_t attempt, int64_t retry_in_ms) {
+        std::lock_guard<std::mutex> cb(callback_mutex);
+        Status copy;
+        {
+            std::lock_guard<std::mutex> lk(mutex);
+            if (stopping) return false;
+            status.state = state;
+            status.attempt = attempt;
+            status.retry_in_ms = retry_in_ms;
+            if (state == State::Connected) ++status.connects;
+            copy = status;
+        }
+        if (on_state) on_state(copy);
+        return true;
+    }
+
+    Options current_options() const {
+        std::lock_guard<std::mutex> lk(mutex);
+        return options;
+    }
+
+    // Wait up to `delay`; false if stop() was called meanwhile.
+    bool sleep_for(std::chrono::milliseconds delay) {
+        std::unique_lock<std::mutex> lk(mutex);
+        return !cv.wait_for(lk, delay, [this]() { return stopping; });
+    }
+};
+
+ReconnectSupervisor::ReconnectSupervisor(ConnectFn connect, AliveFn alive, DisconnectFn disconnect, StateFn on_state,
+                                         Options options)
+    : shared_(std::make_shared<Shared>()) {
+    shared_->connect = std::move(connect);
+    shared_->alive = std::move(alive);
+    shared_->disconnect = std::move(disconnect);
+    shared_->on_state = std::move(on_state);
+    shared_->options = options;
+}
+
+ReconnectSupervisor::~ReconnectSupervisor() {
+    stop();
+}
+
+void ReconnectSupervisor::start() {
+    if (thread_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lk(shared_->mutex);
+        if (shared_->stopping) return;
+    }
+    thread_ = std::thread(&ReconnectSupervisor::run, shared_);
+}
+
+void ReconnectSupervisor::stop() {
+    bool detach = false;
+    {
+        std::lock_guard<std::mutex> lk(shared_->mutex);
+        shared_->stopping = true;
+        shared_->status.state = State::Stopped;
+        detach = shared_->in_connect;
+    }
+    shared_->cv.notify_all();
+    // Wait out a state notification that may already be running.
+    { std::lock_guard<std::mutex> cb(shared_->callback_mutex); }
+    if (!thread_.joinable()) return;
+    if (detach) {
+        OA_LOG(Info, "ReconnectSupervisor", "connect in progress; detaching supervisor thread");
+        thread_.detach();
+    } else {
+        thread_.join();
+    }
+}
+
+void ReconnectSupervisor::set_options(const Options& options) {
+    std::lock_guard<std::mutex> lk(shared_->mutex);
+    shared_->options = options;
+}
+
+ReconnectSupervisor::Status ReconnectSupervisor::status() const {
+    std::lock_guard<std::mutex> lk(shared_->mutex);
+    return shared_->status;
+}
+
+std::chrono::milliseconds ReconnectSupervisor::backoff_for(uint32_t attempt, const Options& options) {
+    if (attempt == 0) return std::chrono::milliseconds{0};
+    const int64_t cap = std::max<int64_t>(options.max_backoff.count(), 0);
+    int64_t delay = std::max<int64_t>(options.initial_backoff.count(), 1);
+    for (uint32_t i = 1; i < attempt && delay < cap; ++i) delay *= 2;
+    return std::chrono::milliseconds{std::min(delay, cap)};
+}
+
+void ReconnectSupervisor::run(std::shared_ptr<Shared> sh) {
+    uint32_t failures = 0;
+    for (;;) {
+        oa_thread::refresh(oa_thread::Role::Supervisor, "oa-reconnect");
+        if (!sh->publish(State::Connecting, failures, 0)) break;
+        {
+            std::lock_guard<std::mutex> lk(sh->mutex);
+            if (sh->stopping) break;
+            sh->in_connect = true;
+        }
+        const bool ok = sh->connect ? sh->connect() : false;
+        bool stopping = false;
+        {
+            std::lock_guard<std::mutex> lk(sh->mutex);
+            sh->in_connect = false;
+            stopping = sh->stopping;
+        }
+        if (ok && (stopping || !sh->publish(State::Connected, 0, 0))) {
+            if (sh->disconnect) sh->disconnect();
+            break;
+        }
+        if (stopping) break;
+
+        if (ok) {
+            OA_LOG(Info, "ReconnectSupervisor", "connected after {} failed attempts", failures);
+            failures = 0;
+            while (sh->sleep_for(sh->current_options().health_interval)) {
+                oa_thread::refresh(oa_thread::Role::Supervisor, "oa-reconnect");
+                if (sh->alive && !sh->alive()) break;
+            }
+            if (sh->disconnect) sh->disconnect();
+            {
+                std::lock_guard<std::mutex> lk(sh->mutex);
+                if (sh->stopping) break;
+            }
+            // Retry right away after losing an established link; back off only
+            // if that fails too.
+            OA_LOG(Warn, "ReconnectSupervisor", "link lost; reconnecting");
+            continue;
+        }
+
+        ++failures;
+        const auto delay = backoff_for(failures, sh->current_options());
+        OA_LOG_RATE(Warn, 1, "ReconnectSupervisor", "connect attempt {} failed; retrying in {} ms", failures,
+                    delay.count());
+        if (!sh->publish(State::Backoff, failures, delay.count())) break;
+        if (!sh->sleep_for(delay)) break;
+    }
+}
@@ -0,0 +1,81 @@
+// Background connect/reconnect loop with exponential backoff.
+//
+// The supervisor owns no connection itself; the owner supplies callbacks that
+// bring a fresh link up (blocking is fine, it runs on the supervisor thread),
+// report whether it is still alive, and tear it down. Every successful connect
+// goes through `connect` again, so per-connection setup such as handler
+// registration naturally happens on each reconnect.
+
+#ifndef RECONNECT_SUPERVISOR_HPP
+#define RECONNECT_SUPERVISOR_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+
+class ReconnectSupervisor {
+public:
+    enum class State : uint8_t {
+        Idle,       // not started
+        Connecting, // connect callback in progress
+        Connected,  // link up; health polled every health_interval
+        Backoff,    // waiting before the next attempt
+        Stopped,    // stop() called
+    };
+
+    struct Options {
+        std::chrono::milliseconds initial_backoff{250};
+        std::chrono::milliseconds max_backoff{10000};
+        std::chrono::milliseconds health_interval{250};
+    };
+
+    struct Status {
+        State state = State::Idle;
+        uint32_t attempt = 0;  // consecutive failed attempts since the last connect
+        int64_t retry_in_ms = 0; // only meaningful in Backoff
+        uint64_t connects = 0; // successful connects so far
+    };
+
+    // Runs on the supervisor thread. Returns true once the link is up.
+    using ConnectFn = std::function<bool()>;
+    using AliveFn = std::function<bool()>;
+    using DisconnectFn = std::function<void()>;
+    // Runs on the supervisor thread on every state change. Never called after stop() returns.
+    using StateFn = std::function<void(const Status&)>;
+
+    ReconnectSupervisor(ConnectFn connect, AliveFn alive, DisconnectFn disconnect, StateFn on_state,
+                        Options options);
+    ReconnectSupervisor(ConnectFn connect, AliveFn alive, DisconnectFn disconnect, StateFn on_state)
+        : ReconnectSupervisor(std::move(connect), std::move(alive), std::move(disconnect), std::move(on_state),
+                              Options{}) {}
+    ~ReconnectSupervisor();
+
+    ReconnectSupervisor(const ReconnectSupervisor&) = delete;
+    ReconnectSupervisor& operator=(const ReconnectSupervisor&) = delete;
+
+    // Spawn the supervisor thread; returns immediately.
+    void start();
+    // Stop supervising and disconnect. If the thread is blocked inside the
+    // connect callback it is detached rather than joined, so shutdown never
+    // waits on the far side; the callbacks must therefore only capture state
+    // that stays valid on their own (e.g. shared_ptrs).
+    void stop();
+
+    Status status() const;
+    // Takes effect from the next backoff or health check.
+    void set_options(const Options& options);
+
+    // Delay before retry number `attempt` (1-based): initial * 2^(attempt-1), capped.
+    static std::chrono::milliseconds backoff_for(uint32_t attempt, const Options& options);
+
+private:
+    struct Shared;
+    static void run(std::shared_ptr<Shared> shared);
+
+    std::shared_ptr<Shared> shared_;
+    std::thread thread_;
+};
+
+#endif // RECONNECT_SUPERVISOR_HPP
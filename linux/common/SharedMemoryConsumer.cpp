@@ -18,7 +18,8 @@
 
 
 #include "SharedMemoryConsumer.hpp"
-#include <iostream>
+#include "Log.hpp"
+#include "MemoryResidency.hpp"
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <cstring>
@@ -47,7 +48,8 @@ SharedMemoryConsumer::SharedMemoryConsumer(const std::string& shmName, const std
             ptr_(MAP_FAILED),
             buffer_(nullptr),
             producerAliveCheck_(0),
-            onNewBuffer_(callback)
+            onNewBuffer_(callback),
+            stopRequested_(false)
 {
     // Setup signal handling
     struct sigaction sa;
@@ -60,14 +62,12 @@ SharedMemoryConsumer::SharedMemoryConsumer(const std::string& shmName, const std
 
 SharedMemoryConsumer::~SharedMemoryConsumer() {
     // Final cleanup
-    if (ptr_ != MAP_FAILED) munmap(ptr_, shmSize_);
-    if (shm_fd_ != -1) close(shm_fd_);
-    if (semaphore_ != SEM_FAILED) sem_close(semaphore_);
-    std::cout << "Consumer has exited." << std::endl;
+    disconnect();
+    OA_LOG(Info, "SharedMemoryConsumer", "Consumer has exited ({}).", shmName_);
 }
 
 void SharedMemoryConsumer::run() {
-    while (running_) {
+    while (running_ && !stopRequested_.load(std::memory_order_relaxed)) {
         switch (currentState_) {
             case State::CONNECTING:
                 handleConnecting();
@@ -82,24 +82,49 @@ void SharedMemoryConsumer::run() {
     }
 }
 
+void SharedMemoryConsumer::stop() {
+    stopRequested_.store(true, std::memory_order_relaxed);
+}
+
+void SharedMemoryConsumer::disconnect() {
+    if (ptr_ != MAP_FAILED) {
+        oa_memory::release(ptr_);
+        munmap(ptr_, shmSize_);
+        ptr_ = MAP_FAILED;
+        buffer_ = nullptr;
+    }
+    if (shm_fd_ != -1) {
+        close(shm_fd_);
+        shm_fd_ = -1;
+    }
+    if (semaphore_ != SEM_FAILED) {
+        sem_close(semaphore_);
+        semaphore_ = SEM_FAILED;
+    }
+}
+
 void SharedMemoryConsumer::handleConnecting() {
-    std::cout << "[State: CONNECTING] Waiting for shared resources..." << std::endl;
+    OA_LOG_FIRST_N_EVERY(Info, 1, 60, "SharedMemoryConsumer", "[State: CONNECTING] Waiting for shared resources ({})...", shmName_);
     shm_fd_ = shm_open(shmName_.c_str(), O_RDONLY, 0666);
     if (shm_fd_ != -1) {
         semaphore_ = sem_open(semName_.c_str(), 0);
         if (semaphore_ != SEM_FAILED) {
-            ptr_ = mmap(nullptr, shmSize_, PROT_READ, MAP_SHARED, shm_fd_, 0);
+            // Prefault (and lock, within budget) the whole mapping here rather
+            // than page by page across the first frames.
+            ptr_ = mmap(nullptr, shmSize_, PROT_READ, MAP_SHARED | oa_memory::map_flags(), shm_fd_, 0);
             if (ptr_ != MAP_FAILED) {
+                oa_memory::make_resident(ptr_, shmSize_);
                 buffer_ = static_cast<unsigned char*>(ptr_);
-                std::cout << "[State: CONNECTING] Successfully connected." << std::endl;
+                OA_LOG(Info, "SharedMemoryConsumer", "[State: CONNECTING] Successfully connected ({}).", shmName_);
                 producerAliveCheck_ = 0; // Reset counter
                 currentState_ = State::POLLING; // Transition
             } else {
-                perror("mmap failed");
+                OA_LOG(Error, "SharedMemoryConsumer", "mmap failed: {}", std::strerror(errno));
                 currentState_ = State::SHUTDOWN;
             }
         } else {
             close(shm_fd_);
+            shm_fd_ = -1;
         }
     }
 
@@ -125,18 +150,18 @@ void SharedMemoryConsumer::handlePolling() {
         if (errno == ETIMEDOUT) {
             producerAliveCheck_++;
             if (producerAliveCheck_ > 100) {
-                std::cout << "[State: POLLING] Producer not detected for 100 cycles." << std::endl;
+                OA_LOG(Warn, "SharedMemoryConsumer", "[State: POLLING] Producer not detected for 100 cycles ({}).", shmName_);
+                // The producer may come back with a new segment; map that one.
+                disconnect();
                 currentState_ = State::CONNECTING;
             }
             return;
         }
-        perror("sem_timedwait failed");
+        OA_LOG(Error, "SharedMemoryConsumer", "sem_timedwait failed: {}", std::strerror(errno));
         currentState_ = State::SHUTDOWN;
     } else {
         producerAliveCheck_ = 0;
 
-        //std::cout << "first byte: " << static_cast<int>(buffer_[0]) << std::endl;
-
         if (onNewBuffer_) {
             onNewBuffer_(buffer_, shmSize_);
         }
@@ -144,6 +169,6 @@ void SharedMemoryConsumer::handlePolling() {
 }
 
 void SharedMemoryConsumer::handleShutdown() {
-    std::cout << "[State: SHUTDOWN] Shutting down." << std::endl;
+    OA_LOG(Info, "SharedMemoryConsumer", "[State: SHUTDOWN] Shutting down.");
     running_ = 0;
 }
\ No newline at end of file
@@ -19,6 +19,7 @@
 #ifndef SHARED_MEMORY_CONSUMER_HPP
 #define SHARED_MEMORY_CONSUMER_HPP
 
+#include <atomic>
 #include <string>
 #include <csignal>
 #include <semaphore.h>
@@ -32,6 +33,8 @@ public:
     SharedMemoryConsumer(const std::string& shmName, const std::string& semName, size_t shmSize, BufferCallback callback, unsigned int polling_ms = 10);
     ~SharedMemoryConsumer();
     void run();
+    // Ask run() to return after the current state step (thread-safe).
+    void stop();
 
 private:
     enum class State {
@@ -43,6 +46,8 @@ private:
     void handleConnecting();
     void handlePolling();
     void handleShutdown();
+    // Unmap and close whatever handleConnecting() opened.
+    void disconnect();
 
     static void signalHandler(int signal);
 
@@ -61,6 +66,8 @@ private:
     // Member to hold the callback function
     BufferCallback onNewBuffer_;
 
+    std::atomic<bool> stopRequested_;
+
     static volatile std::sig_atomic_t running_;
 };
 
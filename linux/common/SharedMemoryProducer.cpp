@@ -0,0 +1,108 @@
+/*
+ *  This file is part of OpenAutoCore project.
+ *  Copyright (C) 2025 buzzcola3 (Samuel Betak)
+ *
+ *  OpenAutoCore is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenAutoCore is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenAutoCore. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "SharedMemoryProducer.hpp"
+#include "Log.hpp"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <cstring>
+#include <errno.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+SharedMemoryProducer::SharedMemoryProducer(const std::string& shmName, const std::string& semName, size_t shmSize, bool unlinkOnExit)
+        : shmName_(shmName),
+            semName_(semName),
+            shmSize_(shmSize),
+            unlinkOnExit_(unlinkOnExit),
+            semaphore_(SEM_FAILED),
+            shm_fd_(-1),
+            ptr_(MAP_FAILED),
+            buffer_(nullptr)
+{
+}
+
+SharedMemoryProducer::~SharedMemoryProducer() {
+    if (ptr_ != MAP_FAILED) munmap(ptr_, shmSize_);
+    if (shm_fd_ != -1) close(shm_fd_);
+    if (semaphore_ != SEM_FAILED) sem_close(semaphore_);
+    if (unlinkOnExit_) {
+        shm_unlink(shmName_.c_str());
+        sem_unlink(semName_.c_str());
+    }
+}
+
+bool SharedMemoryProducer::open() {
+    if (isOpen()) return true;
+    if (shmSize_ <= kHeaderSize) {
+        OA_LOG(Error, "SharedMemoryProducer", "shm size too small: {}", shmSize_);
+        return false;
+    }
+
+    shm_fd_ = shm_open(shmName_.c_str(), O_CREAT | O_RDWR, 0666);
+    if (shm_fd_ == -1) {
+        OA_LOG(Error, "SharedMemoryProducer", "shm_open failed: {}", std::strerror(errno));
+        return false;
+    }
+    if (ftruncate(shm_fd_, static_cast<off_t>(shmSize_)) == -1) {
+        OA_LOG(Error, "SharedMemoryProducer", "ftruncate failed: {}", std::strerror(errno));
+        close(shm_fd_);
+        shm_fd_ = -1;
+        return false;
+    }
+    ptr_ = mmap(nullptr, shmSize_, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd_, 0);
+    if (ptr_ == MAP_FAILED) {
+        OA_LOG(Error, "SharedMemoryProducer", "mmap failed: {}", std::strerror(errno));
+        close(shm_fd_);
+        shm_fd_ = -1;
+        return false;
+    }
+    // Start from a zero count so a stale semaphore does not replay old posts.
+    sem_unlink(semName_.c_str());
+    semaphore_ = sem_open(semName_.c_str(), O_CREAT, 0666, 0);
+    if (semaphore_ == SEM_FAILED) {
+        OA_LOG(Error, "SharedMemoryProducer", "sem_open failed: {}", std::strerror(errno));
+        munmap(ptr_, shmSize_);
+        ptr_ = MAP_FAILED;
+        close(shm_fd_);
+        shm_fd_ = -1;
+        return false;
+    }
+    buffer_ = static_cast<unsigned char*>(ptr_);
+    std::memset(buffer_, 0, kHeaderSize);
+    return true;
+}
+
+bool SharedMemoryProducer::publish(uint64_t timestamp, const unsigned char* payload, size_t size) {
+    if (!isOpen()) return false;
+    if (size > capacity() || size > UINT32_MAX) return false;
+
+    const uint32_t payload_size = static_cast<uint32_t>(size);
+    std::memcpy(buffer_, &timestamp, sizeof(uint64_t));
+    std::memcpy(buffer_ + sizeof(uint64_t), &payload_size, sizeof(uint32_t));
+    if (payload && size > 0) {
+        std::memcpy(buffer_ + kHeaderSize, payload, size);
+    }
+
+    if (sem_post(semaphore_) == -1) {
+        OA_LOG_RATE(Error, 5, "SharedMemoryProducer", "sem_post failed: {}", std::strerror(errno));
+        return false;
+    }
+    return true;
+}
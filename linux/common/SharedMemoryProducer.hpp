@@ -0,0 +1,66 @@
+/*
+ *  This file is part of OpenAutoCore project.
+ *  Copyright (C) 2025 buzzcola3 (Samuel Betak)
+ *
+ *  OpenAutoCore is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  OpenAutoCore is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with OpenAutoCore. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SHARED_MEMORY_PRODUCER_HPP
+#define SHARED_MEMORY_PRODUCER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <semaphore.h>
+
+// Writer side of the SharedMemoryConsumer protocol: a single shm_open'd buffer
+// framed as [u64 timestamp][u32 payload_size][payload...], with one sem_post
+// per published buffer. Used for loopback tests and benchmarks so the IPC path
+// can be exercised without the OpenAuto core.
+class SharedMemoryProducer {
+public:
+    static constexpr size_t kHeaderSize = sizeof(uint64_t) + sizeof(uint32_t);
+
+    // If unlinkOnExit is set, the shm object and semaphore are removed when the
+    // producer is destroyed so the consumer falls back to CONNECTING.
+    SharedMemoryProducer(const std::string& shmName, const std::string& semName, size_t shmSize, bool unlinkOnExit = true);
+    ~SharedMemoryProducer();
+
+    SharedMemoryProducer(const SharedMemoryProducer&) = delete;
+    SharedMemoryProducer& operator=(const SharedMemoryProducer&) = delete;
+
+    // Create (or attach to) the shm object and semaphore. Returns false on error.
+    bool open();
+    bool isOpen() const { return buffer_ != nullptr; }
+
+    // Largest payload that fits after the header.
+    size_t capacity() const { return shmSize_ > kHeaderSize ? shmSize_ - kHeaderSize : 0; }
+
+    // Frame the payload into the shared buffer and wake the consumer.
+    // Returns false if not open or the payload does not fit.
+    bool publish(uint64_t timestamp, const unsigned char* payload, size_t size);
+
+private:
+    const std::string shmName_;
+    const std::string semName_;
+    const size_t shmSize_;
+    const bool unlinkOnExit_;
+
+    sem_t* semaphore_;
+    int shm_fd_;
+    void* ptr_;
+    unsigned char* buffer_;
+};
+
+#endif // SHARED_MEMORY_PRODUCER_HPP
@@ -0,0 +1,294 @@
+#include "ThreadPolicy.hpp"
+#include "Log.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <pthread.h>
+#include <sched.h>
+#include <sstream>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace oa_thread {
+
+namespace {
+
+constexpr size_t kRoles = static_cast<size_t>(Role::Count);
+constexpr const char* kRoleNames[kRoles] = {"decode", "transport", "touch", "consumer", "supervisor", "logger",
+                                               "metrics"};
+
+// Nice wanted when real-time scheduling is refused and the role sets no nice;
+// see fallback_nice() for what is actually used.
+constexpr int kFallbackNice = -5;
+
+struct Registry {
+    std::mutex mutex;
+    Policy policies[kRoles];
+    std::string spec;
+    std::atomic<uint32_t> generation{1};
+
+    Registry() {
+        if (const char* env = std::getenv("OPENAUTOFLUTTER_THREAD_POLICY")) {
+            std::vector<std::pair<Role, Policy>> parsed;
+            if (parse_spec(env, parsed)) {
+                for (auto& entry : parsed) policies[static_cast<size_t>(entry.first)] = entry.second;
+                spec = env;
+            }
+        }
+    }
+};
+
+Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+thread_local uint32_t t_applied[kRoles] = {};
+thread_local bool t_pinned = false;
+
+bool parse_int(const std::string& s, int& out) {
+    if (s.empty()) return false;
+    char* end = nullptr;
+    const long v = std::strtol(s.c_str(), &end, 10);
+    if (!end || *end != '\0') return false;
+    out = static_cast<int>(v);
+    return true;
+}
+
+bool parse_cpus(const std::string& s, std::vector<int>& out) {
+    std::stringstream ss(s);
+    std::string part;
+    while (std::getline(ss, part, '+')) {
+        const size_t dash = part.find('-');
+        int lo = 0;
+        int hi = 0;
+        if (dash == std::string::npos) {
+            if (!parse_int(part, lo)) return false;
+            hi = lo;
+        } else if (!parse_int(part.substr(0, dash), lo) || !parse_int(part.substr(dash + 1), hi)) {
+            return false;
+        }
+        if (lo < 0 || hi < lo || hi >= CPU_SETSIZE) return false;
+        for (int c = lo; c <= hi; ++c) out.push_back(c);
+    }
+    return !out.empty();
+}
+
+bool parse_policy(const std::string& settings, Policy& out) {
+    std::stringstream ss(settings);
+    std::string kv;
+    while (std::getline(ss, kv, ',')) {
+        if (kv.empty()) continue;
+        const size_t eq = kv.find('=');
+        if (eq == std::string::npos) return false;
+        const std::string key = kv.substr(0, eq);
+        const std::string value = kv.substr(eq + 1);
+        if (key == "cpus") {
+            out.cpus.clear();
+            if (!parse_cpus(value, out.cpus)) return false;
+        } else if (key == "sched") {
+            if (value == "fifo") out.sched = Sched::Fifo;
+            else if (value == "rr") out.sched = Sched::Rr;
+            else if (value == "other") out.sched = Sched::Other;
+            else return false;
+        } else if (key == "prio") {
+            if (!parse_int(value, out.priority) || out.priority < 1 || out.priority > 99) return false;
+        } else if (key == "nice") {
+            if (!parse_int(value, out.nice) || out.nice < -20 || out.nice > 19) return false;
+            out.has_nice = true;
+        } else {
+            return false;
+        }
+    }
+    if (out.sched != Sched::Other && out.priority == 0) out.priority = 1;
+    return true;
+}
+
+bool set_nice(int nice) {
+    const pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+    return setpriority(PRIO_PROCESS, static_cast<id_t>(tid), nice) == 0;
+}
+
+int current_nice() {
+    const pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+    errno = 0;
+    const int nice = getpriority(PRIO_PROCESS, static_cast<id_t>(tid));
+    return errno == 0 ? nice : 0;
+}
+
+// Real-time was refused, so CAP_SYS_NICE is missing and lowering nice is
+// limited by RLIMIT_NICE to 20 - rlim_cur (nothing below the current nice
+// with the usual limit of 0). kFallbackNice clamped to that, and never above
+// the thread's current nice: the fallback must not demote the thread.
+int fallback_nice() {
+    int lowest = 20;
+    rlimit lim{};
+    if (getrlimit(RLIMIT_NICE, &lim) == 0) {
+        lowest = 20 - static_cast<int>(std::min<rlim_t>(lim.rlim_cur, 40));
+    }
+    return std::min(std::max(kFallbackNice, lowest), current_nice());
+}
+
+} // namespace
+
+const char* role_name(Role role) {
+    const size_t i = static_cast<size_t>(role);
+    return i < kRoles ? kRoleNames[i] : "unknown";
+}
+
+bool parse_role(const std::string& name, Role& out) {
+    for (size_t i = 0; i < kRoles; ++i) {
+        if (name == kRoleNames[i]) {
+            out = static_cast<Role>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parse_spec(const std::string& spec, std::vector<std::pair<Role, Policy>>& out) {
+    std::vector<std::pair<Role, Policy>> parsed;
+    std::stringstream ss(spec);
+    std::string entry;
+    while (std::getline(ss, entry, ';')) {
+        entry.erase(std::remove_if(entry.begin(), entry.end(), [](char c) { return c == ' ' || c == '\t'; }),
+                    entry.end());
+        if (entry.empty()) continue;
+        const size_t colon = entry.find(':');
+        Role role;
+        Policy policy;
+        if (colon == std::string::npos || !parse_role(entry.substr(0, colon), role) ||
+            !parse_policy(entry.substr(colon + 1), policy)) {
+            return false;
+        }
+        parsed.emplace_back(role, std::move(policy));
+    }
+    out = std::move(parsed);
+    return true;
+}
+
+bool set_spec(const std::string& text) {
+    std::vector<std::pair<Role, Policy>> parsed;
+    if (!parse_spec(text, parsed)) return false;
+    Registry& r = registry();
+    {
+        std::lock_guard<std::mutex> lk(r.mutex);
+        for (auto& p : r.policies) p = Policy{};
+        for (auto& entry : parsed) r.policies[static_cast<size_t>(entry.first)] = entry.second;
+        r.spec = text;
+    }
+    r.generation.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+std::string spec() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lk(r.mutex);
+    return r.spec;
+}
+
+void set_policy(Role role, const Policy& policy) {
+    Registry& r = registry();
+    {
+        std::lock_guard<std::mutex> lk(r.mutex);
+        r.policies[static_cast<size_t>(role)] = policy;
+    }
+    r.generation.fetch_add(1, std::memory_order_release);
+}
+
+Policy policy(Role role) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lk(r.mutex);
+    return r.policies[static_cast<size_t>(role)];
+}
+
+Applied apply_current(const Policy& p) {
+    Applied applied;
+    const pthread_t self = pthread_self();
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    const long online = sysconf(_SC_NPROCESSORS_ONLN);
+    if (!p.cpus.empty()) {
+        for (int cpu : p.cpus) {
+            if (cpu < online) CPU_SET(cpu, &set);
+        }
+        if (CPU_COUNT(&set) > 0 && pthread_setaffinity_np(self, sizeof(set), &set) == 0) {
+            applied.affinity = true;
+            t_pinned = true;
+        }
+    } else if (t_pinned) {
+        // Undo an earlier mask.
+        for (long cpu = 0; cpu < online && cpu < CPU_SETSIZE; ++cpu) CPU_SET(cpu, &set);
+        if (pthread_setaffinity_np(self, sizeof(set), &set) == 0) t_pinned = false;
+    }
+
+    int want_nice = p.nice;
+    bool use_nice = p.has_nice;
+    if (p.sched != Sched::Other) {
+        const int policy = p.sched == Sched::Fifo ? SCHED_FIFO : SCHED_RR;
+        sched_param param{};
+        param.sched_priority = std::clamp(p.priority, sched_get_priority_min(policy), sched_get_priority_max(policy));
+        if (pthread_setschedparam(self, policy, &param) == 0) {
+            applied.realtime = true;
+            use_nice = false;
+        } else {
+            applied.fell_back = true;
+            if (!use_nice) {
+                want_nice = fallback_nice();
+                use_nice = true;
+            }
+        }
+    } else {
+        int current = SCHED_OTHER;
+        sched_param param{};
+        if (pthread_getschedparam(self, &current, &param) == 0 && current != SCHED_OTHER) {
+            param.sched_priority = 0;
+            pthread_setschedparam(self, SCHED_OTHER, &param);
+        }
+    }
+    if (use_nice) {
+        applied.nice = set_nice(want_nice);
+        applied.nice_value = applied.nice ? want_nice : current_nice();
+    }
+    return applied;
+}
+
+void refresh(Role role, const char* name) {
+    const size_t i = static_cast<size_t>(role);
+    if (i >= kRoles) return;
+    Registry& r = registry();
+    const uint32_t gen = r.generation.load(std::memory_order_acquire);
+    if (t_applied[i] == gen) return;
+    const bool first = t_applied[i] == 0;
+    t_applied[i] = gen;
+
+    if (name && *name) {
+        char truncated[16];
+        std::strncpy(truncated, name, sizeof(truncated) - 1);
+        truncated[sizeof(truncated) - 1] = '\0';
+        pthread_setname_np(pthread_self(), truncated);
+    }
+
+    const Policy p = policy(role);
+    const bool is_default = p.cpus.empty() && p.sched == Sched::Other && !p.has_nice;
+    if (is_default && first && !t_pinned) return; // nothing configured, nothing to undo
+    const Applied applied = apply_current(p);
+
+    // The logger thread must not log about itself.
+    if (role == Role::Logger) return;
+    if (applied.fell_back) {
+        OA_LOG_RATE(Warn, 1, "ThreadPolicy",
+                    "{} ({}): real-time scheduling refused (needs CAP_SYS_NICE or RLIMIT_RTPRIO); running at nice {}{}",
+                    name ? name : "?", role_name(role), applied.nice_value, applied.nice ? "" : " (nice refused)");
+    }
+    OA_LOG(Debug, "ThreadPolicy", "{} ({}): affinity={} realtime={} nice={}", name ? name : "?", role_name(role),
+           applied.affinity, applied.realtime, applied.nice);
+}
+
+} // namespace oa_thread
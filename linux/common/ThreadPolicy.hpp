@@ -0,0 +1,86 @@
+// Scheduling policy for the plugin's threads: CPU affinity, SCHED_FIFO/RR or
+// nice, and thread names, configured per role.
+//
+// Spec format (OPENAUTOFLUTTER_THREAD_POLICY or set_spec()), roles separated
+// by ';', settings by ',':
+//
+//   decode:cpus=2-3,sched=fifo,prio=10;transport:cpus=1,nice=-5;logger:nice=10
+//
+//   cpus=0-1+3       affinity mask (ranges joined with '+')
+//   sched=fifo|rr|other
+//   prio=1..99       real-time priority for fifo/rr
+//   nice=-20..19     nice for sched=other, and the fallback when the process
+//                    may not use real-time scheduling (no CAP_SYS_NICE and no
+//                    RLIMIT_RTPRIO)
+//
+// Without nice=, a refused fifo/rr falls back to nice -5 if RLIMIT_NICE allows
+// it, else to the lowest nice it allows (20 - limit); with the usual limit of
+// 0 the thread keeps its current nice. The nice in effect is reported in
+// Applied::nice_value and logged.
+//
+// Threads pick up changes lazily: each calls refresh() from its loop, which
+// costs one relaxed load unless the policy changed since the thread last
+// applied it.
+
+#ifndef THREAD_POLICY_HPP
+#define THREAD_POLICY_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace oa_thread {
+
+enum class Role : uint8_t {
+    Decode,      // decode pool workers
+    TransportRx, // transport receive callbacks and the replay source
+    Touch,       // touch sender
+    Consumer,    // shared-memory consumers
+    Supervisor,  // transport reconnect supervisor
+    Logger,      // async log writer and video capture writer
+    Metrics,     // metrics endpoint; nice 10 unless configured
+    Count,
+};
+
+enum class Sched : uint8_t { Other, Fifo, Rr };
+
+struct Policy {
+    std::vector<int> cpus; // empty leaves affinity alone
+    Sched sched = Sched::Other;
+    int priority = 0;      // fifo/rr only
+    int nice = 0;
+    bool has_nice = false; // nice=0 is a valid explicit setting
+};
+
+// What refresh() managed to apply to the calling thread.
+struct Applied {
+    bool affinity = false;
+    bool realtime = false;
+    bool nice = false;
+    bool fell_back = false; // real-time was refused and nice was used instead
+    int nice_value = 0;     // the thread's nice afterwards, when nice was set or tried
+};
+
+const char* role_name(Role role);
+bool parse_role(const std::string& name, Role& out);
+
+// Parses a full spec; roles not mentioned get the default policy. Returns
+// false (and changes nothing) on a syntax error.
+bool parse_spec(const std::string& spec, std::vector<std::pair<Role, Policy>>& out);
+bool set_spec(const std::string& spec);
+std::string spec();
+
+void set_policy(Role role, const Policy& policy);
+Policy policy(Role role);
+
+// Name the calling thread (truncated to 15 chars) and apply the role's
+// policy if it changed since this thread last applied it. Safe to call on
+// every loop iteration, including from threads the plugin did not create.
+void refresh(Role role, const char* name);
+
+// Unconditionally apply `policy` to the calling thread.
+Applied apply_current(const Policy& policy);
+
+} // namespace oa_thread
+
+#endif // THREAD_POLICY_HPP
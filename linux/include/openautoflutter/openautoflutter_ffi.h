@@ -0,0 +1,111 @@
+#ifndef FLUTTER_PLUGIN_OPENAUTOFLUTTER_FFI_H_
+#define FLUTTER_PLUGIN_OPENAUTOFLUTTER_FFI_H_
+
+// Plain C entry points for dart:ffi. They can be called from any thread and
+// do not go through the platform message loop.
+
+#include <stdint.h>
+
+#ifdef FLUTTER_PLUGIN_IMPL
+#define FLUTTER_PLUGIN_EXPORT __attribute__((visibility("default")))
+#else
+#define FLUTTER_PLUGIN_EXPORT
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Same layout as the TOUCH wire message: x/y normalized to [0, 1], action is
+// 0=down 1=up 2=moved 3=pointer down 4=pointer up.
+typedef struct {
+  float x;
+  float y;
+  uint32_t pointer_id;
+  uint32_t action;
+} OpenautoflutterTouch;
+
+// Fields are only ever appended; callers pass sizeof() of the struct they were
+// built against.
+typedef struct {
+  uint64_t video_packets;
+  uint64_t video_bytes;
+  uint64_t frames_decoded;
+  uint64_t decode_failures;
+  uint64_t frames_presented;
+  int64_t last_decode_us;
+  int64_t last_present_us;
+  int64_t width;
+  int64_t height;
+  int64_t transport_running;
+  uint64_t touch_enqueued;
+  uint64_t touch_coalesced;
+  uint64_t touch_sent;
+  uint64_t touch_failed;
+  uint64_t touch_dropped;
+  int64_t touch_last_latency_us;
+  uint64_t frames_discarded;   // dropped while waiting for an IDR after a decode error
+  uint64_t decode_recoveries;
+  int64_t last_recover_us;     // first decode error -> first clean frame
+  uint64_t keyframe_requests;
+} OpenautoflutterStats;
+
+// A decoded frame published by a stream's frame tap. Read-only; valid until
+// passed to openautoflutter_frame_tap_release().
+typedef struct {
+  uint64_t sequence;      // per stream, increasing
+  int64_t stream_id;
+  int64_t decode_ts_us;   // steady clock
+  uint32_t format;        // 1=luma (8-bit Y plane) 2=I420 packed [Y][U][V]
+  uint32_t width;
+  uint32_t height;
+  uint32_t stride;        // bytes per luma row
+  const uint8_t* data;
+  uint64_t size;          // bytes at data
+  void* reserved;
+} OpenautoflutterTapFrame;
+
+// Queue one touch for the transport. Returns 1 if queued, 0 if no plugin is
+// registered, -1 for an invalid action or coordinate.
+FLUTTER_PLUGIN_EXPORT int32_t openautoflutter_send_touch(uint32_t pointer_id,
+                                                         float x,
+                                                         float y,
+                                                         uint32_t action);
+
+// Queue `count` touches; invalid entries are skipped. Returns the number
+// queued, or -1 if no plugin is registered.
+FLUTTER_PLUGIN_EXPORT int32_t openautoflutter_send_touch_batch(
+    const OpenautoflutterTouch* touches, uint32_t count);
+
+// Copy up to `size` bytes of the current counters into `out`. Returns the
+// number of bytes written.
+FLUTTER_PLUGIN_EXPORT uint32_t openautoflutter_read_stats(OpenautoflutterStats* out,
+                                                          uint32_t size);
+
+// Start, change or stop (format 0) publishing decoded frames of a stream.
+// Luma frames are scaled down to fit max_width x max_height (0 = decoded
+// size); I420 frames keep the decoded size. At most one frame per
+// interval_ms is published. Returns 1 on success, 0 for an unknown stream,
+// -1 for an invalid format.
+FLUTTER_PLUGIN_EXPORT int32_t openautoflutter_frame_tap_configure(int64_t stream_id,
+                                                                  uint32_t format,
+                                                                  uint32_t max_width,
+                                                                  uint32_t max_height,
+                                                                  uint32_t interval_ms);
+
+// The stream's newest frame if its sequence is above after_sequence, else
+// NULL. The frame is referenced for the caller and must be released; while
+// readers hold all of a stream's few buffers, new frames are skipped rather
+// than waited for.
+FLUTTER_PLUGIN_EXPORT const OpenautoflutterTapFrame* openautoflutter_frame_tap_acquire(
+    int64_t stream_id, uint64_t after_sequence);
+
+// Drop a reference from openautoflutter_frame_tap_acquire(). Any thread, also
+// after the stream is destroyed. NULL is ignored.
+FLUTTER_PLUGIN_EXPORT void openautoflutter_frame_tap_release(const OpenautoflutterTapFrame* frame);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // FLUTTER_PLUGIN_OPENAUTOFLUTTER_FFI_H_
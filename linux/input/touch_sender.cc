@@ -0,0 +1,171 @@
+#include "touch_sender.h"
+#include "../common/Log.hpp"
+#include "../common/ThreadPolicy.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+uint64_t steady_now_us() {
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+std::shared_ptr<TouchSender> g_active_sender;
+
+} // namespace
+
+void set_active_touch_sender(std::shared_ptr<TouchSender> sender) {
+	std::atomic_store(&g_active_sender, std::move(sender));
+}
+
+std::shared_ptr<TouchSender> active_touch_sender() {
+	return std::atomic_load(&g_active_sender);
+}
+
+bool sanitize_touch(TouchMessage& msg) {
+	if (msg.action > static_cast<uint32_t>(TouchAction::POINTER_UP)) return false;
+	if (!std::isfinite(msg.x) || !std::isfinite(msg.y)) return false;
+	msg.x = std::clamp(msg.x, 0.0f, 1.0f);
+	msg.y = std::clamp(msg.y, 0.0f, 1.0f);
+	return true;
+}
+
+TouchSender::TouchSender(SendFn send, std::chrono::microseconds coalesce_window)
+	: send_(std::move(send)), window_(coalesce_window) {
+	pending_.reserve(64);
+}
+
+TouchSender::~TouchSender() { stop(); }
+
+void TouchSender::start() {
+	std::lock_guard<std::mutex> lk(mutex_);
+	if (thread_.joinable()) return;
+	stop_ = false;
+	thread_ = std::thread([this]() { run(); });
+}
+
+void TouchSender::stop() {
+	{
+		std::lock_guard<std::mutex> lk(mutex_);
+		stop_ = true;
+	}
+	cv_.notify_one();
+	if (thread_.joinable()) thread_.join();
+}
+
+bool TouchSender::append_coalesced(std::vector<PendingTouch>& pending, const PendingTouch& touch) {
+	if (touch.msg.action == static_cast<uint32_t>(TouchAction::MOVED)) {
+		// Walk back over the trailing run of MOVED events only; anything before
+		// a DOWN/UP must keep its position relative to it.
+		for (auto it = pending.rbegin(); it != pending.rend(); ++it) {
+			if (it->msg.action != static_cast<uint32_t>(TouchAction::MOVED)) break;
+			if (it->msg.pointer_id == touch.msg.pointer_id) {
+				it->msg.x = touch.msg.x;
+				it->msg.y = touch.msg.y;
+				it->ts_us = touch.ts_us;
+				return true;
+			}
+		}
+	}
+	pending.push_back(touch);
+	return false;
+}
+
+void TouchSender::set_region(float x, float y, float width, float height) {
+	if (!std::isfinite(x) || !std::isfinite(y) || !std::isfinite(width) || !std::isfinite(height) ||
+		width <= 0.0f || height <= 0.0f) {
+		x = y = 0.0f;
+		width = height = 1.0f;
+	}
+	std::lock_guard<std::mutex> lk(mutex_);
+	region_x_ = std::clamp(x, 0.0f, 1.0f);
+	region_y_ = std::clamp(y, 0.0f, 1.0f);
+	region_w_ = std::clamp(width, 0.0f, 1.0f - region_x_);
+	region_h_ = std::clamp(height, 0.0f, 1.0f - region_y_);
+}
+
+void TouchSender::enqueue_locked(const TouchMessage& in, uint64_t ts_us) {
+	TouchMessage msg = in;
+	msg.x = region_x_ + msg.x * region_w_;
+	msg.y = region_y_ + msg.y * region_h_;
+	const bool moved = msg.action == static_cast<uint32_t>(TouchAction::MOVED);
+	enqueued_.fetch_add(1, std::memory_order_relaxed);
+	if (moved && pending_.size() >= kMaxPending) {
+		dropped_.fetch_add(1, std::memory_order_relaxed); // never drop DOWN/UP; a later MOVED carries the position
+		return;
+	}
+	if (pending_.empty()) oldest_ = std::chrono::steady_clock::now();
+	if (append_coalesced(pending_, PendingTouch{msg, ts_us})) coalesced_.fetch_add(1, std::memory_order_relaxed);
+	if (!moved) urgent_ = true;
+}
+
+void TouchSender::enqueue(const TouchMessage& msg) {
+	enqueue(&msg, 1);
+}
+
+void TouchSender::enqueue(const TouchMessage* msgs, size_t count) {
+	if (!msgs || count == 0) return;
+	const uint64_t ts_us = steady_now_us();
+	bool notify = false;
+	{
+		std::lock_guard<std::mutex> lk(mutex_);
+		const bool was_empty = pending_.empty();
+		for (size_t i = 0; i < count; ++i) enqueue_locked(msgs[i], ts_us);
+		notify = was_empty || urgent_;
+	}
+	if (notify) cv_.notify_one();
+}
+
+TouchSender::Stats TouchSender::stats() const {
+	Stats s;
+	s.enqueued = enqueued_.load(std::memory_order_relaxed);
+	s.coalesced = coalesced_.load(std::memory_order_relaxed);
+	s.sent = sent_.load(std::memory_order_relaxed);
+	s.failed = failed_.load(std::memory_order_relaxed);
+	s.dropped = dropped_.load(std::memory_order_relaxed);
+	s.last_latency_us = last_latency_us_.load(std::memory_order_relaxed);
+	return s;
+}
+
+void TouchSender::run() {
+	std::vector<PendingTouch> batch;
+	batch.reserve(64);
+	std::unique_lock<std::mutex> lk(mutex_);
+	for (;;) {
+		oa_thread::refresh(oa_thread::Role::Touch, "oa-touch");
+		cv_.wait(lk, [this]() { return stop_ || !pending_.empty(); });
+		if (pending_.empty() && stop_) break;
+		// Hold MOVED-only batches for the rest of the window so further moves
+		// merge into them; DOWN/UP (urgent) or stop flush right away.
+		if (!urgent_ && !stop_) {
+			cv_.wait_until(lk, oldest_ + window_, [this]() { return stop_ || urgent_; });
+		}
+		batch.swap(pending_);
+		urgent_ = false;
+		lk.unlock();
+
+		uint64_t sent = 0;
+		uint64_t failed = 0;
+		for (const PendingTouch& t : batch) {
+			if (send_ && send_(t.msg, t.ts_us)) {
+				++sent;
+			} else {
+				++failed;
+			}
+		}
+		if (!batch.empty()) {
+			last_latency_us_.store(static_cast<int64_t>(steady_now_us() - batch.back().ts_us),
+								   std::memory_order_relaxed);
+		}
+		if (failed) {
+			OA_LOG_RATE(Warn, 1, "TouchSender", "transport not running; dropped {} touch events", failed);
+		}
+		batch.clear();
+		sent_.fetch_add(sent, std::memory_order_relaxed);
+		failed_.fetch_add(failed, std::memory_order_relaxed);
+
+		lk.lock();
+	}
+}
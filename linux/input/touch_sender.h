@@ -0,0 +1,116 @@
+// Touch message types and an asynchronous, coalescing sender.
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+enum class TouchAction : uint32_t {
+	DOWN = 0,
+	UP = 1,
+	MOVED = 2,
+	POINTER_DOWN = 3,
+	POINTER_UP = 4,
+};
+
+// Wire layout of one touch, also used for packed batches from Dart
+// (little-endian f32 x, f32 y, u32 pointer_id, u32 action).
+struct TouchMessage {
+	float x;
+	float y;
+	uint32_t pointer_id;
+	uint32_t action;
+};
+
+static_assert(sizeof(TouchMessage) == 16, "TouchMessage layout unexpected");
+
+struct PendingTouch {
+	TouchMessage msg;
+	uint64_t ts_us;
+};
+
+// Validate the action code and clamp coordinates to [0, 1]. Returns false for
+// unknown actions or non-finite coordinates.
+bool sanitize_touch(TouchMessage& msg);
+
+// Queues touches from any thread and sends them to the transport on a
+// dedicated thread. Consecutive MOVED events for the same pointer that are
+// still queued are merged (latest position wins) for up to one coalescing
+// window; any other action flushes the queue immediately.
+class TouchSender {
+public:
+	using SendFn = std::function<bool(const TouchMessage& msg, uint64_t ts_us)>;
+
+	struct Stats {
+		uint64_t enqueued = 0;
+		uint64_t coalesced = 0;
+		uint64_t sent = 0;
+		uint64_t failed = 0;
+		uint64_t dropped = 0;
+		int64_t last_latency_us = 0; // enqueue to transport send, most recent touch
+	};
+
+	explicit TouchSender(SendFn send,
+						 std::chrono::microseconds coalesce_window = std::chrono::microseconds(8000));
+	~TouchSender();
+
+	TouchSender(const TouchSender&) = delete;
+	TouchSender& operator=(const TouchSender&) = delete;
+
+	void start();
+	// Flush what is queued, then join the sender thread.
+	void stop();
+
+	void enqueue(const TouchMessage& msg);
+	void enqueue(const TouchMessage* msgs, size_t count);
+
+	// Part of the remote screen the local view shows, as fractions of it
+	// (e.g. a cropped video). Touches enqueued afterwards, normalized to the
+	// view, are mapped into that region. Defaults to the whole screen.
+	void set_region(float x, float y, float width, float height);
+
+	// Lock-free snapshot of the counters.
+	Stats stats() const;
+
+	// Append `touch` to `pending`, merging it into the most recent queued
+	// MOVED for the same pointer if no non-MOVED event follows it. Returns true
+	// if it was merged.
+	static bool append_coalesced(std::vector<PendingTouch>& pending, const PendingTouch& touch);
+
+private:
+	void run();
+	void enqueue_locked(const TouchMessage& msg, uint64_t ts_us);
+
+	static constexpr size_t kMaxPending = 1024;
+
+	SendFn send_;
+	const std::chrono::microseconds window_;
+
+	mutable std::mutex mutex_;
+	std::condition_variable cv_;
+	std::vector<PendingTouch> pending_;
+	std::chrono::steady_clock::time_point oldest_;
+	float region_x_ = 0.0f, region_y_ = 0.0f, region_w_ = 1.0f, region_h_ = 1.0f;
+	bool urgent_ = false;
+	bool stop_ = false;
+	std::thread thread_;
+
+	std::atomic<uint64_t> enqueued_{0};
+	std::atomic<uint64_t> coalesced_{0};
+	std::atomic<uint64_t> sent_{0};
+	std::atomic<uint64_t> failed_{0};
+	std::atomic<uint64_t> dropped_{0};
+	std::atomic<int64_t> last_latency_us_{0};
+};
+
+// The sender of the live plugin instance, for callers that have no plugin
+// handle (the exported C ABI). Null when no plugin is registered.
+void set_active_touch_sender(std::shared_ptr<TouchSender> sender);
+std::shared_ptr<TouchSender> active_touch_sender();
@@ -0,0 +1,102 @@
+#include "include/openautoflutter/openautoflutter_ffi.h"
+#include "av/frame_tap.h"
+#include "av/pipeline_stats.h"
+#include "input/touch_sender.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+static_assert(sizeof(OpenautoflutterTouch) == sizeof(TouchMessage),
+              "OpenautoflutterTouch must match TouchMessage");
+static_assert(sizeof(OpenautoflutterTapFrame) == sizeof(TapFrame) &&
+                  offsetof(OpenautoflutterTapFrame, data) == offsetof(TapFrame, data) &&
+                  offsetof(OpenautoflutterTapFrame, reserved) == offsetof(TapFrame, buffer),
+              "OpenautoflutterTapFrame must match TapFrame");
+
+int32_t openautoflutter_send_touch(uint32_t pointer_id, float x, float y, uint32_t action) {
+  TouchMessage msg{x, y, pointer_id, action};
+  if (!sanitize_touch(msg)) return -1;
+  auto sender = active_touch_sender();
+  if (!sender) return 0;
+  sender->enqueue(msg);
+  return 1;
+}
+
+int32_t openautoflutter_send_touch_batch(const OpenautoflutterTouch* touches, uint32_t count) {
+  auto sender = active_touch_sender();
+  if (!sender) return -1;
+  if (!touches || count == 0) return 0;
+
+  std::vector<TouchMessage> batch;
+  batch.reserve(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    TouchMessage msg;
+    std::memcpy(&msg, &touches[i], sizeof(msg));
+    if (sanitize_touch(msg)) batch.push_back(msg);
+  }
+  sender->enqueue(batch.data(), batch.size());
+  return static_cast<int32_t>(batch.size());
+}
+
+uint32_t openautoflutter_read_stats(OpenautoflutterStats* out, uint32_t size) {
+  if (!out || size == 0) return 0;
+
+  const PipelineStats& p = pipeline_stats();
+  OpenautoflutterStats s{};
+  s.video_packets = p.video_packets.load(std::memory_order_relaxed);
+  s.video_bytes = p.video_bytes.load(std::memory_order_relaxed);
+  s.frames_decoded = p.frames_decoded.load(std::memory_order_relaxed);
+  s.decode_failures = p.decode_failures.load(std::memory_order_relaxed);
+  s.frames_presented = p.frames_presented.load(std::memory_order_relaxed);
+  s.last_decode_us = p.last_decode_us.load(std::memory_order_relaxed);
+  s.last_present_us = p.last_present_us.load(std::memory_order_relaxed);
+  s.width = p.width.load(std::memory_order_relaxed);
+  s.height = p.height.load(std::memory_order_relaxed);
+  s.transport_running = p.transport_running.load(std::memory_order_relaxed) ? 1 : 0;
+  s.frames_discarded = p.frames_discarded.load(std::memory_order_relaxed);
+  s.decode_recoveries = p.decode_recoveries.load(std::memory_order_relaxed);
+  s.last_recover_us = p.last_recover_us.load(std::memory_order_relaxed);
+  s.keyframe_requests = p.keyframe_requests.load(std::memory_order_relaxed);
+  if (auto sender = active_touch_sender()) {
+    const TouchSender::Stats t = sender->stats();
+    s.touch_enqueued = t.enqueued;
+    s.touch_coalesced = t.coalesced;
+    s.touch_sent = t.sent;
+    s.touch_failed = t.failed;
+    s.touch_dropped = t.dropped;
+    s.touch_last_latency_us = t.last_latency_us;
+  }
+
+  const uint32_t n = std::min<uint32_t>(size, sizeof(s));
+  std::memcpy(out, &s, n);
+  return n;
+}
+
+int32_t openautoflutter_frame_tap_configure(int64_t stream_id,
+                                            uint32_t format,
+                                            uint32_t max_width,
+                                            uint32_t max_height,
+                                            uint32_t interval_ms) {
+  if (format > static_cast<uint32_t>(FrameTapFormat::I420)) return -1;
+  auto tap = find_frame_tap(stream_id);
+  if (!tap) return 0;
+  FrameTapConfig config;
+  config.format = static_cast<FrameTapFormat>(format);
+  config.max_width = static_cast<int>(std::min<uint32_t>(max_width, 1u << 16));
+  config.max_height = static_cast<int>(std::min<uint32_t>(max_height, 1u << 16));
+  config.min_interval_us = static_cast<int64_t>(interval_ms) * 1000;
+  tap->configure(config);
+  return 1;
+}
+
+const OpenautoflutterTapFrame* openautoflutter_frame_tap_acquire(int64_t stream_id, uint64_t after_sequence) {
+  auto tap = find_frame_tap(stream_id);
+  if (!tap) return nullptr;
+  return reinterpret_cast<const OpenautoflutterTapFrame*>(tap->acquire(after_sequence));
+}
+
+void openautoflutter_frame_tap_release(const OpenautoflutterTapFrame* frame) {
+  FrameTap::release(reinterpret_cast<const TapFrame*>(frame));
+}
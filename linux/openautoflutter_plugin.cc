@@ -1,6 +1,17 @@
 #include "include/openautoflutter/openautoflutter_plugin.h"
-#include "av/oa_video_texture.h"
-#include "av/h264_decoder.h"
+#include "av/decode_pool.h"
+#include "av/gl_resources.h"
+#include "av/metrics_server.h"
+#include "av/pipeline_config.h"
+#include "av/pipeline_stats.h"
+#include "av/startup_timeline.h"
+#include "av/video_capture.h"
+#include "av/video_stream.h"
+#include "common/Log.hpp"
+#include "common/MemoryResidency.hpp"
+#include "common/ReconnectSupervisor.hpp"
+#include "common/ThreadPolicy.hpp"
+#include "input/touch_sender.h"
 #include "transport.hpp"
 #include "wire.hpp"
 #include <flutter_linux/flutter_linux.h>
@@ -9,14 +20,15 @@
 #include <glib.h>
 #include <sys/utsname.h>
 
+#include <atomic>
 #include <chrono>
 #include <cstring>
-#include <iostream>
-#include <iomanip>
+#include <exception>
+#include <map>
 #include <memory>
 #include <algorithm>
 #include <mutex>
-#include <sstream>
+#include <set>
 #include <vector>
 #include <string>
 
@@ -26,36 +38,6 @@ using OAMsgType = buzz::wire::MsgType;
 #include "openautoflutter_plugin_private.h"
 
 namespace {
-// Short hex preview helper for debugging payloads.
-std::string hex_head(const uint8_t* data, size_t size, size_t max_bytes = 32) {
-  if (!data || size == 0) return "";
-  std::ostringstream oss;
-  const size_t n = std::min(size, max_bytes);
-  for (size_t i = 0; i < n; ++i) {
-    if (i) oss << ' ';
-    oss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(data[i]);
-  }
-  if (size > max_bytes) oss << " ...";
-  return oss.str();
-}
-
-enum class TouchAction : uint32_t {
-  DOWN = 0,
-  UP = 1,
-  MOVED = 2,
-  POINTER_DOWN = 3,
-  POINTER_UP = 4,
-};
-
-struct TouchMessage {
-  float x;
-  float y;
-  uint32_t pointer_id;
-  uint32_t action;
-};
-
-static_assert(sizeof(TouchMessage) == 16, "TouchMessage layout unexpected");
-
 double get_number(FlValue* value, bool& ok) {
   ok = false;
   if (!value) return 0.0;
@@ -71,6 +53,139 @@ double get_number(FlValue* value, bool& ok) {
   }
 }
 
+// Returns nullptr if the key is missing or not a string.
+const gchar* get_string(FlValue* args, const char* key) {
+  if (!args || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) return nullptr;
+  FlValue* v = fl_value_lookup_string(args, key);
+  if (!v || fl_value_get_type(v) != FL_VALUE_TYPE_STRING) return nullptr;
+  return fl_value_get_string(v);
+}
+
+bool get_bool(FlValue* args, const char* key, bool fallback) {
+  if (!args || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) return fallback;
+  FlValue* v = fl_value_lookup_string(args, key);
+  if (!v || fl_value_get_type(v) != FL_VALUE_TYPE_BOOL) return fallback;
+  return fl_value_get_bool(v);
+}
+
+// Applies the optional configurePipeline keys to `config`. Keys that are
+// present with the wrong type are errors; ranges are clamped afterwards.
+bool parse_pipeline_args(FlValue* args, PipelineConfig& config, const gchar*& thread_policy, std::string& error) {
+  thread_policy = nullptr;
+  if (!args || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    error = "Args must be a map";
+    return false;
+  }
+  struct IntKey {
+    const char* name;
+    int* field;
+  };
+  const IntKey int_keys[] = {
+    {"pumpIntervalMs", &config.pump_interval_ms},
+    {"transportWaitMs", &config.transport_wait_ms},
+    {"transportPollUs", &config.transport_poll_us},
+    {"reconnectInitialBackoffMs", &config.reconnect_initial_ms},
+    {"reconnectMaxBackoffMs", &config.reconnect_max_ms},
+    {"shmPollMs", &config.shm_poll_ms},
+    {"decodeThreads", &config.decoder.threads},
+    {"keyframeRequestType", &config.keyframe_request_type},
+    {"decodeCpuPercent", &config.worker.cpu_percent},
+  };
+  for (const auto& key : int_keys) {
+    FlValue* v = fl_value_lookup_string(args, key.name);
+    if (!v || fl_value_get_type(v) == FL_VALUE_TYPE_NULL) continue;
+    if (fl_value_get_type(v) != FL_VALUE_TYPE_INT) {
+      error = std::string("Invalid ") + key.name;
+      return false;
+    }
+    *key.field = static_cast<int>(std::clamp<int64_t>(fl_value_get_int(v), INT32_MIN, INT32_MAX));
+  }
+  if (FlValue* v = fl_value_lookup_string(args, "shmVideoSize")) {
+    if (fl_value_get_type(v) == FL_VALUE_TYPE_INT) {
+      config.shm_video_size = static_cast<size_t>(std::max<int64_t>(fl_value_get_int(v), 0));
+    } else if (fl_value_get_type(v) != FL_VALUE_TYPE_NULL) {
+      error = "Invalid shmVideoSize";
+      return false;
+    }
+  }
+  if (FlValue* v = fl_value_lookup_string(args, "memoryLockBudget")) {
+    if (fl_value_get_type(v) == FL_VALUE_TYPE_INT) {
+      config.memory.lock_budget = static_cast<size_t>(std::max<int64_t>(fl_value_get_int(v), 0));
+    } else if (fl_value_get_type(v) != FL_VALUE_TYPE_NULL) {
+      error = "Invalid memoryLockBudget";
+      return false;
+    }
+  }
+  struct BoolKey {
+    const char* name;
+    bool* field;
+  };
+  const BoolKey bool_keys[] = {
+    {"lowDelay", &config.decoder.low_delay},
+    {"fastDecode", &config.decoder.fast},
+    {"decodeWorker", &config.worker.enabled},
+    {"prefaultMemory", &config.memory.prefault},
+    {"hugePages", &config.memory.hugepages},
+  };
+  for (const auto& key : bool_keys) {
+    FlValue* v = fl_value_lookup_string(args, key.name);
+    if (!v || fl_value_get_type(v) == FL_VALUE_TYPE_NULL) continue;
+    if (fl_value_get_type(v) != FL_VALUE_TYPE_BOOL) {
+      error = std::string("Invalid ") + key.name;
+      return false;
+    }
+    *key.field = fl_value_get_bool(v);
+  }
+  if (FlValue* v = fl_value_lookup_string(args, "scaler")) {
+    if (fl_value_get_type(v) != FL_VALUE_TYPE_NULL &&
+        (fl_value_get_type(v) != FL_VALUE_TYPE_STRING || !parse_scaler(fl_value_get_string(v), config.decoder.scaler))) {
+      error = "Unknown scaler";
+      return false;
+    }
+  }
+  if (FlValue* v = fl_value_lookup_string(args, "decodeCgroup")) {
+    if (fl_value_get_type(v) == FL_VALUE_TYPE_STRING) {
+      config.worker.cgroup = fl_value_get_string(v);
+    } else if (fl_value_get_type(v) != FL_VALUE_TYPE_NULL) {
+      error = "Invalid decodeCgroup";
+      return false;
+    }
+  }
+  if (FlValue* v = fl_value_lookup_string(args, "threadPolicy")) {
+    if (fl_value_get_type(v) == FL_VALUE_TYPE_STRING) {
+      thread_policy = fl_value_get_string(v);
+    } else if (fl_value_get_type(v) != FL_VALUE_TYPE_NULL) {
+      error = "Invalid threadPolicy";
+      return false;
+    }
+  }
+  return true;
+}
+
+FlValue* pipeline_config_value(const PipelineConfig& config) {
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(value, "pumpIntervalMs", fl_value_new_int(config.pump_interval_ms));
+  fl_value_set_string_take(value, "transportWaitMs", fl_value_new_int(config.transport_wait_ms));
+  fl_value_set_string_take(value, "transportPollUs", fl_value_new_int(config.transport_poll_us));
+  fl_value_set_string_take(value, "reconnectInitialBackoffMs", fl_value_new_int(config.reconnect_initial_ms));
+  fl_value_set_string_take(value, "reconnectMaxBackoffMs", fl_value_new_int(config.reconnect_max_ms));
+  fl_value_set_string_take(value, "shmPollMs", fl_value_new_int(config.shm_poll_ms));
+  fl_value_set_string_take(value, "shmVideoSize", fl_value_new_int(static_cast<int64_t>(config.shm_video_size)));
+  fl_value_set_string_take(value, "scaler", fl_value_new_string(scaler_name(config.decoder.scaler)));
+  fl_value_set_string_take(value, "decodeThreads", fl_value_new_int(config.decoder.threads));
+  fl_value_set_string_take(value, "lowDelay", fl_value_new_bool(config.decoder.low_delay));
+  fl_value_set_string_take(value, "fastDecode", fl_value_new_bool(config.decoder.fast));
+  fl_value_set_string_take(value, "keyframeRequestType", fl_value_new_int(config.keyframe_request_type));
+  fl_value_set_string_take(value, "decodeWorker", fl_value_new_bool(config.worker.enabled));
+  fl_value_set_string_take(value, "decodeCgroup", fl_value_new_string(config.worker.cgroup.c_str()));
+  fl_value_set_string_take(value, "decodeCpuPercent", fl_value_new_int(config.worker.cpu_percent));
+  fl_value_set_string_take(value, "prefaultMemory", fl_value_new_bool(config.memory.prefault));
+  fl_value_set_string_take(value, "hugePages", fl_value_new_bool(config.memory.hugepages));
+  fl_value_set_string_take(value, "memoryLockBudget", fl_value_new_int(static_cast<int64_t>(config.memory.lock_budget)));
+  fl_value_set_string_take(value, "threadPolicy", fl_value_new_string(oa_thread::spec().c_str()));
+  return value;
+}
+
 bool parse_touch_args(FlValue* args, TouchMessage& out, std::string& error) {
   if (!args || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
     error = "Args must be a map";
@@ -99,27 +214,14 @@ bool parse_touch_args(FlValue* args, TouchMessage& out, std::string& error) {
     return false;
   }
 
-  const int64_t action_i = static_cast<int64_t>(action_val);
-  TouchAction action_enum;
-  switch (action_i) {
-    case 0: action_enum = TouchAction::DOWN; break;
-    case 1: action_enum = TouchAction::UP; break;
-    case 2: action_enum = TouchAction::MOVED; break;
-    case 3: action_enum = TouchAction::POINTER_DOWN; break;
-    case 4: action_enum = TouchAction::POINTER_UP; break;
-    default:
-      error = "Unsupported action code";
-      return false;
-  }
-
-  const auto clamp01 = [](double v) {
-    return std::clamp(v, 0.0, 1.0);
-  };
-
-  out.x = static_cast<float>(clamp01(x));
-  out.y = static_cast<float>(clamp01(y));
+  out.x = static_cast<float>(std::clamp(x, 0.0, 1.0));
+  out.y = static_cast<float>(std::clamp(y, 0.0, 1.0));
   out.pointer_id = pid_val < 0 ? 0u : static_cast<uint32_t>(pid_val);
-  out.action = static_cast<uint32_t>(action_enum);
+  out.action = (action_val < 0 || action_val > UINT32_MAX) ? UINT32_MAX : static_cast<uint32_t>(action_val);
+  if (!sanitize_touch(out)) {
+    error = "Unsupported action code";
+    return false;
+  }
   return true;
 }
 } // namespace
@@ -128,124 +230,429 @@ bool parse_touch_args(FlValue* args, TouchMessage& out, std::string& error) {
   (G_TYPE_CHECK_INSTANCE_CAST((obj), openautoflutter_plugin_get_type(), \
                               OpenautoflutterPlugin))
 
+// Video pipelines and their transport routing. Heap-allocated because GObject
+// instance memory is zero-filled rather than constructed.
+struct VideoStreamTable {
+  // Keyed by stream id; stream 0 is created at startup and bound to
+  // OAMsgType::VIDEO. Only touched on the main thread.
+  std::map<int64_t, std::shared_ptr<VideoStream>> streams;
+  int64_t next_id = 0;
+
+  // Transport message type -> stream, read from transport callbacks.
+  std::mutex routes_mutex;
+  std::map<int, std::weak_ptr<VideoStream>> routes;
+  // Types with a handler on the transport `handled_for`, set as soon as a
+  // connect has started it (before TransportLink publishes it) and cleared
+  // when it is disconnected. Each reconnect brings up a fresh transport, so
+  // this is rebuilt on every connect.
+  std::shared_ptr<OATransport> handled_for;
+  std::set<int> handled_types;
+  bool connected_before = false; // supervisor thread only
+
+  std::shared_ptr<VideoCaptureWriter> capture; // optional VIDEO recording; read with std::atomic_load
+};
+
+// The transport currently connected by the supervisor. Shared with the
+// supervisor thread, which may outlive the plugin while a connect is pending.
+struct TransportLink {
+  std::shared_ptr<OATransport> transport; // null while disconnected; std::atomic_load/store
+};
+
 struct _OpenautoflutterPlugin {
   GObject parent_instance;
-  OAVideoTexture* video_texture;
-  int64_t texture_id;
-  std::unique_ptr<OATransport> transport; // OpenAutoTransport receiver
-  std::shared_ptr<H264Decoder> decoder; // shared to keep alive beyond plugin lifetime
-
-  struct VideoFrameState {
-    std::mutex mutex;
-    std::vector<uint8_t> yuv; // packed YUV420P [Y][U][V]
-    int width = 0;
-    int height = 0;
-    int64_t recv_ts_us = 0;   // when handler received packet
-    int64_t decode_ts_us = 0; // when decode completed
-    bool has_new = false;
-
-    std::atomic<int> log_count{0};
-
-    // Extract payload (optionally strip 8-byte ts + 4-byte payload header) and decode.
-    void ingest_packet(const uint8_t* data, std::size_t size, H264Decoder& decoder) {
-      if (!data || size == 0) return;
+  std::shared_ptr<TransportLink> link;                // OpenAutoTransport receiver
+  std::unique_ptr<ReconnectSupervisor> supervisor;    // brings the transport up in the background
+  std::shared_ptr<VideoStreamTable> video;
 
-      const auto now_us = std::chrono::duration_cast<std::chrono::microseconds>(
-          std::chrono::steady_clock::now().time_since_epoch()).count();
+  std::unique_ptr<VideoReplaySource> replay;   // optional offline VIDEO source
+  std::shared_ptr<TouchSender> touch_sender;   // coalesces and sends TOUCH off the main thread
+  FlTextureRegistrar* texture_registrar; // to mark frames available
+  FlEventChannel* connection_channel;    // "openautoflutter/connection" state events
+  gboolean connection_listening;
+  guint frame_timer_id; // periodic pump for decoded frames
+  int frame_timer_interval_ms;
+  std::unique_ptr<MetricsServer> metrics; // optional UNIX-socket endpoint
+  int metrics_collector;                  // add_metrics_collector id, 0 if none
+};
 
-      const uint8_t* payload = data;
-      std::size_t payload_size = size;
-      bool stripped = false;
-      uint32_t declared = 0;
+G_DEFINE_TYPE(OpenautoflutterPlugin, openautoflutter_plugin, g_object_get_type())
 
-      // Helper: find first Annex-B start code (3 or 4 bytes).
-      auto find_start_code = [](const uint8_t* p, size_t n) -> size_t {
-        for (size_t i = 0; i + 3 < n; ++i) {
-          if (p[i] == 0 && p[i + 1] == 0 && ((p[i + 2] == 1) || (p[i + 2] == 0 && p[i + 3] == 1))) {
-            return i;
-          }
-        }
-        return n;
-      };
-
-      // Common OAT framing: [u64 ts][u32 payload_size][payload...]
-      if (size >= sizeof(uint64_t) + sizeof(uint32_t)) {
-        std::memcpy(&declared, data + sizeof(uint64_t), sizeof(uint32_t));
-        if (declared > 0 && declared <= size - (sizeof(uint64_t) + sizeof(uint32_t))) {
-          payload = data + sizeof(uint64_t) + sizeof(uint32_t);
-          payload_size = declared;
-          stripped = true;
-        }
-      }
+static std::shared_ptr<VideoStream> find_stream(OpenautoflutterPlugin* self, int64_t id) {
+  auto it = self->video->streams.find(id);
+  return it == self->video->streams.end() ? nullptr : it->second;
+}
 
-      // If not stripped yet, try to drop any leading non-start-code bytes (e.g., 4-byte length + nonce).
-      if (!stripped) {
-        size_t idx = find_start_code(payload, payload_size);
-        if (idx != 0 && idx < payload_size) {
-          payload += idx;
-          payload_size -= idx;
-          stripped = true;
+// Handlers cannot be removed from the transport, so each type gets one
+// handler that looks the stream up on every message.
+static void register_type_handler(const std::shared_ptr<VideoStreamTable>& table,
+                                  OATransport& transport, int type) {
+  transport.addTypeHandler(static_cast<OAMsgType>(type),
+    [table, type](uint64_t ts, const void* data, std::size_t size) {
+      // The transport owns its receive thread; apply our policy on its first callback.
+      oa_thread::refresh(oa_thread::Role::TransportRx, "oa-transport-rx");
+      oa_memory::count_faults(oa_thread::Role::TransportRx);
+      if (!data || size == 0) return;
+      if (type == static_cast<int>(OAMsgType::VIDEO)) {
+        if (auto capture = std::atomic_load(&table->capture)) {
+          const auto recv_us = std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now().time_since_epoch()).count();
+          capture->append(ts, static_cast<uint64_t>(recv_us), static_cast<const uint8_t*>(data), size);
         }
       }
-
-      int log_id = log_count.fetch_add(1, std::memory_order_relaxed);
-      if (log_id < 8) {
-        std::cout << "[VideoFrameState] in_size=" << size
-                  << " payload_size=" << payload_size
-                  << " stripped=" << (stripped ? 1 : 0)
-                  << " head=" << hex_head(payload, payload_size, 24)
-                  << std::endl;
+      std::shared_ptr<VideoStream> stream;
+      {
+        std::lock_guard<std::mutex> lk(table->routes_mutex);
+        auto it = table->routes.find(type);
+        if (it != table->routes.end()) stream = it->second.lock();
       }
+      if (stream) stream->submit(static_cast<const uint8_t*>(data), size);
+    });
+}
 
-      int w = 0, h = 0;
-      std::vector<uint8_t> decoded;
-      if (!decoder.decode_to_yuv420p(payload, payload_size, decoded, w, h)) {
-        if (log_id < 8) {
-          std::cout << "[VideoFrameState] decode failed size=" << payload_size
-                    << " declared=" << declared << std::endl;
-        }
-        return;
-      }
-      const auto decode_end_us = std::chrono::duration_cast<std::chrono::microseconds>(
-          std::chrono::steady_clock::now().time_since_epoch()).count();
-
-      std::lock_guard<std::mutex> lk(mutex);
-      width = w;
-      height = h;
-      yuv.swap(decoded);
-      recv_ts_us = now_us;
-      decode_ts_us = decode_end_us;
-      has_new = true;
-      if (log_id < 8) {
-        std::cout << "[VideoFrameState] decoded " << w << "x" << h
-                  << " bytes=" << yuv.size() << std::endl;
-      }
+// Make sure transport messages of `type` reach whichever stream is routed to
+// it. While disconnected there is nothing to do: the next connect registers
+// every routed type. A transport still being set up gets the handler here
+// unless the connect already picked up the route.
+static void ensure_transport_handler(OpenautoflutterPlugin* self, int type) {
+  std::shared_ptr<OATransport> transport;
+  {
+    std::lock_guard<std::mutex> lk(self->video->routes_mutex);
+    transport = self->video->handled_for;
+    if (!transport) return;
+    if (!self->video->handled_types.insert(type).second) return;
+  }
+  register_type_handler(self->video, *transport, type);
+}
+
+// Supervisor thread: bring up a fresh transport and register a handler for
+// every routed type before publishing it.
+static bool connect_transport(const std::shared_ptr<TransportLink>& link,
+                              const std::shared_ptr<VideoStreamTable>& table) {
+  const PipelineConfig config = pipeline_config();
+  auto transport = std::make_shared<OATransport>();
+  OA_LOG(Info, "OAT", "starting transport as Side B (wait={}ms poll={}us)", config.transport_wait_ms,
+         config.transport_poll_us);
+  if (!transport->startAsB(std::chrono::milliseconds{config.transport_wait_ms},
+                           std::chrono::microseconds{config.transport_poll_us})) {
+    OA_LOG_RATE(Warn, 1, "OAT", "startAsB failed");
+    return false;
+  }
+  std::vector<int> types;
+  std::vector<std::shared_ptr<VideoStream>> streams;
+  {
+    std::lock_guard<std::mutex> lk(table->routes_mutex);
+    table->handled_for = transport;
+    table->handled_types.clear();
+    for (auto& route : table->routes) {
+      auto stream = route.second.lock();
+      if (!stream) continue;
+      table->handled_types.insert(route.first);
+      types.push_back(route.first);
+      streams.push_back(std::move(stream));
     }
+  }
+  // A reconnect is a new encoder session: queue the decoder reset ahead of
+  // its first packet. Cached parameter sets and the shown frame survive.
+  if (table->connected_before) {
+    for (auto& stream : streams) stream->reset_session();
+  }
+  table->connected_before = true;
+  for (int type : types) register_type_handler(table, *transport, type);
+  OA_LOG(Info, "OAT", "transport started (side={}, running={}, types={})",
+         static_cast<int>(transport->side()), transport->isRunning(), types.size());
+  std::atomic_store(&link->transport, transport);
+  pipeline_stats().transport_running.store(transport->isRunning(), std::memory_order_relaxed);
+  startup_timeline().mark_connected();
+  return true;
+}
 
-    bool take_latest(std::vector<uint8_t>& out, int& w, int& h, int64_t& recv_us, int64_t& dec_us) {
-      std::lock_guard<std::mutex> lk(mutex);
-      if (!has_new || yuv.empty() || width <= 0 || height <= 0) return false;
-      out = yuv; // copy to avoid holding lock during GL upload
-      w = width;
-      h = height;
-      recv_us = recv_ts_us;
-      dec_us = decode_ts_us;
-      has_new = false;
-      recv_ts_us = 0;
-      decode_ts_us = 0;
-      return true;
+static void disconnect_transport(const std::shared_ptr<TransportLink>& link,
+                                 const std::shared_ptr<VideoStreamTable>& table) {
+  auto transport = std::atomic_exchange(&link->transport, std::shared_ptr<OATransport>());
+  pipeline_stats().transport_running.store(false, std::memory_order_relaxed);
+  if (!transport) return;
+  {
+    // Unless a newer connect has already taken over.
+    std::lock_guard<std::mutex> lk(table->routes_mutex);
+    if (table->handled_for == transport) {
+      table->handled_for.reset();
+      table->handled_types.clear();
     }
-  };
+  }
+  transport->stop();
+}
 
-  std::shared_ptr<VideoFrameState> frame_state;
-  FlTextureRegistrar* texture_registrar; // to mark frames available
-  guint frame_timer_id; // periodic pump for decoded frames
+static const char* connection_state_name(ReconnectSupervisor::State state) {
+  switch (state) {
+    case ReconnectSupervisor::State::Idle: return "idle";
+    case ReconnectSupervisor::State::Connecting: return "connecting";
+    case ReconnectSupervisor::State::Connected: return "connected";
+    case ReconnectSupervisor::State::Backoff: return "backoff";
+    case ReconnectSupervisor::State::Stopped: return "stopped";
+  }
+  return "idle";
+}
+
+static FlValue* connection_status_value(const ReconnectSupervisor::Status& status) {
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(value, "state", fl_value_new_string(connection_state_name(status.state)));
+  fl_value_set_string_take(value, "attempt", fl_value_new_int(status.attempt));
+  fl_value_set_string_take(value, "retryInMs", fl_value_new_int(status.retry_in_ms));
+  fl_value_set_string_take(value, "connects", fl_value_new_int(static_cast<int64_t>(status.connects)));
+  return value;
+}
+
+// Process-wide samples for the metrics endpoint; streams add their own. Runs
+// on the metrics thread and only reads atomics, plus the supervisor status.
+static void collect_plugin_metrics(OpenautoflutterPlugin* self, MetricsWriter& w) {
+  const PipelineStats& p = pipeline_stats();
+  auto load = [](const std::atomic<uint64_t>& v) { return v.load(std::memory_order_relaxed); };
+  w.counter("oaf_video_packets_total", "Video packets received", load(p.video_packets));
+  w.counter("oaf_video_bytes_total", "Video payload bytes received", load(p.video_bytes));
+  w.counter("oaf_frames_decoded_total", "Pictures decoded", load(p.frames_decoded));
+  w.counter("oaf_decode_failures_total", "Packets that produced no picture", load(p.decode_failures));
+  w.counter("oaf_frames_discarded_total", "Packets dropped while waiting for a keyframe after a decode error",
+            load(p.frames_discarded));
+  w.counter("oaf_frames_presented_total", "Frames handed to a Flutter texture", load(p.frames_presented));
+  w.counter("oaf_decode_recoveries_total", "Recoveries from decode errors", load(p.decode_recoveries));
+  w.counter("oaf_keyframe_requests_total", "Keyframes requested from the producer", load(p.keyframe_requests));
+  w.latency("oaf_decode_latency_seconds", "Packet received to picture decoded", p.decode_latency);
+  w.latency("oaf_present_latency_seconds", "Packet received to frame handed to the texture", p.present_latency);
+  w.gauge("oaf_last_recover_seconds", "First decode error to first clean frame, most recent recovery",
+          static_cast<double>(p.last_recover_us.load(std::memory_order_relaxed)) / 1e6);
+  w.gauge("oaf_video_width", "Width of the last decoded picture", p.width.load(std::memory_order_relaxed));
+  w.gauge("oaf_video_height", "Height of the last decoded picture", p.height.load(std::memory_order_relaxed));
+  w.gauge("oaf_memory_bytes", "Memory held per pipeline stage",
+          static_cast<double>(p.decoder_pool_bytes.load(std::memory_order_relaxed)), {{"stage", "decoder_frames"}});
+  const GlResources& gl = gl_resources();
+  const size_t gl_pooled = gl.pooled_bytes();
+  w.gauge("oaf_memory_bytes", "Memory held per pipeline stage",
+          static_cast<double>(gl.live_bytes() - std::min(gl.live_bytes(), gl_pooled)), {{"stage", "gl_textures"}});
+  w.gauge("oaf_memory_bytes", "Memory held per pipeline stage", static_cast<double>(gl_pooled),
+          {{"stage", "gl_texture_pool"}});
+  w.counter("oaf_gl_textures_reused_total", "Video textures taken from the idle pool instead of allocated",
+            gl.reused());
+  w.gauge("oaf_memory_locked_bytes", "Frame memory mlocked within the residency budget",
+          static_cast<double>(oa_memory::locked_bytes()));
+  for (auto role : {oa_thread::Role::TransportRx, oa_thread::Role::Consumer, oa_thread::Role::Decode}) {
+    const oa_memory::Faults f = oa_memory::faults(role);
+    w.counter("oaf_page_faults_total", "Page faults taken on the pipeline threads", f.minor,
+              {{"thread", oa_thread::role_name(role)}, {"kind", "minor"}});
+    w.counter("oaf_page_faults_total", "Page faults taken on the pipeline threads", f.major,
+              {{"thread", oa_thread::role_name(role)}, {"kind", "major"}});
+  }
+
+  w.gauge("oaf_transport_running", "1 while the transport link is up",
+          p.transport_running.load(std::memory_order_relaxed) ? 1 : 0);
+  if (self->supervisor) {
+    const ReconnectSupervisor::Status status = self->supervisor->status();
+    for (auto state : {ReconnectSupervisor::State::Idle, ReconnectSupervisor::State::Connecting,
+                       ReconnectSupervisor::State::Connected, ReconnectSupervisor::State::Backoff,
+                       ReconnectSupervisor::State::Stopped}) {
+      w.gauge("oaf_transport_state", "Reconnect supervisor state; 1 for the current one",
+              status.state == state ? 1 : 0, {{"state", connection_state_name(state)}});
+    }
+    w.gauge("oaf_transport_failed_attempts", "Failed connect attempts since the last connect", status.attempt);
+    w.counter("oaf_transport_connects_total", "Successful transport connects", status.connects);
+  }
+
+  if (auto sender = active_touch_sender()) {
+    const TouchSender::Stats t = sender->stats();
+    w.counter("oaf_touch_enqueued_total", "Touch events queued", t.enqueued);
+    w.counter("oaf_touch_coalesced_total", "Touch moves merged into a queued move", t.coalesced);
+    w.counter("oaf_touch_sent_total", "Touch events sent", t.sent);
+    w.counter("oaf_touch_failed_total", "Touch events the transport did not take", t.failed);
+    w.counter("oaf_touch_dropped_total", "Touch moves dropped from a full queue", t.dropped);
+    w.gauge("oaf_touch_last_latency_seconds", "Enqueue to send of the most recent touch",
+            static_cast<double>(t.last_latency_us) / 1e6);
+  }
+}
+
+// Milestones reached so far, in microseconds since plugin registration.
+static FlValue* startup_timeline_value() {
+  const StartupTimeline& timeline = startup_timeline();
+  const int64_t origin = timeline.at(Milestone::PluginRegistered);
+  FlValue* value = fl_value_new_map();
+  for (size_t i = 0; i < StartupTimeline::kCount; ++i) {
+    const auto milestone = static_cast<Milestone>(i);
+    const int64_t at = timeline.at(milestone);
+    if (at == 0) continue;
+    fl_value_set_string_take(value, milestone_name(milestone), fl_value_new_int(at - origin));
+  }
+  const int64_t warm_us = timeline.last_connect_to_frame_us();
+  if (warm_us >= 0) fl_value_set_string_take(value, "lastConnectToFrame", fl_value_new_int(warm_us));
+  return value;
+}
+
+static FlValue* bitstream_stats_value(const BitstreamStats& stats) {
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(value, "codec", fl_value_new_string(codec_name(stats.codec)));
+  fl_value_set_string_take(value, "accessUnits", fl_value_new_int(static_cast<int64_t>(stats.access_units)));
+  fl_value_set_string_take(value, "bytes", fl_value_new_int(static_cast<int64_t>(stats.bytes)));
+  fl_value_set_string_take(value, "frames", fl_value_new_int(static_cast<int64_t>(stats.frames)));
+  fl_value_set_string_take(value, "keyframes", fl_value_new_int(static_cast<int64_t>(stats.keyframes)));
+  fl_value_set_string_take(value, "bitrateShortBps", fl_value_new_int(stats.bitrate_short_bps));
+  fl_value_set_string_take(value, "bitrateLongBps", fl_value_new_int(stats.bitrate_long_bps));
+  fl_value_set_string_take(value, "fps", fl_value_new_float(stats.fps_short));
+  FlValue* nal_counts = fl_value_new_map();
+  for (size_t type = 0; type < stats.nal_counts.size(); ++type) {
+    if (stats.nal_counts[type] == 0) continue;
+    fl_value_set_take(nal_counts, fl_value_new_int(static_cast<int64_t>(type)),
+                      fl_value_new_int(static_cast<int64_t>(stats.nal_counts[type])));
+  }
+  fl_value_set_string_take(value, "nalCounts", nal_counts);
+  fl_value_set_string_take(value, "gopLength", fl_value_new_int(stats.gop_length));
+  fl_value_set_string_take(value, "currentGop", fl_value_new_int(stats.current_gop));
+  if (stats.keyframe_interval_us >= 0) {
+    fl_value_set_string_take(value, "keyframeIntervalUs", fl_value_new_int(stats.keyframe_interval_us));
+  }
+  fl_value_set_string_take(value, "largestFrame", fl_value_new_int(stats.largest_frame));
+  fl_value_set_string_take(value, "largestKeyframe", fl_value_new_int(stats.largest_keyframe));
+  fl_value_set_string_take(value, "largestRecentFrame", fl_value_new_int(stats.largest_recent_frame));
+  if (stats.have_sps) {
+    fl_value_set_string_take(value, "profile",
+                             fl_value_new_string(video_profile_name(stats.codec, stats.sps.profile_idc).c_str()));
+    fl_value_set_string_take(value, "profileIdc", fl_value_new_int(stats.sps.profile_idc));
+    fl_value_set_string_take(value, "level", fl_value_new_float(video_level(stats.codec, stats.sps.level_idc)));
+    fl_value_set_string_take(value, "width", fl_value_new_int(stats.sps.width));
+    fl_value_set_string_take(value, "height", fl_value_new_int(stats.sps.height));
+  }
+  return value;
+}
+
+static void send_connection_status(OpenautoflutterPlugin* self, const ReconnectSupervisor::Status& status) {
+  if (!self->connection_channel || !self->connection_listening) return;
+  g_autoptr(FlValue) value = connection_status_value(status);
+  fl_event_channel_send(self->connection_channel, value, nullptr, nullptr);
+}
+
+struct ConnectionEvent {
+  OpenautoflutterPlugin* plugin;
+  ReconnectSupervisor::Status status;
 };
 
-// Convenience alias for the nested frame holder type.
-using VideoFrameState = _OpenautoflutterPlugin::VideoFrameState;
+static gboolean connection_event_cb(gpointer user_data) {
+  auto* event = static_cast<ConnectionEvent*>(user_data);
+  send_connection_status(event->plugin, event->status);
+  return FALSE;
+}
 
-G_DEFINE_TYPE(OpenautoflutterPlugin, openautoflutter_plugin, g_object_get_type())
+static void connection_event_free(gpointer user_data) {
+  auto* event = static_cast<ConnectionEvent*>(user_data);
+  g_object_unref(event->plugin);
+  delete event;
+}
+
+static bool is_type_routed(OpenautoflutterPlugin* self, int type) {
+  std::lock_guard<std::mutex> lk(self->video->routes_mutex);
+  auto it = self->video->routes.find(type);
+  return it != self->video->routes.end() && !it->second.expired();
+}
+
+// Returns false if another live stream already owns `type`.
+static bool route_message_type(OpenautoflutterPlugin* self, int type,
+                               const std::shared_ptr<VideoStream>& stream) {
+  {
+    std::lock_guard<std::mutex> lk(self->video->routes_mutex);
+    auto it = self->video->routes.find(type);
+    if (it != self->video->routes.end() && !it->second.expired()) return false;
+    self->video->routes[type] = stream;
+  }
+  // Keyframe requests carry the video message type being recovered as a u32.
+  auto link = self->link;
+  stream->set_keyframe_request([link, type]() {
+    const int request_type = pipeline_config().keyframe_request_type;
+    if (request_type < 0) return;
+    auto transport = std::atomic_load(&link->transport);
+    if (!transport || !transport->isRunning()) return;
+    const uint32_t payload = static_cast<uint32_t>(type);
+    const auto now_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    transport->send(static_cast<OAMsgType>(request_type), static_cast<uint64_t>(now_us), &payload, sizeof(payload));
+    OA_LOG_RATE(Info, 1, "OAT", "requested keyframe for message type {}", type);
+  });
+  ensure_transport_handler(self, type);
+  return true;
+}
+
+// Returns null if libavcodec lacks `codec`.
+static std::shared_ptr<VideoStream> create_stream(OpenautoflutterPlugin* self,
+                                                  VideoCodec codec = VideoCodec::H264) {
+  std::shared_ptr<VideoStream> stream;
+  try {
+    stream = std::make_shared<VideoStream>(self->video->next_id, DecodePool::shared(), codec);
+  } catch (const std::exception& e) {
+    OA_LOG(Error, "OAT", "cannot create {} stream: {}", codec_name(codec), e.what());
+    return nullptr;
+  }
+  const int64_t id = self->video->next_id++;
+  if (self->texture_registrar) stream->attach_texture(self->texture_registrar);
+  self->video->streams[id] = stream;
+  return stream;
+}
+
+static void destroy_stream(OpenautoflutterPlugin* self, int64_t id) {
+  auto stream = find_stream(self, id);
+  if (!stream) return;
+  {
+    std::lock_guard<std::mutex> lk(self->video->routes_mutex);
+    for (auto it = self->video->routes.begin(); it != self->video->routes.end();) {
+      auto routed = it->second.lock();
+      it = (!routed || routed == stream) ? self->video->routes.erase(it) : std::next(it);
+    }
+  }
+  stream->close(true);
+  self->video->streams.erase(id);
+}
+
+static gboolean pump_video_frame_cb(gpointer user_data);
+
+static ReconnectSupervisor::Options reconnect_options(const PipelineConfig& config) {
+  ReconnectSupervisor::Options options;
+  options.initial_backoff = std::chrono::milliseconds{config.reconnect_initial_ms};
+  options.max_backoff = std::chrono::milliseconds{config.reconnect_max_ms};
+  return options;
+}
+
+static void start_frame_timer(OpenautoflutterPlugin* self, int interval_ms) {
+  if (self->frame_timer_id) g_source_remove(self->frame_timer_id);
+  self->frame_timer_id = g_timeout_add(interval_ms, pump_video_frame_cb, self);
+  self->frame_timer_interval_ms = interval_ms;
+}
+
+// The pump only has work while some stream is on screen. Stop it otherwise,
+// so hidden video costs no main-loop wakeups.
+static void update_frame_timer(OpenautoflutterPlugin* self) {
+  bool any_visible = false;
+  for (auto& entry : self->video->streams) any_visible = any_visible || entry.second->visible();
+  if (!any_visible && self->frame_timer_id) {
+    g_source_remove(self->frame_timer_id);
+    self->frame_timer_id = 0;
+  } else if (any_visible && !self->frame_timer_id && self->texture_registrar) {
+    start_frame_timer(self, pipeline_config().pump_interval_ms);
+  }
+}
+
+// Publish `config` and push it to whatever is already running. Transport
+// wait/poll and the SHM settings are read on the next connect or consumer start;
+// the memory policy applies to mappings and frame buffers made from now on.
+static void apply_pipeline_config(OpenautoflutterPlugin* self, const PipelineConfig& config) {
+  const PipelineConfig previous = pipeline_config();
+  set_pipeline_config(config);
+  const PipelineConfig current = pipeline_config();
+  if (self->frame_timer_id && current.pump_interval_ms != self->frame_timer_interval_ms) {
+    start_frame_timer(self, current.pump_interval_ms);
+  }
+  if (self->supervisor) self->supervisor->set_options(reconnect_options(current));
+  oa_memory::set_policy(current.memory);
+  if (current.decoder != previous.decoder) {
+    for (auto& entry : self->video->streams) entry.second->set_decoder_options(current.decoder);
+  }
+  OA_LOG(Info, "OAT", "pipeline: pump={}ms wait={}ms poll={}us shm={}ms/{}B scaler={} threads={} low_delay={} fast={}",
+         current.pump_interval_ms, current.transport_wait_ms, current.transport_poll_us, current.shm_poll_ms,
+         current.shm_video_size, scaler_name(current.decoder.scaler), current.decoder.threads,
+         current.decoder.low_delay, current.decoder.fast);
+}
 
 // Called when a method call is received from Flutter.
 static void openautoflutter_plugin_handle_method_call(
@@ -259,23 +666,276 @@ static void openautoflutter_plugin_handle_method_call(
     response = get_platform_version();
   } else if (strcmp(method, "getVideoTextureId") == 0) {
     // Return the registered Flutter texture ID so Dart can render it via a Texture widget.
-    g_autoptr(FlValue) result = fl_value_new_int(self->texture_id);
+    auto primary = find_stream(self, 0);
+    g_autoptr(FlValue) result = fl_value_new_int(primary ? primary->texture_id() : 0);
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (strcmp(method, "createVideoStream") == 0) {
+    FlValue* args = fl_method_call_get_args(method_call);
+    bool has_type = false;
+    const double type_val = args && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+        ? get_number(fl_value_lookup_string(args, "messageType"), has_type)
+        : 0.0;
+    const gchar* codec_arg = get_string(args, "codec");
+    VideoCodec codec = VideoCodec::H264;
+    std::shared_ptr<VideoStream> stream;
+    if (codec_arg && !parse_codec(codec_arg, codec)) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("invalid_args", "Unknown codec", nullptr));
+    } else if (has_type && is_type_routed(self, static_cast<int>(type_val))) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "invalid_args", "Message type is already bound to a stream", nullptr));
+    } else if (!(stream = create_stream(self, codec))) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "unsupported_codec", "Decoder not available for codec", nullptr));
+    } else {
+      if (has_type) route_message_type(self, static_cast<int>(type_val), stream);
+      update_frame_timer(self);
+      g_autoptr(FlValue) result = fl_value_new_map();
+      fl_value_set_string_take(result, "streamId", fl_value_new_int(stream->id()));
+      fl_value_set_string_take(result, "textureId", fl_value_new_int(stream->texture_id()));
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    }
+  } else if (strcmp(method, "destroyVideoStream") == 0) {
+    bool ok = false;
+    FlValue* args = fl_method_call_get_args(method_call);
+    const double id_val = args && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+        ? get_number(fl_value_lookup_string(args, "streamId"), ok)
+        : 0.0;
+    const int64_t id = static_cast<int64_t>(id_val);
+    if (!ok || !find_stream(self, id)) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("invalid_args", "Unknown streamId", nullptr));
+    } else if (id == 0) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "invalid_args", "The primary stream cannot be destroyed", nullptr));
+    } else {
+      destroy_stream(self, id);
+      update_frame_timer(self);
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    }
+  } else if (strcmp(method, "setVideoStreamCodec") == 0) {
+    FlValue* args = fl_method_call_get_args(method_call);
+    bool ok = false;
+    const double id_val = args && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+        ? get_number(fl_value_lookup_string(args, "streamId"), ok)
+        : 0.0;
+    const gchar* codec_arg = get_string(args, "codec");
+    VideoCodec codec = VideoCodec::H264;
+    auto stream = ok ? find_stream(self, static_cast<int64_t>(id_val)) : nullptr;
+    if (!stream) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("invalid_args", "Unknown streamId", nullptr));
+    } else if (!codec_arg || !parse_codec(codec_arg, codec)) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("invalid_args", "Unknown codec", nullptr));
+    } else if (!stream->set_codec(codec)) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "unsupported_codec", "Decoder not available for codec", nullptr));
+    } else {
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    }
+  } else if (strcmp(method, "addVideoStreamView") == 0 ||
+             strcmp(method, "removeVideoStreamView") == 0) {
+    FlValue* args = fl_method_call_get_args(method_call);
+    const bool is_map = args && fl_value_get_type(args) == FL_VALUE_TYPE_MAP;
+    bool has_stream = false;
+    bool has_texture = false;
+    const double stream_val = is_map ? get_number(fl_value_lookup_string(args, "streamId"), has_stream) : 0.0;
+    const double texture_val = is_map ? get_number(fl_value_lookup_string(args, "textureId"), has_texture) : 0.0;
+    auto stream = find_stream(self, has_stream ? static_cast<int64_t>(stream_val) : 0);
+    if (!stream) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("invalid_args", "Unknown streamId", nullptr));
+    } else if (strcmp(method, "addVideoStreamView") == 0) {
+      const int64_t texture_id = stream->add_view();
+      if (texture_id == 0) {
+        response = FL_METHOD_RESPONSE(fl_method_error_response_new("texture_failed", "Cannot register texture", nullptr));
+      } else {
+        g_autoptr(FlValue) result = fl_value_new_int(texture_id);
+        response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+      }
+    } else if (!has_texture || !stream->remove_view(static_cast<int64_t>(texture_val))) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("invalid_args", "Unknown textureId", nullptr));
+    } else {
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    }
+  } else if (strcmp(method, "setVideoDisplaySize") == 0) {
+    FlValue* args = fl_method_call_get_args(method_call);
+    const bool is_map = args && fl_value_get_type(args) == FL_VALUE_TYPE_MAP;
+    bool ok_id = false, ok_w = false, ok_h = false;
+    const double texture_val = is_map ? get_number(fl_value_lookup_string(args, "textureId"), ok_id) : 0.0;
+    const double w_val = is_map ? get_number(fl_value_lookup_string(args, "width"), ok_w) : 0.0;
+    const double h_val = is_map ? get_number(fl_value_lookup_string(args, "height"), ok_h) : 0.0;
+    bool found = false;
+    if (ok_id && ok_w && ok_h) {
+      const int w = static_cast<int>(std::clamp(w_val, 0.0, 16384.0));
+      const int h = static_cast<int>(std::clamp(h_val, 0.0, 16384.0));
+      for (auto& entry : self->video->streams) {
+        if (entry.second->set_display_size(static_cast<int64_t>(texture_val), w, h)) {
+          found = true;
+          break;
+        }
+      }
+    }
+    response = found ? FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr))
+                     : FL_METHOD_RESPONSE(fl_method_error_response_new("invalid_args", "Unknown textureId or size", nullptr));
+  } else if (strcmp(method, "setVideoVisible") == 0) {
+    FlValue* args = fl_method_call_get_args(method_call);
+    const bool is_map = args && fl_value_get_type(args) == FL_VALUE_TYPE_MAP;
+    bool ok_id = false;
+    const double texture_val = is_map ? get_number(fl_value_lookup_string(args, "textureId"), ok_id) : 0.0;
+    const bool visible = get_bool(args, "visible", true);
+    std::shared_ptr<VideoStream> stream;
+    if (ok_id) {
+      for (auto& entry : self->video->streams) {
+        if (entry.second->set_texture_visible(static_cast<int64_t>(texture_val), visible)) {
+          stream = entry.second;
+          break;
+        }
+      }
+    }
+    if (!stream) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("invalid_args", "Unknown textureId", nullptr));
+    } else {
+      // Show the newest keyframe right away rather than on the next tick.
+      if (visible) stream->present();
+      update_frame_timer(self);
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    }
+  } else if (strcmp(method, "setVideoCrop") == 0) {
+    FlValue* args = fl_method_call_get_args(method_call);
+    const bool is_map = args && fl_value_get_type(args) == FL_VALUE_TYPE_MAP;
+    bool has_stream = false, ok_x = false, ok_y = false, ok_w = false, ok_h = false;
+    const double stream_val = is_map ? get_number(fl_value_lookup_string(args, "streamId"), has_stream) : 0.0;
+    const double x_val = is_map ? get_number(fl_value_lookup_string(args, "x"), ok_x) : 0.0;
+    const double y_val = is_map ? get_number(fl_value_lookup_string(args, "y"), ok_y) : 0.0;
+    const double w_val = is_map ? get_number(fl_value_lookup_string(args, "width"), ok_w) : 0.0;
+    const double h_val = is_map ? get_number(fl_value_lookup_string(args, "height"), ok_h) : 0.0;
+    auto stream = find_stream(self, has_stream ? static_cast<int64_t>(stream_val) : 0);
+    if (!stream) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("invalid_args", "Unknown streamId", nullptr));
+    } else if (!ok_x || !ok_y || !ok_w || !ok_h) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("invalid_args", "Missing crop rectangle", nullptr));
+    } else {
+      VideoCrop crop;
+      crop.x = static_cast<int>(std::clamp(x_val, 0.0, 16384.0));
+      crop.y = static_cast<int>(std::clamp(y_val, 0.0, 16384.0));
+      crop.width = static_cast<int>(std::clamp(w_val, 0.0, 16384.0));
+      crop.height = static_cast<int>(std::clamp(h_val, 0.0, 16384.0));
+      stream->set_crop(crop);
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    }
+  } else if (strcmp(method, "getConnectionState") == 0) {
+    ReconnectSupervisor::Status status;
+    if (self->supervisor) status = self->supervisor->status();
+    g_autoptr(FlValue) result = connection_status_value(status);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (strcmp(method, "getStartupTimeline") == 0) {
+    g_autoptr(FlValue) result = startup_timeline_value();
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (strcmp(method, "getBitstreamStats") == 0) {
+    FlValue* args = fl_method_call_get_args(method_call);
+    bool has_stream = false;
+    const double stream_val = args && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+        ? get_number(fl_value_lookup_string(args, "streamId"), has_stream)
+        : 0.0;
+    auto stream = find_stream(self, has_stream ? static_cast<int64_t>(stream_val) : 0);
+    if (!stream) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("invalid_args", "Unknown streamId", nullptr));
+    } else {
+      g_autoptr(FlValue) result = bitstream_stats_value(stream->bitstream_stats());
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    }
   } else if (strcmp(method, "sendTouchEvent") == 0) {
     TouchMessage touch_msg{};
     std::string error;
     if (!parse_touch_args(fl_method_call_get_args(method_call), touch_msg, error)) {
       response = FL_METHOD_RESPONSE(fl_method_error_response_new("invalid_args", error.c_str(), nullptr));
     } else {
-      const auto now_us = std::chrono::duration_cast<std::chrono::microseconds>(
-          std::chrono::steady_clock::now().time_since_epoch()).count();
-      if (self->transport && self->transport->isRunning()) {
-        self->transport->send(OAMsgType::TOUCH, static_cast<uint64_t>(now_us), &touch_msg, sizeof(touch_msg));
-      } else {
-        g_warning("OAT: transport not running; dropping touch event");
-      }
+      if (self->touch_sender) self->touch_sender->enqueue(touch_msg);
       response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
     }
+  } else if (strcmp(method, "configurePipeline") == 0) {
+    PipelineConfig config = pipeline_config();
+    const gchar* thread_policy = nullptr;
+    std::string error;
+    if (!parse_pipeline_args(fl_method_call_get_args(method_call), config, thread_policy, error)) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("invalid_args", error.c_str(), nullptr));
+    } else if (thread_policy && !oa_thread::set_spec(thread_policy)) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("invalid_args", "Invalid threadPolicy", nullptr));
+    } else {
+      apply_pipeline_config(self, config);
+      g_autoptr(FlValue) result = pipeline_config_value(pipeline_config());
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    }
+  } else if (strcmp(method, "configureLogging") == 0) {
+    FlValue* args = fl_method_call_get_args(method_call);
+    const gchar* level_name = get_string(args, "level");
+    const gchar* sinks = get_string(args, "sinks");
+    oa_log::Level level = oa_log::level();
+    if (level_name && !oa_log::parse_level(level_name, level)) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("invalid_args", "Unknown log level", nullptr));
+    } else if (sinks && !oa_log::set_sinks_from_spec(sinks)) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("invalid_args", "Invalid sink spec", nullptr));
+    } else {
+      oa_log::set_level(level);
+      g_autoptr(FlValue) result = fl_value_new_map();
+      fl_value_set_string_take(result, "level", fl_value_new_string(oa_log::level_name(oa_log::level())));
+      fl_value_set_string_take(result, "sinks", fl_value_new_string(oa_log::sinks_spec().c_str()));
+      fl_value_set_string_take(result, "dropped", fl_value_new_int(static_cast<int64_t>(oa_log::dropped())));
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    }
+  } else if (strcmp(method, "startVideoCapture") == 0) {
+    const gchar* path = get_string(fl_method_call_get_args(method_call), "path");
+    auto writer = std::make_shared<VideoCaptureWriter>();
+    if (!path || !*path) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("invalid_args", "Missing path", nullptr));
+    } else if (!writer->open(path)) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("capture_failed", "Cannot open capture file", nullptr));
+    } else {
+      auto previous = std::atomic_exchange(&self->video->capture, writer);
+      if (previous) previous->close();
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    }
+  } else if (strcmp(method, "stopVideoCapture") == 0) {
+    auto previous = std::atomic_exchange(&self->video->capture, std::shared_ptr<VideoCaptureWriter>());
+    int64_t records = 0;
+    if (previous) {
+      previous->close(); // writes what is still queued
+      records = static_cast<int64_t>(previous->record_count());
+    }
+    g_autoptr(FlValue) result = fl_value_new_int(records);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (strcmp(method, "startVideoReplay") == 0) {
+    FlValue* args = fl_method_call_get_args(method_call);
+    const gchar* path = get_string(args, "path");
+    const bool realtime = get_bool(args, "realtime", true);
+    const bool loop = get_bool(args, "loop", false);
+    bool has_stream = false;
+    const double stream_val = args && fl_value_get_type(args) == FL_VALUE_TYPE_MAP
+        ? get_number(fl_value_lookup_string(args, "streamId"), has_stream)
+        : 0.0;
+    auto stream = find_stream(self, has_stream ? static_cast<int64_t>(stream_val) : 0);
+    if (!path || !*path) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("invalid_args", "Missing path", nullptr));
+    } else if (!stream) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("invalid_args", "Unknown streamId", nullptr));
+    } else {
+      if (!self->replay) self->replay = std::make_unique<VideoReplaySource>();
+      self->replay->stop();
+      std::weak_ptr<VideoStream> target = stream;
+      const bool ok = self->replay->start(path,
+        [target, realtime](uint64_t /*ts*/, const uint8_t* data, std::size_t size) {
+          auto s = target.lock();
+          if (!s) return;
+          // Unpaced replay must not outrun the decoder and queue the whole
+          // file. Paced replay keeps the recorded timing and, like the
+          // transport, leaves a backlog to submit() to shed.
+          if (!realtime) s->wait_pending(8, std::chrono::milliseconds(500));
+          s->submit(data, size);
+        },
+        realtime, loop);
+      response = ok ? FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr))
+                    : FL_METHOD_RESPONSE(fl_method_error_response_new("replay_failed", "Cannot open capture file", nullptr));
+    }
+  } else if (strcmp(method, "stopVideoReplay") == 0) {
+    if (self->replay) self->replay->stop();
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
   } else {
     response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
   }
@@ -293,20 +953,49 @@ FlMethodResponse* get_platform_version() {
 
 static void openautoflutter_plugin_dispose(GObject* object) {
   OpenautoflutterPlugin* self = OPENAUTOFLUTTER_PLUGIN(object);
+  if (self->metrics_collector) {
+    remove_metrics_collector(self->metrics_collector);
+    self->metrics_collector = 0;
+  }
+  if (self->metrics) {
+    self->metrics->stop();
+    self->metrics.reset();
+  }
   if (self->frame_timer_id) {
     g_source_remove(self->frame_timer_id);
     self->frame_timer_id = 0;
   }
-  if (self->transport) {
-    self->transport->stop();
+  if (self->touch_sender) {
+    if (active_touch_sender() == self->touch_sender) set_active_touch_sender(nullptr);
+    self->touch_sender->stop();
+    self->touch_sender.reset();
   }
-  if (self->video_texture != nullptr) {
-    g_clear_object(&self->video_texture);
+  if (self->supervisor) {
+    // Never blocks on a pending startAsB; see ReconnectSupervisor::stop().
+    self->supervisor->stop();
+    self->supervisor.reset();
   }
-  if (self->transport) {
-    self->transport.reset();
+  if (self->link) {
+    disconnect_transport(self->link, self->video);
+    self->link.reset();
+  }
+  g_clear_object(&self->connection_channel);
+  if (self->replay) {
+    self->replay->stop();
+    self->replay.reset();
+  }
+  if (self->video) {
+    if (auto capture = std::atomic_exchange(&self->video->capture, std::shared_ptr<VideoCaptureWriter>())) {
+      capture->close();
+    }
+    {
+      std::lock_guard<std::mutex> lk(self->video->routes_mutex);
+      self->video->routes.clear();
+    }
+    for (auto& entry : self->video->streams) entry.second->close(false);
+    self->video->streams.clear();
+    self->video.reset();
   }
-  self->decoder.reset();
   G_OBJECT_CLASS(openautoflutter_plugin_parent_class)->dispose(object);
 }
 
@@ -315,34 +1004,123 @@ static void openautoflutter_plugin_class_init(OpenautoflutterPluginClass* klass)
 }
 
 static void openautoflutter_plugin_init(OpenautoflutterPlugin* self) {
-  self->video_texture = nullptr;
-  self->texture_id = 0;
-  self->transport = std::make_unique<OATransport>();
-  self->decoder = std::make_shared<H264Decoder>();
-  self->frame_state = std::make_shared<VideoFrameState>();
+  self->link = std::make_shared<TransportLink>();
+  self->video = std::make_shared<VideoStreamTable>();
   self->texture_registrar = nullptr;
+  self->connection_channel = nullptr;
+  self->connection_listening = FALSE;
   self->frame_timer_id = 0;
+  self->frame_timer_interval_ms = 0;
+  self->metrics_collector = 0;
+  auto link = self->link;
+  self->touch_sender = std::make_shared<TouchSender>(
+    [link](const TouchMessage& msg, uint64_t ts_us) {
+      auto transport = std::atomic_load(&link->transport);
+      if (!transport || !transport->isRunning()) return false;
+      transport->send(OAMsgType::TOUCH, ts_us, &msg, sizeof(msg));
+      return true;
+    });
+  self->touch_sender->start();
+  set_active_touch_sender(self->touch_sender);
 
-  // Start as Side B (joiner) with explicit 5s wait and 1ms poll.
-  g_message("OAT: starting transport as Side B (wait=5000ms poll=1000us)");
-  if (!self->transport->startAsB(std::chrono::milliseconds{5000}, std::chrono::microseconds{1000})) {
-    g_warning("OAT: startAsB failed");
-  } else {
-    g_message("OAT: transport started (side=%d, running=%d)", static_cast<int>(self->transport->side()),
-              self->transport->isRunning() ? 1 : 0);
-    // Register handler for VIDEO messages: strip header if present, decode, stash latest.
-    auto decoder = self->decoder;
-    auto state = self->frame_state;
-    g_object_ref(self); // keep plugin alive while transport callbacks run
-    auto self_shared = std::shared_ptr<OpenautoflutterPlugin>(
-      self,
-      [](OpenautoflutterPlugin* p){ g_object_unref(p); });
+  // Field captures without an app change: OPENAUTOFLUTTER_VIDEO_CAPTURE=/path/to/file.oavcap
+  if (const gchar* capture_path = g_getenv("OPENAUTOFLUTTER_VIDEO_CAPTURE")) {
+    auto writer = std::make_shared<VideoCaptureWriter>();
+    if (writer->open(capture_path)) {
+      std::atomic_store(&self->video->capture, writer);
+    } else {
+      g_warning("OAT: cannot open video capture %s", capture_path);
+    }
+  }
 
-    self->transport->addTypeHandler(static_cast<OAMsgType>(OAMsgType::VIDEO),
-      [decoder, state, self_shared](uint64_t /*ts*/, const void* data, std::size_t size) {
-        if (!data || size == 0 || !decoder || !state || !self_shared) return;
-        state->ingest_packet(static_cast<const uint8_t*>(data), size, *decoder);
-      });
+  // Keyframe requests stay off unless the producer understands them:
+  // OPENAUTOFLUTTER_KEYFRAME_REQUEST_TYPE=<message type>
+  if (const gchar* request_type = g_getenv("OPENAUTOFLUTTER_KEYFRAME_REQUEST_TYPE")) {
+    PipelineConfig config = pipeline_config();
+    config.keyframe_request_type = static_cast<int>(g_ascii_strtoll(request_type, nullptr, 10));
+    set_pipeline_config(config);
+  }
+
+  // Decoding in a helper process, before the first stream is created:
+  // OPENAUTOFLUTTER_DECODE_WORKER=1, optionally with
+  // OPENAUTOFLUTTER_DECODE_CGROUP=<cgroup v2 dir> and
+  // OPENAUTOFLUTTER_DECODE_CPU_PERCENT=<percent of one CPU>.
+  if (const gchar* worker = g_getenv("OPENAUTOFLUTTER_DECODE_WORKER")) {
+    PipelineConfig config = pipeline_config();
+    config.worker.enabled = *worker && strcmp(worker, "0") != 0;
+    if (const gchar* cgroup = g_getenv("OPENAUTOFLUTTER_DECODE_CGROUP")) config.worker.cgroup = cgroup;
+    if (const gchar* cpu = g_getenv("OPENAUTOFLUTTER_DECODE_CPU_PERCENT")) {
+      config.worker.cpu_percent = static_cast<int>(g_ascii_strtoll(cpu, nullptr, 10));
+    }
+    set_pipeline_config(config);
+  }
+
+  // Keeping frame memory resident, before the first mapping is made:
+  // OPENAUTOFLUTTER_PREFAULT=1, OPENAUTOFLUTTER_HUGEPAGES=1 and
+  // OPENAUTOFLUTTER_MLOCK_BUDGET=<bytes>.
+  {
+    PipelineConfig config = pipeline_config();
+    if (const gchar* prefault = g_getenv("OPENAUTOFLUTTER_PREFAULT")) {
+      config.memory.prefault = *prefault && strcmp(prefault, "0") != 0;
+    }
+    if (const gchar* hugepages = g_getenv("OPENAUTOFLUTTER_HUGEPAGES")) {
+      config.memory.hugepages = *hugepages && strcmp(hugepages, "0") != 0;
+    }
+    if (const gchar* budget = g_getenv("OPENAUTOFLUTTER_MLOCK_BUDGET")) {
+      config.memory.lock_budget = static_cast<size_t>(g_ascii_strtoull(budget, nullptr, 10));
+    }
+    set_pipeline_config(config);
+    oa_memory::set_policy(pipeline_config().memory);
+  }
+
+  // Stream 0 decodes OAMsgType::VIDEO; its texture is registered with the
+  // registrar in register_with_registrar().
+  // OPENAUTOFLUTTER_VIDEO_CODEC=h265 for head units that negotiate HEVC.
+  VideoCodec primary_codec = VideoCodec::H264;
+  if (const gchar* codec = g_getenv("OPENAUTOFLUTTER_VIDEO_CODEC")) {
+    if (!parse_codec(codec, primary_codec)) g_warning("OAT: unknown video codec %s; using h264", codec);
+  }
+  auto primary = create_stream(self, primary_codec);
+  if (!primary) primary = create_stream(self);
+  route_message_type(self, static_cast<int>(OAMsgType::VIDEO), primary);
+  // Touches address the full projected screen; when the primary stream is
+  // cropped, the view only shows part of it.
+  if (primary) {
+    std::weak_ptr<TouchSender> weak_sender = self->touch_sender;
+    primary->set_region_listener([weak_sender](const CropRegion& region) {
+      if (auto sender = weak_sender.lock()) sender->set_region(region.x, region.y, region.width, region.height);
+    });
+  }
+
+  // Join as Side B in the background so registration, and the app's first
+  // frame, never wait on the phone. Each (re)connect uses a fresh transport
+  // and re-registers the routed types on it.
+  auto table = self->video;
+  self->supervisor = std::make_unique<ReconnectSupervisor>(
+    [link, table]() { return connect_transport(link, table); },
+    [link]() {
+      auto transport = std::atomic_load(&link->transport);
+      return transport && transport->isRunning();
+    },
+    [link, table]() { disconnect_transport(link, table); },
+    [self](const ReconnectSupervisor::Status& status) {
+      // Not called once dispose has stopped the supervisor, so self is valid here.
+      auto* event = new ConnectionEvent{OPENAUTOFLUTTER_PLUGIN(g_object_ref(self)), status};
+      g_idle_add_full(G_PRIORITY_DEFAULT, connection_event_cb, event, connection_event_free);
+    },
+    reconnect_options(pipeline_config()));
+  self->supervisor->start();
+
+  // Prometheus text for fleet agents: OPENAUTOFLUTTER_METRICS_SOCKET=/run/user/<uid>/openautoflutter.sock
+  if (const gchar* socket_path = g_getenv("OPENAUTOFLUTTER_METRICS_SOCKET")) {
+    self->metrics = std::make_unique<MetricsServer>();
+    if (self->metrics->start(socket_path)) {
+      self->metrics_collector =
+        add_metrics_collector([self](MetricsWriter& writer) { collect_plugin_metrics(self, writer); });
+    } else {
+      g_warning("OAT: cannot serve metrics on %s", socket_path);
+      self->metrics.reset();
+    }
   }
 }
 
@@ -352,47 +1130,61 @@ static void method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
   openautoflutter_plugin_handle_method_call(plugin, method_call);
 }
 
-// Periodically pump decoded frames from AVConsumer into the Flutter texture.
+// A new listener gets the current state right away, then every change.
+static FlMethodErrorResponse* connection_listen_cb(FlEventChannel* channel, FlValue* args,
+                                                   gpointer user_data) {
+  OpenautoflutterPlugin* self = OPENAUTOFLUTTER_PLUGIN(user_data);
+  self->connection_listening = TRUE;
+  if (self->supervisor) send_connection_status(self, self->supervisor->status());
+  return nullptr;
+}
+
+static FlMethodErrorResponse* connection_cancel_cb(FlEventChannel* channel, FlValue* args,
+                                                   gpointer user_data) {
+  OPENAUTOFLUTTER_PLUGIN(user_data)->connection_listening = FALSE;
+  return nullptr;
+}
+
+// Packed touch batches from Dart: N x 16-byte TouchMessage records.
+static void touch_message_cb(FlBasicMessageChannel* channel, FlValue* message,
+                             FlBasicMessageChannelResponseHandle* response_handle,
+                             gpointer user_data) {
+  OpenautoflutterPlugin* self = OPENAUTOFLUTTER_PLUGIN(user_data);
+  if (message && fl_value_get_type(message) == FL_VALUE_TYPE_UINT8_LIST) {
+    const uint8_t* bytes = fl_value_get_uint8_list(message);
+    const size_t length = fl_value_get_length(message);
+    if (length % sizeof(TouchMessage) != 0) {
+      OA_LOG_RATE(Warn, 1, "OAT", "touch batch size {} is not a multiple of {}", length, sizeof(TouchMessage));
+    }
+    const size_t count = length / sizeof(TouchMessage);
+    std::vector<TouchMessage> batch;
+    batch.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      TouchMessage msg;
+      std::memcpy(&msg, bytes + i * sizeof(TouchMessage), sizeof(TouchMessage));
+      if (sanitize_touch(msg)) batch.push_back(msg);
+    }
+    if (self->touch_sender) self->touch_sender->enqueue(batch.data(), batch.size());
+  }
+  // The binary codec cannot encode null; reply with an empty buffer.
+  g_autoptr(FlValue) reply = fl_value_new_uint8_list(nullptr, 0);
+  fl_basic_message_channel_respond(channel, response_handle, reply, nullptr);
+}
+
+// Periodically pump decoded frames from every stream into its Flutter texture.
 static gboolean pump_video_frame_cb(gpointer user_data) {
   OpenautoflutterPlugin* self = OPENAUTOFLUTTER_PLUGIN(user_data);
-  if (!self || !self->video_texture || !self->texture_registrar) {
+  if (!self || !self->video || !self->texture_registrar) {
     return TRUE; // keep the timer; environment not ready yet
   }
-
-  std::vector<uint8_t> frame;
-  int w = 0, h = 0;
-  int64_t recv_us = 0;
-  int64_t dec_us = 0;
-  if (self->frame_state && self->frame_state->take_latest(frame, w, h, recv_us, dec_us)) {
-    const gsize need = static_cast<gsize>(w) * static_cast<gsize>(h) * 3u / 2u;
-    if (frame.size() >= need) {
-      oa_video_texture_set_yuv420p_frame(self->video_texture,
-                                         reinterpret_cast<const guint8*>(frame.data()),
-                                         static_cast<gsize>(frame.size()),
-                                         w,
-                                         h);
-      oa_video_texture_mark_frame_available(self->video_texture, self->texture_registrar);
-
-      const auto now_us = std::chrono::duration_cast<std::chrono::microseconds>(
-          std::chrono::steady_clock::now().time_since_epoch()).count();
-      const double decode_ms = dec_us > 0 && recv_us > 0 ? (dec_us - recv_us) / 1000.0 : -1.0;
-      const double upload_ms = dec_us > 0 ? (now_us - dec_us) / 1000.0 : -1.0;
-      const double total_ms = recv_us > 0 ? (now_us - recv_us) / 1000.0 : -1.0;
-
-      static int log_every = 60;
-      static int log_count = 0;
-      if ((log_count++ % log_every) == 0) {
-        std::cout << "[Timing] decode_ms=" << decode_ms
-                  << " upload_ms=" << upload_ms
-                  << " total_ms=" << total_ms
-                  << " size=" << w << "x" << h << std::endl;
-      }
-    }
+  for (auto& entry : self->video->streams) {
+    entry.second->present();
   }
   return TRUE; // continue calling
 }
 
 void openautoflutter_plugin_register_with_registrar(FlPluginRegistrar* registrar) {
+  startup_timeline().mark(Milestone::PluginRegistered);
   OpenautoflutterPlugin* plugin = OPENAUTOFLUTTER_PLUGIN(
       g_object_new(openautoflutter_plugin_get_type(), nullptr));
 
@@ -405,15 +1197,33 @@ void openautoflutter_plugin_register_with_registrar(FlPluginRegistrar* registrar
                                             g_object_ref(plugin),
                                             g_object_unref);
 
-  // Register the GL texture so Flutter can render it via a Texture widget.
+  g_autoptr(FlBinaryCodec) touch_codec = fl_binary_codec_new();
+  g_autoptr(FlBasicMessageChannel) touch_channel =
+      fl_basic_message_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                                   "openautoflutter/touch",
+                                   FL_MESSAGE_CODEC(touch_codec));
+  fl_basic_message_channel_set_message_handler(touch_channel, touch_message_cb,
+                                               g_object_ref(plugin),
+                                               g_object_unref);
+
+  g_autoptr(FlStandardMethodCodec) connection_codec = fl_standard_method_codec_new();
+  plugin->connection_channel =
+      fl_event_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                           "openautoflutter/connection",
+                           FL_METHOD_CODEC(connection_codec));
+  fl_event_channel_set_stream_handlers(plugin->connection_channel, connection_listen_cb,
+                                       connection_cancel_cb, plugin, nullptr);
+
+  // Register the GL textures so Flutter can render them via Texture widgets.
   FlTextureRegistrar* texture_registrar =
       fl_plugin_registrar_get_texture_registrar(registrar);
-  plugin->video_texture = oa_video_texture_new(1, 1);
-  plugin->texture_id = oa_video_texture_register(plugin->video_texture, texture_registrar);
   plugin->texture_registrar = texture_registrar;
+  for (auto& entry : plugin->video->streams) {
+    entry.second->attach_texture(texture_registrar);
+  }
 
-  // Start a 60 FPS timer to feed frames to Flutter when available.
-  plugin->frame_timer_id = g_timeout_add(16, pump_video_frame_cb, plugin);
+  // Feed frames to Flutter when available; 16 ms (60 FPS) unless configurePipeline changes it.
+  start_frame_timer(plugin, pipeline_config().pump_interval_ms);
 
   g_object_unref(plugin);
 }
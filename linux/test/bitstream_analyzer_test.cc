@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "av/bitstream_analyzer.h"
+
+namespace openautoflutter {
+namespace test {
+
+namespace {
+// 1280x720 High profile level 4.0 SPS.
+const std::vector<uint8_t> kSps = {0x67, 0x64, 0x00, 0x28, 0xAC, 0xB4, 0x02, 0x80, 0x2D, 0xC8};
+const std::vector<uint8_t> kPps = {0x68, 0xCE, 0x3C, 0x80};
+
+std::vector<uint8_t> annexb(std::vector<std::vector<uint8_t>> units) {
+  std::vector<uint8_t> out;
+  for (auto& u : units) {
+    out.insert(out.end(), {0x00, 0x00, 0x00, 0x01});
+    out.insert(out.end(), u.begin(), u.end());
+  }
+  return out;
+}
+
+// A slice NAL padded to `size` bytes.
+std::vector<uint8_t> slice(uint8_t header, size_t size) {
+  std::vector<uint8_t> out(size, 0xAA);
+  out[0] = header;
+  return out;
+}
+
+void feed(BitstreamAnalyzer& a, const std::vector<uint8_t>& au, int64_t t_us) {
+  a.on_access_unit(VideoCodec::H264, au.data(), au.size(), t_us);
+}
+}  // namespace
+
+TEST(BitstreamAnalyzer, TracksGopAndNalMix) {
+  BitstreamAnalyzer a;
+  const auto idr = annexb({kSps, kPps, slice(0x65, 200)});
+  const auto p = annexb({slice(0x41, 50)});
+  int64_t t = 1000000;
+  for (int gop = 0; gop < 2; ++gop) {
+    feed(a, idr, t);
+    t += 33333;
+    for (int i = 0; i < 29; ++i, t += 33333) feed(a, p, t);
+  }
+  feed(a, idr, t);
+
+  const BitstreamStats s = a.stats(t);
+  EXPECT_EQ(s.access_units, 61u);
+  EXPECT_EQ(s.frames, 61u);
+  EXPECT_EQ(s.keyframes, 3u);
+  EXPECT_EQ(s.gop_length, 30u);
+  EXPECT_EQ(s.current_gop, 1u);
+  EXPECT_EQ(s.keyframe_interval_us, 30 * 33333);
+  EXPECT_EQ(s.nal_counts[7], 3u);
+  EXPECT_EQ(s.nal_counts[8], 3u);
+  EXPECT_EQ(s.nal_counts[5], 3u);
+  EXPECT_EQ(s.nal_counts[1], 58u);
+  EXPECT_EQ(s.largest_keyframe, idr.size());
+  EXPECT_EQ(s.largest_frame, idr.size());
+
+  ASSERT_TRUE(s.have_sps);
+  EXPECT_EQ(s.sps.width, 1280);
+  EXPECT_EQ(s.sps.height, 720);
+  EXPECT_EQ(video_profile_name(s.codec, s.sps.profile_idc), "High");
+  EXPECT_DOUBLE_EQ(video_level(s.codec, s.sps.level_idc), 4.0);
+}
+
+TEST(BitstreamAnalyzer, MeasuresWindowedBitrate) {
+  BitstreamAnalyzer a;
+  const auto p = annexb({slice(0x41, 996)});  // 1000 bytes with the start code
+  // 10 frames a second for 20 seconds.
+  int64_t t = 0;
+  for (int i = 1; i <= 200; ++i) {
+    t = i * 100000;
+    feed(a, p, t);
+  }
+  BitstreamStats s = a.stats(t);
+  EXPECT_EQ(s.bitrate_short_bps, 80000);
+  EXPECT_EQ(s.bitrate_long_bps, 80000);
+  EXPECT_DOUBLE_EQ(s.fps_short, 10.0);
+  EXPECT_EQ(s.keyframe_interval_us, -1);
+  EXPECT_EQ(s.gop_length, 0u);
+
+  // A burst ages out of the short window first, then the long one.
+  const auto big = annexb({slice(0x41, 9996)});
+  feed(a, big, t + 50000);
+  s = a.stats(t + 100000);
+  EXPECT_EQ(s.largest_recent_frame, big.size());
+  EXPECT_GT(s.bitrate_short_bps, s.bitrate_long_bps);
+  s = a.stats(t + 2000000);
+  EXPECT_EQ(s.bitrate_short_bps, 0);
+  EXPECT_GT(s.bitrate_long_bps, 0);
+  s = a.stats(t + 20000000);
+  EXPECT_EQ(s.bitrate_long_bps, 0);
+  EXPECT_EQ(s.largest_recent_frame, 0u);
+  EXPECT_EQ(s.largest_frame, big.size());
+}
+
+TEST(BitstreamAnalyzer, ResetsOnCodecSwitch) {
+  BitstreamAnalyzer a;
+  const auto h264 = annexb({kSps, kPps, slice(0x65, 100)});
+  feed(a, h264, 1000);
+  ASSERT_TRUE(a.stats(1000).have_sps);
+
+  // H.265 IDR_W_RADL, length-prefixed.
+  const std::vector<uint8_t> hevc = {0x00, 0x00, 0x00, 0x04, 0x26, 0x01, 0xAF, 0x00};
+  a.on_access_unit(VideoCodec::H265, hevc.data(), hevc.size(), 2000);
+  const BitstreamStats s = a.stats(2000);
+  EXPECT_EQ(s.codec, VideoCodec::H265);
+  EXPECT_EQ(s.access_units, 1u);
+  EXPECT_EQ(s.keyframes, 1u);
+  EXPECT_EQ(s.nal_counts[19], 1u);
+  EXPECT_EQ(s.nal_counts[7], 0u);
+  EXPECT_FALSE(s.have_sps);
+  EXPECT_EQ(video_profile_name(VideoCodec::H265, 2), "Main 10");
+  EXPECT_DOUBLE_EQ(video_level(VideoCodec::H265, 93), 3.1);
+}
+
+}  // namespace test
+}  // namespace openautoflutter
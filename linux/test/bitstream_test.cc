@@ -0,0 +1,276 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "av/bitstream.h"
+
+namespace openautoflutter {
+namespace test {
+
+namespace {
+std::vector<uint8_t> nal(std::vector<uint8_t> body) {
+  std::vector<uint8_t> out{0x00, 0x00, 0x00, 0x01};
+  out.insert(out.end(), body.begin(), body.end());
+  return out;
+}
+
+std::vector<uint8_t> concat(std::vector<std::vector<uint8_t>> parts) {
+  std::vector<uint8_t> out;
+  for (auto& p : parts) out.insert(out.end(), p.begin(), p.end());
+  return out;
+}
+
+// H.265 NAL headers are two bytes: type << 1, then temporal id + 1.
+const std::vector<uint8_t> kVps = {0x40, 0x01, 0x0C, 0x01};
+const std::vector<uint8_t> kSps = {0x42, 0x01, 0x01, 0x01};
+const std::vector<uint8_t> kPps = {0x44, 0x01, 0xC1, 0x72};
+const std::vector<uint8_t> kIdr = {0x26, 0x01, 0xAF, 0x00};   // IDR_W_RADL
+const std::vector<uint8_t> kCra = {0x2A, 0x01, 0xAF, 0x00};   // CRA_NUT
+const std::vector<uint8_t> kTrail = {0x02, 0x01, 0xD0, 0x00}; // TRAIL_R
+
+void append_array(std::vector<uint8_t>& out, uint8_t type, const std::vector<uint8_t>& unit) {
+  out.push_back(0x80 | type); // array_completeness
+  out.push_back(0x00);
+  out.push_back(0x01);        // numNalus
+  out.push_back(static_cast<uint8_t>(unit.size() >> 8));
+  out.push_back(static_cast<uint8_t>(unit.size()));
+  out.insert(out.end(), unit.begin(), unit.end());
+}
+
+std::vector<uint8_t> hvcc_record() {
+  std::vector<uint8_t> out(23, 0);
+  out[0] = 1;    // configurationVersion
+  out[21] = 0x0F; // lengthSizeMinusOne = 3
+  out[22] = 3;   // numOfArrays
+  append_array(out, 32, kVps);
+  append_array(out, 33, kSps);
+  append_array(out, 34, kPps);
+  return out;
+}
+
+// Builds RBSP bit by bit, then escapes it into a NAL payload.
+class BitWriter {
+ public:
+  void bits(uint32_t value, int count) {
+    for (int i = count - 1; i >= 0; --i) bit((value >> i) & 1u);
+  }
+  void bit(uint32_t b) {
+    if (pos_ % 8 == 0) bytes_.push_back(0);
+    if (b) bytes_.back() |= static_cast<uint8_t>(0x80 >> (pos_ % 8));
+    ++pos_;
+  }
+  void ue(uint32_t value) {
+    const uint32_t code = value + 1;
+    int len = 0;
+    while ((code >> len) > 1) ++len;
+    bits(0, len);
+    bits(code, len + 1);
+  }
+  // Header bytes, then the RBSP with stop bit and emulation prevention.
+  std::vector<uint8_t> nal(std::vector<uint8_t> header) {
+    bit(1);
+    int zeros = 0;
+    for (uint8_t b : bytes_) {
+      if (zeros >= 2 && b <= 3) {
+        header.push_back(0x03);
+        zeros = 0;
+      }
+      header.push_back(b);
+      zeros = b == 0 ? zeros + 1 : 0;
+    }
+    return header;
+  }
+
+ private:
+  std::vector<uint8_t> bytes_;
+  size_t pos_ = 0;
+};
+
+std::vector<uint8_t> h264_sps(uint32_t profile, uint32_t width_mbs, uint32_t height_units, uint32_t crop_bottom) {
+  BitWriter w;
+  w.bits(profile, 8);
+  w.bits(0, 8);   // constraint flags
+  w.bits(40, 8);  // level_idc
+  w.ue(0);        // seq_parameter_set_id
+  if (profile == 100) {
+    w.ue(1);      // chroma_format_idc 4:2:0
+    w.ue(0);      // bit_depth_luma_minus8
+    w.ue(0);      // bit_depth_chroma_minus8
+    w.bit(0);     // qpprime_y_zero_transform_bypass_flag
+    w.bit(0);     // seq_scaling_matrix_present_flag
+  }
+  w.ue(0);        // log2_max_frame_num_minus4
+  w.ue(2);        // pic_order_cnt_type
+  w.ue(1);        // max_num_ref_frames
+  w.bit(0);       // gaps_in_frame_num_value_allowed_flag
+  w.ue(width_mbs - 1);
+  w.ue(height_units - 1);
+  w.bit(1);       // frame_mbs_only_flag
+  w.bit(1);       // direct_8x8_inference_flag
+  w.bit(crop_bottom ? 1 : 0);
+  if (crop_bottom) {
+    w.ue(0);
+    w.ue(0);
+    w.ue(0);
+    w.ue(crop_bottom);
+  }
+  w.bit(0);       // vui_parameters_present_flag
+  return w.nal({0x67});
+}
+
+std::vector<uint8_t> h265_sps(uint32_t width, uint32_t height, uint32_t crop_bottom) {
+  BitWriter w;
+  w.bits(0, 4);   // sps_video_parameter_set_id
+  w.bits(0, 3);   // sps_max_sub_layers_minus1
+  w.bit(1);       // sps_temporal_id_nesting_flag
+  w.bits(1, 8);   // profile space, tier, general_profile_idc = Main
+  w.bits(0x60000000, 32);
+  w.bits(0x90, 8);
+  w.bits(0, 32);
+  w.bits(0, 8);
+  w.bits(120, 8); // general_level_idc
+  w.ue(0);        // sps_seq_parameter_set_id
+  w.ue(1);        // chroma_format_idc
+  w.ue(width);
+  w.ue(height);
+  w.bit(crop_bottom ? 1 : 0);
+  if (crop_bottom) {
+    w.ue(0);
+    w.ue(0);
+    w.ue(0);
+    w.ue(crop_bottom);
+  }
+  w.ue(0);        // bit_depth_luma_minus8
+  return w.nal({0x42, 0x01});
+}
+}  // namespace
+
+TEST(Bitstream, ScansH265AccessUnits) {
+  const auto key = concat({nal(kVps), nal(kSps), nal(kPps), nal(kIdr)});
+  const AccessUnitInfo idr = scan_h265_access_unit(key.data(), key.size());
+  EXPECT_TRUE(idr.idr);
+  EXPECT_TRUE(idr.intra);
+  EXPECT_TRUE(idr.parameter_sets);
+
+  const auto cra = nal(kCra);
+  const AccessUnitInfo open_gop = scan_h265_access_unit(cra.data(), cra.size());
+  EXPECT_FALSE(open_gop.idr);
+  EXPECT_TRUE(open_gop.intra);
+  EXPECT_FALSE(open_gop.parameter_sets);
+
+  const auto trail = nal(kTrail);
+  const AccessUnitInfo p = scan_h265_access_unit(trail.data(), trail.size());
+  EXPECT_FALSE(p.idr);
+  EXPECT_FALSE(p.intra);
+
+  // SPS/PPS alone are not a complete H.265 set.
+  const auto partial = concat({nal(kSps), nal(kPps), nal(kIdr)});
+  EXPECT_FALSE(scan_h265_access_unit(partial.data(), partial.size()).parameter_sets);
+}
+
+TEST(Bitstream, DetectsParameterSetOnlyPayloads) {
+  const auto h265_config = concat({nal(kVps), nal(kSps), nal(kPps)});
+  EXPECT_TRUE(is_h265_parameter_sets_only(h265_config.data(), h265_config.size()));
+  const auto h265_key = concat({nal(kVps), nal(kSps), nal(kPps), nal(kIdr)});
+  EXPECT_FALSE(is_h265_parameter_sets_only(h265_key.data(), h265_key.size()));
+
+  const auto h264_config = concat({nal({0x67, 0x42, 0x00, 0x1F}), nal({0x68, 0xCE, 0x3C, 0x80})});
+  EXPECT_TRUE(is_h264_parameter_sets_only(h264_config.data(), h264_config.size()));
+  const auto h264_key = concat({h264_config, nal({0x65, 0x88, 0x80})});
+  EXPECT_FALSE(is_h264_parameter_sets_only(h264_key.data(), h264_key.size()));
+}
+
+TEST(Bitstream, ParsesHvccRecord) {
+  const auto record = hvcc_record();
+  std::vector<uint8_t> annexb;
+  ASSERT_TRUE(parse_hvcc_config(record.data(), record.size(), annexb));
+  EXPECT_EQ(annexb, concat({nal(kVps), nal(kSps), nal(kPps)}));
+
+  // Truncated or trailing data is not a record.
+  std::vector<uint8_t> out;
+  EXPECT_FALSE(parse_hvcc_config(record.data(), record.size() - 1, out));
+  auto padded = record;
+  padded.push_back(0);
+  EXPECT_FALSE(parse_hvcc_config(padded.data(), padded.size(), out));
+  EXPECT_TRUE(out.empty());
+}
+
+TEST(Bitstream, ParsesAvccRecord) {
+  const std::vector<uint8_t> sps = {0x67, 0x42, 0x00, 0x1F};
+  const std::vector<uint8_t> pps = {0x68, 0xCE, 0x3C, 0x80};
+  std::vector<uint8_t> record = {0x01, 0x42, 0x00, 0x1F, 0xFF, 0xE1, 0x00, 0x04};
+  record.insert(record.end(), sps.begin(), sps.end());
+  record.insert(record.end(), {0x01, 0x00, 0x04});
+  record.insert(record.end(), pps.begin(), pps.end());
+
+  std::vector<uint8_t> annexb;
+  ASSERT_TRUE(parse_avcc_config(record.data(), record.size(), annexb));
+  EXPECT_EQ(annexb, concat({nal(sps), nal(pps)}));
+}
+
+TEST(Bitstream, ParsesH264SpsSize) {
+  int w = 0, h = 0;
+  // 1920x1088 coded, cropped by 4 chroma rows to 1080.
+  const auto baseline = concat({nal(h264_sps(66, 120, 68, 4)), nal({0x68, 0xCE, 0x3C, 0x80})});
+  ASSERT_TRUE(parse_h264_sps_size(baseline.data(), baseline.size(), w, h));
+  EXPECT_EQ(w, 1920);
+  EXPECT_EQ(h, 1080);
+
+  const auto high = nal(h264_sps(100, 80, 45, 0));
+  ASSERT_TRUE(parse_h264_sps_size(high.data(), high.size(), w, h));
+  EXPECT_EQ(w, 1280);
+  EXPECT_EQ(h, 720);
+
+  const auto pps_only = nal({0x68, 0xCE, 0x3C, 0x80});
+  EXPECT_FALSE(parse_h264_sps_size(pps_only.data(), pps_only.size(), w, h));
+}
+
+TEST(Bitstream, ParsesH265SpsSize) {
+  int w = 0, h = 0;
+  const auto config = concat({nal(kVps), nal(h265_sps(1920, 1088, 4)), nal(kPps)});
+  ASSERT_TRUE(parse_h265_sps_size(config.data(), config.size(), w, h));
+  EXPECT_EQ(w, 1920);
+  EXPECT_EQ(h, 1080);
+
+  // Truncated SPS.
+  const auto truncated = nal(kSps);
+  EXPECT_FALSE(parse_h265_sps_size(truncated.data(), truncated.size(), w, h));
+}
+
+TEST(Bitstream, ParsesSpsProfileAndLevel) {
+  SpsInfo info;
+  const auto high = nal(h264_sps(100, 80, 45, 0));
+  ASSERT_TRUE(parse_h264_sps(high.data(), high.size(), info));
+  EXPECT_EQ(info.profile_idc, 100);
+  EXPECT_EQ(info.level_idc, 40);
+  EXPECT_EQ(info.width, 1280);
+
+  const auto hevc = nal(h265_sps(1920, 1088, 4));
+  ASSERT_TRUE(parse_h265_sps(hevc.data(), hevc.size(), info));
+  EXPECT_EQ(info.profile_idc, 1);
+  EXPECT_EQ(info.level_idc, 120);
+  EXPECT_EQ(info.height, 1080);
+}
+
+TEST(Bitstream, ExtractsInBandParameterSets) {
+  const auto key = concat({nal(kVps), nal(kSps), nal(kPps), nal(kIdr)});
+  std::vector<uint8_t> sets;
+  ASSERT_TRUE(extract_h265_parameter_sets(key.data(), key.size(), sets));
+  EXPECT_EQ(sets, concat({nal(kVps), nal(kSps), nal(kPps)}));
+
+  const auto trail = nal(kTrail);
+  std::vector<uint8_t> none;
+  EXPECT_FALSE(extract_h265_parameter_sets(trail.data(), trail.size(), none));
+  EXPECT_TRUE(none.empty());
+
+  const std::vector<uint8_t> sps = {0x67, 0x42, 0x00, 0x1F};
+  const std::vector<uint8_t> pps = {0x68, 0xCE, 0x3C, 0x80};
+  const auto h264_key = concat({nal(sps), nal(pps), nal({0x65, 0x88, 0x80})});
+  std::vector<uint8_t> h264_sets;
+  ASSERT_TRUE(extract_h264_parameter_sets(h264_key.data(), h264_key.size(), h264_sets));
+  EXPECT_EQ(h264_sets, concat({nal(sps), nal(pps)}));
+}
+
+}  // namespace test
+}  // namespace openautoflutter
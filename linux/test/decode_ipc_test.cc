@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "av/decode_ipc.h"
+#include "av/decode_worker.h"
+
+namespace openautoflutter {
+namespace test {
+
+namespace {
+constexpr size_t kRing = 64 * 1024;
+
+std::shared_ptr<decode_ipc::Channel> make_channel() {
+  return decode_ipc::Channel::create(0, kRing, 2, 4096);
+}
+}  // namespace
+
+TEST(DecodeIpc, RecordsComeOutInOrderAcrossTheWrap) {
+  auto channel = make_channel();
+  ASSERT_NE(channel, nullptr);
+  // 3 x 20000-byte records fill most of the ring; the fourth has to wrap.
+  std::vector<uint8_t> payload(20000);
+  uint64_t next_seq = 1, expect_seq = 1;
+  for (int round = 0; round < 5; ++round) {
+    for (int i = 0; i < 3; ++i) {
+      std::memset(payload.data(), static_cast<int>(next_seq), payload.size());
+      ASSERT_TRUE(channel->write(decode_ipc::RecordType::Packet, next_seq, payload.data(), payload.size()));
+      ++next_seq;
+    }
+    decode_ipc::RecordHeader record;
+    const uint8_t* data = nullptr;
+    while (channel->peek(record, data)) {
+      EXPECT_EQ(record.seq, expect_seq);
+      EXPECT_EQ(record.size, payload.size());
+      EXPECT_EQ(data[0], static_cast<uint8_t>(expect_seq));
+      EXPECT_EQ(data[payload.size() - 1], static_cast<uint8_t>(expect_seq));
+      channel->consume();
+      ++expect_seq;
+    }
+  }
+  EXPECT_EQ(expect_seq, next_seq);
+}
+
+TEST(DecodeIpc, WriteFailsWhenTheRingIsFull) {
+  auto channel = make_channel();
+  ASSERT_NE(channel, nullptr);
+  std::vector<uint8_t> payload(30000);
+  EXPECT_TRUE(channel->write(decode_ipc::RecordType::Packet, 1, payload.data(), payload.size()));
+  EXPECT_TRUE(channel->write(decode_ipc::RecordType::Packet, 2, payload.data(), payload.size()));
+  EXPECT_FALSE(channel->write(decode_ipc::RecordType::Packet, 3, payload.data(), payload.size()));
+  EXPECT_FALSE(channel->write(decode_ipc::RecordType::Packet, 4, payload.data(), kRing));
+
+  decode_ipc::RecordHeader record;
+  const uint8_t* data = nullptr;
+  ASSERT_TRUE(channel->peek(record, data));
+  channel->consume();
+  EXPECT_TRUE(channel->write(decode_ipc::RecordType::Packet, 3, payload.data(), payload.size()));
+}
+
+TEST(DecodeIpc, AttachSeesTheSameMemory) {
+  auto channel = make_channel();
+  ASSERT_NE(channel, nullptr);
+  auto peer = decode_ipc::Channel::attach(dup(channel->fd()));
+  ASSERT_NE(peer, nullptr);
+  EXPECT_EQ(peer->header().slot_count, 2u);
+
+  const uint8_t options[1] = {1};
+  ASSERT_TRUE(channel->write(decode_ipc::RecordType::KeyframesOnly, 7, options, 1));
+  decode_ipc::RecordHeader record;
+  const uint8_t* data = nullptr;
+  ASSERT_TRUE(peer->peek(record, data));
+  EXPECT_EQ(record.type, static_cast<uint32_t>(decode_ipc::RecordType::KeyframesOnly));
+  EXPECT_EQ(data[0], 1);
+  peer->consume();
+  EXPECT_FALSE(channel->peek(record, data));
+}
+
+TEST(DecodeIpc, SlotsAreClaimedUntilReleased) {
+  auto channel = make_channel();
+  ASSERT_NE(channel, nullptr);
+  EXPECT_EQ(channel->claim_slot(), 0);
+  EXPECT_EQ(channel->claim_slot(), 1);
+  EXPECT_EQ(channel->claim_slot(), -1);
+  channel->release_slot(0);
+  EXPECT_EQ(channel->claim_slot(), 0);
+}
+
+TEST(DecodeWorkerArgs, FormatParseRoundTrip) {
+  DecodeWorkerArgs args;
+  args.shm_fd = 3;
+  args.request_fd = 4;
+  args.done_fd = 5;
+  args.cgroup = "/sys/fs/cgroup/user.slice/oa-decode";
+  args.cpu_percent = 150;
+  std::vector<std::string> strings = format_decode_worker_args(args);
+  strings.insert(strings.begin(), "worker");
+  std::vector<const char*> argv;
+  for (const auto& s : strings) argv.push_back(s.c_str());
+
+  DecodeWorkerArgs parsed;
+  ASSERT_TRUE(parse_decode_worker_args(static_cast<int>(argv.size()), argv.data(), parsed));
+  EXPECT_EQ(parsed.shm_fd, 3);
+  EXPECT_EQ(parsed.request_fd, 4);
+  EXPECT_EQ(parsed.done_fd, 5);
+  EXPECT_EQ(parsed.cgroup, args.cgroup);
+  EXPECT_EQ(parsed.cpu_percent, 150);
+
+  const char* missing_fd[] = {"worker", "--shm-fd=3", "--request-fd=4"};
+  EXPECT_FALSE(parse_decode_worker_args(3, missing_fd, parsed));
+  const char* unknown[] = {"worker", "--shm-fd=3", "--request-fd=4", "--done-fd=5", "--bogus=1"};
+  EXPECT_FALSE(parse_decode_worker_args(5, unknown, parsed));
+}
+
+}  // namespace test
+}  // namespace openautoflutter
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "av/decode_pool.h"
+
+namespace openautoflutter {
+namespace test {
+
+namespace {
+void wait_for(const std::atomic<int>& counter, int value) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (counter.load() < value && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+}  // namespace
+
+TEST(DecodePool, StrandRunsTasksInOrder) {
+  DecodePool pool(4);
+  auto strand = pool.make_strand();
+  std::mutex mutex;
+  std::vector<int> order;
+  std::atomic<int> done{0};
+  for (int i = 0; i < 100; ++i) {
+    strand->post([&, i]() {
+      {
+        std::lock_guard<std::mutex> lk(mutex);
+        order.push_back(i);
+      }
+      ++done;
+    });
+  }
+  wait_for(done, 100);
+  ASSERT_EQ(order.size(), 100u);
+  for (int i = 0; i < 100; ++i) EXPECT_EQ(order[i], i);
+}
+
+TEST(DecodePool, StrandsRunInParallel) {
+  DecodePool pool(2);
+  auto a = pool.make_strand();
+  auto b = pool.make_strand();
+  std::atomic<int> running{0};
+  std::atomic<int> peak{0};
+  std::atomic<int> done{0};
+  auto task = [&]() {
+    const int now = ++running;
+    int prev = peak.load();
+    while (now > prev && !peak.compare_exchange_weak(prev, now)) {}
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    --running;
+    ++done;
+  };
+  a->post(task);
+  b->post(task);
+  wait_for(done, 2);
+  EXPECT_EQ(peak.load(), 2);
+}
+
+TEST(DecodePool, WaitPendingReturnsAsTasksAreTaken) {
+  DecodePool pool(1);
+  auto strand = pool.make_strand();
+  std::atomic<bool> release{false};
+  std::atomic<int> done{0};
+  strand->post([&]() {
+    while (!release.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    ++done;
+  });
+  for (int i = 0; i < 5; ++i) strand->post([&]() { ++done; });
+  EXPECT_FALSE(strand->wait_pending(2, std::chrono::milliseconds(20)));
+
+  release = true;
+  EXPECT_TRUE(strand->wait_pending(2, std::chrono::seconds(5)));
+  EXPECT_LE(strand->pending(), 2u);
+  EXPECT_TRUE(strand->wait_pending(0, std::chrono::seconds(5)));
+  wait_for(done, 6);
+  EXPECT_EQ(done.load(), 6);
+}
+
+TEST(DecodePool, ClearDropsQueuedTasks) {
+  DecodePool pool(1);
+  auto strand = pool.make_strand();
+  std::atomic<bool> release{false};
+  std::atomic<int> done{0};
+  strand->post([&]() {
+    while (!release.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    ++done;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  for (int i = 0; i < 5; ++i) strand->post([&]() { ++done; });
+  EXPECT_EQ(strand->clear(), 5u);
+  release = true;
+  wait_for(done, 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(done.load(), 1);
+}
+
+TEST(DecodePool, ShedKeepsQueueBoundedBehindAStalledTask) {
+  // VideoStream's backlog policy: once the queue reaches a limit, drop the
+  // droppable tasks (non-IDR packets) and put a resync task in front of the
+  // kept ones (keyframes).
+  constexpr size_t kLimit = 16;
+  DecodePool pool(1);
+  auto strand = pool.make_strand();
+  std::atomic<bool> release{false};
+  std::atomic<int> done{0};
+  std::mutex mutex;
+  std::vector<int> order;  // -1 for the resync task
+  auto record = [&](int value) {
+    std::lock_guard<std::mutex> lk(mutex);
+    order.push_back(value);
+  };
+  strand->post([&]() {
+    while (!release.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  size_t peak = 0, dropped = 0;
+  int posted = 0;
+  for (int i = 0; i < 1000; ++i) {
+    const bool keyframe = i % 100 == 0;
+    if (keyframe) ++posted;
+    strand->post([&, i]() { record(i); ++done; }, !keyframe);
+    peak = std::max(peak, strand->pending());
+    if (strand->pending() >= kLimit) dropped += strand->shed([&]() { record(-1); });
+  }
+  EXPECT_LE(peak, kLimit);
+  EXPECT_LE(strand->pending(), kLimit);
+
+  release = true;
+  wait_for(done, static_cast<int>(strand->pending()) + posted);
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (strand->pending() > 0 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  std::lock_guard<std::mutex> lk(mutex);
+  EXPECT_GT(dropped, 0u);
+  EXPECT_EQ(order.size() + dropped, 1000u + 1);  // plus the one resync task left
+  // The resync task runs first; every keyframe survives, in order.
+  ASSERT_FALSE(order.empty());
+  EXPECT_EQ(order[0], -1);
+  std::vector<int> keyframes;
+  for (size_t i = 1; i < order.size(); ++i) {
+    EXPECT_GE(order[i], 0);
+    if (order[i] % 100 == 0) keyframes.push_back(order[i]);
+  }
+  EXPECT_EQ(static_cast<int>(keyframes.size()), posted);
+  for (size_t i = 1; i < keyframes.size(); ++i) EXPECT_LT(keyframes[i - 1], keyframes[i]);
+}
+
+TEST(DecodePool, ShedQueuesOneFrontTaskOnlyAfterDropping) {
+  DecodePool pool(1);
+  auto strand = pool.make_strand();
+  std::atomic<bool> release{false};
+  std::atomic<int> done{0};
+  strand->post([&]() {
+    while (!release.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  strand->post([&]() { ++done; });
+  EXPECT_EQ(strand->shed([&]() { done += 100; }), 0u);
+  EXPECT_EQ(strand->pending(), 1u);
+  // A queued front task is replaced, not dropped for good.
+  strand->post([&]() { ++done; }, true);
+  EXPECT_EQ(strand->shed([&]() { done += 10; }), 1u);
+  EXPECT_EQ(strand->shed([&]() { done += 1000; }), 0u);
+  EXPECT_EQ(strand->pending(), 2u);
+  release = true;
+  wait_for(done, 1001);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(done.load(), 1001);
+}
+
+}  // namespace test
+}  // namespace openautoflutter
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "av/decode_recovery.h"
+
+namespace openautoflutter {
+namespace test {
+
+namespace {
+// Annex-B NAL with a 4-byte start code.
+std::vector<uint8_t> nal(std::vector<uint8_t> body) {
+  std::vector<uint8_t> out{0x00, 0x00, 0x00, 0x01};
+  out.insert(out.end(), body.begin(), body.end());
+  return out;
+}
+
+std::vector<uint8_t> concat(std::vector<std::vector<uint8_t>> parts) {
+  std::vector<uint8_t> out;
+  for (auto& p : parts) out.insert(out.end(), p.begin(), p.end());
+  return out;
+}
+
+AccessUnitInfo scan(const std::vector<uint8_t>& au) {
+  return scan_h264_access_unit(au.data(), au.size());
+}
+
+// Slice headers start with ue(first_mb_in_slice)=0 -> '1', then ue(slice_type).
+const std::vector<uint8_t> kPSlice = nal({0x41, 0x9A, 0x00});   // type 1, slice_type 0 (P): '1' '1'
+const std::vector<uint8_t> kISlice = nal({0x41, 0xB8, 0x00});   // type 1, slice_type 2 (I): '1' '011'
+const std::vector<uint8_t> kIdr = nal({0x65, 0x88, 0x80});      // type 5
+const std::vector<uint8_t> kSps = nal({0x67, 0x42, 0x00, 0x1F});
+const std::vector<uint8_t> kPps = nal({0x68, 0xCE, 0x3C, 0x80});
+}  // namespace
+
+TEST(DecodeRecovery, ScansAccessUnits) {
+  const AccessUnitInfo idr = scan(concat({kSps, kPps, kIdr}));
+  EXPECT_TRUE(idr.idr);
+  EXPECT_TRUE(idr.intra);
+  EXPECT_TRUE(idr.sps);
+  EXPECT_TRUE(idr.pps);
+
+  const AccessUnitInfo p = scan(kPSlice);
+  EXPECT_FALSE(p.idr);
+  EXPECT_FALSE(p.intra);
+
+  const AccessUnitInfo i = scan(kISlice);
+  EXPECT_FALSE(i.idr);
+  EXPECT_TRUE(i.intra);
+}
+
+TEST(DecodeRecovery, DiscardsUntilIdrAndMeasuresRecovery) {
+  DecodeRecovery recovery;
+  EXPECT_TRUE(recovery.admit(scan(kPSlice), 0));
+  EXPECT_EQ(recovery.on_frame(10), -1);
+
+  recovery.on_error(1000);
+  EXPECT_TRUE(recovery.awaiting_keyframe());
+  EXPECT_TRUE(recovery.keyframe_request_due(1000));
+  EXPECT_FALSE(recovery.keyframe_request_due(1001));
+  EXPECT_FALSE(recovery.admit(scan(kPSlice), 2000));
+  EXPECT_FALSE(recovery.admit(scan(kISlice), 3000)); // I-slices only after the fallback delay
+  EXPECT_EQ(recovery.stats().discarded, 2u);
+
+  EXPECT_TRUE(recovery.admit(scan(kIdr), 4000));
+  EXPECT_FALSE(recovery.awaiting_keyframe());
+  EXPECT_TRUE(recovery.admit(scan(kPSlice), 4500)); // references the IDR, fine
+  EXPECT_EQ(recovery.on_frame(6000), 5000);
+  EXPECT_FALSE(recovery.recovering());
+  EXPECT_EQ(recovery.stats().recoveries, 1u);
+}
+
+TEST(DecodeRecovery, ErrorWhileResyncingKeepsFirstErrorTime) {
+  DecodeRecovery recovery;
+  recovery.on_error(1000);
+  EXPECT_TRUE(recovery.admit(scan(kIdr), 2000));
+  recovery.on_error(2500);
+  EXPECT_TRUE(recovery.awaiting_keyframe());
+  EXPECT_EQ(recovery.stats().errors, 1u);
+
+  // Past the fallback delay an I-slice picture is good enough.
+  EXPECT_TRUE(recovery.admit(scan(kISlice), 1000 + DecodeRecovery::kIntraFallbackUs));
+  EXPECT_EQ(recovery.on_frame(1000 + DecodeRecovery::kIntraFallbackUs + 500), DecodeRecovery::kIntraFallbackUs + 500);
+}
+
+TEST(DecodeRecovery, PlannedResyncIsNotCountedAsRecovery) {
+  DecodeRecovery recovery;
+  recovery.resync(1000);
+  EXPECT_TRUE(recovery.awaiting_keyframe());
+  EXPECT_FALSE(recovery.admit(scan(kPSlice), 1500));
+  EXPECT_TRUE(recovery.admit(scan(kIdr), 2000));
+  EXPECT_EQ(recovery.on_frame(2500), -1);
+  EXPECT_EQ(recovery.stats().errors, 0u);
+  EXPECT_EQ(recovery.stats().recoveries, 0u);
+}
+
+}  // namespace test
+}  // namespace openautoflutter
@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+
+#include "av/display_sizes.h"
+
+namespace openautoflutter {
+namespace test {
+
+namespace {
+std::pair<int, int> output(const DisplaySizes& sizes, int src_w, int src_h) {
+  int w = 0, h = 0;
+  sizes.output(src_w, src_h, w, h);
+  return {w, h};
+}
+
+const int kPrimary = 0;
+const int kView = 0;
+}  // namespace
+
+TEST(DisplaySizes, DecodedSizeUntilAViewReports) {
+  DisplaySizes sizes;
+  EXPECT_EQ(output(sizes, 1920, 1080), std::make_pair(1920, 1080));
+  EXPECT_TRUE(sizes.set(&kPrimary, 960, 540, 1920, 1080));
+  EXPECT_EQ(output(sizes, 1920, 1080), std::make_pair(960, 540));
+  EXPECT_TRUE(sizes.set(&kPrimary, 0, 540, 1920, 1080));  // forgotten
+  EXPECT_EQ(output(sizes, 1920, 1080), std::make_pair(1920, 1080));
+}
+
+TEST(DisplaySizes, LargestViewWinsPerAxisAndNeverUpscales) {
+  DisplaySizes sizes;
+  sizes.set(&kPrimary, 800, 300, 1280, 720);
+  sizes.set(&kView, 400, 600, 1280, 720);
+  EXPECT_EQ(output(sizes, 1280, 720), std::make_pair(800, 600));
+  // A view larger than the picture is clamped to it.
+  sizes.set(&kView, 4000, 600, 1280, 720);
+  EXPECT_EQ(output(sizes, 1280, 720), std::make_pair(1280, 600));
+  EXPECT_EQ(output(sizes, 640, 480), std::make_pair(640, 480));
+}
+
+TEST(DisplaySizes, ReportsOnlyOutputChanges) {
+  DisplaySizes sizes;
+  EXPECT_TRUE(sizes.set(&kPrimary, 800, 450, 1280, 720));
+  EXPECT_FALSE(sizes.set(&kPrimary, 800, 450, 1280, 720));  // same again
+  EXPECT_FALSE(sizes.set(&kView, 400, 200, 1280, 720));     // smaller than the primary
+  EXPECT_FALSE(sizes.set(&kView, 0, 0, 1280, 720));
+  // Both past the picture: clamped to the same output.
+  EXPECT_TRUE(sizes.set(&kPrimary, 2000, 2000, 1280, 720));
+  EXPECT_FALSE(sizes.set(&kPrimary, 3000, 3000, 1280, 720));
+  // Without a picture nothing is converted yet.
+  DisplaySizes empty;
+  EXPECT_FALSE(empty.set(&kPrimary, 800, 450, 0, 0));
+}
+
+}  // namespace test
+}  // namespace openautoflutter
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "av/frame_tap.h"
+
+namespace openautoflutter {
+namespace test {
+
+namespace {
+// I420 frame whose luma is `luma` everywhere and chroma 128.
+std::vector<uint8_t> i420(int w, int h, uint8_t luma) {
+  std::vector<uint8_t> out(static_cast<size_t>(w) * h, luma);
+  out.resize(out.size() + 2 * static_cast<size_t>((w + 1) / 2) * ((h + 1) / 2), 128);
+  return out;
+}
+
+FrameTapConfig luma_config(int max_w, int max_h, int64_t interval_us = 0) {
+  FrameTapConfig config;
+  config.format = FrameTapFormat::Luma;
+  config.max_width = max_w;
+  config.max_height = max_h;
+  config.min_interval_us = interval_us;
+  return config;
+}
+}  // namespace
+
+TEST(FrameTap, DownscalesByAveraging) {
+  // 4x2 luma, halved: each output pixel is a 2x2 block mean.
+  const uint8_t src[] = {0, 10, 100, 100,
+                         20, 30, 200, 201};
+  uint8_t dst[2] = {};
+  downscale_plane(src, 4, 2, 4, dst, 2, 1);
+  EXPECT_EQ(dst[0], 15);
+  EXPECT_EQ(dst[1], 150);
+
+  int w = 0, h = 0;
+  fit_size(1920, 1080, 320, 0, w, h);
+  EXPECT_EQ(w, 320);
+  EXPECT_EQ(h, 180);
+  fit_size(1920, 1080, 320, 100, w, h);
+  EXPECT_EQ(h, 100);
+  EXPECT_EQ(w, 177);
+  fit_size(640, 480, 0, 0, w, h);
+  EXPECT_EQ(w, 640);
+}
+
+TEST(FrameTap, PublishesAtConfiguredRate) {
+  FrameTap tap(3);
+  const auto frame = i420(64, 36, 77);
+  tap.offer(frame.data(), 64, 36, 1000);
+  EXPECT_EQ(tap.acquire(0), nullptr);  // off by default
+
+  tap.configure(luma_config(32, 32, 100000));
+  for (int i = 0; i < 10; ++i) tap.offer(frame.data(), 64, 36, 1000 + i * 33333);
+  EXPECT_EQ(tap.published(), 3u);  // t = 0, 133 ms, 266 ms
+
+  const TapFrame* f = tap.acquire(0);
+  ASSERT_NE(f, nullptr);
+  EXPECT_EQ(f->sequence, 3u);
+  EXPECT_EQ(f->stream_id, 3);
+  EXPECT_EQ(f->format, static_cast<uint32_t>(FrameTapFormat::Luma));
+  EXPECT_EQ(f->width, 32u);
+  EXPECT_EQ(f->height, 18u);
+  EXPECT_EQ(f->size, 32u * 18u);
+  EXPECT_EQ(f->data[0], 77);
+  EXPECT_EQ(tap.acquire(f->sequence), nullptr);
+  FrameTap::release(f);
+
+  FrameTapConfig full;
+  full.format = FrameTapFormat::I420;
+  tap.configure(full);
+  tap.offer(frame.data(), 64, 36, 2000000);
+  f = tap.acquire(3);
+  ASSERT_NE(f, nullptr);
+  EXPECT_EQ(f->width, 64u);
+  EXPECT_EQ(f->size, frame.size());
+  EXPECT_EQ(f->data[f->size - 1], 128);
+  FrameTap::release(f);
+}
+
+TEST(FrameTap, SkipsWhenReadersHoldEveryBuffer) {
+  FrameTap tap(0);
+  tap.configure(luma_config(8, 8));
+  const auto frame = i420(16, 16, 1);
+  std::vector<const TapFrame*> held;
+  for (int i = 0; i < FrameTap::kMaxBuffers + 2; ++i) {
+    tap.offer(frame.data(), 16, 16, 1000 + i);
+    if (const TapFrame* f = tap.acquire(held.empty() ? 0 : held.back()->sequence)) held.push_back(f);
+  }
+  EXPECT_EQ(held.size(), static_cast<size_t>(FrameTap::kMaxBuffers));
+  EXPECT_EQ(tap.skipped(), 2u);
+
+  for (const TapFrame* f : held) FrameTap::release(f);
+  tap.offer(frame.data(), 16, 16, 5000);
+  EXPECT_EQ(tap.published(), static_cast<uint64_t>(FrameTap::kMaxBuffers) + 1);
+}
+
+TEST(FrameTap, FrameOutlivesTap) {
+  const TapFrame* f = nullptr;
+  {
+    auto tap = std::make_shared<FrameTap>(42);
+    register_frame_tap(tap);
+    EXPECT_EQ(find_frame_tap(42), tap);
+    tap->configure(luma_config(0, 0));
+    const auto frame = i420(8, 8, 9);
+    tap->offer(frame.data(), 8, 8, 1000);
+    f = tap->acquire(0);
+    unregister_frame_tap(*tap);
+    EXPECT_EQ(find_frame_tap(42), nullptr);
+  }
+  ASSERT_NE(f, nullptr);
+  EXPECT_EQ(f->data[63], 9);
+  FrameTap::release(f);
+}
+
+TEST(FrameTap, BuffersReturnedWhileOffAreFreed) {
+  FrameTap tap(5);
+  tap.configure(luma_config(0, 0));
+  const auto frame = i420(32, 32, 3);
+  tap.offer(frame.data(), 32, 32, 1000);
+  const TapFrame* f = tap.acquire(0);
+  ASSERT_NE(f, nullptr);
+  EXPECT_EQ(tap.held_bytes(), 32u * 32u);
+
+  FrameTapConfig off;
+  tap.configure(off);
+  EXPECT_EQ(tap.held_bytes(), 32u * 32u);  // still with the reader
+  FrameTap::release(f);
+  EXPECT_EQ(tap.held_bytes(), 0u);
+
+  // Turned back on, buffers are pooled again.
+  tap.configure(luma_config(0, 0));
+  tap.offer(frame.data(), 32, 32, 2000);
+  f = tap.acquire(0);
+  ASSERT_NE(f, nullptr);
+  tap.offer(frame.data(), 32, 32, 3000);
+  FrameTap::release(f);
+  EXPECT_EQ(tap.held_bytes(), 2u * 32u * 32u);
+}
+
+TEST(FrameTap, PacksPaddedPlanes) {
+  FrameTap tap(4);
+  FrameTapConfig full;
+  full.format = FrameTapFormat::I420;
+  tap.configure(full);
+  // 6x4 picture with 16-byte rows; each plane filled with its index + 1.
+  std::vector<uint8_t> rows(16 * (4 + 2 + 2), 0xEE);
+  I420Planes planes;
+  for (int i = 0; i < 3; ++i) {
+    const int first = i == 0 ? 0 : 4 + (i - 1) * 2;
+    const int count = i == 0 ? 4 : 2;
+    planes.data[i] = rows.data() + 16 * first;
+    planes.stride[i] = 16;
+    for (int r = 0; r < count; ++r) std::fill_n(rows.data() + 16 * (first + r), i == 0 ? 6 : 3, i + 1);
+  }
+  tap.offer(planes, 6, 4, 1000);
+  const TapFrame* f = tap.acquire(0);
+  ASSERT_NE(f, nullptr);
+  std::vector<uint8_t> expected(24, 1);
+  expected.resize(30, 2);
+  expected.resize(36, 3);
+  EXPECT_EQ(std::vector<uint8_t>(f->data, f->data + f->size), expected);
+  FrameTap::release(f);
+
+  tap.configure(luma_config(0, 0));
+  tap.offer(planes, 6, 4, 2000);
+  f = tap.acquire(1);
+  ASSERT_NE(f, nullptr);
+  EXPECT_EQ(std::vector<uint8_t>(f->data, f->data + f->size), std::vector<uint8_t>(24, 1));
+  FrameTap::release(f);
+}
+
+}  // namespace test
+}  // namespace openautoflutter
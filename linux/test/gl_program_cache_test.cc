@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <dirent.h>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "av/gl_program_cache.h"
+
+namespace openautoflutter {
+namespace test {
+
+namespace {
+std::string temp_cache_dir(const char* name) {
+  return "/tmp/oaf_glcache_" + std::string(name) + "_" + std::to_string(getpid()) + "/nested";
+}
+
+std::string only_entry(const std::string& dir) {
+  std::string found;
+  if (DIR* d = opendir(dir.c_str())) {
+    while (dirent* e = readdir(d)) {
+      if (e->d_name[0] != '.') found = dir + "/" + e->d_name;
+    }
+    closedir(d);
+  }
+  return found;
+}
+}  // namespace
+
+TEST(GLProgramCache, KeyDependsOnEveryPart) {
+  EXPECT_EQ(program_cache_key({"Mesa", "llvmpipe"}), program_cache_key({"Mesa", "llvmpipe"}));
+  EXPECT_NE(program_cache_key({"Mesa", "llvmpipe"}), program_cache_key({"Mesa", "softpipe"}));
+  EXPECT_NE(program_cache_key({"ab", "c"}), program_cache_key({"a", "bc"}));
+}
+
+TEST(GLProgramCache, RoundTripCreatesDirectory) {
+  const std::string dir = temp_cache_dir("roundtrip");
+  const std::string key = program_cache_key({"vendor", "renderer", "shader"});
+  ProgramBinary in;
+  in.format = 0x8741;
+  in.data = {1, 2, 3, 4, 5};
+  ASSERT_TRUE(store_program_binary(dir, key, in));
+
+  ProgramBinary out;
+  ASSERT_TRUE(load_program_binary(dir, key, out));
+  EXPECT_EQ(out.format, in.format);
+  EXPECT_EQ(out.data, in.data);
+
+  // Another driver string must not pick up this entry.
+  EXPECT_FALSE(load_program_binary(dir, program_cache_key({"vendor", "other", "shader"}), out));
+
+  remove_program_binary(dir, key);
+  EXPECT_FALSE(load_program_binary(dir, key, out));
+}
+
+TEST(GLProgramCache, RejectsTruncatedAndPaddedFiles) {
+  const std::string dir = temp_cache_dir("corrupt");
+  const std::string key = program_cache_key({"k"});
+  ProgramBinary in;
+  in.format = 1;
+  in.data.assign(64, 0x5a);
+  ASSERT_TRUE(store_program_binary(dir, key, in));
+  const std::string path = only_entry(dir);
+  ASSERT_FALSE(path.empty());
+
+  ASSERT_EQ(truncate(path.c_str(), 40), 0);
+  ProgramBinary out;
+  EXPECT_FALSE(load_program_binary(dir, key, out));
+  EXPECT_TRUE(out.data.empty());
+
+  ASSERT_TRUE(store_program_binary(dir, key, in));
+  FILE* f = fopen(path.c_str(), "ab");
+  ASSERT_NE(f, nullptr);
+  fputc(0, f);
+  fclose(f);
+  EXPECT_FALSE(load_program_binary(dir, key, out));
+  remove_program_binary(dir, key);
+}
+
+TEST(GLProgramCache, DirectoryHonoursOverrideAndOff) {
+  const char* saved = std::getenv("OPENAUTOFLUTTER_GL_CACHE_DIR");
+  const std::string restore = saved ? saved : "";
+
+  setenv("OPENAUTOFLUTTER_GL_CACHE_DIR", "/tmp/oaf_cache_override", 1);
+  EXPECT_EQ(program_cache_dir(), "/tmp/oaf_cache_override");
+  setenv("OPENAUTOFLUTTER_GL_CACHE_DIR", "off", 1);
+  EXPECT_EQ(program_cache_dir(), "");
+  ProgramBinary in;
+  in.data = {1};
+  EXPECT_FALSE(store_program_binary(program_cache_dir(), "k", in));
+
+  if (saved) {
+    setenv("OPENAUTOFLUTTER_GL_CACHE_DIR", restore.c_str(), 1);
+  } else {
+    unsetenv("OPENAUTOFLUTTER_GL_CACHE_DIR");
+  }
+}
+
+}  // namespace test
+}  // namespace openautoflutter
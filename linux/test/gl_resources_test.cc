@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "av/gl_resources.h"
+
+namespace openautoflutter {
+namespace test {
+
+namespace {
+constexpr uint32_t kRgba8 = 0x8058;  // GL_RGBA8
+constexpr uint32_t kR8 = 0x8229;     // GL_R8
+
+GlTextureFormat rgba(int w, int h) { return GlTextureFormat{w, h, kRgba8, 4}; }
+}  // namespace
+
+TEST(GlResources, ReleasedTexturesAreReusedBySize) {
+  GlResources r;
+  r.track_texture(1, rgba(1280, 720));
+  r.track_texture(2, rgba(1920, 1080));
+  EXPECT_EQ(r.live_bytes(), rgba(1280, 720).bytes() + rgba(1920, 1080).bytes());
+
+  r.release_texture(1);
+  r.release_texture(2);
+  EXPECT_EQ(r.pooled_bytes(), r.live_bytes());
+  EXPECT_EQ(r.acquire_texture(GlTextureFormat{1280, 720, kR8, 1}), 0u);  // format is part of the key
+  EXPECT_EQ(r.acquire_texture(rgba(1280, 720)), 1u);
+  EXPECT_EQ(r.acquire_texture(rgba(1280, 720)), 0u);
+  EXPECT_EQ(r.pooled_bytes(), rgba(1920, 1080).bytes());
+  EXPECT_EQ(r.reused(), 1u);
+  EXPECT_TRUE(r.take_deletions().empty());
+}
+
+TEST(GlResources, UntrackedAndOverflowingTexturesAreDeleted) {
+  GlResources r;
+  r.release_texture(0);
+  r.release_texture(99);  // never given storage
+  EXPECT_EQ(r.take_deletions(), std::vector<uint32_t>{99});
+  EXPECT_TRUE(r.take_deletions().empty());
+
+  for (uint32_t name = 1; name <= GlResources::kMaxPooled + 2; ++name) {
+    r.track_texture(name, GlTextureFormat{64, 64, kR8, 1});
+    r.release_texture(name);
+  }
+  // The oldest go first, and their storage stops counting.
+  EXPECT_EQ(r.take_deletions(), (std::vector<uint32_t>{1, 2}));
+  EXPECT_EQ(r.live_bytes(), GlResources::kMaxPooled * 64 * 64);
+
+  r.track_texture(100, rgba(4096, 4096));  // larger than the whole pool
+  r.release_texture(100);
+  EXPECT_EQ(r.take_deletions(), std::vector<uint32_t>{100});
+}
+
+TEST(GlResources, CountsMipmapsAndRespecifiedStorage) {
+  GlResources r;
+  r.track_texture(5, GlTextureFormat{300, 300, kR8, 1});
+  r.track_mipmaps(5);
+  r.track_mipmaps(5);
+  EXPECT_EQ(r.live_bytes(), 90000u + 30000u);
+  r.track_texture(5, GlTextureFormat{100, 100, kR8, 1});  // glTexImage2D drops the chain
+  EXPECT_EQ(r.live_bytes(), 10000u);
+  r.release_texture(5);
+  EXPECT_EQ(r.acquire_texture(GlTextureFormat{300, 300, kR8, 1}), 0u);
+  EXPECT_EQ(r.acquire_texture(GlTextureFormat{100, 100, kR8, 1}), 5u);
+}
+
+}  // namespace test
+}  // namespace openautoflutter
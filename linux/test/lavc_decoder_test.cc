@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "av/h264_decoder.h"
+
+namespace openautoflutter {
+namespace test {
+
+namespace {
+// Writes an RBSP bit by bit.
+class BitWriter {
+ public:
+  void u(int bits, uint32_t value) {
+    for (int i = bits - 1; i >= 0; --i) bits_.push_back((value >> i) & 1);
+  }
+  void ue(uint32_t value) {
+    const uint32_t code = value + 1;
+    int len = 0;
+    while ((code >> len) > 1) ++len;
+    u(len, 0);
+    u(len + 1, code);
+  }
+  void se(int32_t value) { ue(value > 0 ? 2 * value - 1 : -2 * value); }
+  void align() {
+    while (bits_.size() % 8) bits_.push_back(0);
+  }
+  void trailing() {
+    bits_.push_back(1);
+    align();
+  }
+  std::vector<uint8_t> bytes() const {
+    std::vector<uint8_t> out(bits_.size() / 8, 0);
+    for (size_t i = 0; i < bits_.size(); ++i) out[i / 8] |= bits_[i] << (7 - i % 8);
+    return out;
+  }
+
+ private:
+  std::vector<uint8_t> bits_;
+};
+
+// Start code, NAL header and RBSP with emulation prevention.
+void append_nal(std::vector<uint8_t>& out, uint8_t header, const BitWriter& rbsp) {
+  out.insert(out.end(), {0x00, 0x00, 0x00, 0x01, header});
+  int zeros = 0;
+  for (uint8_t b : rbsp.bytes()) {
+    if (zeros >= 2 && b <= 3) {
+      out.push_back(0x03);
+      zeros = 0;
+    }
+    out.push_back(b);
+    zeros = b == 0 ? zeros + 1 : 0;
+  }
+}
+
+// Baseline SPS + PPS + an IDR of one row of `mb_width` grey I_PCM macroblocks,
+// i.e. a (16 * mb_width)x16 keyframe that needs no real encoder.
+std::vector<uint8_t> pcm_keyframe(uint32_t mb_width) {
+  std::vector<uint8_t> au;
+  BitWriter sps;
+  sps.u(8, 66);  // profile_idc: Baseline
+  sps.u(8, 0);
+  sps.u(8, 40);  // level_idc
+  sps.ue(0);     // seq_parameter_set_id
+  sps.ue(0);     // log2_max_frame_num_minus4
+  sps.ue(2);     // pic_order_cnt_type
+  sps.ue(0);     // max_num_ref_frames
+  sps.u(1, 0);
+  sps.ue(mb_width - 1);
+  sps.ue(0);     // pic_height_in_map_units_minus1
+  sps.u(1, 1);   // frame_mbs_only_flag
+  sps.u(1, 1);   // direct_8x8_inference_flag
+  sps.u(1, 0);   // frame_cropping_flag
+  sps.u(1, 0);   // vui_parameters_present_flag
+  sps.trailing();
+  append_nal(au, 0x67, sps);
+
+  BitWriter pps;
+  pps.ue(0);     // pic_parameter_set_id
+  pps.ue(0);     // seq_parameter_set_id
+  pps.u(1, 0);   // CAVLC
+  pps.u(1, 0);
+  pps.ue(0);     // num_slice_groups_minus1
+  pps.ue(0);
+  pps.ue(0);
+  pps.u(1, 0);
+  pps.u(2, 0);
+  pps.se(0);     // pic_init_qp_minus26
+  pps.se(0);
+  pps.se(0);
+  pps.u(1, 1);   // deblocking_filter_control_present_flag
+  pps.u(1, 0);
+  pps.u(1, 0);
+  pps.trailing();
+  append_nal(au, 0x68, pps);
+
+  BitWriter idr;
+  idr.ue(0);     // first_mb_in_slice
+  idr.ue(7);     // slice_type: I
+  idr.ue(0);     // pic_parameter_set_id
+  idr.u(4, 0);   // frame_num
+  idr.ue(0);     // idr_pic_id
+  idr.u(1, 0);   // no_output_of_prior_pics_flag
+  idr.u(1, 0);   // long_term_reference_flag
+  idr.se(0);     // slice_qp_delta
+  idr.ue(1);     // disable_deblocking_filter_idc
+  for (uint32_t mb = 0; mb < mb_width; ++mb) {
+    idr.ue(25);  // mb_type: I_PCM
+    idr.align();
+    for (int i = 0; i < 384; ++i) idr.u(8, 0x80);
+  }
+  idr.trailing();
+  append_nal(au, 0x65, idr);
+  return au;
+}
+}  // namespace
+
+TEST(LavcDecoder, KeyframesOnlyRecoversFromRejectedFrame) {
+  H264Decoder decoder;
+  decoder.set_keyframes_only(true);
+  std::vector<uint8_t> yuv;
+  int width = 0, height = 0;
+
+  // 8208 pixels wide: decodes, then fails the size guard after the drain.
+  const std::vector<uint8_t> too_wide = pcm_keyframe(513);
+  EXPECT_FALSE(decoder.decode_to_yuv420p(too_wide.data(), too_wide.size(), yuv, width, height));
+  EXPECT_EQ(width, 8208);
+  EXPECT_FALSE(decoder.recovering());
+
+  // The codec left draining mode, so the next keyframe is accepted.
+  const std::vector<uint8_t> keyframe = pcm_keyframe(1);
+  ASSERT_TRUE(decoder.decode_to_yuv420p(keyframe.data(), keyframe.size(), yuv, width, height));
+  EXPECT_EQ(width, 16);
+  EXPECT_EQ(height, 16);
+  EXPECT_FALSE(decoder.recovering());
+}
+
+}  // namespace test
+}  // namespace openautoflutter
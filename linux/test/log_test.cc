@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/Log.hpp"
+
+namespace openautoflutter {
+namespace test {
+
+namespace {
+// Keeps the message part of each line ("... [tag] message").
+class CaptureSink : public oa_log::Sink {
+ public:
+  void write(oa_log::Level, const std::string& line) override {
+    const size_t tag_end = line.find("] ");
+    std::lock_guard<std::mutex> lk(mutex_);
+    lines_.push_back(tag_end == std::string::npos ? line : line.substr(tag_end + 2));
+  }
+
+  std::vector<std::string> lines() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return lines_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<std::string> lines_;
+};
+
+// Blocks the log thread in write() until released.
+class BlockingSink : public CaptureSink {
+ public:
+  void write(oa_log::Level level, const std::string& line) override {
+    std::unique_lock<std::mutex> lk(gate_mutex_);
+    entered_ = true;
+    gate_cv_.notify_all();
+    gate_cv_.wait(lk, [this]() { return released_; });
+    lk.unlock();
+    CaptureSink::write(level, line);
+  }
+
+  void wait_entered() {
+    std::unique_lock<std::mutex> lk(gate_mutex_);
+    gate_cv_.wait(lk, [this]() { return entered_; });
+  }
+
+  void release() {
+    std::lock_guard<std::mutex> lk(gate_mutex_);
+    released_ = true;
+    gate_cv_.notify_all();
+  }
+
+ private:
+  std::mutex gate_mutex_;
+  std::condition_variable gate_cv_;
+  bool entered_ = false;
+  bool released_ = false;
+};
+
+// Routes lines to `sink` for the duration of a test.
+struct ScopedSink {
+  explicit ScopedSink(std::shared_ptr<oa_log::Sink> sink) {
+    oa_log::flush();
+    oa_log::set_level(oa_log::Level::Info);
+    oa_log::set_sinks({std::move(sink)});
+  }
+  ~ScopedSink() {
+    oa_log::flush();
+    oa_log::set_sinks({std::make_shared<oa_log::ConsoleSink>()});
+  }
+};
+
+void gated(int i) { OA_LOG_FIRST_N(Info, 2, "LogTest", "gated {}", i); }
+}  // namespace
+
+TEST(Log, ProducersKeepTheirOrderAndLoseNothing) {
+  constexpr int kThreads = 4;
+  constexpr int kPerThread = 200;  // all fit in the ring at once
+  auto sink = std::make_shared<CaptureSink>();
+  ScopedSink scoped(sink);
+  const uint64_t dropped_before = oa_log::dropped();
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([t]() {
+      for (int i = 0; i < kPerThread; ++i) OA_LOG(Info, "LogTest", "{} {}", t, i);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  oa_log::flush();
+
+  EXPECT_EQ(oa_log::dropped(), dropped_before);
+  const std::vector<std::string> lines = sink->lines();
+  ASSERT_EQ(lines.size(), static_cast<size_t>(kThreads * kPerThread));
+  std::vector<int> next(kThreads, 0);
+  for (const std::string& line : lines) {
+    std::istringstream in(line);
+    int t = -1, i = -1;
+    in >> t >> i;
+    ASSERT_TRUE(t >= 0 && t < kThreads) << line;
+    EXPECT_EQ(i, next[t]) << line;
+    next[t] = i + 1;
+  }
+}
+
+TEST(Log, FullRingDropsAndReportsInsteadOfBlocking) {
+  constexpr int kBurst = 2000;  // more than the ring holds
+  auto sink = std::make_shared<BlockingSink>();
+  ScopedSink scoped(sink);
+  const uint64_t dropped_before = oa_log::dropped();
+
+  OA_LOG(Info, "LogTest", "stall");
+  sink->wait_entered();
+  for (int i = 0; i < kBurst; ++i) OA_LOG(Info, "LogTest", "burst {}", i);
+  const uint64_t dropped = oa_log::dropped() - dropped_before;
+  EXPECT_GT(dropped, 0u);
+  EXPECT_LT(dropped, static_cast<uint64_t>(kBurst));
+
+  sink->release();
+  const std::string report = "dropped " + std::to_string(dropped) + " messages (ring full)";  // after "[Log] "
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  std::vector<std::string> lines;
+  while (std::chrono::steady_clock::now() < deadline) {
+    oa_log::flush();
+    lines = sink->lines();
+    if (!lines.empty() && lines.back() == report) break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  // The oldest messages are kept, in order; the overflow is reported once.
+  ASSERT_EQ(lines.size(), 1 + (kBurst - dropped) + 1);
+  EXPECT_EQ(lines.front(), "stall");
+  for (size_t i = 1; i + 1 < lines.size(); ++i) EXPECT_EQ(lines[i], "burst " + std::to_string(i - 1));
+  EXPECT_EQ(lines.back(), report);
+}
+
+TEST(Log, BlockedSinkDoesNotHoldUpReconfiguration) {
+  auto blocked = std::make_shared<BlockingSink>();
+  ScopedSink scoped(blocked);
+  OA_LOG(Info, "LogTest", "stall");
+  blocked->wait_entered();
+
+  // The log thread is stuck in write(), as on a full journald pipe; swapping
+  // the sinks and reading the spec must not wait for it.
+  auto next = std::make_shared<CaptureSink>();
+  auto reconfigured = std::async(std::launch::async, [next]() {
+    oa_log::set_sinks({next});
+    return oa_log::sinks_spec();
+  });
+  const bool finished = reconfigured.wait_for(std::chrono::seconds(2)) == std::future_status::ready;
+  blocked->release();
+  EXPECT_TRUE(finished);
+
+  OA_LOG(Info, "LogTest", "after");
+  oa_log::flush();
+  EXPECT_EQ(blocked->lines(), std::vector<std::string>{"stall"});
+  EXPECT_EQ(next->lines(), std::vector<std::string>{"after"});
+}
+
+TEST(Log, LimitersGateEachCallSite) {
+  auto sink = std::make_shared<CaptureSink>();
+  ScopedSink scoped(sink);
+
+  for (int i = 0; i < 10; ++i) OA_LOG_FIRST_N(Info, 3, "LogTest", "first {}", i);
+  for (int i = 0; i < 10; ++i) OA_LOG_EVERY_N(Info, 4, "LogTest", "every {}", i);
+  for (int i = 0; i < 10; ++i) OA_LOG_FIRST_N_EVERY(Info, 2, 5, "LogTest", "first_every {}", i);
+  for (int i = 0; i < 10; ++i) OA_LOG_RATE(Info, 2, "LogTest", "rate {}", i);
+  // Hits below the level do not use up a limiter.
+  oa_log::set_level(oa_log::Level::Warn);
+  for (int i = 0; i < 5; ++i) gated(i);
+  oa_log::set_level(oa_log::Level::Info);
+  for (int i = 5; i < 10; ++i) gated(i);
+  oa_log::flush();
+
+  const std::vector<std::string> expected = {
+      "first 0", "first 1", "first 2",
+      "every 0", "every 4", "every 8",
+      "first_every 0", "first_every 1", "first_every 5",
+      "rate 0", "rate 1",
+      "gated 5", "gated 6",
+  };
+  EXPECT_EQ(sink->lines(), expected);
+}
+
+TEST(LogDeathTest, WritesSynchronouslyAfterShutdown) {
+  ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+  auto run = []() {
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 100;
+    auto sink = std::make_shared<CaptureSink>();
+    oa_log::set_sinks({sink});
+    OA_LOG(Info, "LogTest", "before");
+    oa_log::shutdown();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+      threads.emplace_back([t]() {
+        for (int i = 0; i < kPerThread; ++i) OA_LOG(Info, "LogTest", "{} {} {}", t, i, t * 1000 + i);
+      });
+    }
+    for (auto& thread : threads) thread.join();
+
+    // Every line is written at once, with its own arguments.
+    const std::vector<std::string> lines = sink->lines();
+    bool ok = lines.size() == 1 + kThreads * kPerThread && lines[0] == "before";
+    for (size_t n = 1; ok && n < lines.size(); ++n) {
+      std::istringstream in(lines[n]);
+      int t = -1, i = -1, both = -1;
+      in >> t >> i >> both;
+      ok = t >= 0 && t < kThreads && both == t * 1000 + i;
+    }
+    std::fprintf(stderr, "%zu lines %s\n", lines.size(), ok ? "intact" : "garbled");
+    std::exit(ok ? 0 : 1);
+  };
+  EXPECT_EXIT(run(), ::testing::ExitedWithCode(0), "401 lines intact");
+}
+
+}  // namespace test
+}  // namespace openautoflutter
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <thread>
+#include <unistd.h>
+
+#include "common/MemoryResidency.hpp"
+
+namespace openautoflutter {
+namespace test {
+
+namespace {
+// Restores the default policy when a test ends.
+struct ScopedPolicy {
+  explicit ScopedPolicy(const oa_memory::Policy& policy) { oa_memory::set_policy(policy); }
+  ~ScopedPolicy() { oa_memory::set_policy(oa_memory::Policy()); }
+};
+}  // namespace
+
+TEST(MemoryResidency, MapFlagsFollowPolicy) {
+  EXPECT_EQ(oa_memory::map_flags(), 0);
+  oa_memory::Policy policy;
+  policy.prefault = true;
+  ScopedPolicy scoped(policy);
+  EXPECT_EQ(oa_memory::map_flags(), MAP_POPULATE);
+}
+
+TEST(MemoryResidency, LargeBuffersAreHugepageAligned) {
+  oa_memory::Policy policy;
+  policy.hugepages = true;
+  ScopedPolicy scoped(policy);
+  void* large = oa_memory::alloc_buffer(3 * 1024 * 1024, 64);
+  void* small = oa_memory::alloc_buffer(4096, 64);
+  ASSERT_NE(large, nullptr);
+  ASSERT_NE(small, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(large) % oa_memory::kHugePage, 0u);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(small) % 64, 0u);
+  std::memset(large, 1, 3 * 1024 * 1024);
+  oa_memory::free_buffer(large);
+  oa_memory::free_buffer(small);
+}
+
+TEST(MemoryResidency, LocksWithinBudget) {
+  const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  rlimit limit{};
+  getrlimit(RLIMIT_MEMLOCK, &limit);
+  if (limit.rlim_cur != RLIM_INFINITY && limit.rlim_cur < 4 * page) GTEST_SKIP() << "RLIMIT_MEMLOCK too low";
+
+  oa_memory::Policy policy;
+  policy.lock_budget = 2 * page;
+  ScopedPolicy scoped(policy);
+  void* a = oa_memory::alloc_buffer(page, 64);
+  void* b = oa_memory::alloc_buffer(page - 100, 64);  // rounded up to a page
+  void* c = oa_memory::alloc_buffer(page, 64);        // over budget, left unlocked
+  ASSERT_TRUE(a && b && c);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % page, 0u);
+  EXPECT_EQ(oa_memory::locked_bytes(), 2 * page);
+  oa_memory::free_buffer(a);
+  EXPECT_EQ(oa_memory::locked_bytes(), page);
+  oa_memory::free_buffer(b);
+  oa_memory::free_buffer(c);
+  EXPECT_EQ(oa_memory::locked_bytes(), 0u);
+}
+
+TEST(MemoryResidency, CountsFaultsOfTheCallingThread) {
+  const size_t size = 1024 * 1024;
+  const uint64_t before = oa_memory::faults(oa_thread::Role::Metrics).minor;
+  std::thread([size]() {
+    oa_memory::count_faults(oa_thread::Role::Metrics);
+    void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ASSERT_NE(p, MAP_FAILED);
+    std::memset(p, 1, size);
+    oa_memory::count_faults(oa_thread::Role::Metrics);
+    munmap(p, size);
+  }).join();
+  EXPECT_GE(oa_memory::faults(oa_thread::Role::Metrics).minor - before, 16u);
+}
+
+}  // namespace test
+}  // namespace openautoflutter
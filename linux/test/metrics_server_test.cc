@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "av/latency_histogram.h"
+#include "av/metrics_server.h"
+
+namespace openautoflutter {
+namespace test {
+
+namespace {
+// Send `request` (may be empty) to the server and read until it closes.
+std::string fetch(const std::string& path, const std::string& request) {
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  std::snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path.c_str());
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+    close(fd);
+    return {};
+  }
+  if (!request.empty()) (void)send(fd, request.data(), request.size(), 0);
+  std::string out;
+  char buf[4096];
+  ssize_t n;
+  while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) out.append(buf, static_cast<size_t>(n));
+  close(fd);
+  return out;
+}
+}  // namespace
+
+TEST(LatencyHistogram, QuantilesInterpolateWithinBuckets) {
+  LatencyHistogram h;
+  for (int i = 0; i < 90; ++i) h.record(300);     // <= 500 us
+  for (int i = 0; i < 10; ++i) h.record(40000);   // 33..50 ms
+  const LatencyHistogram::Snapshot s = h.snapshot();
+  EXPECT_EQ(s.count, 100u);
+  EXPECT_EQ(s.sum_us, 90 * 300 + 10 * 40000);
+  EXPECT_LE(s.quantile(0.5), 500.0);
+  EXPECT_GT(s.quantile(0.99), 33000.0);
+  EXPECT_LE(s.quantile(0.99), 50000.0);
+  EXPECT_EQ(LatencyHistogram::Snapshot().quantile(0.5), 0.0);
+
+  const LatencyHistogram::Snapshot before = h.snapshot();
+  h.record(5000000);  // unbounded bucket reports its lower bound
+  const LatencyHistogram::Snapshot window = h.snapshot().since(before);
+  EXPECT_EQ(window.count, 1u);
+  EXPECT_EQ(window.quantile(0.5), 1000000.0);
+}
+
+TEST(MetricsWriter, GroupsSamplesUnderOneHeader) {
+  MetricsWriter w;
+  w.counter("oaf_test_total", "Test counter", 3, {{"stream", "0"}});
+  w.gauge("oaf_test_gauge", "Test gauge", 0.25);
+  w.counter("oaf_test_total", "Test counter", 5, {{"stream", "1\"x"}});
+  EXPECT_EQ(w.text(),
+            "# HELP oaf_test_total Test counter\n"
+            "# TYPE oaf_test_total counter\n"
+            "oaf_test_total{stream=\"0\"} 3\n"
+            "oaf_test_total{stream=\"1\\\"x\"} 5\n"
+            "# HELP oaf_test_gauge Test gauge\n"
+            "# TYPE oaf_test_gauge gauge\n"
+            "oaf_test_gauge 0.25\n");
+}
+
+TEST(MetricsWriter, LatencyQuantilesCoverTheLastScrape) {
+  std::map<std::string, LatencyHistogram::Snapshot> previous;
+  LatencyHistogram h;
+  for (int i = 0; i < 10; ++i) h.record(400);
+  {
+    MetricsWriter w(&previous);
+    w.latency("oaf_test_seconds", "Test latency", h);
+    const std::string text = w.text();
+    EXPECT_NE(text.find("# TYPE oaf_test_seconds summary"), std::string::npos);
+    EXPECT_NE(text.find("oaf_test_seconds_count 10\n"), std::string::npos);
+    EXPECT_EQ(text.find("NaN"), std::string::npos);
+  }
+  MetricsWriter w(&previous);
+  w.latency("oaf_test_seconds", "Test latency", h);
+  const std::string text = w.text();
+  EXPECT_NE(text.find("oaf_test_seconds{quantile=\"0.5\"} NaN\n"), std::string::npos);
+  EXPECT_NE(text.find("oaf_test_seconds_count 10\n"), std::string::npos);
+}
+
+TEST(MetricsServer, ServesHttpAndBareClients) {
+  const std::string path = "/tmp/oaf_metrics_test_" + std::to_string(getpid()) + ".sock";
+  const int id = add_metrics_collector([](MetricsWriter& w) { w.counter("oaf_test_scrape_total", "Test", 7); });
+  MetricsServer server;
+  ASSERT_TRUE(server.start(path));
+  EXPECT_FALSE(server.start(path));
+
+  const std::string http = fetch(path, "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  EXPECT_EQ(http.rfind("HTTP/1.0 200 OK\r\n", 0), 0u);
+  EXPECT_NE(http.find("\r\n\r\n# HELP"), std::string::npos);
+  EXPECT_NE(http.find("oaf_test_scrape_total 7\n"), std::string::npos);
+
+  EXPECT_EQ(fetch(path, "GET /nope HTTP/1.1\r\n\r\n").rfind("HTTP/1.0 404", 0), 0u);
+
+  const std::string bare = fetch(path, "");
+  EXPECT_EQ(bare.rfind("# HELP", 0), 0u);
+  EXPECT_NE(bare.find("oaf_test_scrape_total 7\n"), std::string::npos);
+  EXPECT_EQ(server.scrapes(), 2u);
+
+  remove_metrics_collector(id);
+  server.stop();
+  EXPECT_NE(access(path.c_str(), F_OK), 0);
+}
+
+}  // namespace test
+}  // namespace openautoflutter
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "av/frame_tap.h"
+#include "av/pipeline_stats.h"
+#include "include/openautoflutter/openautoflutter_ffi.h"
+#include "input/touch_sender.h"
+
+namespace openautoflutter {
+namespace test {
+
+TEST(OpenautoflutterFfi, TouchNeedsRegisteredSender) {
+  set_active_touch_sender(nullptr);
+  EXPECT_EQ(openautoflutter_send_touch(0, 0.5f, 0.5f, 0), 0);
+  EXPECT_EQ(openautoflutter_send_touch(0, 0.5f, 0.5f, 42), -1);
+  const OpenautoflutterTouch touch{0.5f, 0.5f, 0, 0};
+  EXPECT_EQ(openautoflutter_send_touch_batch(&touch, 1), -1);
+}
+
+TEST(OpenautoflutterFfi, BatchSkipsInvalidEntries) {
+  auto sender = std::make_shared<TouchSender>([](const TouchMessage&, uint64_t) { return true; });
+  set_active_touch_sender(sender);
+  const OpenautoflutterTouch touches[] = {
+    {0.1f, 0.1f, 1, 0},
+    {0.2f, 0.2f, 1, 7},
+    {0.3f, 0.3f, 1, 1},
+  };
+  EXPECT_EQ(openautoflutter_send_touch_batch(touches, 3), 2);
+  EXPECT_EQ(sender->stats().enqueued, 2u);
+  set_active_touch_sender(nullptr);
+}
+
+TEST(OpenautoflutterFfi, ReadStatsHonoursCallerSize) {
+  pipeline_stats().video_packets.store(5);
+  OpenautoflutterStats stats{};
+  EXPECT_EQ(openautoflutter_read_stats(&stats, sizeof(stats)), sizeof(stats));
+  EXPECT_EQ(stats.video_packets, 5u);
+
+  OpenautoflutterStats partial{};
+  partial.video_bytes = 99;
+  EXPECT_EQ(openautoflutter_read_stats(&partial, sizeof(uint64_t)), sizeof(uint64_t));
+  EXPECT_EQ(partial.video_bytes, 99u);
+}
+
+TEST(OpenautoflutterFfi, FrameTapByStreamId) {
+  EXPECT_EQ(openautoflutter_frame_tap_configure(77, 1, 16, 16, 0), 0);
+  EXPECT_EQ(openautoflutter_frame_tap_acquire(77, 0), nullptr);
+
+  auto tap = std::make_shared<FrameTap>(77);
+  register_frame_tap(tap);
+  EXPECT_EQ(openautoflutter_frame_tap_configure(77, 9, 16, 16, 0), -1);
+  EXPECT_EQ(openautoflutter_frame_tap_configure(77, 1, 16, 16, 0), 1);
+  const std::vector<uint8_t> frame(32 * 32 * 3 / 2, 50);
+  tap->offer(frame.data(), 32, 32, 1000);
+
+  const OpenautoflutterTapFrame* f = openautoflutter_frame_tap_acquire(77, 0);
+  ASSERT_NE(f, nullptr);
+  EXPECT_EQ(f->width, 16u);
+  EXPECT_EQ(f->stride, 16u);
+  EXPECT_EQ(f->data[0], 50);
+  openautoflutter_frame_tap_release(f);
+  unregister_frame_tap(*tap);
+}
+
+}  // namespace test
+}  // namespace openautoflutter
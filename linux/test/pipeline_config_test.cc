@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include "av/pipeline_config.h"
+
+namespace openautoflutter {
+namespace test {
+
+TEST(PipelineConfig, DefaultsMatchBuiltInValues) {
+  const PipelineConfig config;
+  EXPECT_EQ(config.pump_interval_ms, 16);
+  EXPECT_EQ(config.transport_wait_ms, 5000);
+  EXPECT_EQ(config.transport_poll_us, 1000);
+  EXPECT_EQ(config.shm_poll_ms, 10);
+  EXPECT_EQ(config.shm_video_size, static_cast<size_t>(1920 * 1080 * 3));
+  EXPECT_EQ(config.decoder.scaler, ScalerMode::Bilinear);
+  EXPECT_EQ(config.keyframe_request_type, -1);
+}
+
+TEST(PipelineConfig, SanitizeClampsOutOfRangeValues) {
+  PipelineConfig config;
+  config.pump_interval_ms = 0;
+  config.transport_wait_ms = 1000000;
+  config.transport_poll_us = -5;
+  config.reconnect_initial_ms = 500;
+  config.reconnect_max_ms = 100;
+  config.shm_video_size = 1;
+  config.decoder.threads = 99;
+  config.keyframe_request_type = -7;
+  config.worker.cpu_percent = -20;
+  config.memory.lock_budget = size_t{8} << 30;
+
+  const PipelineConfig clean = sanitize_pipeline_config(config);
+  EXPECT_EQ(clean.pump_interval_ms, 1);
+  EXPECT_EQ(clean.transport_wait_ms, 60000);
+  EXPECT_EQ(clean.transport_poll_us, 50);
+  EXPECT_EQ(clean.reconnect_max_ms, 500); // never below the initial backoff
+  EXPECT_EQ(clean.shm_video_size, static_cast<size_t>(64 * 1024));
+  EXPECT_EQ(clean.decoder.threads, 16);
+  EXPECT_EQ(clean.keyframe_request_type, -1);
+  EXPECT_EQ(clean.worker.cpu_percent, 0);
+  EXPECT_EQ(clean.memory.lock_budget, size_t{1} << 30);
+}
+
+TEST(PipelineConfig, ScalerNamesRoundTrip) {
+  for (ScalerMode mode : {ScalerMode::FastBilinear, ScalerMode::Bilinear, ScalerMode::Bicubic, ScalerMode::Point,
+                          ScalerMode::Area}) {
+    ScalerMode parsed = ScalerMode::Bilinear;
+    ASSERT_TRUE(parse_scaler(scaler_name(mode), parsed));
+    EXPECT_EQ(parsed, mode);
+  }
+  ScalerMode unchanged = ScalerMode::Area;
+  EXPECT_FALSE(parse_scaler("lanczos9", unchanged));
+  EXPECT_EQ(unchanged, ScalerMode::Area);
+}
+
+TEST(PipelineConfig, SetStoresSanitizedCopy) {
+  const PipelineConfig saved = pipeline_config();
+  PipelineConfig config;
+  config.pump_interval_ms = 5000;
+  set_pipeline_config(config);
+  EXPECT_EQ(pipeline_config().pump_interval_ms, 1000);
+  set_pipeline_config(saved);
+}
+
+}  // namespace test
+}  // namespace openautoflutter
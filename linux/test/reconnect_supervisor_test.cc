@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "common/ReconnectSupervisor.hpp"
+
+namespace openautoflutter {
+namespace test {
+
+namespace {
+using ms = std::chrono::milliseconds;
+
+bool wait_until(const std::function<bool()>& pred) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!pred() && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(ms(1));
+  }
+  return pred();
+}
+
+ReconnectSupervisor::Options fast_options() {
+  ReconnectSupervisor::Options options;
+  options.initial_backoff = ms(1);
+  options.max_backoff = ms(4);
+  options.health_interval = ms(1);
+  return options;
+}
+}  // namespace
+
+TEST(ReconnectSupervisor, BackoffDoublesUpToCap) {
+  ReconnectSupervisor::Options options;
+  options.initial_backoff = ms(100);
+  options.max_backoff = ms(1000);
+  EXPECT_EQ(ReconnectSupervisor::backoff_for(1, options), ms(100));
+  EXPECT_EQ(ReconnectSupervisor::backoff_for(2, options), ms(200));
+  EXPECT_EQ(ReconnectSupervisor::backoff_for(4, options), ms(800));
+  EXPECT_EQ(ReconnectSupervisor::backoff_for(5, options), ms(1000));
+  EXPECT_EQ(ReconnectSupervisor::backoff_for(100, options), ms(1000));
+}
+
+TEST(ReconnectSupervisor, RetriesUntilConnectedAndReconnectsAfterLoss) {
+  std::atomic<int> attempts{0};
+  std::atomic<bool> alive{false};
+  std::atomic<int> disconnects{0};
+  std::atomic<int> backoffs{0};
+  ReconnectSupervisor supervisor(
+      [&]() {
+        // Fail twice, then succeed on every later attempt.
+        if (++attempts <= 2) return false;
+        alive = true;
+        return true;
+      },
+      [&]() { return alive.load(); },
+      [&]() { ++disconnects; },
+      [&](const ReconnectSupervisor::Status& status) {
+        if (status.state == ReconnectSupervisor::State::Backoff) ++backoffs;
+      },
+      fast_options());
+  supervisor.start();
+
+  ASSERT_TRUE(wait_until([&]() { return supervisor.status().state == ReconnectSupervisor::State::Connected; }));
+  EXPECT_EQ(attempts.load(), 3);
+  EXPECT_EQ(backoffs.load(), 2);
+  EXPECT_EQ(supervisor.status().connects, 1u);
+
+  alive = false; // drop the link; the supervisor must connect again
+  ASSERT_TRUE(wait_until([&]() { return supervisor.status().connects == 2u; }));
+  EXPECT_GE(disconnects.load(), 1);
+
+  supervisor.stop();
+  EXPECT_EQ(supervisor.status().state, ReconnectSupervisor::State::Stopped);
+}
+
+TEST(ReconnectSupervisor, StopDoesNotWaitForBlockedConnect) {
+  auto release = std::make_shared<std::atomic<bool>>(false);
+  auto entered = std::make_shared<std::atomic<bool>>(false);
+  auto disconnected = std::make_shared<std::atomic<bool>>(false);
+  {
+    ReconnectSupervisor supervisor(
+        [release, entered]() {
+          *entered = true;
+          while (!*release) std::this_thread::sleep_for(ms(1));
+          return true;
+        },
+        []() { return true; },
+        [disconnected]() { *disconnected = true; },
+        nullptr, fast_options());
+    supervisor.start();
+    ASSERT_TRUE(wait_until([&]() { return entered->load(); }));
+
+    const auto begin = std::chrono::steady_clock::now();
+    supervisor.stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - begin, ms(500));
+  }
+  // The detached thread tears down the link it finished connecting.
+  *release = true;
+  EXPECT_TRUE(wait_until([&]() { return disconnected->load(); }));
+}
+
+}  // namespace test
+}  // namespace openautoflutter
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "common/SharedMemoryConsumer.hpp"
+#include "common/SharedMemoryProducer.hpp"
+
+namespace openautoflutter {
+namespace test {
+
+TEST(SharedMemoryIpc, ProducerFramesAreSeenByConsumer) {
+  const std::string tag = std::to_string(getpid());
+  const std::string shm_name = "/oaf_test_shm_" + tag;
+  const std::string sem_name = "/oaf_test_sem_" + tag;
+  const size_t shm_size = 4096;
+
+  SharedMemoryProducer producer(shm_name, sem_name, shm_size);
+  ASSERT_TRUE(producer.open());
+  EXPECT_EQ(producer.capacity(), shm_size - SharedMemoryProducer::kHeaderSize);
+
+  std::vector<unsigned char> too_big(producer.capacity() + 1);
+  EXPECT_FALSE(producer.publish(0, too_big.data(), too_big.size()));
+
+  std::atomic<uint64_t> seen_ts{0};
+  std::atomic<uint32_t> seen_size{0};
+  std::atomic<bool> payload_ok{false};
+  const unsigned char payload[] = {0x00, 0x00, 0x00, 0x01, 0x65, 0x88};
+
+  SharedMemoryConsumer consumer(shm_name, sem_name, shm_size,
+      [&](const unsigned char* buffer, size_t size) {
+        ASSERT_EQ(size, shm_size);
+        uint64_t ts = 0;
+        uint32_t declared = 0;
+        std::memcpy(&ts, buffer, sizeof(ts));
+        std::memcpy(&declared, buffer + sizeof(ts), sizeof(declared));
+        payload_ok = declared == sizeof(payload) &&
+                     std::memcmp(buffer + SharedMemoryProducer::kHeaderSize, payload, sizeof(payload)) == 0;
+        seen_size = declared;
+        seen_ts = ts;
+      },
+      5);
+  std::thread consumer_thread([&consumer]() { consumer.run(); });
+
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (seen_ts.load() != 42 && std::chrono::steady_clock::now() < deadline) {
+    ASSERT_TRUE(producer.publish(42, payload, sizeof(payload)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  consumer.stop();
+  consumer_thread.join();
+
+  EXPECT_EQ(seen_ts.load(), 42u);
+  EXPECT_EQ(seen_size.load(), sizeof(payload));
+  EXPECT_TRUE(payload_ok.load());
+}
+
+}  // namespace test
+}  // namespace openautoflutter
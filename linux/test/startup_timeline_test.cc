@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include "av/startup_timeline.h"
+
+namespace openautoflutter {
+namespace test {
+
+TEST(StartupTimeline, KeepsFirstOccurrence) {
+  StartupTimeline timeline;
+  EXPECT_EQ(timeline.at(Milestone::FirstVideoPacket), 0);
+  timeline.mark(Milestone::PluginRegistered, 1000);
+  timeline.mark(Milestone::FirstVideoPacket, 5000);
+  timeline.mark(Milestone::FirstVideoPacket, 9000);
+  EXPECT_EQ(timeline.at(Milestone::PluginRegistered), 1000);
+  EXPECT_EQ(timeline.at(Milestone::FirstVideoPacket), 5000);
+  EXPECT_STREQ(milestone_name(Milestone::FirstFramePopulated), "firstFramePopulated");
+
+  timeline.reset();
+  EXPECT_EQ(timeline.at(Milestone::FirstVideoPacket), 0);
+}
+
+TEST(StartupTimeline, MeasuresEveryConnectToFirstFrame) {
+  StartupTimeline timeline;
+  EXPECT_EQ(timeline.last_connect_to_frame_us(), -1);
+
+  timeline.mark_connected(10000);
+  timeline.mark_populated(40000);
+  timeline.mark_populated(50000); // later frames do not count
+  EXPECT_EQ(timeline.at(Milestone::TransportConnected), 10000);
+  EXPECT_EQ(timeline.at(Milestone::FirstFramePopulated), 40000);
+  EXPECT_EQ(timeline.last_connect_to_frame_us(), 30000);
+
+  // Reconnect: the cold-start milestones stay, the warm-start clock restarts.
+  timeline.mark_connected(100000);
+  timeline.mark_populated(112000);
+  EXPECT_EQ(timeline.at(Milestone::TransportConnected), 10000);
+  EXPECT_EQ(timeline.at(Milestone::FirstFramePopulated), 40000);
+  EXPECT_EQ(timeline.last_connect_to_frame_us(), 12000);
+}
+
+TEST(StartupTimeline, FrameBeforeConnectIsNotAWarmStart) {
+  StartupTimeline timeline;
+  timeline.mark_populated(2000); // e.g. replay before any transport
+  EXPECT_EQ(timeline.at(Milestone::FirstFramePopulated), 2000);
+  EXPECT_EQ(timeline.last_connect_to_frame_us(), -1);
+}
+
+}  // namespace test
+}  // namespace openautoflutter
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include "av/texture_visibility.h"
+
+namespace openautoflutter {
+namespace test {
+
+namespace {
+constexpr int64_t kPrimary = 1;
+constexpr int64_t kView = 2;
+constexpr int64_t kOtherView = 3;
+
+// What VideoStream does with the result: each flip toggles the decoder's
+// keyframes-only mode.
+struct Stream {
+  TextureVisibility visibility;
+  bool keyframes_only = false;
+  int toggles = 0;
+
+  void follow(bool flipped) {
+    if (!flipped) return;
+    keyframes_only = !visibility.visible();
+    ++toggles;
+  }
+  void add(int64_t id) { follow(visibility.add(id)); }
+  void set(int64_t id, bool visible) { follow(visibility.set(id, visible)); }
+  void remove(int64_t id) { follow(visibility.remove(id)); }
+};
+}  // namespace
+
+TEST(TextureVisibility, HiddenOnlyWhenEveryTextureIs) {
+  Stream s;
+  EXPECT_TRUE(s.visibility.visible());  // no textures yet
+  s.add(kPrimary);
+  s.add(kView);
+
+  s.set(kPrimary, false);
+  EXPECT_TRUE(s.visibility.visible());
+  EXPECT_FALSE(s.keyframes_only);
+  s.set(kView, false);
+  EXPECT_FALSE(s.visibility.visible());
+  EXPECT_TRUE(s.keyframes_only);
+  s.set(kView, false);  // repeated reports change nothing
+  EXPECT_EQ(s.toggles, 1);
+
+  s.set(kView, true);
+  EXPECT_TRUE(s.visibility.visible());
+  EXPECT_FALSE(s.keyframes_only);
+  EXPECT_EQ(s.toggles, 2);
+}
+
+TEST(TextureVisibility, UnknownTexturesChangeNothing) {
+  Stream s;
+  s.add(kPrimary);
+  EXPECT_FALSE(s.visibility.known(kView));
+  s.set(kView, false);
+  s.set(kView, true);
+  EXPECT_TRUE(s.visibility.visible());
+  s.set(kPrimary, false);
+  EXPECT_FALSE(s.visibility.visible());
+  s.set(kView, true);  // still unknown
+  EXPECT_FALSE(s.visibility.visible());
+  EXPECT_EQ(s.toggles, 1);
+}
+
+TEST(TextureVisibility, RemovingViews) {
+  Stream s;
+  s.add(kPrimary);
+  s.add(kView);
+  s.add(kOtherView);
+  s.set(kPrimary, false);
+  s.set(kView, false);
+  EXPECT_TRUE(s.visibility.visible());
+
+  // The only visible view goes away: the stream is hidden now.
+  s.remove(kOtherView);
+  EXPECT_FALSE(s.visibility.visible());
+  EXPECT_TRUE(s.keyframes_only);
+
+  // A hidden view goes away while the stream is hidden: still hidden, and
+  // its hidden state does not linger.
+  s.remove(kView);
+  EXPECT_FALSE(s.visibility.visible());
+  EXPECT_TRUE(s.keyframes_only);
+  EXPECT_EQ(s.toggles, 1);
+  // A new view, even with a reused id, starts visible and resumes decoding.
+  s.add(kView);
+  EXPECT_TRUE(s.visibility.visible());
+  EXPECT_FALSE(s.keyframes_only);
+  s.remove(kView);
+  EXPECT_FALSE(s.visibility.visible());
+  EXPECT_TRUE(s.keyframes_only);
+
+  s.set(kPrimary, true);
+  EXPECT_TRUE(s.visibility.visible());
+  EXPECT_FALSE(s.keyframes_only);
+}
+
+}  // namespace test
+}  // namespace openautoflutter
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "common/ThreadPolicy.hpp"
+
+namespace openautoflutter {
+namespace test {
+
+using oa_thread::Policy;
+using oa_thread::Role;
+using oa_thread::Sched;
+
+TEST(ThreadPolicy, ParsesSpec) {
+  std::vector<std::pair<Role, Policy>> parsed;
+  ASSERT_TRUE(oa_thread::parse_spec("decode:cpus=2-3+5,sched=fifo,prio=10; touch:nice=-5", parsed));
+  ASSERT_EQ(parsed.size(), 2u);
+  EXPECT_EQ(parsed[0].first, Role::Decode);
+  EXPECT_EQ(parsed[0].second.cpus, (std::vector<int>{2, 3, 5}));
+  EXPECT_EQ(parsed[0].second.sched, Sched::Fifo);
+  EXPECT_EQ(parsed[0].second.priority, 10);
+  EXPECT_EQ(parsed[1].first, Role::Touch);
+  EXPECT_TRUE(parsed[1].second.has_nice);
+  EXPECT_EQ(parsed[1].second.nice, -5);
+
+  EXPECT_FALSE(oa_thread::parse_spec("decoder:nice=1", parsed));
+  EXPECT_FALSE(oa_thread::parse_spec("decode:prio=100", parsed));
+  EXPECT_FALSE(oa_thread::parse_spec("decode:cpus=3-1", parsed));
+  EXPECT_FALSE(oa_thread::set_spec("touch:sched=idle"));
+}
+
+TEST(ThreadPolicy, RefreshAppliesAffinityOnPolicyChange) {
+  std::thread worker([]() {
+    ASSERT_TRUE(oa_thread::set_spec("decode:cpus=0"));
+    oa_thread::refresh(Role::Decode, "oa-test-decode");
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    ASSERT_EQ(pthread_getaffinity_np(pthread_self(), sizeof(set), &set), 0);
+    EXPECT_EQ(CPU_COUNT(&set), 1);
+    EXPECT_TRUE(CPU_ISSET(0, &set));
+
+    char name[16] = {};
+    pthread_getname_np(pthread_self(), name, sizeof(name));
+    EXPECT_STREQ(name, "oa-test-decode");
+
+    // Back to defaults: the mask is undone on the next refresh.
+    ASSERT_TRUE(oa_thread::set_spec(""));
+    oa_thread::refresh(Role::Decode, "oa-test-decode");
+    CPU_ZERO(&set);
+    ASSERT_EQ(pthread_getaffinity_np(pthread_self(), sizeof(set), &set), 0);
+    if (sysconf(_SC_NPROCESSORS_ONLN) > 1) {
+      EXPECT_GT(CPU_COUNT(&set), 1);
+    }
+  });
+  worker.join();
+}
+
+TEST(ThreadPolicy, RealtimeFallsBackWithoutPrivileges) {
+  std::thread worker([]() {
+    Policy policy;
+    policy.sched = Sched::Rr;
+    policy.priority = 5;
+    const oa_thread::Applied applied = oa_thread::apply_current(policy);
+    // Either we may use SCHED_RR, or the refusal is reported as a fallback.
+    EXPECT_NE(applied.realtime, applied.fell_back);
+  });
+  worker.join();
+}
+
+TEST(ThreadPolicyDeathTest, RefusedRealtimeFallsBackToAllowedNice) {
+  ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+  auto run = []() {
+    // Unprivileged, with no real-time budget. Nice may go down to -2 where
+    // the hard limit allows it (raising it needs CAP_SYS_RESOURCE).
+    rlimit nice_limit{};
+    const rlimit no_rt{0, 0};
+    if (getrlimit(RLIMIT_NICE, &nice_limit) != 0) std::exit(2);
+    nice_limit.rlim_cur = std::min<rlim_t>(nice_limit.rlim_max, 22);
+    if (setrlimit(RLIMIT_NICE, &nice_limit) != 0 || setrlimit(RLIMIT_RTPRIO, &no_rt) != 0) std::exit(2);
+    if (geteuid() == 0 && (setgid(65534) != 0 || setuid(65534) != 0)) std::exit(2);
+    errno = 0;
+    const int base = getpriority(PRIO_PROCESS, 0);
+    if (errno != 0) std::exit(2);
+    const int expected = std::min(base, std::max(-5, 20 - static_cast<int>(nice_limit.rlim_cur)));
+    bool ok = false;
+    std::thread worker([&ok, expected]() {
+      Policy policy;
+      policy.sched = Sched::Fifo;
+      policy.priority = 5;
+      const oa_thread::Applied applied = oa_thread::apply_current(policy);
+      const int nice = getpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)));
+      std::fprintf(stderr, "realtime=%d fell_back=%d nice=%d/%d\n", applied.realtime, applied.fell_back,
+                   applied.nice_value, nice);
+      ok = !applied.realtime && applied.fell_back && applied.nice && applied.nice_value == expected &&
+           nice == expected;
+    });
+    worker.join();
+    std::exit(ok ? 0 : 1);
+  };
+  EXPECT_EXIT(run(), ::testing::ExitedWithCode(0), "realtime=0 fell_back=1");
+}
+
+}  // namespace test
+}  // namespace openautoflutter
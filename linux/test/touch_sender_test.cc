@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <vector>
+
+#include "input/touch_sender.h"
+
+namespace openautoflutter {
+namespace test {
+
+namespace {
+PendingTouch touch(TouchAction action, uint32_t pointer, float x, float y, uint64_t ts = 0) {
+  return PendingTouch{TouchMessage{x, y, pointer, static_cast<uint32_t>(action)}, ts};
+}
+}  // namespace
+
+TEST(TouchSender, CoalescesTrailingMovesPerPointer) {
+  std::vector<PendingTouch> pending;
+  EXPECT_FALSE(TouchSender::append_coalesced(pending, touch(TouchAction::DOWN, 1, 0.1f, 0.1f)));
+  EXPECT_FALSE(TouchSender::append_coalesced(pending, touch(TouchAction::MOVED, 1, 0.2f, 0.2f, 1)));
+  EXPECT_FALSE(TouchSender::append_coalesced(pending, touch(TouchAction::MOVED, 2, 0.5f, 0.5f, 2)));
+  EXPECT_TRUE(TouchSender::append_coalesced(pending, touch(TouchAction::MOVED, 1, 0.3f, 0.4f, 3)));
+
+  ASSERT_EQ(pending.size(), 3u);
+  EXPECT_EQ(pending[1].msg.pointer_id, 1u);
+  EXPECT_FLOAT_EQ(pending[1].msg.x, 0.3f);
+  EXPECT_FLOAT_EQ(pending[1].msg.y, 0.4f);
+  EXPECT_EQ(pending[1].ts_us, 3u);
+}
+
+TEST(TouchSender, NeverMergesAcrossDownOrUp) {
+  std::vector<PendingTouch> pending;
+  TouchSender::append_coalesced(pending, touch(TouchAction::MOVED, 1, 0.2f, 0.2f));
+  TouchSender::append_coalesced(pending, touch(TouchAction::POINTER_DOWN, 2, 0.5f, 0.5f));
+  EXPECT_FALSE(TouchSender::append_coalesced(pending, touch(TouchAction::MOVED, 1, 0.3f, 0.3f)));
+  EXPECT_FALSE(TouchSender::append_coalesced(pending, touch(TouchAction::UP, 1, 0.3f, 0.3f)));
+  EXPECT_EQ(pending.size(), 4u);
+}
+
+TEST(TouchSender, SanitizeRejectsBadInput) {
+  TouchMessage ok{1.5f, -0.5f, 0, static_cast<uint32_t>(TouchAction::MOVED)};
+  EXPECT_TRUE(sanitize_touch(ok));
+  EXPECT_FLOAT_EQ(ok.x, 1.0f);
+  EXPECT_FLOAT_EQ(ok.y, 0.0f);
+
+  TouchMessage bad_action{0.5f, 0.5f, 0, 9};
+  EXPECT_FALSE(sanitize_touch(bad_action));
+  TouchMessage nan{std::nanf(""), 0.5f, 0, 0};
+  EXPECT_FALSE(sanitize_touch(nan));
+}
+
+TEST(TouchSender, SendsInOrderOnStop) {
+  std::mutex mutex;
+  std::vector<TouchMessage> sent;
+  TouchSender sender([&](const TouchMessage& msg, uint64_t) {
+    std::lock_guard<std::mutex> lk(mutex);
+    sent.push_back(msg);
+    return true;
+  }, std::chrono::milliseconds(50));
+  sender.start();
+
+  const TouchMessage batch[] = {
+    {0.1f, 0.1f, 1, static_cast<uint32_t>(TouchAction::DOWN)},
+    {0.2f, 0.2f, 1, static_cast<uint32_t>(TouchAction::MOVED)},
+    {0.3f, 0.3f, 1, static_cast<uint32_t>(TouchAction::MOVED)},
+    {0.4f, 0.4f, 1, static_cast<uint32_t>(TouchAction::MOVED)},
+  };
+  sender.enqueue(batch, 4);
+  sender.stop();
+
+  const TouchSender::Stats stats = sender.stats();
+  EXPECT_EQ(stats.enqueued, 4u);
+  EXPECT_EQ(stats.coalesced + stats.sent, 4u);
+  ASSERT_FALSE(sent.empty());
+  EXPECT_EQ(sent.front().action, static_cast<uint32_t>(TouchAction::DOWN));
+  EXPECT_FLOAT_EQ(sent.back().x, 0.4f);
+}
+
+TEST(TouchSender, MapsTouchesIntoRegion) {
+  std::vector<TouchMessage> sent;
+  TouchSender sender([&](const TouchMessage& msg, uint64_t) {
+    sent.push_back(msg);
+    return true;
+  });
+  sender.set_region(0.25f, 0.1f, 0.5f, 0.8f);
+  sender.enqueue(TouchMessage{0.0f, 0.0f, 1, static_cast<uint32_t>(TouchAction::DOWN)});
+  sender.enqueue(TouchMessage{1.0f, 0.5f, 1, static_cast<uint32_t>(TouchAction::UP)});
+  sender.set_region(0.0f, 0.0f, 0.0f, 0.0f); // invalid: back to the whole screen
+  sender.enqueue(TouchMessage{0.5f, 0.5f, 1, static_cast<uint32_t>(TouchAction::DOWN)});
+  sender.start();
+  sender.stop();
+
+  ASSERT_EQ(sent.size(), 3u);
+  EXPECT_FLOAT_EQ(sent[0].x, 0.25f);
+  EXPECT_FLOAT_EQ(sent[0].y, 0.1f);
+  EXPECT_FLOAT_EQ(sent[1].x, 0.75f);
+  EXPECT_FLOAT_EQ(sent[1].y, 0.5f);
+  EXPECT_FLOAT_EQ(sent[2].x, 0.5f);
+  EXPECT_FLOAT_EQ(sent[2].y, 0.5f);
+}
+
+}  // namespace test
+}  // namespace openautoflutter
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "av/video_capture.h"
+
+namespace openautoflutter {
+namespace test {
+
+namespace {
+std::string temp_capture_path(const char* name) {
+  return "/tmp/oaf_" + std::string(name) + "_" + std::to_string(getpid()) + ".oavcap";
+}
+}  // namespace
+
+TEST(VideoCapture, RoundTripUsesFooterIndex) {
+  const std::string path = temp_capture_path("roundtrip");
+  const std::vector<uint8_t> a = {0x00, 0x00, 0x00, 0x01, 0x67};
+  const std::vector<uint8_t> b(1000, 0x42);
+  {
+    VideoCaptureWriter writer;
+    ASSERT_TRUE(writer.open(path));
+    ASSERT_TRUE(writer.append(10, 1000, a.data(), a.size()));
+    ASSERT_TRUE(writer.append(20, 2000, b.data(), b.size()));
+    EXPECT_EQ(writer.record_count(), 2u);
+    writer.close();
+  }
+
+  VideoCaptureReader reader;
+  ASSERT_TRUE(reader.open(path));
+  EXPECT_TRUE(reader.indexed());
+  ASSERT_EQ(reader.size(), 2u);
+  VideoCaptureReader::Record rec;
+  ASSERT_TRUE(reader.record(1, rec));
+  EXPECT_EQ(rec.transport_ts, 20u);
+  EXPECT_EQ(rec.recv_us, 2000u);
+  ASSERT_EQ(rec.size, b.size());
+  EXPECT_EQ(std::vector<uint8_t>(rec.data, rec.data + rec.size), b);
+  EXPECT_FALSE(reader.record(2, rec));
+  std::remove(path.c_str());
+}
+
+TEST(VideoCapture, UnclosedCaptureIsRecoveredByScan) {
+  const std::string path = temp_capture_path("recover");
+  const std::vector<uint8_t> payload(37, 0x11);
+  off_t cut = 0;
+  {
+    VideoCaptureWriter writer;
+    ASSERT_TRUE(writer.open(path));
+    ASSERT_TRUE(writer.append(1, 100, payload.data(), payload.size()));
+    ASSERT_TRUE(writer.append(2, 200, payload.data(), payload.size()));
+    writer.close();
+    // Drop the footer and half of the second record, as after a crash.
+    cut = static_cast<off_t>(sizeof(oa_capture::FileHeader) + 2 * sizeof(oa_capture::RecordHeader) + 40 + 10);
+  }
+  ASSERT_EQ(truncate(path.c_str(), cut), 0);
+
+  VideoCaptureReader reader;
+  ASSERT_TRUE(reader.open(path));
+  EXPECT_FALSE(reader.indexed());
+  EXPECT_EQ(reader.size(), 1u);
+  std::remove(path.c_str());
+}
+
+TEST(VideoCapture, FullQueueDropsInsteadOfBlocking) {
+  // A FIFO nobody drains yet stalls the writer thread in its first write.
+  const std::string path = temp_capture_path("stalled");
+  ASSERT_EQ(mkfifo(path.c_str(), 0600), 0);
+  const int drain = ::open(path.c_str(), O_RDONLY | O_NONBLOCK);
+  ASSERT_NE(drain, -1);
+  constexpr size_t kRecord = 1024 * 1024;
+  constexpr uint64_t kAppends = VideoCaptureWriter::kMaxQueuedBytes / kRecord + 16;
+  const std::vector<uint8_t> payload(kRecord, 0x5a);
+
+  VideoCaptureWriter writer;
+  ASSERT_TRUE(writer.open(path));
+  for (uint64_t i = 0; i < kAppends; ++i) writer.append(i, i, payload.data(), payload.size());
+  const uint64_t accepted = writer.record_count();
+  EXPECT_GE(writer.dropped(), 15u);
+  EXPECT_EQ(accepted + writer.dropped(), kAppends);
+
+  // Once the disk catches up every accepted record is written, then the index.
+  ASSERT_EQ(fcntl(drain, F_SETFL, 0), 0);
+  size_t total = 0;
+  std::thread reader([drain, &total]() {
+    std::vector<uint8_t> buf(1 << 16);
+    ssize_t n;
+    while ((n = read(drain, buf.data(), buf.size())) > 0) total += static_cast<size_t>(n);
+  });
+  writer.close();
+  reader.join();
+  ::close(drain);
+  EXPECT_EQ(writer.record_count(), accepted);
+  EXPECT_EQ(total, sizeof(oa_capture::FileHeader) + accepted * (sizeof(oa_capture::RecordHeader) + kRecord) +
+                       accepted * sizeof(uint64_t) + sizeof(oa_capture::IndexFooter));
+  std::remove(path.c_str());
+}
+
+TEST(VideoCapture, ReplayDeliversAllPacketsInOrder) {
+  const std::string path = temp_capture_path("replay");
+  {
+    VideoCaptureWriter writer;
+    ASSERT_TRUE(writer.open(path));
+    for (uint8_t i = 1; i <= 5; ++i) {
+      ASSERT_TRUE(writer.append(i, i * 1000u, &i, 1));
+    }
+  }
+
+  std::vector<uint64_t> seen;
+  VideoReplaySource replay;
+  ASSERT_TRUE(replay.start(path,
+      [&seen](uint64_t ts, const uint8_t* data, size_t size) {
+        ASSERT_EQ(size, 1u);
+        EXPECT_EQ(data[0], ts);
+        seen.push_back(ts);
+      },
+      /*realtime=*/false, /*loop=*/false));
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (replay.is_running() && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  replay.stop();
+  EXPECT_EQ(seen, (std::vector<uint64_t>{1, 2, 3, 4, 5}));
+  std::remove(path.c_str());
+}
+
+}  // namespace test
+}  // namespace openautoflutter
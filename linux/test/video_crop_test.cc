@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include "av/video_crop.h"
+
+namespace openautoflutter {
+namespace test {
+
+namespace {
+VideoCrop crop(int x, int y, int w, int h) {
+  VideoCrop c;
+  c.x = x;
+  c.y = y;
+  c.width = w;
+  c.height = h;
+  return c;
+}
+}  // namespace
+
+TEST(VideoCrop, EmptyOrOutsideShowsWholeFrame) {
+  EXPECT_EQ(effective_crop(VideoCrop(), 800, 480), crop(0, 0, 800, 480));
+  EXPECT_EQ(effective_crop(crop(900, 0, 100, 100), 800, 480), crop(0, 0, 800, 480));
+  EXPECT_EQ(effective_crop(crop(10, 10, 0, 100), 800, 480), crop(0, 0, 800, 480));
+}
+
+TEST(VideoCrop, ClampsAndAlignsOriginForChroma) {
+  // Odd origin moves down to even; the right/bottom edges stay.
+  EXPECT_EQ(effective_crop(crop(33, 21, 100, 50), 800, 480), crop(32, 20, 101, 51));
+  // Letterbox margins past the frame are clipped.
+  EXPECT_EQ(effective_crop(crop(80, 0, 1000, 1000), 800, 480), crop(80, 0, 720, 480));
+  EXPECT_EQ(effective_crop(crop(0, 0, 2147483647, 2147483647), 800, 480), crop(0, 0, 800, 480));
+}
+
+TEST(VideoCrop, RegionIsFractionOfFrame) {
+  const CropRegion full = crop_region(VideoCrop(), 800, 480);
+  EXPECT_FLOAT_EQ(full.x, 0.0f);
+  EXPECT_FLOAT_EQ(full.width, 1.0f);
+
+  const CropRegion r = crop_region(crop(160, 48, 640, 384), 800, 480);
+  EXPECT_FLOAT_EQ(r.x, 0.2f);
+  EXPECT_FLOAT_EQ(r.y, 0.1f);
+  EXPECT_FLOAT_EQ(r.width, 0.8f);
+  EXPECT_FLOAT_EQ(r.height, 0.8f);
+
+  // Unknown frame size: nothing to map yet.
+  EXPECT_EQ(crop_region(crop(160, 48, 640, 384), 0, 0), CropRegion());
+}
+
+}  // namespace test
+}  // namespace openautoflutter
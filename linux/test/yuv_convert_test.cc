@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "av/yuv_convert.h"
+
+namespace openautoflutter {
+namespace test {
+
+namespace {
+std::vector<uint8_t> random_i420(int width, int height, uint32_t seed) {
+  const size_t uv = static_cast<size_t>((width + 1) / 2) * ((height + 1) / 2);
+  std::vector<uint8_t> yuv(static_cast<size_t>(width) * height + uv * 2);
+  std::mt19937 rng(seed);
+  for (auto& b : yuv) b = static_cast<uint8_t>(rng());
+  return yuv;
+}
+
+std::vector<uint8_t> convert_pixel(uint8_t y, uint8_t u, uint8_t v, YuvColorSpace cs) {
+  const uint8_t yuv[3] = {y, u, v};
+  std::vector<uint8_t> rgba(4);
+  i420_to_rgba(yuv, 1, 1, rgba.data(), 4, cs);
+  return rgba;
+}
+}  // namespace
+
+TEST(YuvConvert, SimdMatchesScalarForAnySize) {
+  const YuvColorSpace spaces[] = {
+    {YuvMatrix::Bt601, false}, {YuvMatrix::Bt709, false}, {YuvMatrix::Bt601, true}, {YuvMatrix::Bt709, true}};
+  for (int width : {1, 2, 15, 16, 17, 31, 64, 97}) {
+    for (int height : {1, 2, 3, 8}) {
+      const auto yuv = random_i420(width, height, static_cast<uint32_t>(width * 131 + height));
+      for (const auto& cs : spaces) {
+        // Padded stride: rows must not spill into each other.
+        const size_t stride = static_cast<size_t>(width) * 4 + 12;
+        std::vector<uint8_t> simd(stride * height, 0xAB);
+        std::vector<uint8_t> scalar(stride * height, 0xAB);
+        i420_to_rgba(yuv.data(), width, height, simd.data(), stride, cs);
+        i420_to_rgba_scalar(yuv.data(), width, height, scalar.data(), stride, cs);
+        ASSERT_EQ(simd, scalar) << i420_to_rgba_impl() << " " << width << "x" << height;
+        EXPECT_EQ(simd[width * 4], 0xAB);
+      }
+    }
+  }
+}
+
+TEST(YuvConvert, LimitedRangeReferenceColours) {
+  const YuvColorSpace bt601{YuvMatrix::Bt601, false};
+  EXPECT_EQ(convert_pixel(16, 128, 128, bt601), (std::vector<uint8_t>{0, 0, 0, 255}));
+  EXPECT_EQ(convert_pixel(235, 128, 128, bt601), (std::vector<uint8_t>{255, 255, 255, 255}));
+
+  // 75% colour bars, BT.601 and BT.709 code values.
+  const auto red601 = convert_pixel(65, 100, 212, bt601);
+  EXPECT_NEAR(red601[0], 191, 2);
+  EXPECT_NEAR(red601[1], 0, 2);
+  EXPECT_NEAR(red601[2], 0, 2);
+  const auto red709 = convert_pixel(51, 109, 212, YuvColorSpace{YuvMatrix::Bt709, false});
+  EXPECT_NEAR(red709[0], 191, 2);
+  EXPECT_NEAR(red709[1], 0, 2);
+  EXPECT_NEAR(red709[2], 0, 2);
+}
+
+TEST(YuvConvert, WithinOneOfFloatingPoint) {
+  const YuvColorSpace cs{YuvMatrix::Bt709, false};
+  const YuvShaderMatrix m = yuv_shader_matrix(cs);
+  for (int y = 0; y < 256; y += 5) {
+    for (int u = 0; u < 256; u += 15) {
+      for (int v = 0; v < 256; v += 15) {
+        const auto rgba = convert_pixel(static_cast<uint8_t>(y), static_cast<uint8_t>(u), static_cast<uint8_t>(v), cs);
+        const float yn = y / 255.0f - m.y_offset;
+        const float un = u / 255.0f - 128.0f / 255.0f;
+        const float vn = v / 255.0f - 128.0f / 255.0f;
+        for (int c = 0; c < 3; ++c) {
+          const float f = m.m[c * 3] * yn + m.m[c * 3 + 1] * un + m.m[c * 3 + 2] * vn;
+          const int expected = static_cast<int>(std::lround(std::clamp(f, 0.0f, 1.0f) * 255.0f));
+          ASSERT_LE(std::abs(rgba[c] - expected), 1) << "y=" << y << " u=" << u << " v=" << v << " c=" << c;
+        }
+      }
+    }
+  }
+}
+
+TEST(YuvConvert, DefaultColorSpaceFollowsResolution) {
+  EXPECT_EQ(default_color_space(800, 480).matrix, YuvMatrix::Bt601);
+  EXPECT_EQ(default_color_space(1280, 720).matrix, YuvMatrix::Bt709);
+  EXPECT_EQ(default_color_space(1920, 1080).matrix, YuvMatrix::Bt709);
+  EXPECT_FALSE(default_color_space(1920, 1080).full_range);
+}
+
+TEST(YuvConvert, PaddedPlanesMatchPacked) {
+  // Decoder-style planes: rows padded to 64 bytes, planes apart.
+  const int width = 37, height = 9;
+  const int uv_w = (width + 1) / 2, uv_h = (height + 1) / 2;
+  const auto yuv = random_i420(width, height, 7);
+  const I420Planes packed = i420_packed_planes(yuv.data(), width, height);
+  std::vector<uint8_t> padded(64 * (height + 2 * uv_h), 0xEE);
+  I420Planes planes;
+  const int rows[3] = {height, uv_h, uv_h};
+  const int widths[3] = {width, uv_w, uv_w};
+  uint8_t* dst = padded.data();
+  for (int i = 0; i < 3; ++i) {
+    planes.data[i] = dst;
+    planes.stride[i] = 64;
+    for (int r = 0; r < rows[i]; ++r, dst += 64) {
+      std::copy_n(packed.data[i] + r * packed.stride[i], widths[i], dst);
+    }
+  }
+  const YuvColorSpace cs = default_color_space(width, height);
+  std::vector<uint8_t> from_packed(static_cast<size_t>(width) * height * 4);
+  std::vector<uint8_t> from_planes(from_packed.size());
+  i420_to_rgba(yuv.data(), width, height, from_packed.data(), width * 4, cs);
+  i420_to_rgba(planes, width, height, from_planes.data(), width * 4, cs);
+  EXPECT_EQ(from_packed, from_planes);
+}
+
+}  // namespace test
+}  // namespace openautoflutter
@@ -0,0 +1,27 @@
+// openautoflutter_decode_worker: decodes one video stream for the plugin in
+// a separate process, so a crash in libavcodec does not take the HMI down and
+// decode CPU time can be capped in its own cgroup. Started by RemoteDecoder
+// with the channel fds already in place; not meant to be run by hand.
+//
+// Usage:
+//   openautoflutter_decode_worker --shm-fd=N --request-fd=N --done-fd=N
+//                                 [--cgroup=/sys/fs/cgroup/...] [--cpu-percent=N]
+
+#include "../av/decode_worker.h"
+
+#include <csignal>
+#include <iostream>
+
+int main(int argc, char** argv) {
+	DecodeWorkerArgs args;
+	if (!parse_decode_worker_args(argc, argv, args)) {
+		std::cerr << "usage: " << argv[0]
+			<< " --shm-fd=N --request-fd=N --done-fd=N [--cgroup=PATH] [--cpu-percent=N]" << std::endl;
+		return 2;
+	}
+	// The plugin may be stopped in a debugger; never die from its terminal.
+	std::signal(SIGINT, SIG_IGN);
+	std::signal(SIGPIPE, SIG_IGN);
+	join_cgroup(args.cgroup, args.cpu_percent);
+	return run_decode_worker(args);
+}
@@ -1,5 +1,8 @@
+import 'dart:typed_data';
+
 import 'package:flutter/services.dart';
 import 'package:flutter_test/flutter_test.dart';
+import 'package:openautoflutter/openautoflutter.dart';
 import 'package:openautoflutter/openautoflutter_method_channel.dart';
 
 void main() {
@@ -7,17 +10,63 @@ void main() {
 
   MethodChannelOpenautoflutter platform = MethodChannelOpenautoflutter();
   const MethodChannel channel = MethodChannel('openautoflutter');
+  final List<MethodCall> log = <MethodCall>[];
 
   setUp(() {
+    log.clear();
     TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(
       channel,
       (MethodCall methodCall) async {
+        log.add(methodCall);
         if (methodCall.method == 'getPlatformVersion') {
           return '42';
         }
         if (methodCall.method == 'getVideoTextureId') {
           return 7;
         }
+        if (methodCall.method == 'stopVideoCapture') {
+          return 12;
+        }
+        if (methodCall.method == 'addVideoStreamView') {
+          return 11;
+        }
+        if (methodCall.method == 'getConnectionState') {
+          return <String, Object?>{'state': 'backoff', 'attempt': 2, 'retryInMs': 500, 'connects': 0};
+        }
+        if (methodCall.method == 'configurePipeline') {
+          final args = Map<String, Object?>.from(methodCall.arguments as Map);
+          return <String, Object?>{
+            'pumpIntervalMs': args['pumpIntervalMs'] ?? 16,
+            'transportWaitMs': 5000,
+            'scaler': args['scaler'] ?? 'bilinear',
+            'lowDelay': args['lowDelay'] ?? false,
+            'decodeWorker': args['decodeWorker'] ?? false,
+            'decodeCpuPercent': args['decodeCpuPercent'] ?? 0,
+            'prefaultMemory': args['prefaultMemory'] ?? false,
+            'hugePages': args['hugePages'] ?? false,
+            'memoryLockBudget': args['memoryLockBudget'] ?? 0,
+          };
+        }
+        if (methodCall.method == 'getStartupTimeline') {
+          return <String, Object?>{'pluginRegistered': 0, 'glProgramReady': 1500, 'firstFramePopulated': 820000};
+        }
+        if (methodCall.method == 'getBitstreamStats') {
+          return <String, Object?>{
+            'codec': 'h264',
+            'frames': 60,
+            'keyframes': 2,
+            'bitrateShortBps': 4000000,
+            'fps': 30.0,
+            'nalCounts': <int, int>{1: 58, 5: 2, 7: 2},
+            'gopLength': 30,
+            'keyframeIntervalUs': 1000000,
+            'profile': 'High',
+            'level': 4.1,
+          };
+        }
+        if (methodCall.method == 'createVideoStream') {
+          return <String, Object?>{'streamId': 1, 'textureId': 9};
+        }
         return null;
       },
     );
@@ -34,4 +83,112 @@ void main() {
   test('getVideoTextureId', () async {
     expect(await platform.getVideoTextureId(), 7);
   });
+
+  test('sendTouchBatch uses the binary touch channel', () async {
+    ByteData? received;
+    TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMessageHandler(
+      'openautoflutter/touch',
+      (ByteData? message) async {
+        received = message;
+        return ByteData(0);
+      },
+    );
+    final packed = TouchEvent.pack(const [
+      TouchEvent(pointerId: 3, x: 0.25, y: 0.5, action: TouchAction.moved),
+    ]);
+    await platform.sendTouchBatch(packed);
+    expect(received?.lengthInBytes, 16);
+    expect(received?.getFloat32(0, Endian.little), 0.25);
+    expect(received?.getUint32(8, Endian.little), 3);
+    expect(received?.getUint32(12, Endian.little), 2);
+    TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMessageHandler('openautoflutter/touch', null);
+  });
+
+  test('createVideoStream', () async {
+    final result = await platform.createVideoStream(messageType: 5);
+    expect(result['streamId'], 1);
+    expect(result['textureId'], 9);
+  });
+
+  test('createVideoStream and setVideoStreamCodec pass the codec', () async {
+    await platform.createVideoStream(messageType: 5, codec: VideoCodec.h265.name);
+    expect(log.last.arguments, <String, Object?>{'messageType': 5, 'codec': 'h265'});
+    await platform.setVideoStreamCodec(0, VideoCodec.h264.name);
+    expect(log.last.method, 'setVideoStreamCodec');
+    expect(log.last.arguments, <String, Object?>{'streamId': 0, 'codec': 'h264'});
+  });
+
+  test('getConnectionState', () async {
+    final status = TransportStatus.fromMap(await platform.getConnectionState());
+    expect(status.state, TransportState.backoff);
+    expect(status.attempt, 2);
+    expect(status.retryIn, const Duration(milliseconds: 500));
+  });
+
+  test('configurePipeline sends only the set fields', () async {
+    const config = PipelineConfig(pumpInterval: Duration(milliseconds: 8), scaler: ScalerMode.fastBilinear);
+    expect(config.toMap(), <String, Object?>{'pumpIntervalMs': 8, 'scaler': 'fast_bilinear'});
+    final effective = PipelineConfig.fromMap(await platform.configurePipeline(config.toMap()));
+    expect(effective.pumpInterval, const Duration(milliseconds: 8));
+    expect(effective.transportWait, const Duration(seconds: 5));
+    expect(effective.scaler, ScalerMode.fastBilinear);
+    expect(effective.lowDelay, isFalse);
+    expect(effective.decodeWorker, isFalse);
+  });
+
+  test('configurePipeline carries the decode worker settings', () async {
+    const config = PipelineConfig(decodeWorker: true, decodeCpuPercent: 150);
+    expect(config.toMap(), <String, Object?>{'decodeWorker': true, 'decodeCpuPercent': 150});
+    final effective = PipelineConfig.fromMap(await platform.configurePipeline(config.toMap()));
+    expect(effective.decodeWorker, isTrue);
+    expect(effective.decodeCpuPercent, 150);
+    expect(effective.decodeCgroup, isNull);
+  });
+
+  test('configurePipeline carries the memory residency settings', () async {
+    const config = PipelineConfig(prefaultMemory: true, memoryLockBudget: 16 << 20);
+    expect(config.toMap(), <String, Object?>{'prefaultMemory': true, 'memoryLockBudget': 16 << 20});
+    final effective = PipelineConfig.fromMap(await platform.configurePipeline(config.toMap()));
+    expect(effective.prefaultMemory, isTrue);
+    expect(effective.hugePages, isFalse);
+    expect(effective.memoryLockBudget, 16 << 20);
+  });
+
+  test('getStartupTimeline', () async {
+    final timeline = StartupTimeline.fromMap(await platform.getStartupTimeline());
+    expect(timeline.glProgramReady, const Duration(microseconds: 1500));
+    expect(timeline.firstFramePopulated, const Duration(milliseconds: 820));
+    expect(timeline.firstVideoPacket, isNull);
+    expect(timeline.lastConnectToFrame, isNull);
+  });
+
+  test('getBitstreamStats', () async {
+    final stats = BitstreamStats.fromMap(await platform.getBitstreamStats(1));
+    expect(log.last.arguments, <String, Object?>{'streamId': 1});
+    expect(stats.gopLength, 30);
+    expect(stats.keyframeInterval, const Duration(seconds: 1));
+    expect(stats.nalCounts[5], 2);
+    expect(stats.profile, 'High');
+    expect(stats.width, isNull);
+  });
+
+  test('setVideoVisible', () async {
+    await platform.setVideoVisible(9, false);
+    expect(log.last.method, 'setVideoVisible');
+    expect(log.last.arguments, <String, Object?>{'textureId': 9, 'visible': false});
+  });
+
+  test('setVideoCrop', () async {
+    await platform.setVideoCrop(0, 80, 0, 640, 480);
+    expect(log.last.method, 'setVideoCrop');
+    expect(log.last.arguments, <String, Object?>{'streamId': 0, 'x': 80, 'y': 0, 'width': 640, 'height': 480});
+  });
+
+  test('addVideoStreamView', () async {
+    expect(await platform.addVideoStreamView(0), 11);
+  });
+
+  test('stopVideoCapture', () async {
+    expect(await platform.stopVideoCapture(), 12);
+  });
 }